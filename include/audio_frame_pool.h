@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class AudioFramePool;
+class AudioFrameRef;
+
+// 池化的PCM帧
+// 引用计数内嵌在帧中，帧在预处理、VAD和分段器之间传递时只传引用；
+// 引用归零后帧回到所属的池，samples保留已分配的容量供下次使用。
+// 帧只在持有唯一引用时修改，共享后视为只读。
+class AudioFrame {
+public:
+    std::vector<float> samples;
+
+    AudioFrame(const AudioFrame&) = delete;
+    AudioFrame& operator=(const AudioFrame&) = delete;
+
+private:
+    friend class AudioFramePool;
+    friend class AudioFrameRef;
+
+    AudioFrame() = default;
+
+    std::atomic<uint32_t> ref_count{0};
+    AudioFramePool* pool = nullptr;
+    AudioFrame* next_free = nullptr;  // 空闲链表
+};
+
+// 帧的侵入式引用
+class AudioFrameRef {
+public:
+    AudioFrameRef() = default;
+    AudioFrameRef(const AudioFrameRef& other) : frame(other.frame) { retain(); }
+    AudioFrameRef(AudioFrameRef&& other) noexcept : frame(other.frame) { other.frame = nullptr; }
+    ~AudioFrameRef() { reset(); }
+
+    AudioFrameRef& operator=(const AudioFrameRef& other) {
+        if (frame != other.frame) {
+            AudioFrameRef(other).swap(*this);
+        }
+        return *this;
+    }
+    AudioFrameRef& operator=(AudioFrameRef&& other) noexcept {
+        AudioFrameRef(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void swap(AudioFrameRef& other) noexcept { std::swap(frame, other.frame); }
+    void reset();
+
+    AudioFrame* get() const { return frame; }
+    AudioFrame* operator->() const { return frame; }
+    AudioFrame& operator*() const { return *frame; }
+    explicit operator bool() const { return frame != nullptr; }
+
+    // 是否为唯一引用（可以安全修改）
+    bool unique() const { return frame && frame->ref_count.load(std::memory_order_acquire) == 1; }
+
+private:
+    friend class AudioFramePool;
+
+    explicit AudioFrameRef(AudioFrame* f) : frame(f) { retain(); }
+    void retain() {
+        if (frame) {
+            frame->ref_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    AudioFrame* frame = nullptr;
+};
+
+// 帧池统计
+struct AudioFramePoolStats {
+    size_t slabs = 0;          // 已分配的slab数
+    size_t frames_total = 0;   // 帧总数
+    size_t frames_in_use = 0;  // 正在使用的帧数
+    size_t peak_in_use = 0;    // 使用峰值
+};
+
+// 音频帧池
+// 帧按slab成批分配，每帧预留frame_samples个样本，空闲帧用侵入式链表管理。
+// 池只增不减；帧的容量被调用方换成过大的存储时，归还时收缩回默认容量。
+class AudioFramePool {
+public:
+    static constexpr size_t DEFAULT_FRAME_SAMPLES = 4096;  // 与采集缓冲区大小一致
+    static constexpr size_t DEFAULT_FRAMES_PER_SLAB = 64;
+
+    // 进程内共享的池（多通道共用）
+    static AudioFramePool& getInstance();
+
+    explicit AudioFramePool(size_t frame_samples = DEFAULT_FRAME_SAMPLES,
+                            size_t frames_per_slab = DEFAULT_FRAMES_PER_SLAB);
+    ~AudioFramePool();
+
+    AudioFramePool(const AudioFramePool&) = delete;
+    AudioFramePool& operator=(const AudioFramePool&) = delete;
+
+    // 取出一个空帧（samples为空，容量至少为frame_samples）
+    AudioFrameRef acquire();
+
+    AudioFramePoolStats getStats() const;
+
+private:
+    friend class AudioFrameRef;
+
+    // 引用归零时由AudioFrameRef调用
+    void release(AudioFrame* frame);
+
+    // 分配一个新的slab并把帧加入空闲链表，调用时需持有mutex
+    void addSlab();
+
+    const size_t frame_samples;
+    const size_t frames_per_slab;
+
+    mutable std::mutex mutex;
+    AudioFrame* free_list = nullptr;
+    std::vector<std::unique_ptr<AudioFrame[]>> slabs;
+    size_t frames_in_use = 0;
+    size_t peak_in_use = 0;
+};
+
+inline void AudioFrameRef::reset() {
+    if (frame) {
+        if (frame->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            frame->pool->release(frame);
+        }
+        frame = nullptr;
+    }
+}
@@ -7,9 +7,11 @@
 #include <QtGlobal>
 #include <QString>
 #include "realtime_segment_handler.h"
+#include "wav_reader.h"
 #include <functional>
 #include <memory>
 #include <thread>
+#include <mutex>
 #include <QObject>
 
 // 麦克风捕获回调接口
@@ -82,6 +84,9 @@ public:
     // 添加setFastMode方法用于动态切换处理模式
     void setFastMode(bool fast_mode);
     
+    // 设置多声道文件的下混方式，channel仅用于SelectChannel模式，下一次处理文件时生效
+    void setDownmixMode(DownmixMode mode, int channel = 0);
+    
     // 修改start方法，使其不需要参数
     bool start();
     // 保留原有的带参数的start方法重载
@@ -100,6 +105,8 @@ private:
     std::thread process_thread;
     bool fast_mode{false};
     std::atomic<qint64> current_position{0}; // 当前播放位置，毫秒
+    DownmixMode downmix_mode{DownmixMode::Average};
+    int downmix_channel{0};
     
     void processFile();
 };
@@ -157,7 +164,25 @@ public:
     void stop();
     void process_audio_batch(const std::vector<AudioBuffer>& batch);
     
+    // 直接识别连续的PCM样本（如离线摄取的语音段视图），无需先拷贝到AudioBuffer
+    void process_audio(const float* samples, size_t count,
+                       std::chrono::system_clock::time_point timestamp, qint64 duration_ms = 0);
+    
+    // 离线并行识别：states个whisper_state共享模型权重，各占一个工作线程并行解码blocks，
+    // whisper内部线程数按CPU核数平均分配。每段完成时以段的下标回调on_result（回调之间互斥，
+    // 完成顺序不定，未识别出语音时text为空）；cancel置位后不再开始新的段
+    void process_blocks_parallel(const std::vector<PcmBlockPtr>& blocks, int states,
+                                 const std::function<void(size_t index, const std::string& text)>& on_result,
+                                 const std::atomic<bool>* cancel = nullptr);
+    
+    // 流式部分结果解码：使用独立的whisper_state，可与process_audio_batch并发执行
+    bool decodePartial(const std::vector<float>& audio, std::string& text);
+    
 private:
+    // 识别一段音频并整理文本，state为空时使用ctx自带的状态；未识别出语音或失败时返回false
+    bool recognize(struct whisper_state* state, const float* samples, size_t count, int n_threads,
+                   std::string& text);
+    
     std::string model_path;
     ResultQueue* input_queue;
     ResultQueue* output_queue{nullptr};
@@ -167,6 +192,10 @@ private:
     std::atomic<bool> running{false};
     Translator* translator{nullptr};
     struct whisper_context* ctx{nullptr};
+    struct whisper_state* partial_state{nullptr};  // 部分结果解码专用状态（首次使用时创建）
+    std::mutex partial_mutex;
+    std::vector<struct whisper_state*> pool_states;  // 并行识别的状态池（按需扩充，析构时释放）
+    std::mutex pool_mutex;
 };
 
 // 精确识别器类
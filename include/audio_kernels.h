@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 一次遍历得到的缓冲区统计
+struct AudioBufferStats {
+    float sum_squares = 0.0f;  // 平方和
+    float peak = 0.0f;         // 最大绝对值
+};
+
+// 逐点处理链的参数，按AGC增益 -> 压缩 -> 整体增益的顺序在一次遍历中完成
+struct PointwiseChainParams {
+    bool apply_gain = false;        // AGC增益，乘后限幅到[-1, 1]
+    float gain = 1.0f;
+    bool apply_compression = false; // 超过阈值的部分按压缩比衰减，之后限幅
+    float compression_threshold = 0.5f;
+    float compression_ratio = 2.0f;
+    bool apply_final_gain = false;  // 整体音量放大，乘后限幅
+    float final_gain = 1.0f;
+};
+
+// 预处理的向量化内核
+// 运行时按CPU能力选择AVX2/SSE2/NEON实现，没有可用指令集时使用标量实现。
+// 平方和按8路交错累加后固定顺序合并，各实现的运算顺序完全一致，结果逐位相同；
+// 首次使用时会用合成数据与标量实现对比，不一致则退回标量实现。
+class AudioKernels {
+public:
+    // 平方和与峰值
+    static AudioBufferStats analyze(const float* data, size_t count);
+
+    // 原地预加重 y[i] = x[i] - coef * x[i-1]（首个样本不变），返回处理后的平方和
+    static float preEmphasis(float* data, size_t count, float coef);
+
+    // 可选的缩放限幅 + 一阶高通（状态跨调用保存），返回处理后的平方和
+    // 高通是递归滤波器，启用时按样本顺序计算
+    static float scaleAndHighPass(float* data, size_t count,
+                                  bool apply_scale, float scale,
+                                  bool apply_high_pass, float alpha, float* hp_state);
+
+    // 逐点处理链，返回处理后的统计
+    static AudioBufferStats applyPointwise(float* data, size_t count, const PointwiseChainParams& params);
+
+    // float转int16：限幅到[-1, 1]后乘32767并向零取整（与static_cast<int16_t>一致）
+    static void floatToInt16(const float* input, size_t count, int16_t* output);
+
+    // int16转float：乘1/32768
+    static void int16ToFloat(const int16_t* input, size_t count, float* output);
+
+    // 交错样本拆分为各声道平面：planes[c][i] = input[i * channels + c]
+    static void deinterleave(const float* input, size_t frames, int channels, float* const* planes);
+
+    // 各声道逐样本取平均：按声道顺序累加后乘1/channels
+    static void averageChannels(const float* const* planes, int channels, size_t frames, float* output);
+
+    // 当前使用的实现名称（AVX2/SSE2/NEON/Scalar）
+    static const char* getActiveImplementation();
+};
@@ -3,9 +3,8 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
-
-// 前向声明RNNoise结构体
-struct DenoiseState;
+#include <memory>
+#include "streaming_denoiser.h"
 
 class AudioPreprocessor {
 public:
@@ -27,8 +26,11 @@ public:
     void destroyNoiseSuppressor();
     bool isNoiseSuppressionAvailable() const;
     
-    // 获取噪声抑制器指针（供外部直接调用）
-    void* getNoiseSuppressor() const { return noise_suppressor; }
+    // 获取流式降噪级（供外部直接调用）
+    StreamingDenoiser* getNoiseSuppressor() const { return noise_suppressor.get(); }
+    
+    // 降噪引入的延迟（16kHz样本数），未启用降噪时为0
+    size_t getNoiseSuppressionLatency() const;
 
     // 兼容性函数 - 保持与旧代码兼容
     void setUsePreEmphasis(bool enable) { use_pre_emphasis = enable; }
@@ -97,8 +99,8 @@ public:
 
     // 滤波器状态
     float hp_filter_state[2];
-    // 噪声抑制器指针（RNNoise DenoiseState*）
-    void* noise_suppressor;
+    // 流式降噪级，持有本路流的RNNoise状态和跨调用的帧缓冲
+    std::unique_ptr<StreamingDenoiser> noise_suppressor;
 
     // 🔧 新增：噪声抑制参数设置函数
     void setNoiseSuppressionParameters(float strength, float mix_ratio, bool adaptive = false) {
@@ -111,20 +113,12 @@ public:
     }
 
 private:
-    // 私有辅助函数
-    void convertFloatToPCM16(const std::vector<float>& float_buffer, std::vector<short>& pcm_buffer);
-    void convertPCM16ToFloat(const std::vector<short>& pcm_buffer, std::vector<float>& float_buffer);
-    
-    // RNNoise 16kHz适配处理方法
-    void processWithNative16k(std::vector<float>& audio_buffer, void* state, size_t frame_size);
-    void processWithAdapted48k(std::vector<float>& audio_buffer, void* state);
-    void processWithHighQualityResampling(std::vector<float>& audio_buffer, void* state);
-    void processWithSimpleMethod(std::vector<float>& audio_buffer, void* state);
-    
     // 辅助函数
     float calculateRMS(const std::vector<float>& buffer);
-    std::vector<float> upsampleLanczos(const std::vector<float>& input, int orig_sr, int target_sr);
-    std::vector<float> downsampleLanczos(const std::vector<float>& input, int orig_sr, int target_sr);
+    float updateAGCGain(float rms, float target_level);  // 根据当前RMS平滑更新AGC增益并返回
+    
+    // 与降噪输出对齐（同样延迟）的原始音频，用于干湿混合
+    std::vector<float> dry_buffer;
     
     // 🔧 新增：改进的噪声抑制处理方法
     void applyAdaptiveNoiseSuppression(std::vector<float>& audio_buffer, const std::vector<float>& original_buffer);
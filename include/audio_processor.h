@@ -23,6 +23,9 @@
 #include <voice_activity_detector.h>
 #include <audio_preprocessor.h>
 #include <output_corrector.h>
+#include <streaming_recognizer.h>
+#include <offline_file_ingestor.h>
+#include <precise_server_pool.h>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QPointer>
@@ -53,6 +56,7 @@ struct RecognitionParams {
     bool use_gpu = false;
     int beam_size = 5;
     float temperature = 0.0f;
+    bool is_final_segment = false;  // 最后一段音频，服务器优先调度
 };
 
 class AudioProcessor : public QObject {
@@ -95,6 +99,15 @@ public:
     void setFastMode(bool enable);
     bool isFastMode() const { return fast_mode; }
     
+    // 多声道音频文件的下混方式（平均/指定声道/最响声道），下一次处理文件时生效
+    void setFileDownmix(DownmixMode mode, int channel = 0);
+    DownmixMode getFileDownmixMode() const { return file_downmix_mode; }
+    
+    // 离线整文件摄取：快速模式下处理文件时，内存映射读取整个WAV并先做整文件VAD，
+    // 再把语音段不按实时节奏直接分发给识别器，下一次处理文件时生效
+    void setOfflineIngest(bool enable);
+    bool isOfflineIngestEnabled() const { return use_offline_ingest; }
+    
     // OpenAI API设置
     void setUseOpenAI(bool enable);
     bool isUsingOpenAI() const;
@@ -109,6 +122,10 @@ public:
     void setSegmentSize(size_t ms);
     void setSegmentOverlap(size_t ms);
     
+    // 流式部分结果设置（仅快速识别模式，使用本地模型对增长中的语音段反复解码）
+    void setStreamingPartials(bool enable);
+    bool isStreamingPartialsEnabled() const { return use_streaming_partials; }
+    
     // 添加识别模式设置方法
     void setRecognitionMode(RecognitionMode mode);
     RecognitionMode getRecognitionMode() const { return current_recognition_mode; }
@@ -118,11 +135,14 @@ public:
     void setPreciseServerURL(const std::string& url);
     std::string getPreciseServerURL() const { return precise_server_url; }
     
-    // 测试精确服务器连接
+    // 测试精确服务器连接（同步，供界面上的手动测试使用；上传前只查询后台健康监测的缓存状态）
     bool testPreciseServerConnection();
     
     // 发送到精确识别服务器
     bool sendToPreciseServer(const std::string& audio_file_path, const RecognitionParams& params);
+    
+    // 发送内存中的PCM块到精确识别服务器（不经过临时文件）
+    bool sendToPreciseServer(const PcmBlockPtr& audio, const RecognitionParams& params);
 
     void parallelOpenAIProcessor(const QString& result);
     
@@ -288,6 +308,9 @@ public:
     // 延迟初始化VAD实例（在Qt multimedia完全初始化后调用）
     bool initializeVADSafely();
     
+    // voice_detector的配置变化后同步到分段处理器的VAD
+    void syncSegmentVoiceDetector();
+    
     // 检查VAD是否已初始化
     bool isVADInitialized() const;
     
@@ -340,6 +363,10 @@ signals:
     
     void recognitionResultReady(const QString& text);
     
+    // 流式部分结果：committed为已稳定的前缀，tentative为可能被修正的部分
+    // 语音段结束后其最终结果仍通过recognitionResultReady等信号给出
+    void partialResultReady(const QString& committed, const QString& tentative);
+    
     void subtitlePreviewReady(const QString& text, qint64 timestamp, qint64 duration);
     
     // 添加一个新的信号，通知处理已完全停止
@@ -368,12 +395,26 @@ private:
                               const std::string& temp_dir, 
                               size_t segment_num);
                               
-    // 根据识别模式处理音频数据
-    void processAudioDataByMode(const std::vector<float>& audio_data);
+    // 根据识别模式处理音频数据，PCM块直接传给上传或OpenAI处理器，不再复制
+    void processAudioDataByMode(const PcmBlockPtr& audio, bool is_final_segment = false);
+    
+    // 取出待处理的音频段并清空队列：只有一段时原样返回，多段时合并为一个块
+    PcmBlockPtr takePendingAudio();
     
     // 启动最后段延迟处理，确保最后一个音频段的识别结果有足够时间返回
     void startFinalSegmentDelayProcessing();
     
+    // 启动/停止流式增量识别器，并连接到当前的分段处理器
+    void startStreamingRecognizer();
+    void stopStreamingRecognizer();
+    
+    // 离线摄取线程：切分整个文件并按识别模式分发各语音段，结束后发送最后一个缓冲区标记
+    void runOfflineIngest(const std::string& file_path);
+    void dispatchOfflineSegment(const OfflineSpeechSegment& segment, bool is_last);
+    
+    // 快速识别模式下在whisper状态池上并行识别全部语音段，按序拼接后推送结果
+    void transcribeOfflineParallel(const std::vector<OfflineSpeechSegment>& segments);
+    
     // GUI指针
     WhisperGUI* gui;
     
@@ -404,18 +445,39 @@ private:
     size_t min_speech_segment_samples{0};  // 最小语音段长度(样本数)
     size_t max_silence_ms{500};  // 最大静音长度(毫秒)
     size_t silence_frames_count{0};  // 静音帧计数
-    std::unique_ptr<VoiceActivityDetector> voice_detector;  // VAD检测器
+    std::unique_ptr<VoiceActivityDetector> voice_detector;  // VAD检测器（检测原始音频）
+    std::unique_ptr<VoiceActivityDetector> segment_voice_detector;  // 实时分段处理器的VAD（检测预处理后的音频），配置与voice_detector同步
     
     // OpenAI API设置
     bool use_openai{false}; // 默认关闭OpenAI API
     std::string openai_server_url{"http://127.0.0.1:5000"}; // 默认API服务器地址
     std::string openai_model{"whisper-1"}; // 默认OpenAI模型
+    std::string openai_upload_format{"wav"}; // 内存段上传格式（wav/flac）
     
     // 实时分段设置
     bool use_realtime_segments{false}; // 默认不启用实时分段
     size_t segment_size_ms{3500};      // 默认3.5秒，减半音频段大小  
     size_t segment_overlap_ms{1000};   // 默认1秒重叠，提高连续性
     
+    // 流式部分结果设置
+    bool use_streaming_partials{false}; // 默认不启用
+    size_t streaming_step_ms{500};      // 每增长500ms重新解码一次
+    size_t streaming_window_ms{15000};  // 解码窗口，与15秒强制分段一致
+    
+    // 文件输入的下混设置
+    DownmixMode file_downmix_mode{DownmixMode::Average};
+    int file_downmix_channel{0};        // SelectChannel模式使用的声道（从0开始）
+    
+    // 离线整文件摄取设置
+    bool use_offline_ingest{false};     // 默认关闭，仅在快速模式下生效
+    OfflineIngestOptions offline_ingest_options;
+    int offline_max_uploads{4};         // 精确识别模式下同时在途的上传数
+    int offline_parallel_states{0};     // 快速识别模式下并行的whisper状态数，0表示按CPU核数选择
+    std::string offline_ingest_path;    // 本次处理待摄取的文件，为空表示按常规方式读取
+    std::thread offline_thread;
+    std::atomic<bool> offline_cancel{false};
+    std::atomic<int> offline_queued_uploads{0};  // 已提交到主线程但尚未发出的上传
+    
     // 处理状态
     std::atomic<bool> is_processing{false};
     std::atomic<bool> is_paused{false};
@@ -465,6 +527,15 @@ private:
     std::string precise_server_url = "http://localhost:8080";  // 默认精确识别服务地址
     QNetworkAccessManager* precise_network_manager = nullptr;
     std::atomic<int> next_request_id{0};
+    
+    // 精确识别服务器池（各服务器带后台健康监测与熔断），首次上传或进入精确识别模式时创建
+    HealthCheckOptions precise_health_options;
+    std::vector<std::string> precise_extra_endpoints;  // precise_server_url之外的服务器
+    PreciseRouting precise_routing = PreciseRouting::LeastOutstanding;
+    std::string precise_upload_format = "wav";  // flac时向声明支持FLAC的服务器压缩上传内存段
+    std::unique_ptr<PreciseServerPool> precise_server_pool;
+    PreciseServerPool* getPreciseServerPool();
+    std::vector<std::string> getPreciseEndpointUrls() const;
     std::map<int, std::chrono::system_clock::time_point> request_timestamps;
     std::mutex request_mutex;
     
@@ -508,8 +579,8 @@ private:
     std::vector<AudioBuffer> current_batch;
     size_t batch_size;
     
-    // 用于合并短音频段
-    std::vector<float> pending_audio_data;
+    // 用于合并短音频段（保存段的PCM块，达到处理长度时才合并）
+    std::vector<PcmBlockPtr> pending_audio_blocks;
     size_t pending_audio_samples = 0;
     size_t min_processing_samples = 16000; // 1秒的最小处理长度（移除const修饰符）
     
@@ -544,13 +615,21 @@ private:
     bool startStreamAudioExtraction();
     
     // 请求管理相关变量
+    // 精确服务器上传的统一实现，audio非空时忽略file_path
+    // failed_endpoint为重试前失败的服务器，有其他可用服务器时转移过去
+    bool postToPreciseServer(const std::string& audio_file_path, const PcmBlockPtr& audio,
+                             const RecognitionParams& params,
+                             const PreciseEndpointPtr& failed_endpoint = nullptr);
+    
     struct RequestInfo {
         std::string file_path;
+        PcmBlockPtr audio;  // 内存段（重试时直接复用）
         std::chrono::system_clock::time_point start_time;
         int retry_count = 0;
         RecognitionParams params;
         qint64 file_size = 0;
         bool is_final_segment = false;
+        PreciseEndpointPtr endpoint;  // 处理此请求的服务器
     };
     
     std::map<int, RequestInfo> active_requests;
@@ -571,4 +650,7 @@ private:
     int calculateDynamicTimeout(qint64 file_size_bytes);
     bool shouldRetryRequest(int request_id, QNetworkReply::NetworkError error);
     void retryRequest(int request_id);
+    
+    // 流式增量识别器（最后声明，先于识别器析构）
+    std::unique_ptr<StreamingRecognizer> streaming_recognizer;
 };
\ No newline at end of file
@@ -1,33 +1,81 @@
 ﻿#pragma once
 
 #include <queue>
+#include <vector>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <cstdint>
 #include "audio_types.h"
 
 // 前向声明
 class AudioProcessor;
 
+// 音频队列统计（用于观察背压情况）
+struct AudioQueueStats {
+    uint64_t pushed = 0;       // 成功入队的缓冲区数
+    uint64_t popped = 0;       // 出队的缓冲区数
+    uint64_t dropped = 0;      // 队列满时被丢弃的缓冲区数
+    uint64_t full_waits = 0;   // 生产者因队列满而等待的次数
+    size_t high_watermark = 0; // 队列最大深度
+};
+
 // 音频队列类
+// 单生产者/单消费者无锁环形队列：槽位在构造时预分配，入队和出队只交换槽位与调用方的存储，
+// 采集线程上不再有逐缓冲区的内存分配和加锁。只允许一个线程push、一个线程pop。
 class AudioQueue {
 public:
+    static constexpr size_t DEFAULT_CAPACITY = 128;       // 槽位数（向上取整为2的幂）
+    static constexpr size_t DEFAULT_FRAME_SAMPLES = 4096; // 每个槽位预分配的样本数
+
+    explicit AudioQueue(size_t capacity = DEFAULT_CAPACITY, size_t frame_samples = DEFAULT_FRAME_SAMPLES);
+    AudioQueue(const AudioQueue&) = delete;
+    AudioQueue& operator=(const AudioQueue&) = delete;
+
+    // 消费者：取出一个缓冲区，buffer原有的存储交还给队列复用
     bool pop(AudioBuffer& buffer, bool wait = true);
-    void push(const AudioBuffer& buffer);
+
+    // 生产者：移入一个缓冲区，buffer换回一块已清空的预分配存储。
+    // 队列满时：wait为false直接返回false（buffer保持不变，计入丢弃），
+    // wait为true则等待消费者腾出空间，队列终止时返回false
+    bool push(AudioBuffer&& buffer, bool wait = false);
+
     size_t size() const;
+    size_t capacity() const { return ring.size(); }
     bool is_terminated() const;
     void terminate();
+    // 清空队列并重置终止标志，只能在生产者和消费者都停止时调用
     void reset();
-    bool empty() { return queue.empty(); };
+    bool empty() const { return size() == 0; }
+
+    AudioQueueStats getStats() const;
     
     // 设置和获取关联的 AudioProcessor
     void setProcessor(AudioProcessor* processor) { audio_processor = processor; }
     AudioProcessor* getProcessor() const { return audio_processor; }
     
 private:
-    std::queue<AudioBuffer> queue;
-    mutable std::mutex mutex;
-    std::condition_variable condition;
+    // 唤醒阻塞在pop中的消费者
+    void notifyConsumer();
+
+    std::vector<AudioBuffer> ring;
+    size_t mask;
+
+    // 读写位置分别只由消费者/生产者修改，放在不同的缓存行避免伪共享
+    alignas(64) std::atomic<size_t> head{0};  // 下一个读取位置
+    alignas(64) std::atomic<size_t> tail{0};  // 下一个写入位置
+
+    alignas(64) std::atomic<uint64_t> pushed_count{0};
+    std::atomic<uint64_t> dropped_count{0};
+    std::atomic<uint64_t> full_wait_count{0};
+    std::atomic<size_t> high_watermark{0};
+    std::atomic<uint64_t> popped_count{0};
+
+    // 仅在消费者阻塞等待时使用
+    std::mutex wait_mutex;
+    std::condition_variable wait_condition;
+    std::atomic<bool> consumer_waiting{false};
+
     std::atomic<bool> terminated{false};
     AudioProcessor* audio_processor = nullptr;
 };
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+// 多相FIR重采样器
+// 按最简整数比 up/down 重采样：相当于先插入up-1个零、经低通滤波、再每down个取一个，
+// 但只计算实际需要的输出，每个输出只需一个相位的taps个乘加。
+// 各相位的滤波系数按比例预先计算并在所有实例间共享（只缓存最近使用的几种比例），系数按内存顺序与输入对齐，便于向量化。
+// 实例保存跨调用的历史样本，分块输入与整段输入的结果一致，块边界不会产生咔哒声。
+class AudioResampler {
+public:
+    static constexpr int DEFAULT_TAPS = 32;  // 每个相位的抽头数
+    static constexpr int MIN_SAMPLE_RATE = 1000;    // 支持的采样率范围，超出时构造函数抛出异常
+    static constexpr int MAX_SAMPLE_RATE = 384000;
+    static constexpr size_t MAX_CACHED_TABLES = 8;  // 系数表缓存上限，超出时淘汰最久未使用的表
+
+    AudioResampler(int input_rate, int output_rate, int taps_per_phase = DEFAULT_TAPS);
+
+    int getInputRate() const { return input_rate; }
+    int getOutputRate() const { return output_rate; }
+
+    // 流式处理：输出追加到output末尾
+    // 输出相对输入有固定的延迟（见getLatency），输出样本数与输入样本数严格成比例
+    void process(const float* input, size_t count, std::vector<float>& output);
+    void process(const std::vector<float>& input, std::vector<float>& output) {
+        process(input.data(), input.size(), output);
+    }
+
+    // 输入结束：补零输出滤波器中剩余的样本
+    void flush(std::vector<float>& output);
+
+    // 清空历史，开始新的流
+    void reset();
+
+    // 滤波器延迟（输出样本数）
+    size_t getLatency() const;
+
+    // 一次性重采样整段音频，已补偿滤波器延迟
+    static std::vector<float> resample(const std::vector<float>& input, int input_rate, int output_rate,
+                                       int taps_per_phase = DEFAULT_TAPS);
+
+private:
+    struct FilterTable {
+        int up = 1;
+        int down = 1;
+        int taps = 0;
+        std::vector<float> coeffs;  // coeffs[phase * taps + m]，m从最旧的输入样本开始
+    };
+
+    // 获取（必要时设计）指定比例的滤波系数表，最近使用的表保留在缓存中
+    static std::shared_ptr<const FilterTable> getFilterTable(int up, int down, int taps);
+    static std::shared_ptr<const FilterTable> designFilterTable(int up, int down, int taps);
+
+    int input_rate;
+    int output_rate;
+    int up;
+    int down;
+    int taps;
+    std::shared_ptr<const FilterTable> table;
+
+    std::vector<float> history;  // 最近taps-1个输入样本 + 本次输入
+    uint64_t position = 0;       // 下一个输出在上采样序列中的位置（以history起点为0）
+};
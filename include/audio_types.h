@@ -3,6 +3,7 @@
 #include <string>
 #include <chrono>
 #include <vector>
+#include <memory>
 #include <qtypes.h>
 
 // 音频输入模式枚举
@@ -34,9 +35,14 @@ struct AudioBuffer {
     bool is_empty() { return data.size() == 0; }
 };
 
+// 引用计数的PCM数据块（定义见audio_utils.h）
+class PcmBlock;
+using PcmBlockPtr = std::shared_ptr<const PcmBlock>;
+
 // 语音段结构
 struct AudioSegment {
-    std::string filepath;        // WAV文件路径
+    std::string filepath;        // WAV文件路径（内存模式下为空）
+    PcmBlockPtr pcm;             // 内存中的PCM数据（内存模式下有效）
     std::chrono::system_clock::time_point timestamp = std::chrono::system_clock::now();
     int sequence_number = 0;  // 添加序列号字段
     bool is_last{false};         // 是否是最后一个段
@@ -44,6 +50,9 @@ struct AudioSegment {
     int overlap_ms{0};          // 重叠毫秒数
 	int priority{ 0 };        // 优先级
     double duration_ms = 0.0; // 语音段的时长（毫秒）
+    
+    // 是否携带音频数据（内存块或WAV文件）
+    bool hasAudio() const { return pcm != nullptr || !filepath.empty(); }
 };
 
 // 识别结果结构
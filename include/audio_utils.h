@@ -9,58 +9,100 @@
 #include <cstring>
 #include <chrono>
 #include <ctime>
+#include <memory>
+#include <mutex>
+#include <algorithm>
 #include "audio_types.h"
+#include "flac_encoder.h"
 
 namespace fs = std::filesystem;
 
 class WavFileUtils {
 public:
+    // 将浮点数格式的音频数据编码为内存中的16位PCM WAV字节流
+    static std::string encodeWav(const float* samples,
+                                 size_t count,
+                                 int sampleRate = 16000,
+                                 int channels = 1) {
+        const uint16_t bitsPerSample = 16;
+        const uint32_t dataSize = static_cast<uint32_t>(count * sizeof(int16_t));
+        const uint32_t fileSize = 36 + dataSize;
+        const uint32_t subChunkSize = 16;
+        const uint16_t audioFormat = 1; // PCM格式
+        const uint16_t numChannels = static_cast<uint16_t>(channels);
+        const uint32_t rate = static_cast<uint32_t>(sampleRate);
+        const uint32_t byteRate = rate * numChannels * bitsPerSample / 8;
+        const uint16_t blockAlign = numChannels * bitsPerSample / 8;
+
+        std::string bytes(44 + dataSize, '\0');
+        char* out = bytes.data();
+
+        // 写入WAV头
+        std::memcpy(out, "RIFF", 4);
+        std::memcpy(out + 4, &fileSize, 4);
+        std::memcpy(out + 8, "WAVE", 4);
+        std::memcpy(out + 12, "fmt ", 4);
+        std::memcpy(out + 16, &subChunkSize, 4);
+        std::memcpy(out + 20, &audioFormat, 2);
+        std::memcpy(out + 22, &numChannels, 2);
+        std::memcpy(out + 24, &rate, 4);
+        std::memcpy(out + 28, &byteRate, 4);
+        std::memcpy(out + 32, &blockAlign, 2);
+        std::memcpy(out + 34, &bitsPerSample, 2);
+        std::memcpy(out + 36, "data", 4);
+        std::memcpy(out + 40, &dataSize, 4);
+
+        // 一次性将浮点转换为int16，限幅避免溢出回绕
+        int16_t* pcm = reinterpret_cast<int16_t*>(out + 44);
+        for (size_t i = 0; i < count; ++i) {
+            float sample = samples[i];
+            if (sample > 1.0f) sample = 1.0f;
+            if (sample < -1.0f) sample = -1.0f;
+            pcm[i] = static_cast<int16_t>(sample * 32767.0f);
+        }
+
+        return bytes;
+    }
+
     // 将浮点数格式的音频数据保存为WAV文件
     static bool saveWavFile(const std::string& filename, 
                             const std::vector<float>& audioData, 
                             int sampleRate = 16000, 
                             int channels = 1, 
                             int bitsPerSample = 16) {
+        if (bitsPerSample != 16) {
+            std::cerr << "仅支持16位WAV输出，忽略位深度: " << bitsPerSample << std::endl;
+        }
+
         std::ofstream file(filename, std::ios::binary);
         if (!file.is_open()) {
             std::cerr << "无法创建WAV文件: " << filename << std::endl;
             return false;
         }
 
-        // 写入WAV头
-        file.write("RIFF", 4);
-        uint32_t fileSize = 36 + audioData.size() * sizeof(int16_t);
-        file.write(reinterpret_cast<const char*>(&fileSize), 4);
-        file.write("WAVE", 4);
-        file.write("fmt ", 4);
-
-        uint32_t subChunkSize = 16;
-        uint16_t audioFormat = 1; // PCM格式
-        uint32_t byteRate = sampleRate * channels * bitsPerSample / 8;
-        uint16_t blockAlign = channels * bitsPerSample / 8;
-
-        file.write(reinterpret_cast<const char*>(&subChunkSize), 4);
-        file.write(reinterpret_cast<const char*>(&audioFormat), 2);
-        file.write(reinterpret_cast<const char*>(&channels), 2);
-        file.write(reinterpret_cast<const char*>(&sampleRate), 4);
-        file.write(reinterpret_cast<const char*>(&byteRate), 4);
-        file.write(reinterpret_cast<const char*>(&blockAlign), 2);
-        file.write(reinterpret_cast<const char*>(&bitsPerSample), 2);
-        file.write("data", 4);
-
-        uint32_t dataSize = audioData.size() * sizeof(int16_t);
-        file.write(reinterpret_cast<const char*>(&dataSize), 4);
-
-        // 写入音频数据 - 将浮点转换为int16
-        for (size_t i = 0; i < audioData.size(); ++i) {
-            int16_t sample = static_cast<int16_t>(audioData[i] * 32767.0f);
-            file.write(reinterpret_cast<const char*>(&sample), sizeof(int16_t));
-        }
+        // 在内存中完成编码后一次性写入，避免逐样本的write调用
+        const std::string bytes = encodeWav(audioData.data(), audioData.size(), sampleRate, channels);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
 
         file.close();
         return true;
     }
 
+    // 将多个AudioBuffer拼接为连续的浮点数据
+    static std::vector<float> concatBuffers(const std::vector<AudioBuffer>& buffers) {
+        size_t totalSize = 0;
+        for (const auto& buffer : buffers) {
+            totalSize += buffer.data.size();
+        }
+
+        std::vector<float> combined;
+        combined.reserve(totalSize);
+        for (const auto& buffer : buffers) {
+            combined.insert(combined.end(), buffer.data.begin(), buffer.data.end());
+        }
+        return combined;
+    }
+
     // 创建临时目录
     static std::string createTempDirectory(const std::string& baseName = "audio_segments") {
         try {
@@ -334,4 +376,79 @@ public:
         file.close();
         return true;
     }
-}; 
\ No newline at end of file
+};
+
+// 引用计数的浮点PCM数据块
+// 分段器生成后在合并、识别和上传各环节之间共享同一份采样数据，
+// WAV/FLAC字节流只在HTTP上传真正需要时按需生成一次并缓存
+// slice()得到的视图引用父块的一段样本，不复制数据，并持有父块保证其存活
+class PcmBlock {
+public:
+    explicit PcmBlock(std::vector<float> samples, int sampleRate = 16000)
+        : samples_(std::move(samples)), data_(samples_.data()), size_(samples_.size()),
+          sample_rate_(sampleRate) {}
+
+    PcmBlock(PcmBlockPtr parent, size_t offset, size_t length)
+        : parent_(std::move(parent)), data_(parent_->data() + offset), size_(length),
+          sample_rate_(parent_->sampleRate()) {}
+
+    static PcmBlockPtr create(std::vector<float> samples, int sampleRate = 16000) {
+        return std::make_shared<const PcmBlock>(std::move(samples), sampleRate);
+    }
+
+    static PcmBlockPtr fromBuffers(const std::vector<AudioBuffer>& buffers, int sampleRate = 16000) {
+        return create(WavFileUtils::concatBuffers(buffers), sampleRate);
+    }
+
+    // 从offset开始的length个样本的零拷贝视图，超出父块的部分被截掉
+    static PcmBlockPtr slice(const PcmBlockPtr& parent, size_t offset, size_t length) {
+        offset = std::min(offset, parent->size());
+        length = std::min(length, parent->size() - offset);
+        return std::make_shared<const PcmBlock>(parent, offset, length);
+    }
+
+    const float* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    int sampleRate() const { return sample_rate_; }
+    double durationMs() const { return size_ * 1000.0 / sample_rate_; }
+
+    // 惰性生成的WAV视图，首次调用时编码，之后复用
+    const std::string& wavBytes() const {
+        std::call_once(wav_once_, [this]() {
+            wav_bytes_ = WavFileUtils::encodeWav(data_, size_, sample_rate_);
+        });
+        return wav_bytes_;
+    }
+
+    // 惰性生成的FLAC视图，用于向支持的服务器压缩上传，量化方式与WAV相同
+    const std::string& flacBytes() const {
+        std::call_once(flac_once_, [this]() {
+            flac_bytes_ = FlacEncoder::encode(data_, size_, sample_rate_);
+        });
+        return flac_bytes_;
+    }
+
+    // 调试或兼容旧接口时落盘
+    bool saveTo(const std::string& filename) const {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "无法创建WAV文件: " << filename << std::endl;
+            return false;
+        }
+        const std::string& bytes = wavBytes();
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        return true;
+    }
+
+private:
+    std::vector<float> samples_;  // 视图不持有样本
+    PcmBlockPtr parent_;          // 视图所引用的父块
+    const float* data_;
+    size_t size_;
+    int sample_rate_;
+    mutable std::once_flag wav_once_;
+    mutable std::string wav_bytes_;
+    mutable std::once_flag flac_once_;
+    mutable std::string flac_bytes_;
+};
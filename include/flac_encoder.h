@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+// 无损FLAC编码（16位单声道）
+// 用于压缩上传的语音段。样本按与WavFileUtils::encodeWav相同的方式量化为16位，因此解码结果与上传WAV
+// 完全一致。每块使用0-4阶固定预测器中最省的一种，残差用分区Rice编码；语音通常能压缩到WAV的一半以下。
+class FlacEncoder {
+public:
+    static constexpr int BLOCK_SIZE = 4096;  // 每帧样本数
+
+    // 将[-1, 1]的浮点样本编码为完整的FLAC流（含STREAMINFO，MD5留空）
+    static std::string encode(const float* samples, size_t count, int sample_rate = 16000);
+};
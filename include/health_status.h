@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// 识别服务器/health响应中与路由有关的部分
+struct ServerHealthStatus {
+    std::vector<std::string> upload_formats;  // 声明支持的上传格式，旧版服务器不声明（只接受WAV）
+    bool has_load = false;                    // 响应中带有多路识别状态
+    int capacity = 0;                         // 识别通道数
+    int load = 0;                             // 正在识别的通道数加排队的任务数
+};
+
+// 解析/health（内嵌multi_channel_status）或/multi_channel_status的响应，不是JSON对象时返回false
+// 忙碌通道数优先取busy_channels，旧版服务器没有该字段时按channels中状态为BUSY的通道计数；
+// active_channels是正常工作的通道数，不代表负载
+bool parseServerHealthStatus(const std::string& body, ServerHealthStatus& status);
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "audio_types.h"
+#include "wav_reader.h"
+
+// 离线整文件摄取参数
+struct OfflineIngestOptions {
+    int vad_mode = 2;              // WebRTC VAD模式（0-3，越大越严格）
+    int min_silence_ms = 500;      // 短于此的静音不切分，并入前后语音
+    int min_speech_ms = 250;       // 短于此的语音段丢弃
+    int max_segment_ms = 15000;    // 超过此长度的段在最安静处切开
+    int split_overlap_ms = 1000;   // 切开处后一段向前多取的音频，拼接文本时去重
+    int padding_ms = 200;          // 语音段前后保留的静音
+    DownmixMode downmix_mode = DownmixMode::Average;
+    int downmix_channel = 0;
+};
+
+// 离线摄取得到的语音段
+struct OfflineSpeechSegment {
+    PcmBlockPtr pcm;               // 整文件PCM块中的零拷贝视图
+    size_t start_sample = 0;       // 在文件中的起点（16kHz样本）
+    int sequence_number = 0;
+    int overlap_ms = 0;            // 开头与上一段重叠的音频长度（仅强制切开的段）
+
+    double startMs() const { return start_sample * 1000.0 / 16000; }
+
+    // 以文件内的偏移作为时间戳，与媒体时间轴一致
+    std::chrono::system_clock::time_point timestamp() const {
+        return std::chrono::system_clock::time_point(
+            std::chrono::milliseconds(static_cast<int64_t>(startMs())));
+    }
+};
+
+// 离线整文件摄取
+// 以内存映射方式读取WAV，整文件一次下混、重采样为16kHz单声道，随后对整段音频运行VAD并切出语音段。
+// 各段只是整文件PCM块的视图，不复制样本，可以不受实时节奏限制地并行分发给识别器。
+class OfflineFileIngestor {
+public:
+    static constexpr int SAMPLE_RATE = 16000;
+
+    explicit OfflineFileIngestor(const OfflineIngestOptions& options = OfflineIngestOptions());
+
+    // 读取并切分文件，cancel置位时尽快返回false
+    bool load(const std::string& path, const std::atomic<bool>* cancel = nullptr);
+
+    const std::vector<OfflineSpeechSegment>& getSegments() const { return segments; }
+    PcmBlockPtr getAudio() const { return audio; }
+    double getDurationMs() const;
+
+    // 各阶段耗时，用于日志
+    double getDecodeMs() const { return decode_ms; }
+    double getVadMs() const { return vad_ms; }
+
+    const std::string& getError() const { return error; }
+
+private:
+    bool decodeFile(const std::string& path, const std::atomic<bool>* cancel);
+    bool detectSpeech(const std::atomic<bool>* cancel);
+    void buildSegments();
+
+    // 在[begin, end)帧内找能量最低的帧，用于切开过长的段
+    size_t findQuietestFrame(size_t begin, size_t end) const;
+
+    OfflineIngestOptions options;
+    PcmBlockPtr audio;                   // 整文件16kHz单声道PCM
+    std::vector<uint8_t> speech_flags;   // 每帧VAD结果
+    std::vector<float> frame_energy;     // 每帧平均能量
+    std::vector<OfflineSpeechSegment> segments;
+    double decode_ms = 0.0;
+    double vad_ms = 0.0;
+    std::string error;
+};
@@ -3,15 +3,18 @@
 #include <QObject>
 #include <string>
 #include <vector>
-#include <thread>
 #include <atomic>
 #include <mutex>
-#include <condition_variable>
 #include <queue>
 #include <chrono>
+#include <random>
 #include "audio_types.h"
 
 class QTimer;
+class QThread;
+class QNetworkAccessManager;
+class QNetworkReply;
+class QHttpMultiPart;
 
 class ParallelOpenAIProcessor : public QObject {
     Q_OBJECT
@@ -29,6 +32,9 @@ public:
     void setModelName(const std::string& model);
     void setServerURL(const std::string& url);
     
+    // 内存段的上传格式：wav（默认）或flac（无损压缩，上传字节约为WAV的一半）
+    void setUploadFormat(const std::string& format);
+    
     // 批处理配置
     void setBatchProcessing(bool enable, int interval_ms = -1, size_t size = 0);
     
@@ -55,6 +61,8 @@ public:
     void handleApiResult(const QString& result, const SegmentTask& task);
     
 signals:
+    // JSON结果，sequence为段的加入顺序；完成顺序不定，由ResultMerger按sequence恢复顺序并去除重叠
+    // 重试后仍失败的段发出text为空的结果，后面的段不必等待合并器超时
     void resultReady(const QString& result, const std::chrono::system_clock::time_point& timestamp);
     void resultForDisplay(const QString& result);
     
@@ -62,18 +70,35 @@ private slots:
     void processPendingBatch();
     
 private:
-    void workerThread();
-    void processSegmentWithOpenAI(const AudioSegment& segment);
+    // 以下方法只在网络线程上运行
+    void dispatchPending();
+    void processSegmentWithOpenAI(const AudioSegment& segment, int sequence_number, int attempt,
+                                  std::chrono::steady_clock::time_point segment_start);
+    void handleReply(QNetworkReply* reply, const AudioSegment& segment, int sequence_number, int attempt,
+                     std::chrono::steady_clock::time_point segment_start);
+    void finishSegment();
+    int nextRetryDelayMs(int attempt);
+    
+    // 在网络线程上调度一次分发
+    void scheduleDispatch();
+    int resolveSequenceNumber(const AudioSegment& segment);
+    QHttpMultiPart* buildMultiPart(const AudioSegment& segment, int sequence_number);
     void processPendingBatchInternal();
     
-    std::vector<std::thread> worker_threads;
     std::atomic<bool> running{false};
     std::mutex queue_mutex;
-    std::condition_variable queue_cv;
+    int next_sequence_number = 0;  // 按加入顺序给段编号，每次启动从0开始（受queue_mutex保护）
     std::queue<AudioSegment> processing_queue;
     std::queue<SegmentTask> task_queue;  // 添加任务队列
     size_t max_parallel_requests = 6;  // 最大并行请求数，修改为可变成员变量
     
+    // 长连接HTTP客户端：整个处理器共用一个QNetworkAccessManager，运行在独立的网络线程上，
+    // 连接保持复用并允许HTTP/2多路复用；请求异步发出，不再为每个段创建事件循环
+    QThread* network_thread = nullptr;
+    QNetworkAccessManager* network_manager = nullptr;
+    size_t in_flight = 0;              // 已发出或等待重试的请求数（仅网络线程访问）
+    std::mt19937 retry_rng{std::random_device{}()};  // 重试抖动（仅网络线程访问）
+    
     // 批处理相关
     QTimer* batch_timer = nullptr;
     bool enable_batch_processing = true;  // 默认启用批处理
@@ -84,4 +109,5 @@ private:
     // API设置
     std::string model_name{"gpt-4o-transcribe"}; // 默认模型
     std::string server_url{"http://127.0.0.1:5000"}; // 默认服务器URL
+    bool upload_flac = false; // 内存段以FLAC上传
 }; 
\ No newline at end of file
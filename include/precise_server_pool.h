@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include "server_health_monitor.h"
+
+// 多台识别服务器之间的路由方式
+enum class PreciseRouting {
+    LeastOutstanding,  // 未完成请求数（与服务器上报的排队深度取大者）除以识别通道数最小的
+    EwmaLatency        // 上传耗时滑动平均按负载加权后最小的
+};
+
+// 一台精确识别服务器
+class PreciseEndpoint {
+public:
+    PreciseEndpoint(const std::string& url, const HealthCheckOptions& options);
+
+    const std::string& getUrl() const { return url; }
+    ServerHealthMonitor& getMonitor() { return monitor; }
+    const ServerHealthMonitor& getMonitor() const { return monitor; }
+    int getOutstanding() const { return outstanding; }
+
+private:
+    friend class PreciseServerPool;
+
+    std::string url;
+    ServerHealthMonitor monitor;
+    std::atomic<int> outstanding{0};  // 本客户端发往此服务器、尚未完成的请求
+    double upload_latency_ms = -1.0;  // 上传往返耗时的滑动平均（由池的互斥锁保护）
+};
+
+using PreciseEndpointPtr = std::shared_ptr<PreciseEndpoint>;
+
+// 精确识别服务器池
+// 每台服务器有独立的健康监测和熔断器，探测时顺带读取服务器上报的排队深度。上传前按路由方式选出
+// 熔断器关闭的服务器；请求失败时熔断器累计失败次数，重试时优先转移到其他服务器。
+// 只有一台服务器时退化为原来的单服务器行为。需要在主线程上创建和更新端点。
+class PreciseServerPool {
+public:
+    enum class Outcome {
+        Success,    // 服务器有响应
+        Failure,    // 连接错误、超时或5xx
+        Cancelled   // 主动中止，不计入健康状态
+    };
+
+    explicit PreciseServerPool(const HealthCheckOptions& options = HealthCheckOptions());
+
+    // 更新端点列表，URL不变的端点保留其状态和统计
+    void setEndpoints(const std::vector<std::string>& urls);
+    std::vector<PreciseEndpointPtr> getEndpoints() const;
+    PreciseEndpointPtr find(const std::string& url) const;
+    size_t size() const;
+
+    void setRouting(PreciseRouting routing);
+    PreciseRouting getRouting() const;
+
+    void start();
+    void stop();
+
+    // 选出一台可用的服务器并计入其未完成请求，没有可用服务器时返回nullptr
+    // avoid为刚失败的服务器，有其他可用服务器时不选它
+    PreciseEndpointPtr acquire(const PreciseEndpointPtr& avoid = nullptr);
+
+    // 请求结束，与acquire成对调用；latency_ms为上传往返耗时
+    void release(const PreciseEndpointPtr& endpoint, Outcome outcome, double latency_ms,
+                 const std::string& reason = std::string());
+
+    // 除endpoint外是否还有可用的服务器，用于决定立即故障转移还是退避后重试
+    bool hasAlternative(const PreciseEndpointPtr& endpoint) const;
+
+    // 各服务器的状态摘要，用于日志
+    std::string describe() const;
+
+    // 配置字符串（least_outstanding/ewma）与路由方式互转
+    static bool parseRouting(const std::string& name, PreciseRouting& routing);
+    static const char* getRoutingName(PreciseRouting routing);
+
+private:
+    double score(const PreciseEndpoint& endpoint) const;
+
+    HealthCheckOptions options;
+    mutable std::mutex mutex;
+    std::vector<PreciseEndpointPtr> endpoints;
+    PreciseRouting routing = PreciseRouting::LeastOutstanding;
+    bool running = false;
+    size_t next_index = 0;  // 得分相同时从这里开始轮转，避免总是选第一台
+};
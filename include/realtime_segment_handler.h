@@ -2,6 +2,7 @@
 
 #include "audio_types.h"
 #include "audio_utils.h"
+#include "audio_frame_pool.h"
 #include "audio_preprocessor.h"
 #include "voice_activity_detector.h"
 #include <vector>
@@ -28,6 +29,16 @@
 // 回调函数类型定义
 using SegmentReadyCallback = std::function<void(const AudioSegment&)>;
 
+// 流式部分音频回调：语音段增长时给出该段当前的全部音频，段结束时segment_ended为true且audio为空
+using PartialAudioCallback = std::function<void(size_t segment_id, const std::vector<float>& audio, bool segment_ended)>;
+
+// 分段器内部累积的音频：PCM在帧池中，并入语音段或只取前一部分时只增加引用计数
+struct SegmentFrame {
+    AudioFrameRef pcm;
+    size_t length = 0;        // 使用帧中前length个样本
+    bool is_last = false;
+};
+
 // 实时语音分段处理器
 class RealtimeSegmentHandler : public QObject {
     Q_OBJECT
@@ -47,9 +58,12 @@ public:
     // 停止处理
     void stop();
     
-    // 添加音频缓冲区
+    // 添加音频缓冲区（复制样本到帧池中的帧）
     void addBuffer(const AudioBuffer& buffer);
     
+    // 添加音频缓冲区，不复制样本：buffer的存储交给分段器，buffer.data换回一块已清空的存储
+    void addBuffer(AudioBuffer&& buffer);
+    
     // 强制生成当前段（不管是否达到目标长度）
     void flushCurrentSegment();
     
@@ -91,6 +105,18 @@ public:
     // 设置VAD检测器
     void setVoiceActivityDetector(VoiceActivityDetector* detector);
     
+    // 设置内存分段模式 - 段以引用计数的PCM块交付，不再写入临时WAV文件
+    void setInMemorySegments(bool enable);
+    
+    // 获取内存分段模式状态
+    bool isInMemorySegmentsEnabled() const;
+    
+    // 设置流式部分结果模式 - 语音段每增长step_ms就通过部分音频回调交出当前段
+    void setStreamingPartials(bool enable, size_t step_ms = 500);
+    
+    // 设置部分音频回调
+    void setPartialAudioCallback(PartialAudioCallback callback);
+    
 private:
     // 处理线程函数
     void processingThread();
@@ -98,14 +124,19 @@ private:
     // 缓冲区处理线程函数（新增）
     void bufferProcessingThread();
     
-    // 单线程模式：直接处理缓冲区
-    void processBufferDirectly(const AudioBuffer& buffer);
+    // 单线程模式：直接处理缓冲区（样本在pcm中，buffer只提供采样率和标志位）
+    void processBufferDirectly(const AudioBuffer& buffer, AudioFrameRef pcm);
     
     // 处理单个缓冲区的辅助方法
     void processBuffer(std::vector<AudioBuffer>* buffer, size_t segment_num);
     
-    // 生成语音段
-    std::string createSegment(const std::vector<AudioBuffer>& buffers);
+    // 生成语音段（内存模式下填充pcm，否则写入WAV文件并填充filepath）
+    AudioSegment createSegment(const std::vector<AudioBuffer>& buffers);
+    AudioSegment createSegment(const std::vector<SegmentFrame>& frames);
+    AudioSegment createSegment(std::vector<float> samples, bool is_last);
+    
+    // 拼接分段器累积的帧
+    static std::vector<float> concatFrames(const std::vector<SegmentFrame>& frames);
     
     // 保存重叠部分
     void storeOverlap();
@@ -116,6 +147,10 @@ private:
     // 获取新的缓冲区（从池中）
     std::vector<AudioBuffer>* getNextBuffer();
     
+    // 流式模式下交出当前段的音频 / 通知当前段结束
+    void emitPartialAudio();
+    void endPartialSegment();
+    
     // 成员变量
     std::string temp_directory;      // 临时目录
     bool own_temp_directory = false; // 是否自己创建的临时目录
@@ -124,9 +159,10 @@ private:
     size_t overlap_samples;          // 重叠大小（采样点）
     static constexpr int SAMPLE_RATE = 16000; // 采样率
     
-    std::vector<AudioBuffer> current_buffers;  // 当前累积的缓冲区
+    std::vector<SegmentFrame> current_buffers; // 当前累积的缓冲区
     std::vector<float> overlap_buffer;         // 重叠部分的缓冲区
-    std::vector<AudioBuffer> silence_buffers;  // 累积的静音缓冲区（用于短静音保留策略）
+    std::vector<SegmentFrame> silence_buffers; // 累积的静音缓冲区（用于短静音保留策略）
+    AudioFrameRef padding_frame;               // 语音段末尾的静音填充（各段共享）
     
     std::atomic<bool> running{false}; // 运行状态
     std::thread processing_thread;    // 处理线程
@@ -152,9 +188,16 @@ private:
     std::atomic<bool> immediate_processing{false}; // 默认关闭即时处理模式
     std::atomic<bool> openai_mode{false};          // OpenAI处理模式标志
     std::atomic<bool> use_overlap_processing{false}; // 默认关闭重叠处理
+    std::atomic<bool> in_memory_segments{false};     // 内存分段模式，默认写入临时文件
     
     SegmentReadyCallback segment_ready_callback = nullptr; // 段就绪回调
     
+    // 流式部分结果
+    std::atomic<bool> streaming_partials{false};          // 是否交出增长中的语音段
+    size_t partial_step_samples = SAMPLE_RATE / 2;        // 交出间隔（样本）
+    size_t last_partial_samples = 0;                      // 上次交出时当前段的样本数
+    PartialAudioCallback partial_audio_callback = nullptr; // 部分音频回调
+    
     size_t total_samples = 0;        // 当前段累积的样本数
     std::atomic<size_t> segment_count{0}; // 已生成的段数量
     
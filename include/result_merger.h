@@ -7,9 +7,23 @@
 #include <QObject>
 #include <QTimer>
 #include <QMutex>
-#include <QPair>
 #include <QJsonObject>
 #include <chrono>
+#include "audio_types.h"
+
+// 待合并的单段识别结果
+// ParallelOpenAIProcessor的JSON结果在进入合并器时解析一次，之后排序、去重叠和输出都直接使用字段
+struct SegmentResult {
+    int sequence = -1;       // 段序号，-1表示未知（无法排序，到达后立即输出）
+    QString text;
+    std::chrono::system_clock::time_point timestamp;
+    bool is_last = false;
+    int overlap_ms = 0;      // 开头与上一段重叠的音频长度，0表示没有重叠
+
+    // 解析JSON格式的结果，不是JSON对象时整串作为文本
+    static SegmentResult fromJson(const QString& json, const std::chrono::system_clock::time_point& timestamp);
+    QJsonObject toJson() const;
+};
 
 class ResultMerger : public QObject {
     Q_OBJECT
@@ -42,9 +56,17 @@ public:
     
     // 设置合并延迟时间（毫秒）
     void setMergeDelayMs(int delay_ms);
+    
+    // 在currentText开头附近查找与prevText结尾重复的文本（overlap_ms为两段重叠的音频长度）
+    // 找到时返回true，position和length为重复部分在currentText中的位置和长度
+    static bool findOverlap(const QString& prevText, const QString& currentText, int overlap_ms,
+                            int& position, int& length);
+
+    // 添加已解析的结果
+    void addResult(SegmentResult result);
 
 public slots:
-    // 添加新结果
+    // 添加新结果（JSON字符串，解析后按上面的重载处理）
     void addResult(const QString& result, const std::chrono::system_clock::time_point& timestamp = std::chrono::system_clock::now());
     
     // 强制合并并发出所有待处理结果
@@ -59,11 +81,20 @@ private slots:
     void timerMergeResults();  // 定时合并结果
 
 private:
-    // 内部合并方法
+    // 内部合并方法（调用方持有mutex）
     void mergeAndEmitResultsInternal();
     
-    // 结果存储 - 使用QPair存储JSON对象和时间戳
-    QList<QPair<QJsonObject, std::chrono::system_clock::time_point>> results;
+    // 堆顶结果是否可以按序输出（调用方持有mutex）
+    bool nextResultReady() const;
+    
+    // 结果存储 - 按序号的最小堆，序号相同时按时间戳，每个结果入堆出堆O(log n)
+    struct LaterResult {
+        bool operator()(const SegmentResult& a, const SegmentResult& b) const {
+            return a.sequence != b.sequence ? a.sequence > b.sequence : a.timestamp > b.timestamp;
+        }
+    };
+    std::vector<SegmentResult> results;
+    QString last_text;  // 最近输出的非空文本，用于去除下一段开头的重叠
     QMutex mutex;
     
     // 合并设置
@@ -85,22 +116,35 @@ private:
     // 用于记录添加时间，计算等待时间
     std::chrono::steady_clock::time_point last_add_time;
 
-    // 检查并合并序列化结果
-    void checkAndMergeSequential();
-    
     // 启动合并定时器
     void startMergeTimer();
     
     // 去除重叠文本
     QString removeOverlappingText(const QString& prevText, const QString& currentText, int overlap_ms);
     
-    // 成员变量
-    std::mutex result_mutex;
-    std::vector<QString> pending_results;
-    std::map<int, QString> pending_sequences;
-    int next_sequence_to_emit = 0;
-    
     //bool sequential_mode = false;
     bool timer_merge = false;
     bool merge_timer_active = false;
-}; 
\ No newline at end of file
+};
+
+// 离线并行识别结果的按序拼接
+// 各段完成顺序不定，按序号缓存，前面的段都到齐后依次输出；
+// 强制切开的长段开头与上一段有重叠的音频，输出前去掉与上一段结尾重复的文本
+class SegmentStitcher {
+public:
+    void reset();
+    
+    // 加入序号为sequence的段的识别结果，overlap_ms为该段开头与上一段重叠的音频长度
+    // 返回因此可以按序输出的结果（没有识别出文本的段也会返回，text为空）
+    std::vector<RecognitionResult> add(int sequence, RecognitionResult result, int overlap_ms = 0);
+    
+private:
+    struct PendingResult {
+        RecognitionResult result;
+        int overlap_ms = 0;
+    };
+    
+    std::map<int, PendingResult> pending;
+    int next_sequence = 0;
+    QString last_text;  // 最近输出的非空文本
+};
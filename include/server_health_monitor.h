@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+class QTimer;
+class QNetworkAccessManager;
+class QNetworkReply;
+class QByteArray;
+
+// 健康检查参数
+struct HealthCheckOptions {
+    int interval_ms = 5000;       // 探测间隔，期间有上传成功时跳过本次探测
+    int timeout_ms = 3000;        // 单次探测超时
+    int failure_threshold = 3;    // 连续失败多少次后熔断
+    int open_ms = 5000;           // 熔断后等待多久再探测
+    int max_open_ms = 60000;      // 熔断期间探测连续失败时等待时间加倍的上限
+    bool track_load = false;      // 有上传成功时也照常探测，使服务器排队深度保持最新；关闭时排队深度只在实际探测后的一段时间内有效
+};
+
+// 识别服务器健康监测与熔断器
+// 在后台定期异步GET /health，记录连续失败次数和延迟的滑动平均。上传请求的结果也作为健康信息反馈回来，
+// 有上传在成功时不再额外探测。连续失败达到阈值后熔断（Open），此时allowRequest()直接返回false，
+// 等待一段时间后由一次探测（HalfOpen）决定恢复还是继续熔断。所有网络操作都在创建它的线程上异步进行。
+class ServerHealthMonitor {
+public:
+    enum class State {
+        Closed,    // 正常，允许请求
+        Open,      // 熔断，拒绝请求
+        HalfOpen   // 熔断等待结束，正在探测
+    };
+
+    explicit ServerHealthMonitor(const HealthCheckOptions& options = HealthCheckOptions());
+    ~ServerHealthMonitor();
+
+    ServerHealthMonitor(const ServerHealthMonitor&) = delete;
+    ServerHealthMonitor& operator=(const ServerHealthMonitor&) = delete;
+
+    // 切换服务器时重置状态，运行中则立即探测一次
+    void setServerUrl(const std::string& url);
+
+    // 在创建它的线程上调用
+    void start();
+    void stop();
+    bool isRunning() const { return running; }
+
+    // 查询缓存的熔断状态，不发起网络请求
+    bool allowRequest() const;
+
+    // 请求结果反馈；上传的耗时包含识别时间，不计入延迟（latency_ms传负值）
+    void recordSuccess(double latency_ms = -1.0);
+    void recordFailure(const std::string& reason);
+
+    State getState() const;
+    double getLatencyMs() const;          // 延迟滑动平均，尚无数据时为负
+    int getConsecutiveFailures() const;
+
+    // 最近一次探测得到的服务器负载（正在识别和排队的任务数）与识别通道数，尚无数据时返回false
+    bool getServerLoad(int& load, int& capacity) const;
+
+    // 服务器在健康检查响应的upload_formats中声明支持该上传格式（如"flac"），尚无数据时返回false
+    bool supportsUploadFormat(const std::string& format) const;
+
+    static const char* getStateName(State state);
+
+private:
+    void probe();
+    void scheduleProbe(int delay_ms);
+    void cancelProbe();
+    void onProbeFinished(QNetworkReply* reply, std::chrono::steady_clock::time_point sent_at);
+    void parseHealthStatus(const QByteArray& body);
+
+    HealthCheckOptions options;
+
+    QObject context;                      // 定时器、网络管理器和回调的所属对象
+    QTimer* probe_timer = nullptr;
+    QNetworkAccessManager* network_manager = nullptr;
+    QPointer<QNetworkReply> probe_reply;  // 正在进行的探测
+    bool probe_cancelled = false;
+    std::atomic<bool> running{false};
+
+    mutable std::mutex mutex;
+    std::string server_url;
+    State state = State::Closed;
+    int consecutive_failures = 0;
+    double latency_ms = -1.0;
+    int server_load = -1;
+    int server_capacity = 0;
+    std::chrono::steady_clock::time_point load_time;  // 排队深度的更新时间
+    std::vector<std::string> upload_formats;
+    int current_open_ms = 0;
+    std::chrono::steady_clock::time_point last_success;
+};
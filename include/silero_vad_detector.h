@@ -4,18 +4,14 @@
 #include <memory>
 #include <string>
 #include <mutex>
+#include <cstdint>
 
-// 前向声明ONNX Runtime类型
-namespace Ort {
-    class Env;
-    class Session;
-    class SessionOptions;
-    class Value;
-}
+class SileroVADEngine;
 
 /**
  * Silero VAD检测器类
  * 使用ONNX Runtime运行Silero VAD深度学习模型进行语音活动检测
+ * 推理由同一模型的共享引擎批量完成，每个检测器对应引擎中的一个流，保存自己的循环状态
  */
 class SileroVADDetector {
 public:
@@ -44,6 +40,14 @@ public:
      */
     float detectVoiceActivity(const std::vector<float>& audio_data);
     
+    /**
+     * 检测一个与之前输入不连续的独立窗口
+     * 先清空本流的循环状态再推理，避免把不相邻的窗口当作连续音频
+     * @param audio_data 音频数据（浮点格式，16kHz采样率）
+     * @return 语音活动概率（0.0-1.0）
+     */
+    float detectIsolatedWindow(const std::vector<float>& audio_data);
+    
     /**
      * 检测是否有语音（基于阈值）
      * @param audio_data 音频数据
@@ -76,7 +80,7 @@ public:
     std::string getModelInfo() const;
     
     /**
-     * 重置内部状态
+     * 重置内部状态（清空本流的模型循环状态）
      */
     void reset();
 
@@ -86,16 +90,9 @@ private:
     float threshold_;
     bool is_initialized_;
     
-    // ONNX Runtime组件
-    std::unique_ptr<Ort::Env> ort_env_;
-    std::unique_ptr<Ort::SessionOptions> session_options_;
-    std::unique_ptr<Ort::Session> session_;
-    
-    // 模型输入输出信息
-    std::vector<const char*> input_names_;
-    std::vector<const char*> output_names_;
-    std::vector<std::vector<int64_t>> input_shapes_;
-    std::vector<std::vector<int64_t>> output_shapes_;
+    // 共享推理引擎与本检测器的流
+    std::shared_ptr<SileroVADEngine> engine_;
+    uint64_t stream_id_ = 0;
     
     // 音频处理参数
     static constexpr size_t SAMPLE_RATE = 16000;
@@ -106,10 +103,7 @@ private:
     mutable std::mutex mutex_;
     
     // 内部辅助方法
-    bool loadModel();
-    bool validateModelInputOutput();
     std::vector<float> preprocessAudio(const std::vector<float>& audio_data);
-    float runInference(const std::vector<float>& processed_audio);
     void logError(const std::string& message) const;
     void logInfo(const std::string& message) const;
 }; 
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+
+// 共享推理引擎的配置
+struct SileroEngineOptions {
+    int intra_op_threads = 1;   // ONNX Runtime算子内线程数
+    size_t max_batch = 32;      // 单次推理合并的最大窗口数
+    int batch_wait_us = 1000;   // 收到第一个窗口后等待其他流凑批的最长时间（微秒）
+};
+
+// 引擎运行统计
+struct SileroEngineStats {
+    uint64_t runs = 0;          // session->Run次数
+    uint64_t windows = 0;       // 推理的窗口总数
+    size_t largest_batch = 0;   // 最大批大小
+    size_t streams = 0;         // 当前打开的流数
+};
+
+/**
+ * Silero VAD共享推理引擎
+ * 同一模型的所有检测器共用一个ORT会话，各流提交的512样本窗口由后台线程合并为一个批次，
+ * 一次Run完成推理。模型的循环状态（v4的h/c，v5的state）按流保存，批前收集、批后写回（均持有锁，推理本身在锁外进行）。
+ * 输入输出张量建立在预分配的缓冲区上，每种批大小只绑定一次（IoBinding），推理时不再创建张量。
+ */
+class SileroVADEngine {
+public:
+    static constexpr size_t WINDOW_SIZE = 512;  // 32ms @ 16kHz
+    static constexpr int SAMPLE_RATE = 16000;
+
+    /**
+     * 获取指定模型的共享引擎，首次获取时加载模型
+     * @return 加载失败时返回nullptr
+     */
+    static std::shared_ptr<SileroVADEngine> acquire(const std::string& model_path);
+
+    // 设置之后新建引擎使用的配置（已存在的引擎不受影响）
+    static void setDefaultOptions(const SileroEngineOptions& options);
+    static SileroEngineOptions getDefaultOptions();
+
+    ~SileroVADEngine();
+
+    SileroVADEngine(const SileroVADEngine&) = delete;
+    SileroVADEngine& operator=(const SileroVADEngine&) = delete;
+
+    // 流管理：每个流有独立的循环状态
+    uint64_t openStream();
+    void closeStream(uint64_t stream_id);
+    void resetStream(uint64_t stream_id);
+
+    /**
+     * 推理一个窗口（WINDOW_SIZE个样本），阻塞直到所在批次完成
+     * 同一个流的窗口按提交顺序依次推理，不会出现在同一个批次中
+     * @return 语音概率（0.0-1.0），失败时返回0
+     */
+    float infer(uint64_t stream_id, const float* window);
+
+    SileroEngineStats getStats() const;
+    std::string getModelInfo() const;
+
+private:
+    struct Runtime;     // ONNX Runtime对象与预绑定的缓冲区，定义在实现文件中
+
+    struct Request {
+        uint64_t stream_id = 0;
+        const float* window = nullptr;
+        uint64_t generation = 0;    // 收集状态时流的重置代数
+        float result = 0.0f;
+        bool done = false;
+    };
+
+    // 每个流的循环状态，只在持有mutex_时读写
+    struct StreamState {
+        std::vector<float> values;
+        uint64_t generation = 0;    // 每次重置加一，推理期间被重置的流不写回旧窗口得到的状态
+    };
+
+    SileroVADEngine(const std::string& model_path, const SileroEngineOptions& options);
+
+    bool initialize();
+    void workerLoop();
+    // 把批次的窗口和各流状态拷入输入缓冲区（需持有mutex_）
+    void collectBatch(const std::vector<Request*>& batch);
+    // 推理（不加锁，只访问引擎线程独占的缓冲区），返回是否成功
+    bool runBatch(size_t batch_size);
+    // 写回概率和新状态（需持有mutex_），推理期间被关闭或重置的流不写回状态
+    void storeBatch(const std::vector<Request*>& batch, bool success);
+
+    std::string model_path_;
+    SileroEngineOptions options_;
+    std::unique_ptr<Runtime> runtime_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;     // 有新窗口或需要停止
+    std::condition_variable result_cv_;   // 批次完成
+    std::deque<Request*> pending_;
+    std::unordered_map<uint64_t, StreamState> states_;
+    uint64_t next_stream_id_ = 1;
+    bool stopping_ = false;
+    SileroEngineStats stats_;
+
+    std::thread worker_;
+};
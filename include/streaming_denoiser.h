@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include "audio_resampler.h"
+
+struct DenoiseState;
+
+// RNNoise流式降噪级
+// 每个实例对应一路流，持有一个跨调用保留的DenoiseState；不足一帧的尾部样本留到下次调用，
+// 不补零、不丢弃，帧网格在调用之间连续。
+// 链接的RNNoise帧率与输入采样率一致时（如16kHz专用库的160样本帧）直接分帧处理；
+// 否则经流式重采样器升到库的采样率（原版为48kHz、480样本帧）处理后再降回。
+// 输出样本数与输入严格相等，整体相对输入固定延迟getLatencySamples()个样本，
+// 包括凑满一帧的缓冲、RNNoise本身的一帧延迟和重采样滤波器的群延迟。
+class StreamingDenoiser {
+public:
+    explicit StreamingDenoiser(int sample_rate = 16000);
+    ~StreamingDenoiser();
+
+    StreamingDenoiser(const StreamingDenoiser&) = delete;
+    StreamingDenoiser& operator=(const StreamingDenoiser&) = delete;
+
+    // 创建DenoiseState并选择处理路径，RNNoise不可用时返回false
+    bool initialize();
+    bool isInitialized() const { return state != nullptr; }
+
+    // 降噪count个样本（[-1, 1]），output可与input相同
+    // dry不为空时写入同样延迟的原始样本，便于与降噪结果按样本对齐混合
+    void process(const float* input, size_t count, float* output, float* dry = nullptr);
+
+    // 清空缓冲、重采样历史和RNNoise状态，开始新的流
+    void reset();
+
+    // 是否按输入采样率直接处理（无需重采样）
+    bool isNativeRate() const { return !upsampler; }
+    int getSampleRate() const { return sample_rate; }
+
+    // 引入的延迟
+    size_t getLatencySamples() const { return latency; }
+    double getLatencyMs() const { return latency * 1000.0 / sample_rate; }
+
+private:
+    // 按RNNoise帧长分帧处理库采样率下的样本，降噪结果（输入采样率）追加到ready末尾
+    void feedFrames(const float* samples, size_t count);
+
+    int sample_rate;
+    DenoiseState* state = nullptr;
+
+    size_t frame_size = 0;        // RNNoise帧长（库采样率下的样本数）
+    size_t buffer_delay = 0;      // 凑满一帧引入的延迟
+    size_t latency = 0;           // 总延迟（输入采样率下的样本数）
+
+    std::unique_ptr<AudioResampler> upsampler;    // 输入 -> 库采样率
+    std::unique_ptr<AudioResampler> downsampler;  // 库采样率 -> 输入
+
+    std::vector<float> frame;     // 正在凑的一帧（已换算为RNNoise的int16幅度）
+    size_t frame_fill = 0;
+    std::vector<float> upsampled;
+    std::vector<float> ready;     // 已降噪、待输出的样本（开头预填充缓冲延迟个零）
+    std::vector<float> dry_delay; // 原始样本的延迟线
+};
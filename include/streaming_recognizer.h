@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+// 对一段音频执行一次解码，成功时返回true并写入文本
+using PartialDecodeFunction = std::function<bool(const std::vector<float>& audio, std::string& text)>;
+
+// 部分结果回调：committed为已稳定、不会再改变的前缀，tentative为可能被后续解码修正的部分
+using PartialResultCallback = std::function<void(const std::string& committed, const std::string& tentative)>;
+
+// 流式增量识别器
+// 参照whisper.cpp stream示例，在语音段增长过程中每隔一段时间对当前段（或其最后window_ms）重新解码，
+// 连续两次解码结果的公共前缀视为稳定并提交，其余部分作为临时结果输出。
+// 解码在独立线程中进行，只保留最新的待解码窗口，解码跟不上时自动跳过过期的窗口。
+class StreamingRecognizer {
+public:
+    StreamingRecognizer(PartialDecodeFunction decode,
+                        PartialResultCallback callback,
+                        size_t window_ms = 15000,
+                        int sample_rate = 16000);
+    ~StreamingRecognizer();
+
+    StreamingRecognizer(const StreamingRecognizer&) = delete;
+    StreamingRecognizer& operator=(const StreamingRecognizer&) = delete;
+
+    // 启动/停止解码线程
+    void start();
+    void stop();
+    bool isRunning() const { return running; }
+
+    // 提交语音段当前的全部音频，segment_id变化表示开始了新的语音段
+    void submit(size_t segment_id, std::vector<float> audio);
+
+    // 语音段结束（最终结果由常规识别流程给出），丢弃该段的待解码窗口和假设
+    void endSegment(size_t segment_id);
+
+    // 两次假设的稳定前缀（按UTF-8字符边界截断；含空格的文本退回到最后一个完整单词）
+    static size_t stablePrefixLength(const std::string& a, const std::string& b);
+
+private:
+    struct PendingWindow {
+        size_t segment_id = 0;
+        std::vector<float> audio;
+    };
+
+    void decodeLoop();
+
+    // 用新的解码结果更新假设并回调
+    void updateHypothesis(size_t segment_id, bool window_shifted, const std::string& text);
+
+    // 重置当前段的假设
+    void resetHypothesis(size_t segment_id);
+
+    PartialDecodeFunction decode_function;
+    PartialResultCallback result_callback;
+    size_t window_samples;
+
+    std::thread decode_thread;
+    std::atomic<bool> running{false};
+
+    std::mutex pending_mutex;
+    std::condition_variable pending_cv;
+    PendingWindow pending;
+    bool has_pending = false;
+    size_t ended_segment_id = 0;  // 最近结束的段（不再为其输出部分结果）
+    bool any_segment_ended = false;
+
+    // 以下仅在解码线程中访问
+    size_t current_segment_id = 0;
+    bool has_segment = false;
+    std::string frozen_text;      // 窗口滑动前已提交的文本
+    std::string committed_text;   // 当前窗口中已提交的前缀
+    std::string previous_text;    // 上一次解码结果
+};
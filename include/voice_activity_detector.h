@@ -2,6 +2,7 @@
 
 #include <QObject>
 #include <vector>
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <chrono>
@@ -15,11 +16,70 @@ struct Fvad;
 // 包含Silero VAD类型
 #include "silero_vad_detector.h"
 
+// 每个10ms帧一位的WebRTC VAD判决结果
+// 按64位字存储，clear()只重置计数，存储在调用之间复用
+class VadFrameDecisions {
+public:
+    void clear() { count = 0; }
+    
+    void push(bool is_voice) {
+        const size_t word = count / 64;
+        const size_t bit = count % 64;
+        if (word >= words.size()) {
+            words.push_back(0);
+        } else if (bit == 0) {
+            words[word] = 0;
+        }
+        if (is_voice) {
+            words[word] |= (uint64_t(1) << bit);
+        }
+        ++count;
+    }
+    
+    bool test(size_t index) const { return (words[index / 64] >> (index % 64)) & 1; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    
+    // 语音帧数
+    size_t countVoice() const {
+        size_t total = 0;
+        const size_t full_words = count / 64;
+        for (size_t i = 0; i < full_words; ++i) {
+            total += popcount(words[i]);
+        }
+        if (count % 64) {
+            total += popcount(words[full_words] & ((uint64_t(1) << (count % 64)) - 1));
+        }
+        return total;
+    }
+    
+private:
+    static size_t popcount(uint64_t value) {
+        value = value - ((value >> 1) & 0x5555555555555555ULL);
+        value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+        value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return static_cast<size_t>((value * 0x0101010101010101ULL) >> 56);
+    }
+    
+    std::vector<uint64_t> words;
+    size_t count = 0;
+};
+
 // VAD类型枚举
 enum class VADType {
     WebRTC,
     Silero,
-    Hybrid  // 混合使用两种VAD
+    Hybrid,  // 混合使用两种VAD，按权重融合
+    Cascade  // 级联：能量门和WebRTC先判决，只有边界附近或起止点的缓冲区才调用Silero
+};
+
+// 级联VAD各级的判决次数（每次detect计一次）
+struct VadCascadeStats {
+    uint64_t energy_decided = 0;   // 能量门判为静音
+    uint64_t webrtc_decided = 0;   // WebRTC帧投票明确且不在起止点
+    uint64_t silero_decided = 0;   // 交给Silero判决
+    
+    uint64_t total() const { return energy_decided + webrtc_decided + silero_decided; }
 };
 
 /**
@@ -111,12 +171,22 @@ public:
     // 处理单个AudioBuffer，检测语音活动并更新is_silence标志
     bool process(AudioBuffer& audio_buffer, float threshold);
     
+    // 最近一次detect/process调用中各10ms帧的判决（帧网格跨调用连续）
+    const VadFrameDecisions& getFrameDecisions() const { return frame_decisions; }
+    
+    // 尚未凑满一帧、留待下次调用的样本数
+    size_t getPendingSamples() const { return pending_count; }
+    
     // 设置语音结束检测的静音时长(毫秒)
     void setSilenceDuration(size_t silence_ms);
     
     // 重置语音结束检测状态
     void resetVoiceEndDetection();
     
+    // 复制另一个检测器的配置（模式、门限、静音时长、VAD类型等），不复制跨调用的检测状态
+    // 检测不同音频流的检测器各自独立，但需要保持相同的配置
+    void copySettingsFrom(const VoiceActivityDetector& other);
+    
     // 更新语音活动状态，返回是否为静音
     bool updateVoiceState(bool is_silence);
     
@@ -149,6 +219,11 @@ public:
     VADType getVADType() const { return vad_type_; }
     bool setSileroModelPath(const std::string& model_path);
     float getSileroVADProbability(const std::vector<float>& audio_buffer);
+    
+    // 级联模式：WebRTC语音帧比例不高于low判为静音、不低于high判为语音，中间交给Silero
+    void setCascadeBounds(float low, float high);
+    const VadCascadeStats& getCascadeStats() const { return cascade_stats_; }
+    void resetCascadeStats() { cascade_stats_ = VadCascadeStats(); }
 
 private:
     // VAD阈值，值越大检测越严格
@@ -184,6 +259,16 @@ private:
     // 音频转换缓冲区 - 线程安全的实例变量
     std::vector<int16_t> int16_buffer;
     
+    // 流式分帧：不足一帧的尾部样本保留到下次调用，帧网格跨调用连续
+    static constexpr size_t FRAME_SAMPLES = 160;  // 10ms@16kHz
+    int16_t pending_samples[FRAME_SAMPLES] = {};
+    size_t pending_count = 0;
+    VadFrameDecisions frame_decisions;
+    
+    // 将新样本接到上次剩余的样本之后，按帧运行WebRTC VAD，判决写入frame_decisions
+    // 返回false表示fvad_process出错
+    bool runWebRtcFrames(const float* samples, size_t count);
+    
     // 连续静音检测相关变量
     std::deque<bool> silence_history;   // 最近帧的静音历史
     size_t silence_frames_count = 0;    // 连续静音帧计数
@@ -210,5 +295,28 @@ private:
     // 混合VAD相关参数
     float webrtc_weight_ = 0.4f;        // WebRTC VAD权重
     float silero_weight_ = 0.6f;        // Silero VAD权重
+    
+    // 级联VAD相关参数
+    float cascade_low_ = 0.2f;          // 语音帧比例不高于此值为明确静音
+    float cascade_high_ = 0.8f;         // 语音帧比例不低于此值为明确语音
+    VadCascadeStats cascade_stats_;
+    bool cascade_last_result_ = false;  // 上一次级联判决，用于识别起止点
+    
+    // Silero按512样本（32ms）窗口推理
+    static constexpr size_t SILERO_WINDOW_SAMPLES = 512;
+    std::vector<float> silero_window_;
+    std::vector<float> silero_pending_;      // 连续推理时不足一个窗口、留到下一个缓冲区的样本
+    float silero_last_probability_ = 0.0f;   // 连续推理最近一个窗口的概率，缓冲区不足一个窗口时沿用
+    
+    // 创建并初始化Silero检测器，失败时silero_vad_保持为空
+    bool initSileroDetector();
+    // 缓冲区末尾窗口的Silero语音概率，每次从空状态推理（级联只在边界附近调用），Silero不可用时返回负值
+    float sileroTailProbability(const std::vector<float>& audio_buffer);
+    // 把连续的缓冲区按窗口依次送入Silero并沿用循环状态，返回最后一个窗口的概率，Silero不可用时返回负值
+    float sileroStreamProbability(const std::vector<float>& audio_buffer);
+    // 清空连续推理的残留样本和Silero的循环状态
+    void resetSileroStream();
+    // 级联判决：能量门 -> WebRTC帧投票 -> Silero
+    bool decideCascade(const std::vector<float>& audio_buffer, float voice_ratio, float current_energy);
 };
 
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstddef>
+#include <cstdint>
+
+// WAV文件的数据格式
+struct WavFormat {
+    int sample_rate = 0;
+    int channels = 0;
+    int bits_per_sample = 0;   // 每个样本的存储位数（8/16/24/32/64）
+    bool is_float = false;     // IEEE浮点样本（32/64位）
+    size_t block_align = 0;    // 每帧字节数
+};
+
+// 流式WAV读取器
+// 按RIFF块逐个遍历，不假设固定的44字节文件头：跳过LIST/bext/JUNK等块，支持WAVE_FORMAT_EXTENSIBLE
+// 和RF64（超过4GB的广播录音）。样本转换为[-1, 1]的浮点后拆分为各声道平面。
+// 内存映射方式打开时直接从映射的页面解码，不经过文件流和中间缓冲区，适合整文件顺序读取。
+class WavReader {
+public:
+    WavReader() = default;
+    WavReader(const WavReader&) = delete;
+    WavReader& operator=(const WavReader&) = delete;
+
+    ~WavReader() { close(); }
+
+    // 打开文件并解析格式，失败时getError()返回原因
+    // memory_mapped为true时将整个文件映射到内存（只读）
+    bool open(const std::string& path, bool memory_mapped = false);
+    void close();
+    bool isOpen() const { return file.is_open() || mapped != nullptr; }
+    bool isMemoryMapped() const { return mapped != nullptr; }
+
+    const WavFormat& getFormat() const { return format; }
+    uint64_t getTotalFrames() const { return total_frames; }
+    uint64_t getPosition() const { return position; }  // 下一次读取的帧序号
+
+    // 定位到指定帧，超出数据范围时返回false且位置不变
+    bool seekToFrame(uint64_t frame);
+
+    // 读取最多max_frames帧，planes按声道数调整并写入各声道样本（每个平面至少有返回值个样本）
+    // 返回读到的帧数，0表示数据结束或读取出错（出错时getError()非空）
+    size_t readFrames(size_t max_frames, std::vector<std::vector<float>>& planes);
+
+    const std::string& getError() const { return error; }
+
+private:
+    bool mapFile(const std::string& path);
+    void unmapFile();
+    // 从文件的offset处读取size字节，映射和文件流两种方式通用
+    bool readAt(uint64_t offset, void* buffer, size_t size);
+    bool parseChunks(uint64_t file_size);
+    bool parseFormatChunk(const std::vector<uint8_t>& chunk);
+    void decodeFrames(const uint8_t* data, size_t frames, std::vector<std::vector<float>>& planes);
+    bool fail(const std::string& message);
+
+    std::ifstream file;
+    const uint8_t* mapped = nullptr;  // 映射的文件内容
+    uint64_t mapped_size = 0;
+    WavFormat format;
+    uint64_t data_offset = 0;
+    uint64_t total_frames = 0;
+    uint64_t position = 0;
+    std::string error;
+
+    // 读取缓冲区，调用之间复用
+    std::vector<char> raw;
+    std::vector<float> interleaved;
+    std::vector<float*> plane_pointers;
+};
+
+// 下混方式
+enum class DownmixMode {
+    Average,        // 各声道平均
+    SelectChannel,  // 只取指定声道（如5.1的中置声道）
+    Loudest         // 跟随能量最大的声道，切换时短暂交叉淡化
+};
+
+// 多声道到单声道的下混
+class ChannelDownmixer {
+public:
+    void setMode(DownmixMode mode, int channel = 0);
+    DownmixMode getMode() const { return mode; }
+    int getSelectedChannel() const { return selected_channel; }
+
+    // Loudest模式当前跟随的声道
+    int getActiveChannel() const { return active_channel; }
+
+    // 清空Loudest模式的能量统计，开始新的流
+    void reset();
+
+    // 将各声道平面的前frames个样本合成为单声道，output调整为frames个样本
+    void process(const std::vector<std::vector<float>>& planes, size_t frames, std::vector<float>& output);
+
+    // 配置字符串（average/channel/loudest）与模式互转
+    static bool parseMode(const std::string& name, DownmixMode& mode);
+    static const char* getModeName(DownmixMode mode);
+
+private:
+    void processLoudest(const std::vector<std::vector<float>>& planes, size_t frames, std::vector<float>& output);
+
+    DownmixMode mode = DownmixMode::Average;
+    int selected_channel = 0;
+
+    std::vector<float> smoothed_energy;  // 各声道平滑后的每样本能量
+    int active_channel = 0;
+    std::vector<const float*> plane_pointers;
+};
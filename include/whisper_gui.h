@@ -155,6 +155,11 @@ private:
     void setupBetterFont();
     void safeInitialize();
     
+    // 流式部分结果显示在输出区末尾的一行，最终结果到达时被替换
+    void updatePartialOutput(const QString& committed, const QString& tentative);
+    void removePartialLine();
+    bool hasPartialLine = false;
+    
     // 识别模式记忆功能
     void loadLastRecognitionMode();
     void saveRecognitionModeToConfig(RecognitionMode mode);
@@ -10,7 +10,6 @@
 
 #include "vad_core.h"
 #include "vad_filterbank.h"
-#include "vad_gmm.h"
 #include "vad_sp.h"
 #include <string.h>
 
@@ -150,6 +149,8 @@ static int16_t GmmProbability(VadInstT* self, int16_t* features,
   int32_t sum_log_likelihood_ratios = 0;
   int32_t noise_global_mean, speech_global_mean;
   int32_t noise_probability[kNumGaussians], speech_probability[kNumGaussians];
+  int16_t gmm_input[kTableSize];
+  int32_t noise_gaussians[kTableSize], speech_gaussians[kTableSize];
   int16_t overhead1, overhead2, individualTest, totalTest;
 
   // Set various thresholds based on frame lengths (80, 160 or 240 samples).
@@ -182,6 +183,19 @@ static int16_t GmmProbability(VadInstT* self, int16_t* features,
     //
     // We combine a global LRT with local tests, for each frequency sub-band,
     // here defined as |channel|.
+    //
+    // All Gaussians are evaluated up front, as one batch per hypothesis, in
+    // the order of the model tables, i.e., |gaussian| = channel + k * 6.
+    for (gaussian = 0; gaussian < kTableSize; gaussian++) {
+      gmm_input[gaussian] = features[gaussian % kNumChannels];
+    }
+    self->kernels->gaussian_probabilities(gmm_input, self->noise_means,
+                                          self->noise_stds, kTableSize,
+                                          noise_gaussians, deltaN);
+    self->kernels->gaussian_probabilities(gmm_input, self->speech_means,
+                                          self->speech_stds, kTableSize,
+                                          speech_gaussians, deltaS);
+
     for (channel = 0; channel < kNumChannels; channel++) {
       // For each channel we model the probability with a GMM consisting of
       // |kNumGaussians|, with different means and standard deviations depending
@@ -192,19 +206,13 @@ static int16_t GmmProbability(VadInstT* self, int16_t* features,
         gaussian = channel + k * kNumChannels;
         // Probability under H0, that is, probability of frame being noise.
         // Value given in Q27 = Q7 * Q20.
-        tmp1_s32 = WebRtcVad_GaussianProbability(features[channel],
-                                                 self->noise_means[gaussian],
-                                                 self->noise_stds[gaussian],
-                                                 &deltaN[gaussian]);
+        tmp1_s32 = noise_gaussians[gaussian];
         noise_probability[k] = kNoiseDataWeights[gaussian] * tmp1_s32;
         h0_test += noise_probability[k];  // Q27
 
         // Probability under H1, that is, probability of frame being speech.
         // Value given in Q27 = Q7 * Q20.
-        tmp1_s32 = WebRtcVad_GaussianProbability(features[channel],
-                                                 self->speech_means[gaussian],
-                                                 self->speech_stds[gaussian],
-                                                 &deltaS[gaussian]);
+        tmp1_s32 = speech_gaussians[gaussian];
         speech_probability[k] = kSpeechDataWeights[gaussian] * tmp1_s32;
         h1_test += speech_probability[k];  // Q27
       }
@@ -532,6 +540,9 @@ int WebRtcVad_InitCore(VadInstT* self) {
     self->mean_value[i] = 1600;
   }
 
+  // Pick the fastest filter bank and GMM kernels the CPU supports.
+  self->kernels = WebRtcVad_SelectKernels();
+
   // Set aggressiveness mode to default (=|kDefaultMode|).
   if (WebRtcVad_set_mode_core(self, kDefaultMode) != 0) {
     return -1;
@@ -17,6 +17,7 @@
 #define COMMON_AUDIO_VAD_VAD_CORE_H_
 
 #include "../signal_processing/signal_processing_library.h"
+#include "vad_kernels.h"
 
 enum { kNumChannels = 6 };  // Number of frequency bands (named channels).
 enum { kNumGaussians = 2 };  // Number of Gaussians per channel in the GMM.
@@ -48,6 +49,8 @@ typedef struct VadInstT_ {
     int16_t individual[3];
     int16_t total[3];
 
+    const VadKernels* kernels;  // Filter bank and GMM kernels for this CPU.
+
     int init_flag;
 } VadInstT;
 
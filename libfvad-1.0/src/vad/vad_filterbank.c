@@ -18,10 +18,6 @@ static const int16_t kLogEnergyIntPart = 14336;  // 14 in Q10
 static const int16_t kHpZeroCoefs[3] = { 6631, -13262, 6631 };
 static const int16_t kHpPoleCoefs[3] = { 16384, -7756, 5620 };
 
-// Allpass filter coefficients, upper and lower, in Q15.
-// Upper: 0.64, Lower: 0.17
-static const int16_t kAllPassCoefsQ15[2] = { 20972, 5571 };
-
 // Adjustment for division with two in SplitFilter.
 static const int16_t kOffsetVector[6] = { 368, 368, 272, 176, 176, 176 };
 
@@ -66,78 +62,10 @@ static void HighPassFilter(const int16_t* data_in, size_t data_length,
   }
 }
 
-// All pass filtering of |data_in|, used before splitting the signal into two
-// frequency bands (low pass vs high pass).
-// Note that |data_in| and |data_out| can NOT correspond to the same address.
-//
-// - data_in            [i]   : Input audio signal given in Q0.
-// - data_length        [i]   : Length of input and output data.
-// - filter_coefficient [i]   : Given in Q15.
-// - filter_state       [i/o] : State of the filter given in Q(-1).
-// - data_out           [o]   : Output audio signal given in Q(-1).
-static void AllPassFilter(const int16_t* data_in, size_t data_length,
-                          int16_t filter_coefficient, int16_t* filter_state,
-                          int16_t* data_out) {
-  // The filter can only cause overflow (in the w16 output variable)
-  // if more than 4 consecutive input numbers are of maximum value and
-  // has the the same sign as the impulse responses first taps.
-  // First 6 taps of the impulse response:
-  // 0.6399 0.5905 -0.3779 0.2418 -0.1547 0.0990
-
-  size_t i;
-  int16_t tmp16 = 0;
-  int32_t tmp32 = 0;
-  int32_t state32 = ((int32_t) (*filter_state) * (1 << 16));  // Q15
-
-  for (i = 0; i < data_length; i++) {
-    tmp32 = state32 + filter_coefficient * *data_in;
-    tmp16 = (int16_t) (tmp32 >> 16);  // Q(-1)
-    *data_out++ = tmp16;
-    state32 = (*data_in * (1 << 14)) - filter_coefficient * tmp16;  // Q14
-    state32 *= 2;  // Q15.
-    data_in += 2;
-  }
-
-  *filter_state = (int16_t) (state32 >> 16);  // Q(-1)
-}
-
-// Splits |data_in| into |hp_data_out| and |lp_data_out| corresponding to
-// an upper (high pass) part and a lower (low pass) part respectively.
-//
-// - data_in      [i]   : Input audio data to be split into two frequency bands.
-// - data_length  [i]   : Length of |data_in|.
-// - upper_state  [i/o] : State of the upper filter, given in Q(-1).
-// - lower_state  [i/o] : State of the lower filter, given in Q(-1).
-// - hp_data_out  [o]   : Output audio data of the upper half of the spectrum.
-//                        The length is |data_length| / 2.
-// - lp_data_out  [o]   : Output audio data of the lower half of the spectrum.
-//                        The length is |data_length| / 2.
-static void SplitFilter(const int16_t* data_in, size_t data_length,
-                        int16_t* upper_state, int16_t* lower_state,
-                        int16_t* hp_data_out, int16_t* lp_data_out) {
-  size_t i;
-  size_t half_length = data_length >> 1;  // Downsampling by 2.
-  int16_t tmp_out;
-
-  // All-pass filtering upper branch.
-  AllPassFilter(&data_in[0], half_length, kAllPassCoefsQ15[0], upper_state,
-                hp_data_out);
-
-  // All-pass filtering lower branch.
-  AllPassFilter(&data_in[1], half_length, kAllPassCoefsQ15[1], lower_state,
-                lp_data_out);
-
-  // Make LP and HP signals.
-  for (i = 0; i < half_length; i++) {
-    tmp_out = *hp_data_out;
-    *hp_data_out++ -= *lp_data_out;
-    *lp_data_out++ += tmp_out;
-  }
-}
-
 // Calculates the energy of |data_in| in dB, and also updates an overall
 // |total_energy| if necessary.
 //
+// - kernels      [i]   : Kernels used for the energy calculation.
 // - data_in      [i]   : Input audio data for energy calculation.
 // - data_length  [i]   : Length of input data.
 // - offset       [i]   : Offset value added to |log_energy|.
@@ -146,9 +74,9 @@ static void SplitFilter(const int16_t* data_in, size_t data_length,
 //                        NOTE: |total_energy| is only updated if
 //                        |total_energy| <= |kMinEnergy|.
 // - log_energy   [o]   : 10 * log10("energy of |data_in|") given in Q4.
-static void LogOfEnergy(const int16_t* data_in, size_t data_length,
-                        int16_t offset, int16_t* total_energy,
-                        int16_t* log_energy) {
+static void LogOfEnergy(const VadKernels* kernels, const int16_t* data_in,
+                        size_t data_length, int16_t offset,
+                        int16_t* total_energy, int16_t* log_energy) {
   // |tot_rshifts| accumulates the number of right shifts performed on |energy|.
   int tot_rshifts = 0;
   // The |energy| will be normalized to 15 bits. We use unsigned integer because
@@ -158,8 +86,7 @@ static void LogOfEnergy(const int16_t* data_in, size_t data_length,
   RTC_DCHECK(data_in);
   RTC_DCHECK_GT(data_length, 0);
 
-  energy = (uint32_t) WebRtcSpl_Energy((int16_t*) data_in, data_length,
-                                       &tot_rshifts);
+  energy = (uint32_t) kernels->energy(data_in, data_length, &tot_rshifts);
 
   if (energy != 0) {
     // By construction, normalizing to 15 bits is equivalent with 17 leading
@@ -239,6 +166,7 @@ static void LogOfEnergy(const int16_t* data_in, size_t data_length,
 
 int16_t WebRtcVad_CalculateFeatures(VadInstT* self, const int16_t* data_in,
                                     size_t data_length, int16_t* features) {
+  const VadKernels* kernels = self->kernels;
   int16_t total_energy = 0;
   // We expect |data_length| to be 80, 160 or 240 samples, which corresponds to
   // 10, 20 or 30 ms in 8 kHz. Therefore, the intermediate downsampled data will
@@ -260,24 +188,28 @@ int16_t WebRtcVad_CalculateFeatures(VadInstT* self, const int16_t* data_in,
   RTC_DCHECK_LT(4, kNumChannels - 1);  // Checking maximum |frequency_band|.
 
   // Split at 2000 Hz and downsample.
-  SplitFilter(in_ptr, data_length, &self->upper_state[frequency_band],
-              &self->lower_state[frequency_band], hp_out_ptr, lp_out_ptr);
+  kernels->split_filter(in_ptr, data_length, &self->upper_state[frequency_band],
+                        &self->lower_state[frequency_band], hp_out_ptr,
+                        lp_out_ptr);
 
   // For the upper band (2000 Hz - 4000 Hz) split at 3000 Hz and downsample.
   frequency_band = 1;
   in_ptr = hp_120;  // [2000 - 4000] Hz.
   hp_out_ptr = hp_60;  // [3000 - 4000] Hz.
   lp_out_ptr = lp_60;  // [2000 - 3000] Hz.
-  SplitFilter(in_ptr, length, &self->upper_state[frequency_band],
-              &self->lower_state[frequency_band], hp_out_ptr, lp_out_ptr);
+  kernels->split_filter(in_ptr, length, &self->upper_state[frequency_band],
+                        &self->lower_state[frequency_band], hp_out_ptr,
+                        lp_out_ptr);
 
   // Energy in 3000 Hz - 4000 Hz.
   length >>= 1;  // |data_length| / 4 <=> bandwidth = 1000 Hz.
 
-  LogOfEnergy(hp_60, length, kOffsetVector[5], &total_energy, &features[5]);
+  LogOfEnergy(kernels, hp_60, length, kOffsetVector[5], &total_energy,
+              &features[5]);
 
   // Energy in 2000 Hz - 3000 Hz.
-  LogOfEnergy(lp_60, length, kOffsetVector[4], &total_energy, &features[4]);
+  LogOfEnergy(kernels, lp_60, length, kOffsetVector[4], &total_energy,
+              &features[4]);
 
   // For the lower band (0 Hz - 2000 Hz) split at 1000 Hz and downsample.
   frequency_band = 2;
@@ -285,42 +217,49 @@ int16_t WebRtcVad_CalculateFeatures(VadInstT* self, const int16_t* data_in,
   hp_out_ptr = hp_60;  // [1000 - 2000] Hz.
   lp_out_ptr = lp_60;  // [0 - 1000] Hz.
   length = half_data_length;  // |data_length| / 2 <=> bandwidth = 2000 Hz.
-  SplitFilter(in_ptr, length, &self->upper_state[frequency_band],
-              &self->lower_state[frequency_band], hp_out_ptr, lp_out_ptr);
+  kernels->split_filter(in_ptr, length, &self->upper_state[frequency_band],
+                        &self->lower_state[frequency_band], hp_out_ptr,
+                        lp_out_ptr);
 
   // Energy in 1000 Hz - 2000 Hz.
   length >>= 1;  // |data_length| / 4 <=> bandwidth = 1000 Hz.
-  LogOfEnergy(hp_60, length, kOffsetVector[3], &total_energy, &features[3]);
+  LogOfEnergy(kernels, hp_60, length, kOffsetVector[3], &total_energy,
+              &features[3]);
 
   // For the lower band (0 Hz - 1000 Hz) split at 500 Hz and downsample.
   frequency_band = 3;
   in_ptr = lp_60;  // [0 - 1000] Hz.
   hp_out_ptr = hp_120;  // [500 - 1000] Hz.
   lp_out_ptr = lp_120;  // [0 - 500] Hz.
-  SplitFilter(in_ptr, length, &self->upper_state[frequency_band],
-              &self->lower_state[frequency_band], hp_out_ptr, lp_out_ptr);
+  kernels->split_filter(in_ptr, length, &self->upper_state[frequency_band],
+                        &self->lower_state[frequency_band], hp_out_ptr,
+                        lp_out_ptr);
 
   // Energy in 500 Hz - 1000 Hz.
   length >>= 1;  // |data_length| / 8 <=> bandwidth = 500 Hz.
-  LogOfEnergy(hp_120, length, kOffsetVector[2], &total_energy, &features[2]);
+  LogOfEnergy(kernels, hp_120, length, kOffsetVector[2], &total_energy,
+              &features[2]);
 
   // For the lower band (0 Hz - 500 Hz) split at 250 Hz and downsample.
   frequency_band = 4;
   in_ptr = lp_120;  // [0 - 500] Hz.
   hp_out_ptr = hp_60;  // [250 - 500] Hz.
   lp_out_ptr = lp_60;  // [0 - 250] Hz.
-  SplitFilter(in_ptr, length, &self->upper_state[frequency_band],
-              &self->lower_state[frequency_band], hp_out_ptr, lp_out_ptr);
+  kernels->split_filter(in_ptr, length, &self->upper_state[frequency_band],
+                        &self->lower_state[frequency_band], hp_out_ptr,
+                        lp_out_ptr);
 
   // Energy in 250 Hz - 500 Hz.
   length >>= 1;  // |data_length| / 16 <=> bandwidth = 250 Hz.
-  LogOfEnergy(hp_60, length, kOffsetVector[1], &total_energy, &features[1]);
+  LogOfEnergy(kernels, hp_60, length, kOffsetVector[1], &total_energy,
+              &features[1]);
 
   // Remove 0 Hz - 80 Hz, by high pass filtering the lower band.
   HighPassFilter(lp_60, length, self->hp_filter_state, hp_120);
 
   // Energy in 80 Hz - 250 Hz.
-  LogOfEnergy(hp_120, length, kOffsetVector[0], &total_energy, &features[0]);
+  LogOfEnergy(kernels, hp_120, length, kOffsetVector[0], &total_energy,
+              &features[0]);
 
   return total_energy;
 }
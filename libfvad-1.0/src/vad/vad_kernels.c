@@ -0,0 +1,463 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *  Copyright (c) 2016 Daniel Pirch.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "vad_kernels.h"
+#include "vad_gmm.h"
+#include "../signal_processing/signal_processing_library.h"
+#include <string.h>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define VAD_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__GNUC__)
+#define VAD_KERNELS_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define VAD_KERNELS_AVX2_TARGET
+#endif
+#endif
+
+// Allpass filter coefficients, upper and lower, in Q15.
+// Upper: 0.64, Lower: 0.17
+static const int16_t kAllPassCoefsQ15[2] = { 20972, 5571 };
+
+// Same as in vad_gmm.c.
+static const int32_t kCompVar = 22005;
+static const int16_t kLog2Exp = 5909;  // log2(exp(1)) in Q12.
+
+// All pass filtering of |data_in|, used before splitting the signal into two
+// frequency bands (low pass vs high pass).
+// Note that |data_in| and |data_out| can NOT correspond to the same address.
+//
+// - data_in            [i]   : Input audio signal given in Q0.
+// - data_length        [i]   : Length of input and output data.
+// - filter_coefficient [i]   : Given in Q15.
+// - filter_state       [i/o] : State of the filter given in Q(-1).
+// - data_out           [o]   : Output audio signal given in Q(-1).
+static void AllPassFilter(const int16_t* data_in, size_t data_length,
+                          int16_t filter_coefficient, int16_t* filter_state,
+                          int16_t* data_out) {
+  // The filter can only cause overflow (in the w16 output variable)
+  // if more than 4 consecutive input numbers are of maximum value and
+  // has the the same sign as the impulse responses first taps.
+  // First 6 taps of the impulse response:
+  // 0.6399 0.5905 -0.3779 0.2418 -0.1547 0.0990
+
+  size_t i;
+  int16_t tmp16 = 0;
+  int32_t tmp32 = 0;
+  int32_t state32 = ((int32_t) (*filter_state) * (1 << 16));  // Q15
+
+  for (i = 0; i < data_length; i++) {
+    tmp32 = state32 + filter_coefficient * *data_in;
+    tmp16 = (int16_t) (tmp32 >> 16);  // Q(-1)
+    *data_out++ = tmp16;
+    state32 = (*data_in * (1 << 14)) - filter_coefficient * tmp16;  // Q14
+    state32 *= 2;  // Q15.
+    data_in += 2;
+  }
+
+  *filter_state = (int16_t) (state32 >> 16);  // Q(-1)
+}
+
+static void SplitFilterC(const int16_t* data_in, size_t data_length,
+                         int16_t* upper_state, int16_t* lower_state,
+                         int16_t* hp_data_out, int16_t* lp_data_out) {
+  size_t i;
+  size_t half_length = data_length >> 1;  // Downsampling by 2.
+  int16_t tmp_out;
+
+  // All-pass filtering upper branch.
+  AllPassFilter(&data_in[0], half_length, kAllPassCoefsQ15[0], upper_state,
+                hp_data_out);
+
+  // All-pass filtering lower branch.
+  AllPassFilter(&data_in[1], half_length, kAllPassCoefsQ15[1], lower_state,
+                lp_data_out);
+
+  // Make LP and HP signals.
+  for (i = 0; i < half_length; i++) {
+    tmp_out = *hp_data_out;
+    *hp_data_out++ -= *lp_data_out;
+    *lp_data_out++ += tmp_out;
+  }
+}
+
+static int32_t EnergyC(const int16_t* data_in, size_t data_length,
+                       int* scale_factor) {
+  return WebRtcSpl_Energy((int16_t*) data_in, data_length, scale_factor);
+}
+
+static void GaussianProbabilitiesC(const int16_t* input, const int16_t* mean,
+                                   const int16_t* std, size_t length,
+                                   int32_t* probability, int16_t* delta) {
+  size_t i;
+
+  for (i = 0; i < length; i++) {
+    probability[i] = WebRtcVad_GaussianProbability(input[i], mean[i], std[i],
+                                                   &delta[i]);
+  }
+}
+
+static const VadKernels kScalarKernels = {
+  "scalar", SplitFilterC, EnergyC, GaussianProbabilitiesC
+};
+
+#if defined(VAD_KERNELS_X86)
+
+// Number of sample pairs filtered before the LP and HP signals are formed.
+enum { kSplitBlock = 64 };
+
+// Same as WebRtcSpl_GetScalingSquare(), given the largest absolute value.
+static int ScalingSquare(int16_t smax, size_t length) {
+  int16_t nbits = WebRtcSpl_GetSizeInBits((uint32_t) length);
+  int16_t t = WebRtcSpl_NormW32(smax * smax);
+
+  if (smax == 0) {
+    return 0;  // Since norm(0) returns 0
+  }
+  return (t > nbits) ? 0 : nbits - t;
+}
+
+// Forms the HP and LP signals from |length| filter outputs, each holding the
+// upper branch in the low and the lower branch in the high 16 bits.
+static void CombineSse2(const int32_t* pairs, size_t length,
+                        int16_t* hp_data_out, int16_t* lp_data_out) {
+  size_t i = 0;
+
+  for (; i + 8 <= length; i += 8) {
+    const __m128i p0 = _mm_loadu_si128((const __m128i*) &pairs[i]);
+    const __m128i p1 = _mm_loadu_si128((const __m128i*) &pairs[i + 4]);
+    const __m128i upper = _mm_packs_epi32(
+        _mm_srai_epi32(_mm_slli_epi32(p0, 16), 16),
+        _mm_srai_epi32(_mm_slli_epi32(p1, 16), 16));
+    const __m128i lower = _mm_packs_epi32(_mm_srai_epi32(p0, 16),
+                                          _mm_srai_epi32(p1, 16));
+    _mm_storeu_si128((__m128i*) &hp_data_out[i], _mm_sub_epi16(upper, lower));
+    _mm_storeu_si128((__m128i*) &lp_data_out[i], _mm_add_epi16(upper, lower));
+  }
+  for (; i < length; i++) {
+    const int16_t upper = (int16_t) (pairs[i] & 0xFFFF);
+    const int16_t lower = (int16_t) (pairs[i] >> 16);
+    hp_data_out[i] = (int16_t) (upper - lower);
+    lp_data_out[i] = (int16_t) (upper + lower);
+  }
+}
+
+// The all-pass recursion is serial in time, so instead of vectorizing along
+// the samples both branches run side by side: lane 0 filters the even samples
+// with the upper coefficient, lane 1 the odd samples with the lower one.
+static void SplitFilterSse2(const int16_t* data_in, size_t data_length,
+                            int16_t* upper_state, int16_t* lower_state,
+                            int16_t* hp_data_out, int16_t* lp_data_out) {
+  const size_t half_length = data_length >> 1;  // Downsampling by 2.
+  const __m128i coefs = _mm_setr_epi32(kAllPassCoefsQ15[0],
+                                       kAllPassCoefsQ15[1], 0, 0);
+  __m128i state32 = _mm_setr_epi32((int32_t) (*upper_state) * (1 << 16),
+                                   (int32_t) (*lower_state) * (1 << 16),
+                                   0, 0);  // Q15
+  int32_t pairs[kSplitBlock];
+  size_t i = 0;
+
+  while (i < half_length) {
+    const size_t block = (half_length - i < kSplitBlock) ?
+        half_length - i : kSplitBlock;
+    size_t j;
+
+    for (j = 0; j < block; j++) {
+      int32_t samples;
+      __m128i x, tmp32, tmp16;
+
+      memcpy(&samples, &data_in[2 * (i + j)], sizeof(samples));
+      x = _mm_cvtsi32_si128(samples);
+      x = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+      tmp32 = _mm_add_epi32(state32, _mm_madd_epi16(x, coefs));
+      tmp16 = _mm_srai_epi32(tmp32, 16);  // Q(-1)
+      state32 = _mm_sub_epi32(_mm_slli_epi32(x, 14),
+                              _mm_madd_epi16(tmp16, coefs));  // Q14
+      state32 = _mm_slli_epi32(state32, 1);  // Q15.
+      pairs[j] = _mm_cvtsi128_si32(_mm_packs_epi32(tmp16, tmp16));
+    }
+    CombineSse2(pairs, block, &hp_data_out[i], &lp_data_out[i]);
+    i += block;
+  }
+
+  *upper_state = (int16_t) (_mm_cvtsi128_si32(state32) >> 16);  // Q(-1)
+  *lower_state = (int16_t) (_mm_cvtsi128_si32(_mm_srli_si128(state32, 4))
+                            >> 16);  // Q(-1)
+}
+
+static int32_t EnergySse2(const int16_t* data_in, size_t data_length,
+                          int* scale_factor) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i vmax = _mm_set1_epi16(-1);
+  __m128i acc = zero;
+  __m128i shift;
+  int16_t smax;
+  uint32_t en;
+  int scaling;
+  size_t i;
+
+  // Largest absolute value. As in WebRtcSpl_GetScalingSquare(), -32768 wraps
+  // to itself and never becomes the maximum.
+  for (i = 0; i + 8 <= data_length; i += 8) {
+    const __m128i x = _mm_loadu_si128((const __m128i*) &data_in[i]);
+    vmax = _mm_max_epi16(vmax, _mm_max_epi16(x, _mm_sub_epi16(zero, x)));
+  }
+  vmax = _mm_max_epi16(vmax, _mm_srli_si128(vmax, 8));
+  vmax = _mm_max_epi16(vmax, _mm_srli_si128(vmax, 4));
+  vmax = _mm_max_epi16(vmax, _mm_srli_si128(vmax, 2));
+  smax = (int16_t) _mm_cvtsi128_si32(vmax);
+  for (; i < data_length; i++) {
+    const int16_t sabs = (int16_t) (data_in[i] > 0 ? data_in[i] : -data_in[i]);
+    smax = (sabs > smax ? sabs : smax);
+  }
+  scaling = ScalingSquare(smax, data_length);
+
+  // Each square is shifted before it is accumulated.
+  shift = _mm_cvtsi32_si128(scaling);
+  for (i = 0; i + 8 <= data_length; i += 8) {
+    const __m128i x = _mm_loadu_si128((const __m128i*) &data_in[i]);
+    const __m128i lo = _mm_mullo_epi16(x, x);
+    const __m128i hi = _mm_mulhi_epi16(x, x);
+    acc = _mm_add_epi32(acc, _mm_sra_epi32(_mm_unpacklo_epi16(lo, hi), shift));
+    acc = _mm_add_epi32(acc, _mm_sra_epi32(_mm_unpackhi_epi16(lo, hi), shift));
+  }
+  acc = _mm_add_epi32(acc, _mm_srli_si128(acc, 8));
+  acc = _mm_add_epi32(acc, _mm_srli_si128(acc, 4));
+  en = (uint32_t) _mm_cvtsi128_si32(acc);
+  for (; i < data_length; i++) {
+    en += (uint32_t) ((data_in[i] * data_in[i]) >> scaling);
+  }
+
+  *scale_factor = scaling;
+  return (int32_t) en;
+}
+
+// Sign extends the low 16 bits of each 32 bit lane.
+static __m128i Trunc16Sse2(__m128i x) {
+  return _mm_srai_epi32(_mm_slli_epi32(x, 16), 16);
+}
+
+// 16 x 16 bit multiplication of sign extended lanes.
+static __m128i Mul16Sse2(__m128i a, __m128i b) {
+  return _mm_madd_epi16(a, _mm_and_si128(b, _mm_set1_epi32(0xFFFF)));
+}
+
+// Low 32 bits of a 32 x 32 bit multiplication, wrapping like the scalar code.
+static __m128i MulLo32Sse2(__m128i a, __m128i b) {
+  const __m128i even = _mm_mul_epu32(a, b);
+  const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32),
+                                    _mm_srli_epi64(b, 32));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// WebRtcVad_GaussianProbability() for four Gaussians, see vad_gmm.c for the
+// derivation of each step.
+static void GaussianProbability4Sse2(const int16_t* input, const int16_t* mean,
+                                     const int16_t* std, int32_t* probability,
+                                     int16_t* delta) {
+  const __m128i in16 = _mm_loadl_epi64((const __m128i*) input);
+  const __m128i mean16 = _mm_loadl_epi64((const __m128i*) mean);
+  const __m128i std16 = _mm_loadl_epi64((const __m128i*) std);
+  const __m128i x = _mm_srai_epi32(_mm_unpacklo_epi16(in16, in16), 16);
+  const __m128i m = _mm_srai_epi32(_mm_unpacklo_epi16(mean16, mean16), 16);
+  const __m128i s = _mm_srai_epi32(_mm_unpacklo_epi16(std16, std16), 16);
+  __m128i tmp32, tmp16, inv_std, inv_std2, diff, delta32, exp_value, shifts,
+      in_range;
+
+  // |inv_std| = 1 / s, in Q10. The quotient of these integers is never close
+  // enough to an integer for the float division to truncate differently.
+  // WebRtcSpl_DivW32W16() returns 0x7FFFFFFF on division by zero.
+  tmp32 = _mm_add_epi32(_mm_set1_epi32(131072), _mm_srai_epi32(s, 1));
+  inv_std = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(tmp32),
+                                        _mm_cvtepi32_ps(s)));
+  tmp32 = _mm_cmpeq_epi32(s, _mm_setzero_si128());
+  inv_std = _mm_or_si128(_mm_andnot_si128(tmp32, inv_std),
+                         _mm_and_si128(tmp32, _mm_set1_epi32(0x7FFFFFFF)));
+  inv_std = Trunc16Sse2(inv_std);
+
+  // |inv_std2| = 1 / s^2, in Q14.
+  tmp16 = _mm_srai_epi32(inv_std, 2);
+  inv_std2 = Trunc16Sse2(_mm_srai_epi32(Mul16Sse2(tmp16, tmp16), 2));
+
+  // (x - m) in Q7.
+  diff = Trunc16Sse2(_mm_sub_epi32(Trunc16Sse2(_mm_slli_epi32(x, 3)), m));
+
+  // |delta| = (x - m) / s^2, in Q11.
+  delta32 = Trunc16Sse2(_mm_srai_epi32(Mul16Sse2(inv_std2, diff), 10));
+
+  // Exponent (x - m)^2 / (2 * s^2), in Q10.
+  tmp32 = _mm_srai_epi32(Mul16Sse2(delta32, diff), 9);
+  in_range = _mm_cmplt_epi32(tmp32, _mm_set1_epi32(kCompVar));
+
+  // |exp_value| ~= exp2(-log2(exp(1)) * |tmp32|), in Q10. The variable right
+  // shift is a multiplication by a power of two, exact in float for these
+  // magnitudes. The count is masked as x86 does for the scalar shift.
+  tmp16 = _mm_srai_epi32(MulLo32Sse2(tmp32, _mm_set1_epi32(kLog2Exp)), 12);
+  tmp16 = Trunc16Sse2(_mm_sub_epi32(_mm_setzero_si128(), Trunc16Sse2(tmp16)));
+  exp_value = _mm_or_si128(_mm_set1_epi32(0x0400),
+                           _mm_and_si128(tmp16, _mm_set1_epi32(0x03FF)));
+  shifts = _mm_srai_epi32(_mm_xor_si128(tmp16, _mm_set1_epi32(-1)), 10);
+  shifts = _mm_and_si128(_mm_add_epi32(shifts, _mm_set1_epi32(1)),
+                         _mm_set1_epi32(31));
+  exp_value = _mm_cvttps_epi32(_mm_mul_ps(
+      _mm_cvtepi32_ps(exp_value),
+      _mm_castsi128_ps(_mm_slli_epi32(
+          _mm_sub_epi32(_mm_set1_epi32(127), shifts), 23))));
+  exp_value = _mm_and_si128(in_range, exp_value);
+
+  // (1 / s) * exp(-(x - m)^2 / (2 * s^2)), in Q20.
+  _mm_storeu_si128((__m128i*) probability, Mul16Sse2(inv_std, exp_value));
+  _mm_storel_epi64((__m128i*) delta, _mm_packs_epi32(delta32, delta32));
+}
+
+static void GaussianProbabilitiesSse2(const int16_t* input,
+                                      const int16_t* mean, const int16_t* std,
+                                      size_t length, int32_t* probability,
+                                      int16_t* delta) {
+  size_t i = 0;
+
+  for (; i + 4 <= length; i += 4) {
+    GaussianProbability4Sse2(&input[i], &mean[i], &std[i], &probability[i],
+                             &delta[i]);
+  }
+  GaussianProbabilitiesC(&input[i], &mean[i], &std[i], length - i,
+                         &probability[i], &delta[i]);
+}
+
+VAD_KERNELS_AVX2_TARGET
+static __m256i Trunc16Avx2(__m256i x) {
+  return _mm256_srai_epi32(_mm256_slli_epi32(x, 16), 16);
+}
+
+// Eight Gaussians per step; all products fit in (or wrap like) 32 bits, so
+// plain 32 bit multiplications replace the 16 bit emulation of the SSE2 path.
+VAD_KERNELS_AVX2_TARGET
+static void GaussianProbabilitiesAvx2(const int16_t* input,
+                                      const int16_t* mean, const int16_t* std,
+                                      size_t length, int32_t* probability,
+                                      int16_t* delta) {
+  size_t i = 0;
+
+  for (; i + 8 <= length; i += 8) {
+    const __m256i x = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128((const __m128i*) &input[i]));
+    const __m256i m = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128((const __m128i*) &mean[i]));
+    const __m256i s = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128((const __m128i*) &std[i]));
+    __m256i tmp32, tmp16, inv_std, inv_std2, diff, delta32, exp_value, shifts;
+
+    tmp32 = _mm256_add_epi32(_mm256_set1_epi32(131072),
+                             _mm256_srai_epi32(s, 1));
+    inv_std = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(tmp32),
+                                                _mm256_cvtepi32_ps(s)));
+    inv_std = _mm256_blendv_epi8(inv_std, _mm256_set1_epi32(0x7FFFFFFF),
+        _mm256_cmpeq_epi32(s, _mm256_setzero_si256()));
+    inv_std = Trunc16Avx2(inv_std);
+
+    tmp16 = _mm256_srai_epi32(inv_std, 2);
+    inv_std2 = Trunc16Avx2(_mm256_srai_epi32(_mm256_mullo_epi32(tmp16, tmp16),
+                                             2));
+
+    diff = Trunc16Avx2(_mm256_sub_epi32(
+        Trunc16Avx2(_mm256_slli_epi32(x, 3)), m));
+
+    delta32 = Trunc16Avx2(_mm256_srai_epi32(
+        _mm256_mullo_epi32(inv_std2, diff), 10));
+
+    tmp32 = _mm256_srai_epi32(_mm256_mullo_epi32(delta32, diff), 9);
+
+    tmp16 = _mm256_srai_epi32(_mm256_mullo_epi32(tmp32,
+                                                 _mm256_set1_epi32(kLog2Exp)),
+                              12);
+    tmp16 = Trunc16Avx2(_mm256_sub_epi32(_mm256_setzero_si256(),
+                                         Trunc16Avx2(tmp16)));
+    exp_value = _mm256_or_si256(
+        _mm256_set1_epi32(0x0400),
+        _mm256_and_si256(tmp16, _mm256_set1_epi32(0x03FF)));
+    shifts = _mm256_srai_epi32(
+        _mm256_xor_si256(tmp16, _mm256_set1_epi32(-1)), 10);
+    shifts = _mm256_and_si256(_mm256_add_epi32(shifts, _mm256_set1_epi32(1)),
+                              _mm256_set1_epi32(31));
+    exp_value = _mm256_srlv_epi32(exp_value, shifts);
+    exp_value = _mm256_and_si256(
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(kCompVar), tmp32), exp_value);
+
+    _mm256_storeu_si256((__m256i*) &probability[i],
+                        _mm256_mullo_epi32(inv_std, exp_value));
+    _mm_storeu_si128((__m128i*) &delta[i],
+                     _mm_packs_epi32(_mm256_castsi256_si128(delta32),
+                                     _mm256_extracti128_si256(delta32, 1)));
+  }
+  GaussianProbabilitiesSse2(&input[i], &mean[i], &std[i], length - i,
+                            &probability[i], &delta[i]);
+}
+
+static int CpuSupportsAvx2(void) {
+#if defined(_MSC_VER)
+  int info[4] = { 0 };
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return 0;
+  }
+  __cpuid(info, 1);
+  // AVX and OSXSAVE, and the OS must save the YMM registers.
+  if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 ||
+      (_xgetbv(0) & 0x6) != 0x6) {
+    return 0;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// SSE2 is part of x86-64, only AVX2 needs a check.
+static const VadKernels kSse2Kernels = {
+  "SSE2", SplitFilterSse2, EnergySse2, GaussianProbabilitiesSse2
+};
+
+// The split filter only uses two lanes and the energies are at most 60
+// samples long, so wider registers would not help them.
+static const VadKernels kAvx2Kernels = {
+  "AVX2", SplitFilterSse2, EnergySse2, GaussianProbabilitiesAvx2
+};
+
+#endif  // VAD_KERNELS_X86
+
+const VadKernels* WebRtcVad_AvailableKernels(size_t index) {
+  const VadKernels* available[3];
+  size_t count = 0;
+
+  available[count++] = &kScalarKernels;
+#if defined(VAD_KERNELS_X86)
+  available[count++] = &kSse2Kernels;
+  if (CpuSupportsAvx2()) {
+    available[count++] = &kAvx2Kernels;
+  }
+#endif
+
+  return index < count ? available[index] : NULL;
+}
+
+const VadKernels* WebRtcVad_SelectKernels(void) {
+#if defined(VAD_KERNELS_X86)
+  return CpuSupportsAvx2() ? &kAvx2Kernels : &kSse2Kernels;
+#else
+  return &kScalarKernels;
+#endif
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2016 Daniel Pirch
+ *
+ * Use of this source code is governed by a BSD-style license
+ * that can be found in the LICENSE file in the root of the source
+ * tree. An additional intellectual property rights grant can be found
+ * in the file PATENTS.  All contributing project authors may
+ * be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The inner loops of the VAD that run on every frame: the split filters of the
+ * filter bank, the sub-band energies and the evaluation of the Gaussians of the
+ * GMM. Each function has a scalar reference and SIMD versions (SSE2/AVX2 on
+ * x86-64); the table is chosen at runtime from the CPU features. All versions
+ * give bit-exact results compared to the scalar code, including its 16 and 32
+ * bit wrap-around behavior.
+ */
+
+#ifndef COMMON_AUDIO_VAD_VAD_KERNELS_H_
+#define COMMON_AUDIO_VAD_VAD_KERNELS_H_
+
+#include "../common.h"
+
+typedef struct VadKernels_ {
+  const char* name;
+
+  // Splits |data_in| into an upper (high pass) and a lower (low pass) band by
+  // two all-pass filters, downsampling by two.
+  //
+  // - data_in      [i]   : Input audio data to be split into two bands.
+  // - data_length  [i]   : Length of |data_in|.
+  // - upper_state  [i/o] : State of the upper filter, given in Q(-1).
+  // - lower_state  [i/o] : State of the lower filter, given in Q(-1).
+  // - hp_data_out  [o]   : Upper half of the spectrum, |data_length| / 2 long.
+  // - lp_data_out  [o]   : Lower half of the spectrum, |data_length| / 2 long.
+  void (*split_filter)(const int16_t* data_in, size_t data_length,
+                       int16_t* upper_state, int16_t* lower_state,
+                       int16_t* hp_data_out, int16_t* lp_data_out);
+
+  // Energy of |data_in|, same as WebRtcSpl_Energy().
+  //
+  // - data_in      [i]   : Input data.
+  // - data_length  [i]   : Length of |data_in|.
+  // - scale_factor [o]   : Number of right shifts applied to each square.
+  int32_t (*energy)(const int16_t* data_in, size_t data_length,
+                    int* scale_factor);
+
+  // WebRtcVad_GaussianProbability() for |length| independent Gaussians.
+  //
+  // - input        [i]   : Input samples in Q4.
+  // - mean         [i]   : Means in Q7.
+  // - std          [i]   : Standard deviations in Q7.
+  // - length       [i]   : Number of Gaussians.
+  // - probability  [o]   : Probabilities in Q20.
+  // - delta        [o]   : (|input| - |mean|) / |std|^2 in Q11.
+  void (*gaussian_probabilities)(const int16_t* input, const int16_t* mean,
+                                 const int16_t* std, size_t length,
+                                 int32_t* probability, int16_t* delta);
+} VadKernels;
+
+// Returns the fastest kernels supported by the CPU.
+const VadKernels* WebRtcVad_SelectKernels(void);
+
+// Returns the |index|-th kernel table usable on this CPU, index 0 being the
+// scalar reference, or NULL if |index| is past the last one. Lets the unit
+// tests run every implementation.
+const VadKernels* WebRtcVad_AvailableKernels(size_t index);
+
+#endif  // COMMON_AUDIO_VAD_VAD_KERNELS_H_
@@ -10,13 +10,60 @@
 
 #include "vad_unittest.h"
 #include "../src/vad/vad_filterbank.h"
+#include "../src/vad/vad_kernels.h"
 #include <string.h>
 
 
 #define kNumValidFrameLengths 3
 
-void test_main() {
-  VadInstT* self = malloc(sizeof(VadInstT));
+// Compares the split filter and energy of |kernels| with the scalar reference
+// on pseudo-random input covering the full 16 bit range.
+static void CompareWithScalar(const VadKernels* kernels) {
+  const VadKernels* scalar = WebRtcVad_AvailableKernels(0);
+  int16_t data[240];
+  int16_t hp[120], lp[120], hp_ref[120], lp_ref[120];
+  int16_t upper = 0, lower = 0, upper_ref = 0, lower_ref = 0;
+  uint32_t seed = 12345;
+
+  for (int frame = 0; frame < 100; ++frame) {
+    // Alternate between full scale and small signals.
+    const int shift = (frame % 2 == 0) ? 16 : 24;
+    for (size_t i = 0; i < arraysize(data); ++i) {
+      seed = seed * 1664525 + 1013904223;
+      data[i] = (int16_t) ((int32_t) seed >> shift);
+    }
+    for (size_t length = 2; length <= arraysize(data); length += 19) {
+      kernels->split_filter(data, length, &upper, &lower, hp, lp);
+      scalar->split_filter(data, length, &upper_ref, &lower_ref, hp_ref,
+                           lp_ref);
+      EXPECT_EQ(upper_ref, upper);
+      EXPECT_EQ(lower_ref, lower);
+      EXPECT_EQ(0, memcmp(hp_ref, hp, length / 2 * sizeof(*hp)));
+      EXPECT_EQ(0, memcmp(lp_ref, lp, length / 2 * sizeof(*lp)));
+
+      int scale = -1, scale_ref = -2;
+      EXPECT_EQ(scalar->energy(data, length, &scale_ref),
+                kernels->energy(data, length, &scale));
+      EXPECT_EQ(scale_ref, scale);
+    }
+  }
+
+  // Energy of silence and of -32768, which does not count as maximum.
+  int16_t extreme[16] = { 0 };
+  int scale = -1, scale_ref = -2;
+  EXPECT_EQ(scalar->energy(extreme, 16, &scale_ref),
+            kernels->energy(extreme, 16, &scale));
+  EXPECT_EQ(scale_ref, scale);
+  for (size_t i = 0; i < 16; ++i) {
+    extreme[i] = (i % 3 == 0) ? -32768 : 3;
+  }
+  EXPECT_EQ(scalar->energy(extreme, 16, &scale_ref),
+            kernels->energy(extreme, 16, &scale));
+  EXPECT_EQ(scale_ref, scale);
+}
+
+// Checks the reference features with the given kernels.
+static void TestFeatures(VadInstT* self, const VadKernels* kernels) {
   static const int16_t kReference[kNumValidFrameLengths] = { 48, 11, 11 };
   static const int16_t kFeatures[kNumValidFrameLengths * kNumChannels] = {
       1213, 759, 587, 462, 434, 272,
@@ -36,6 +83,7 @@ void test_main() {
 
   int frame_length_index = 0;
   ASSERT_EQ(0, WebRtcVad_InitCore(self));
+  self->kernels = kernels;
   for (size_t j = 0; j < kFrameLengthsSize; ++j) {
     if (ValidRatesAndFrameLengths(8000, kFrameLengths[j])) {
       EXPECT_EQ(kReference[frame_length_index],
@@ -53,6 +101,7 @@ void test_main() {
   // Verify that all zeros in gives kOffsetVector out.
   memset(speech, 0, sizeof(speech));
   ASSERT_EQ(0, WebRtcVad_InitCore(self));
+  self->kernels = kernels;
   for (size_t j = 0; j < kFrameLengthsSize; ++j) {
     if (ValidRatesAndFrameLengths(8000, kFrameLengths[j])) {
       EXPECT_EQ(0, WebRtcVad_CalculateFeatures(self, speech, kFrameLengths[j],
@@ -71,6 +120,7 @@ void test_main() {
   for (size_t j = 0; j < kFrameLengthsSize; ++j) {
     if (ValidRatesAndFrameLengths(8000, kFrameLengths[j])) {
       ASSERT_EQ(0, WebRtcVad_InitCore(self));
+      self->kernels = kernels;
       EXPECT_EQ(0, WebRtcVad_CalculateFeatures(self, speech, kFrameLengths[j],
                                                features));
       for (int k = 0; k < kNumChannels; ++k) {
@@ -78,6 +128,20 @@ void test_main() {
       }
     }
   }
+}
+
+void test_main() {
+  VadInstT* self = malloc(sizeof(VadInstT));
+  const VadKernels* kernels;
+
+  ASSERT_EQ(0, WebRtcVad_InitCore(self));
+  ASSERT_TRUE(self->kernels != NULL);
+  EXPECT_TRUE(WebRtcVad_AvailableKernels(0) != NULL);
+
+  for (size_t k = 0; (kernels = WebRtcVad_AvailableKernels(k)) != NULL; ++k) {
+    TestFeatures(self, kernels);
+    CompareWithScalar(kernels);
+  }
 
   free(self);
 }
@@ -10,6 +10,7 @@
 
 #include "vad_unittest.h"
 #include "../src/vad/vad_gmm.h"
+#include "../src/vad/vad_core.h"
 
 
 void test_main() {
@@ -33,4 +34,55 @@ void test_main() {
   // Too large input, should give zero probability.
   EXPECT_EQ(0, WebRtcVad_GaussianProbability(105, 0, 128, &delta));
   EXPECT_EQ(13440, delta);
+
+  // The same cases through every kernel table, batched as in the GMM.
+  static const int16_t kInput[7] = { 0, 16, -16, 59, 75, -75, 105 };
+  static const int16_t kMean[7] = { 0, 128, -128, 0, 128, -128, 0 };
+  static const int16_t kStd[7] = { 128, 128, 128, 128, 128, 128, 128 };
+  static const int32_t kProbability[7] = {
+      1048576, 1048576, 1048576, 1024, 1024, 1024, 0 };
+  static const int16_t kDelta[7] = { 0, 0, 0, 7552, 7552, -7552, 13440 };
+  const VadKernels* kernels;
+  int16_t input[kTableSize], mean[kTableSize], std[kTableSize];
+  int16_t deltas[kTableSize], deltas_ref[kTableSize];
+  int32_t probability[kTableSize], probability_ref[kTableSize];
+
+  for (size_t k = 0; (kernels = WebRtcVad_AvailableKernels(k)) != NULL; ++k) {
+    for (size_t length = 1; length <= kTableSize; ++length) {
+      for (size_t i = 0; i < length; ++i) {
+        input[i] = kInput[i % 7];
+        mean[i] = kMean[i % 7];
+        std[i] = kStd[i % 7];
+      }
+      kernels->gaussian_probabilities(input, mean, std, length, probability,
+                                      deltas);
+      for (size_t i = 0; i < length; ++i) {
+        EXPECT_EQ(kProbability[i % 7], probability[i]);
+        EXPECT_EQ(kDelta[i % 7], deltas[i]);
+      }
+    }
+
+    // Pseudo-random features and model parameters in the ranges the GMM
+    // produces, compared with the scalar function.
+    uint32_t seed = 4711;
+    for (int run = 0; run < 10000; ++run) {
+      for (size_t i = 0; i < kTableSize; ++i) {
+        seed = seed * 1664525 + 1013904223;
+        input[i] = (int16_t) ((seed >> 8) % 2000);  // Q4
+        seed = seed * 1664525 + 1013904223;
+        mean[i] = (int16_t) ((seed >> 8) % 16000);  // Q7
+        seed = seed * 1664525 + 1013904223;
+        std[i] = (int16_t) (384 + (seed >> 8) % 6000);  // Q7, >= kMinStd
+        probability_ref[i] = WebRtcVad_GaussianProbability(input[i], mean[i],
+                                                           std[i],
+                                                           &deltas_ref[i]);
+      }
+      kernels->gaussian_probabilities(input, mean, std, kTableSize,
+                                      probability, deltas);
+      for (size_t i = 0; i < kTableSize; ++i) {
+        EXPECT_EQ(probability_ref[i], probability[i]);
+        EXPECT_EQ(deltas_ref[i], deltas[i]);
+      }
+    }
+  }
 }
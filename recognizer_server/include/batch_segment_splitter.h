@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+#include "recognition_service.h"
+
+// 批量识别时一段输入在拼接音频中的位置（单位：毫秒）
+struct BatchClipSpan {
+    long long start_ms = 0;
+    long long end_ms = 0;
+};
+
+// 拼接识别结果按输入拆分后的结果
+struct BatchSplitResult {
+    std::vector<std::vector<TranscriptSegment>> clip_segments;  // 各段分到的片段，时间相对该段起点
+    std::vector<bool> needs_rerun;  // 有片段跨越了段边界，该段需要单独重新识别
+};
+
+// 按时间把拼接识别得到的片段分配回各段输入
+// whisper不保证在段间静音处切分片段，一个片段可能同时覆盖相邻两段的语音，
+// 此时无法确定文本的归属，涉及的各段都标记为需要重新识别，其余片段丢弃；
+// 只落在静音间隔内的片段按中点归入前一段。
+BatchSplitResult splitBatchSegments(const std::vector<TranscriptSegment>& segments,
+                                    const std::vector<BatchClipSpan>& clips);
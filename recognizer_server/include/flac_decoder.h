@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// FLAC解码器
+// 把完整的FLAC流一次性解码为单声道float样本（多声道取平均），用于客户端压缩上传的语音段。
+// 支持所有标准块大小/采样率编码、声道去相关、CONSTANT/VERBATIM/FIXED/LPC子帧和Rice转义分区，
+// 并校验帧头CRC-8和帧CRC-16。
+class FlacDecoder {
+public:
+    // 数据是否以"fLaC"标记开头
+    static bool isFlac(const char* data, size_t size);
+
+    // 解码整个流，返回false表示数据格式错误（错误信息见getError）
+    bool decode(const char* data, size_t size);
+
+    // 取走已解码的样本
+    std::vector<float> takeSamples();
+
+    // 采样率和声道数（解码成功后有效）
+    int getSampleRate() const;
+    int getChannels() const;
+
+    // 错误信息
+    const std::string& getError() const;
+
+private:
+    class BitReader;
+
+    bool parseMetadata(BitReader& reader);
+    bool decodeFrame(BitReader& reader);
+    bool decodeSubframe(BitReader& reader, int bits_per_sample, size_t block_size, std::vector<int64_t>& output);
+    bool decodeResidual(BitReader& reader, size_t block_size, int predictor_order, std::vector<int64_t>& output);
+
+    bool fail(const std::string& message);
+
+    int sample_rate_ = 0;
+    int channels_ = 0;
+    int bits_per_sample_ = 0;
+    uint64_t total_samples_ = 0;    // STREAMINFO中的总样本数，0表示未知
+
+    std::vector<std::vector<int64_t>> channel_buffers_;
+    std::vector<float> samples_;
+    std::string error_;
+};
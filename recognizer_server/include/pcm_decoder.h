@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// 上传音频的编码格式
+enum class PcmFormat {
+    S16LE,  // 原始16位有符号小端PCM
+    F32LE,  // 原始32位浮点小端PCM
+    WAV     // 带RIFF头的WAV数据（16位PCM或32位浮点）
+};
+
+// 流式PCM解码器
+// 按任意大小的字节块增量输入，直接解码为单声道float样本，不经过临时文件。
+// 适用于分块传输的上传请求，在上传未完成时即可开始解码。
+class StreamingPcmDecoder {
+public:
+    static constexpr int TARGET_SAMPLE_RATE = 16000;  // Whisper要求的采样率
+
+    // 接受的输入范围，超出范围的请求直接拒绝，避免除零和异常大的重采样缓冲区
+    static constexpr int MIN_SAMPLE_RATE = 8000;
+    static constexpr int MAX_SAMPLE_RATE = 192000;
+    static constexpr int MAX_CHANNELS = 8;
+
+    // 采样率和声道数是否在接受范围内
+    static bool isValidFormat(int sample_rate, int channels);
+
+    // 原始PCM需要调用方给出采样率和声道数，WAV格式以文件头为准
+    StreamingPcmDecoder(PcmFormat format, int sample_rate = TARGET_SAMPLE_RATE, int channels = 1);
+
+    // 追加一段字节数据，返回false表示数据格式错误（错误信息见getError）
+    bool feed(const char* data, size_t size);
+
+    // 输入结束，检查头部是否完整以及是否有残留的不完整帧（原始PCM的长度必须是帧大小的整数倍）
+    bool finish();
+
+    // 已解码的样本（多声道已平均为单声道）
+    const std::vector<float>& samples() const;
+
+    // 取走已解码的样本
+    std::vector<float> takeSamples();
+
+    // 当前采样率和声道数（WAV格式在头部解析完成后有效）
+    int getSampleRate() const;
+    int getChannels() const;
+
+    // 错误信息
+    const std::string& getError() const;
+
+    // 解析格式名称（s16le/pcm_s16le/f32le/pcm_f32le/wav），失败返回false
+    static bool parseFormat(const std::string& name, PcmFormat& format);
+
+private:
+    // 从pending_中解析WAV头部，数据不足时返回true并等待更多输入
+    bool parseWavHeader();
+
+    // 解码整帧数据（size必须是帧大小的整数倍）
+    void decodeFrames(const char* data, size_t size);
+
+    // 处理数据块（头部之后的音频数据）
+    void consumeAudio(const char* data, size_t size);
+
+    bool fail(const std::string& message);
+
+    PcmFormat format_;
+    int sample_rate_;
+    int channels_;
+    int bytes_per_sample_ = 2;
+    bool is_float_ = false;
+
+    bool header_done_ = false;
+    bool data_unbounded_ = false;   // WAV数据块长度未知（流式写出的WAV）
+    uint64_t data_remaining_ = 0;   // WAV数据块剩余字节数
+
+    std::string pending_;           // 未解析的头部字节或不完整的帧
+    std::vector<float> samples_;
+    std::string error_;
+};
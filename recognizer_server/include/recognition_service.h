@@ -4,6 +4,7 @@
 #include <vector>
 #include <mutex>
 #include <memory>
+#include "speech_trimmer.h"
 
 // 前向声明
 struct CorrectionParams;
@@ -21,6 +22,16 @@ struct RecognitionParams {
     std::string correction_server = "http://localhost:8000";  // 矫正服务地址
     float correction_temperature = 0.3f; // 矫正时的采样温度
     int correction_max_tokens = 512;     // 矫正最大token数
+    
+    // 静音裁剪：-1跟随服务器配置，0关闭，1开启
+    int trim_silence = -1;
+};
+
+// 识别出的文本片段（时间相对于输入音频起点，单位：毫秒）
+struct TranscriptSegment {
+    std::string text;
+    long long start_ms = 0;
+    long long end_ms = 0;
 };
 
 // 识别结果结构体
@@ -37,12 +48,56 @@ struct RecognitionResult {
     float correction_confidence = 0.0f; // 矫正置信度
     long long correction_time_ms = 0;   // 矫正耗时（毫秒）
     std::string correction_error;   // 矫正错误信息
+    
+    // 分段结果（启用静音裁剪时时间已换算回原始音频）
+    std::vector<TranscriptSegment> segments;
+    long long trimmed_ms = 0;       // 推理前裁剪掉的静音时长（毫秒）
+};
+
+// 共享的Whisper模型权重
+// 模型只加载一次（不带解码状态），各通道通过whisper_init_state创建独立的解码状态，
+// 多路并发时显存只随激活/KV缓存增长，而不是随权重副本增长
+class SharedWhisperModel {
+public:
+    SharedWhisperModel(const std::string& model_path, int gpu_device = 0);
+    ~SharedWhisperModel();
+    
+    SharedWhisperModel(const SharedWhisperModel&) = delete;
+    SharedWhisperModel& operator=(const SharedWhisperModel&) = delete;
+    
+    // 加载模型权重（重复调用直接返回）
+    bool load();
+    
+    // 是否已加载
+    bool isLoaded() const;
+    
+    // 获取模型路径
+    std::string getModelPath() const;
+    
+    // 获取whisper_context指针（无状态，仅供*_with_state接口使用）
+    void* getContext() const;
+    
+    // 创建新的whisper_state，失败返回nullptr，调用方负责用whisper_free_state释放
+    void* createState();
+
+private:
+    std::string model_path_;
+    int gpu_device_ = 0;
+    void* context_ptr_ = nullptr;    // whisper_context*
+    mutable std::mutex model_mutex_;
 };
 
 // 语音识别服务类
 class RecognitionService {
 public:
+    // 批量识别时各段音频拼接进同一个编码窗口（whisper按30秒窗口编码，短音频单独识别会浪费大部分窗口）
+    static constexpr int BATCH_WINDOW_MS = 30000;  // 单个编码窗口时长
+    static constexpr int BATCH_GAP_MS = 1000;      // 段间插入的静音间隔
+    
     RecognitionService(const std::string& model_path);
+    
+    // 使用共享模型构造，只创建本实例独有的解码状态
+    explicit RecognitionService(std::shared_ptr<SharedWhisperModel> shared_model);
     ~RecognitionService();
 
     // 初始化识别服务
@@ -51,6 +106,17 @@ public:
     // 执行语音识别
     RecognitionResult recognize(const std::string& audio_path, const RecognitionParams& params);
     
+    // 直接对内存中的16kHz单声道PCM执行语音识别（不经过临时文件）
+    RecognitionResult recognizeSamples(const std::vector<float>& pcmf32, const RecognitionParams& params);
+    
+    // 将多段短音频拼接后一次识别，再按时间戳拆分回各自的结果（有片段跨越段边界时涉及的段单独重新识别）
+    // 解码参数取params_list[0]（调用方需保证解码参数一致），文本矫正按各自参数进行
+    std::vector<RecognitionResult> recognizeBatch(const std::vector<const std::vector<float>*>& inputs,
+                                                  const std::vector<RecognitionParams>& params_list);
+    
+    // 设置推理前的静音裁剪配置
+    void setTrimOptions(const SpeechTrimOptions& options);
+    
     // 获取模型路径
     std::string getModelPath() const;
     
@@ -61,6 +127,8 @@ private:
     std::string model_path_;
     bool is_initialized_ = false;
     void* model_ptr_ = nullptr;  // 实际使用时会指向具体的模型实例
+    void* state_ptr_ = nullptr;  // 共享模型模式下本实例的whisper_state
+    std::shared_ptr<SharedWhisperModel> shared_model_;  // 共享模型（为空时独占加载）
     
     // CUDA相关成员变量
     mutable std::mutex recognition_mutex_;  // 识别操作的互斥锁
@@ -70,6 +138,9 @@ private:
     
     // 文本矫正相关
     std::unique_ptr<TextCorrector> text_corrector_;  // 文本矫正器
+    
+    // 静音裁剪
+    SpeechTrimmer speech_trimmer_;
 
     // 加载模型
     bool loadModel();
@@ -83,6 +154,27 @@ private:
     // 内部识别方法（不加锁）
     RecognitionResult recognizeInternal(const std::string& audio_path, const RecognitionParams& params);
     
+    // 内部识别方法，直接使用已解码的PCM（不加锁）
+    RecognitionResult recognizeSamplesInternal(const std::vector<float>& pcmf32, const RecognitionParams& params);
+    
+    // 检查GPU状态，必要时返回切换到CPU模式的参数
+    RecognitionParams prepareDeviceParams(const RecognitionParams& params);
+    
+    // 执行whisper_full（不加锁），失败时填充错误信息
+    bool runWhisper(const std::vector<float>& pcmf32, const RecognitionParams& params, std::string& error_message);
+    
+    // 读取最近一次识别的片段
+    std::vector<TranscriptSegment> collectSegments() const;
+    
+    // 按参数和服务器配置判断是否裁剪静音
+    bool shouldTrimSilence(const RecognitionParams& params) const;
+    
+    // 按参数裁剪静音（不裁剪时返回的结果trimmed为false）
+    SpeechTrimResult trimSilence(const std::vector<float>& pcmf32, const RecognitionParams& params) const;
+    
+    // 按参数对识别结果执行文本矫正
+    void applyTextCorrection(RecognitionResult& result, const RecognitionParams& params);
+    
     // CUDA设备管理方法
     bool initializeCUDA();
     void cleanupCUDA();
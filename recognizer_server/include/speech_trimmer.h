@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// 静音裁剪配置
+struct SpeechTrimOptions {
+    bool enabled = false;           // 是否默认对所有请求裁剪静音（请求参数trim_silence可覆盖）
+    std::string mode = "fvad";      // 检测方式：fvad（WebRTC VAD，未编译时自动改用energy）或energy
+    int fvad_mode = 2;              // WebRTC VAD激进程度（0-3，越大越容易判为静音）
+    float energy_threshold_db = -45.0f; // 能量门限（dBFS），仅energy模式使用
+    int frame_ms = 30;              // 检测帧长（10/20/30ms）
+    int guard_ms = 200;             // 每段语音前后保留的保护带
+    int min_silence_ms = 500;       // 短于该时长的停顿不裁剪
+    int min_speech_ms = 90;         // 短于该时长的语音视为噪声
+};
+
+// 裁剪后音频中的一段与原始音频的对应关系（单位：样本）
+struct TrimSpan {
+    size_t source_offset = 0;       // 在原始音频中的起点
+    size_t output_offset = 0;       // 在裁剪后音频中的起点
+    size_t length = 0;
+};
+
+// 裁剪结果
+struct SpeechTrimResult {
+    std::vector<float> samples;     // 拼接后的语音（trimmed为false时为空，直接使用原始音频）
+    std::vector<TrimSpan> spans;    // 时间映射表
+    bool trimmed = false;           // 是否实际裁剪了音频
+    bool has_speech = true;         // 是否检测到语音
+    size_t source_samples = 0;      // 原始音频样本数
+
+    // 将裁剪后音频中的时间（毫秒）换算回原始音频中的时间
+    long long toSourceMs(long long output_ms, int sample_rate) const;
+};
+
+// 推理前的静音裁剪
+// 按帧检测语音，去掉首尾静音和较长的停顿，保留保护带后把语音段拼接起来，
+// 并记录每段在原始音频中的位置，使识别结果的时间戳仍对应原始音频。
+// whisper按30秒窗口编码，去掉的静音直接减少需要编码的窗口数。
+class SpeechTrimmer {
+public:
+    explicit SpeechTrimmer(const SpeechTrimOptions& options = SpeechTrimOptions());
+
+    // 裁剪16kHz单声道音频
+    SpeechTrimResult trim(const std::vector<float>& pcmf32, int sample_rate) const;
+
+    const SpeechTrimOptions& getOptions() const;
+
+    // 是否编译了WebRTC VAD（libfvad）
+    static bool isFvadAvailable();
+
+private:
+    // 逐帧判定是否为语音
+    std::vector<bool> detectFrames(const std::vector<float>& pcmf32, int sample_rate, size_t frame_samples) const;
+    std::vector<bool> detectFramesFvad(const std::vector<float>& pcmf32, int sample_rate, size_t frame_samples) const;
+    std::vector<bool> detectFramesEnergy(const std::vector<float>& pcmf32, size_t frame_samples) const;
+
+    // 把短停顿并入语音、丢弃过短的语音段
+    void smoothDecisions(std::vector<bool>& speech, int frame_ms) const;
+
+    SpeechTrimOptions options_;
+};
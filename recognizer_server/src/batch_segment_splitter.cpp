@@ -0,0 +1,58 @@
+#include "../include/batch_segment_splitter.h"
+#include <algorithm>
+
+BatchSplitResult splitBatchSegments(const std::vector<TranscriptSegment>& segments,
+                                    const std::vector<BatchClipSpan>& clips) {
+    BatchSplitResult result;
+    result.clip_segments.resize(clips.size());
+    result.needs_rerun.assign(clips.size(), false);
+    if (clips.empty()) {
+        return result;
+    }
+    
+    std::vector<size_t> owner(segments.size(), clips.size());
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const TranscriptSegment& segment = segments[i];
+        
+        // 找出与片段时间有重叠的段（clips按起点升序排列）
+        size_t first = clips.size();
+        size_t last = clips.size();
+        for (size_t c = 0; c < clips.size(); ++c) {
+            if (segment.start_ms < clips[c].end_ms && segment.end_ms > clips[c].start_ms) {
+                if (first == clips.size()) {
+                    first = c;
+                }
+                last = c;
+            }
+        }
+        
+        if (first != last) {
+            for (size_t c = first; c <= last; ++c) {
+                result.needs_rerun[c] = true;
+            }
+            continue;
+        }
+        
+        if (first == clips.size()) {
+            // 片段落在静音间隔内，按中点归入起点不晚于它的最后一段
+            long long mid_ms = (segment.start_ms + segment.end_ms) / 2;
+            auto it = std::upper_bound(clips.begin(), clips.end(), mid_ms,
+                                       [](long long value, const BatchClipSpan& clip) { return value < clip.start_ms; });
+            first = it == clips.begin() ? 0 : static_cast<size_t>(it - clips.begin()) - 1;
+        }
+        owner[i] = first;
+    }
+    
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const size_t c = owner[i];
+        if (c == clips.size() || result.needs_rerun[c]) {
+            continue;
+        }
+        const long long length_ms = clips[c].end_ms - clips[c].start_ms;
+        TranscriptSegment segment = segments[i];
+        segment.start_ms = std::min(std::max(segment.start_ms - clips[c].start_ms, 0LL), length_ms);
+        segment.end_ms = std::min(std::max(segment.end_ms - clips[c].start_ms, 0LL), length_ms);
+        result.clip_segments[c].push_back(std::move(segment));
+    }
+    return result;
+}
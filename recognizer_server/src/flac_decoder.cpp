@@ -0,0 +1,541 @@
+#include "../include/flac_decoder.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 帧头中采样率编码1-11对应的采样率
+constexpr int STANDARD_SAMPLE_RATES[] = {88200, 176400, 192000, 8000, 16000, 22050, 24000, 32000, 44100, 48000, 96000};
+
+// 帧头中样本位数编码对应的位数，0表示取STREAMINFO中的值，-1为保留值
+constexpr int STANDARD_SAMPLE_SIZES[] = {0, 8, 12, -1, 16, 20, 24, 32};
+
+// 声道编码：0-7为独立声道，以下三种为立体声去相关
+constexpr int CHANNELS_LEFT_SIDE = 8;
+constexpr int CHANNELS_SIDE_RIGHT = 9;
+constexpr int CHANNELS_MID_SIDE = 10;
+
+constexpr int MAX_FIXED_ORDER = 4;
+
+// 按剩余数据量预分配输出的上限：每字节至多预留4个样本（16位单声道压缩到1/8），
+// 压缩率更高时随解码增长，避免伪造的STREAMINFO总样本数触发超大分配
+constexpr uint64_t MAX_RESERVED_SAMPLES_PER_BYTE = 4;
+
+uint8_t crc8(const uint8_t* data, size_t size) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint16_t crc16(const uint8_t* data, size_t size) {
+    uint16_t crc = 0;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x8005) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+} // namespace
+
+// 按位读取，高位在前；越界时后续读取全部失败
+class FlacDecoder::BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    bool read(int bits, uint64_t& value) {
+        value = 0;
+        if (bits > 64 || bit_pos_ + static_cast<size_t>(bits) > size_ * 8) {
+            return false;
+        }
+        for (int i = 0; i < bits; ++i) {
+            const uint8_t byte = data_[bit_pos_ >> 3];
+            value = (value << 1) | ((byte >> (7 - (bit_pos_ & 7))) & 1);
+            ++bit_pos_;
+        }
+        return true;
+    }
+
+    bool read(int bits, uint32_t& value) {
+        uint64_t wide = 0;
+        if (bits > 32 || !read(bits, wide)) {
+            return false;
+        }
+        value = static_cast<uint32_t>(wide);
+        return true;
+    }
+
+    bool readSigned(int bits, int64_t& value) {
+        uint64_t raw = 0;
+        if (bits <= 0 || !read(bits, raw)) {
+            value = 0;
+            return bits == 0;
+        }
+        // 符号扩展
+        const uint64_t sign = uint64_t(1) << (bits - 1);
+        value = static_cast<int64_t>((raw ^ sign) - sign);
+        return true;
+    }
+
+    // 计数连续的0直到遇到1
+    bool readUnary(uint64_t& zeros) {
+        zeros = 0;
+        while (bit_pos_ < size_ * 8) {
+            const uint8_t byte = data_[bit_pos_ >> 3];
+            const bool one = ((byte >> (7 - (bit_pos_ & 7))) & 1) != 0;
+            ++bit_pos_;
+            if (one) {
+                return true;
+            }
+            ++zeros;
+        }
+        return false;
+    }
+
+    void alignToByte() { bit_pos_ = (bit_pos_ + 7) & ~static_cast<size_t>(7); }
+    size_t bytePosition() const { return bit_pos_ >> 3; }
+    size_t remainingBytes() const { return size_ - std::min(size_, bytePosition()); }
+    const uint8_t* data() const { return data_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t bit_pos_ = 0;
+};
+
+bool FlacDecoder::isFlac(const char* data, size_t size) {
+    return size >= 4 && std::memcmp(data, "fLaC", 4) == 0;
+}
+
+bool FlacDecoder::decode(const char* data, size_t size) {
+    samples_.clear();
+    error_.clear();
+    if (!isFlac(data, size)) {
+        return fail("不是FLAC数据");
+    }
+
+    BitReader reader(reinterpret_cast<const uint8_t*>(data), size);
+    uint64_t marker = 0;
+    reader.read(32, marker);
+    if (!parseMetadata(reader)) {
+        return false;
+    }
+    if (total_samples_ > 0) {
+        const uint64_t payload_limit = static_cast<uint64_t>(reader.remainingBytes()) * MAX_RESERVED_SAMPLES_PER_BYTE;
+        samples_.reserve(static_cast<size_t>(std::min(total_samples_, payload_limit)));
+    }
+
+    // 帧之后可能有ID3等尾部数据，剩余字节不足一个帧头时结束
+    while (reader.remainingBytes() >= 2) {
+        const uint8_t* next = reader.data() + reader.bytePosition();
+        if (next[0] != 0xFF || (next[1] & 0xFE) != 0xF8) {
+            break;
+        }
+        if (!decodeFrame(reader)) {
+            return false;
+        }
+    }
+
+    if (total_samples_ > 0 && samples_.size() != total_samples_) {
+        return fail("FLAC样本数与STREAMINFO不符: " + std::to_string(samples_.size()) + "/" +
+                    std::to_string(total_samples_));
+    }
+    return true;
+}
+
+bool FlacDecoder::parseMetadata(BitReader& reader) {
+    bool has_streaminfo = false;
+    bool last = false;
+    while (!last) {
+        uint32_t is_last = 0;
+        uint32_t type = 0;
+        uint32_t length = 0;
+        if (!reader.read(1, is_last) || !reader.read(7, type) || !reader.read(24, length)) {
+            return fail("FLAC元数据不完整");
+        }
+        last = is_last != 0;
+
+        if (type == 0) {
+            uint32_t value = 0;
+            uint64_t total = 0;
+            uint64_t skipped = 0;
+            if (length < 34 || !reader.read(16, value) || !reader.read(16, value) ||  // 最小/最大块大小
+                !reader.read(24, value) || !reader.read(24, value) ||                    // 最小/最大帧大小
+                !reader.read(20, value)) {
+                return fail("FLAC STREAMINFO不完整");
+            }
+            sample_rate_ = static_cast<int>(value);
+            if (!reader.read(3, value)) {
+                return fail("FLAC STREAMINFO不完整");
+            }
+            channels_ = static_cast<int>(value) + 1;
+            if (!reader.read(5, value) || !reader.read(36, total) ||
+                !reader.read(64, skipped) || !reader.read(64, skipped)) {  // MD5
+                return fail("FLAC STREAMINFO不完整");
+            }
+            bits_per_sample_ = static_cast<int>(value) + 1;
+            total_samples_ = total;
+            for (uint32_t i = 34; i < length; ++i) {
+                reader.read(8, value);
+            }
+            has_streaminfo = true;
+        } else {
+            if (reader.remainingBytes() < length) {
+                return fail("FLAC元数据块长度超出数据范围");
+            }
+            for (uint32_t i = 0; i < length; ++i) {
+                uint32_t skipped = 0;
+                reader.read(8, skipped);
+            }
+        }
+    }
+
+    if (!has_streaminfo) {
+        return fail("FLAC缺少STREAMINFO");
+    }
+    if (sample_rate_ <= 0) {
+        return fail("FLAC采样率无效");
+    }
+    return true;
+}
+
+bool FlacDecoder::decodeFrame(BitReader& reader) {
+    const size_t frame_start = reader.bytePosition();
+
+    uint32_t sync = 0;
+    uint32_t reserved = 0;
+    uint32_t blocking_strategy = 0;
+    uint32_t block_size_code = 0;
+    uint32_t sample_rate_code = 0;
+    uint32_t channel_code = 0;
+    uint32_t sample_size_code = 0;
+    uint32_t reserved2 = 0;
+    if (!reader.read(14, sync) || !reader.read(1, reserved) || !reader.read(1, blocking_strategy) ||
+        !reader.read(4, block_size_code) || !reader.read(4, sample_rate_code) ||
+        !reader.read(4, channel_code) || !reader.read(3, sample_size_code) || !reader.read(1, reserved2)) {
+        return fail("FLAC帧头不完整");
+    }
+    if (sync != 0x3FFE || reserved != 0 || reserved2 != 0) {
+        return fail("FLAC帧同步码错误");
+    }
+
+    // 帧号或样本号（UTF-8方式的变长编码），解码时不需要其值
+    uint32_t first = 0;
+    if (!reader.read(8, first)) {
+        return fail("FLAC帧头不完整");
+    }
+    int continuation = 0;
+    while (continuation < 8 && (first & (0x80 >> continuation))) {
+        ++continuation;
+    }
+    if (continuation == 1 || continuation == 8) {
+        return fail("FLAC帧号编码错误");
+    }
+    for (int i = 1; i < continuation; ++i) {
+        uint32_t byte = 0;
+        if (!reader.read(8, byte) || (byte & 0xC0) != 0x80) {
+            return fail("FLAC帧号编码错误");
+        }
+    }
+
+    size_t block_size = 0;
+    uint32_t value = 0;
+    if (block_size_code == 0) {
+        return fail("FLAC块大小编码无效");
+    } else if (block_size_code == 1) {
+        block_size = 192;
+    } else if (block_size_code <= 5) {
+        block_size = size_t(576) << (block_size_code - 2);
+    } else if (block_size_code == 6) {
+        if (!reader.read(8, value)) {
+            return fail("FLAC帧头不完整");
+        }
+        block_size = value + 1;
+    } else if (block_size_code == 7) {
+        if (!reader.read(16, value)) {
+            return fail("FLAC帧头不完整");
+        }
+        block_size = value + 1;
+    } else {
+        block_size = size_t(256) << (block_size_code - 8);
+    }
+
+    int frame_sample_rate = sample_rate_;
+    if (sample_rate_code >= 1 && sample_rate_code <= 11) {
+        frame_sample_rate = STANDARD_SAMPLE_RATES[sample_rate_code - 1];
+    } else if (sample_rate_code == 12) {
+        if (!reader.read(8, value)) {
+            return fail("FLAC帧头不完整");
+        }
+        frame_sample_rate = static_cast<int>(value) * 1000;
+    } else if (sample_rate_code == 13 || sample_rate_code == 14) {
+        if (!reader.read(16, value)) {
+            return fail("FLAC帧头不完整");
+        }
+        frame_sample_rate = static_cast<int>(value) * (sample_rate_code == 14 ? 10 : 1);
+    } else if (sample_rate_code == 15) {
+        return fail("FLAC采样率编码无效");
+    }
+    if (frame_sample_rate != sample_rate_) {
+        return fail("FLAC帧采样率与STREAMINFO不一致");
+    }
+
+    const int bits_per_sample = STANDARD_SAMPLE_SIZES[sample_size_code] == 0
+        ? bits_per_sample_ : STANDARD_SAMPLE_SIZES[sample_size_code];
+    if (bits_per_sample < 4 || bits_per_sample > 32) {
+        return fail("FLAC样本位数无效");
+    }
+
+    int frame_channels = 0;
+    if (channel_code < 8) {
+        frame_channels = static_cast<int>(channel_code) + 1;
+    } else if (channel_code <= CHANNELS_MID_SIDE) {
+        frame_channels = 2;
+    } else {
+        return fail("FLAC声道编码无效");
+    }
+    if (frame_channels != channels_) {
+        return fail("FLAC帧声道数与STREAMINFO不一致");
+    }
+
+    const size_t header_end = reader.bytePosition();
+    if (!reader.read(8, value) || value != crc8(reader.data() + frame_start, header_end - frame_start)) {
+        return fail("FLAC帧头CRC校验失败");
+    }
+
+    // 去相关时差值声道多占1位
+    channel_buffers_.resize(frame_channels);
+    for (int c = 0; c < frame_channels; ++c) {
+        const bool side_channel = (c == 1 && (channel_code == CHANNELS_LEFT_SIDE || channel_code == CHANNELS_MID_SIDE)) ||
+                                  (c == 0 && channel_code == CHANNELS_SIDE_RIGHT);
+        if (!decodeSubframe(reader, bits_per_sample + (side_channel ? 1 : 0), block_size, channel_buffers_[c])) {
+            return false;
+        }
+    }
+
+    reader.alignToByte();
+    const size_t frame_end = reader.bytePosition();
+    if (!reader.read(16, value) || value != crc16(reader.data() + frame_start, frame_end - frame_start)) {
+        return fail("FLAC帧CRC校验失败");
+    }
+
+    if (channel_code >= CHANNELS_LEFT_SIDE) {
+        std::vector<int64_t>& first_channel = channel_buffers_[0];
+        std::vector<int64_t>& second_channel = channel_buffers_[1];
+        for (size_t i = 0; i < block_size; ++i) {
+            if (channel_code == CHANNELS_LEFT_SIDE) {
+                second_channel[i] = first_channel[i] - second_channel[i];
+            } else if (channel_code == CHANNELS_SIDE_RIGHT) {
+                first_channel[i] += second_channel[i];
+            } else {
+                const int64_t side = second_channel[i];
+                const int64_t mid = (first_channel[i] * 2) | (side & 1);
+                first_channel[i] = (mid + side) >> 1;
+                second_channel[i] = (mid - side) >> 1;
+            }
+        }
+    }
+
+    // 多声道平均为单声道，按样本位数归一化到[-1, 1)
+    const double scale = 1.0 / (static_cast<double>(uint64_t(1) << (bits_per_sample - 1)) * frame_channels);
+    for (size_t i = 0; i < block_size; ++i) {
+        int64_t sum = 0;
+        for (int c = 0; c < frame_channels; ++c) {
+            sum += channel_buffers_[c][i];
+        }
+        samples_.push_back(static_cast<float>(sum * scale));
+    }
+    return true;
+}
+
+bool FlacDecoder::decodeSubframe(BitReader& reader, int bits_per_sample, size_t block_size,
+                                 std::vector<int64_t>& output) {
+    uint32_t padding = 0;
+    uint32_t type = 0;
+    uint32_t has_wasted_bits = 0;
+    if (!reader.read(1, padding) || !reader.read(6, type) || !reader.read(1, has_wasted_bits)) {
+        return fail("FLAC子帧不完整");
+    }
+    if (padding != 0) {
+        return fail("FLAC子帧头错误");
+    }
+
+    // 每个样本低位都为0时编码器会去掉这些位
+    int wasted_bits = 0;
+    if (has_wasted_bits) {
+        uint64_t zeros = 0;
+        if (!reader.readUnary(zeros) || zeros + 1 >= static_cast<uint64_t>(bits_per_sample)) {
+            return fail("FLAC子帧无效位数错误");
+        }
+        wasted_bits = static_cast<int>(zeros) + 1;
+        bits_per_sample -= wasted_bits;
+    }
+
+    output.assign(block_size, 0);
+    if (type == 0) {
+        // CONSTANT
+        int64_t value = 0;
+        if (!reader.readSigned(bits_per_sample, value)) {
+            return fail("FLAC子帧不完整");
+        }
+        std::fill(output.begin(), output.end(), value);
+    } else if (type == 1) {
+        // VERBATIM
+        for (size_t i = 0; i < block_size; ++i) {
+            if (!reader.readSigned(bits_per_sample, output[i])) {
+                return fail("FLAC子帧不完整");
+            }
+        }
+    } else if (type >= 8 && type <= 8 + MAX_FIXED_ORDER) {
+        // FIXED
+        const int order = static_cast<int>(type) - 8;
+        if (static_cast<size_t>(order) > block_size) {
+            return fail("FLAC预测阶数大于块大小");
+        }
+        for (int i = 0; i < order; ++i) {
+            if (!reader.readSigned(bits_per_sample, output[i])) {
+                return fail("FLAC子帧不完整");
+            }
+        }
+        if (!decodeResidual(reader, block_size, order, output)) {
+            return false;
+        }
+        for (size_t i = order; i < block_size; ++i) {
+            int64_t prediction = 0;
+            switch (order) {
+                case 0: break;
+                case 1: prediction = output[i - 1]; break;
+                case 2: prediction = 2 * output[i - 1] - output[i - 2]; break;
+                case 3: prediction = 3 * output[i - 1] - 3 * output[i - 2] + output[i - 3]; break;
+                default: prediction = 4 * output[i - 1] - 6 * output[i - 2] + 4 * output[i - 3] - output[i - 4]; break;
+            }
+            output[i] += prediction;
+        }
+    } else if (type >= 32) {
+        // LPC
+        const int order = static_cast<int>(type & 31) + 1;
+        if (static_cast<size_t>(order) > block_size) {
+            return fail("FLAC预测阶数大于块大小");
+        }
+        for (int i = 0; i < order; ++i) {
+            if (!reader.readSigned(bits_per_sample, output[i])) {
+                return fail("FLAC子帧不完整");
+            }
+        }
+        uint32_t precision = 0;
+        int64_t shift = 0;
+        if (!reader.read(4, precision) || precision == 15 || !reader.readSigned(5, shift)) {
+            return fail("FLAC LPC参数错误");
+        }
+        if (shift < 0) {
+            return fail("FLAC LPC量化位移为负");
+        }
+        std::vector<int64_t> coefficients(order);
+        for (int i = 0; i < order; ++i) {
+            if (!reader.readSigned(static_cast<int>(precision) + 1, coefficients[i])) {
+                return fail("FLAC子帧不完整");
+            }
+        }
+        if (!decodeResidual(reader, block_size, order, output)) {
+            return false;
+        }
+        for (size_t i = order; i < block_size; ++i) {
+            int64_t prediction = 0;
+            for (int j = 0; j < order; ++j) {
+                prediction += coefficients[j] * output[i - j - 1];
+            }
+            output[i] += prediction >> shift;
+        }
+    } else {
+        return fail("FLAC子帧类型保留: " + std::to_string(type));
+    }
+
+    if (wasted_bits > 0) {
+        for (int64_t& sample : output) {
+            sample *= int64_t(1) << wasted_bits;
+        }
+    }
+    return true;
+}
+
+bool FlacDecoder::decodeResidual(BitReader& reader, size_t block_size, int predictor_order,
+                                 std::vector<int64_t>& output) {
+    uint32_t method = 0;
+    uint32_t partition_order = 0;
+    if (!reader.read(2, method) || !reader.read(4, partition_order)) {
+        return fail("FLAC残差不完整");
+    }
+    if (method > 1) {
+        return fail("FLAC残差编码方式保留");
+    }
+    const int param_bits = method == 0 ? 4 : 5;
+    const uint32_t escape = method == 0 ? 15 : 31;
+
+    const size_t partitions = size_t(1) << partition_order;
+    const size_t partition_size = block_size >> partition_order;
+    if (block_size % partitions != 0 || partition_size < static_cast<size_t>(predictor_order)) {
+        return fail("FLAC残差分区阶数无效");
+    }
+
+    size_t index = predictor_order;
+    for (size_t p = 0; p < partitions; ++p) {
+        const size_t count = partition_size - (p == 0 ? predictor_order : 0);
+        uint32_t param = 0;
+        if (!reader.read(param_bits, param)) {
+            return fail("FLAC残差不完整");
+        }
+
+        if (param == escape) {
+            // 转义分区：残差以固定位数存储
+            uint32_t raw_bits = 0;
+            if (!reader.read(5, raw_bits)) {
+                return fail("FLAC残差不完整");
+            }
+            for (size_t i = 0; i < count; ++i) {
+                if (!reader.readSigned(static_cast<int>(raw_bits), output[index++])) {
+                    return fail("FLAC残差不完整");
+                }
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t quotient = 0;
+            uint64_t remainder = 0;
+            if (!reader.readUnary(quotient) || !reader.read(static_cast<int>(param), remainder)) {
+                return fail("FLAC残差不完整");
+            }
+            const uint64_t folded = (quotient << param) | remainder;
+            output[index++] = static_cast<int64_t>(folded >> 1) ^ -static_cast<int64_t>(folded & 1);
+        }
+    }
+    return true;
+}
+
+std::vector<float> FlacDecoder::takeSamples() {
+    return std::move(samples_);
+}
+
+int FlacDecoder::getSampleRate() const {
+    return sample_rate_;
+}
+
+int FlacDecoder::getChannels() const {
+    return channels_;
+}
+
+const std::string& FlacDecoder::getError() const {
+    return error_;
+}
+
+bool FlacDecoder::fail(const std::string& message) {
+    error_ = message;
+    return false;
+}
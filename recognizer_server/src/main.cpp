@@ -1,5 +1,9 @@
 #include "../include/recognition_service.h"
 #include "../include/file_handler.h"
+#include "../include/pcm_decoder.h"
+#include "../include/flac_decoder.h"
+#include "../include/speech_trimmer.h"
+#include "../include/audio_resampler.h"
 #include <nlohmann/json.hpp>
 #include <iostream>
 #include <string>
@@ -14,21 +18,68 @@
 #include <httplib.h>
 #include <future>
 #include <queue>
+#include <deque>
+#include <algorithm>
 #include <unordered_map>
 #include <condition_variable>
-#include <tuple>
+#include <charconv>
 
 using json = nlohmann::json;
 
+// 任务优先级（数值越大越先处理）
+enum TaskPriority {
+    PRIORITY_BULK = 0,          // 批量文件任务
+    PRIORITY_INTERACTIVE = 10,  // 实时流/交互式音频段
+    PRIORITY_FINAL = 20         // 实时流的最后一段，用户正在等待最终结果
+};
+
+// 优先级老化：任务每排队该时长相当于提升一个优先级档位，低优先级任务不会被持续到达的高优先级任务饿死
+constexpr long long PRIORITY_AGING_MS = 5000;
+constexpr int PRIORITY_LEVEL_STEP = PRIORITY_INTERACTIVE - PRIORITY_BULK;
+
+// 任务状态
+enum TaskState {
+    TASK_QUEUED = 0,      // 排队中（含批量收集窗口）
+    TASK_PROCESSING = 1,  // 识别中
+    TASK_COMPLETED = 2    // 已完成（成功或失败）
+};
+
 // 多路识别任务结构体
 struct AsyncRecognitionTask {
     std::string task_id;
     std::string channel_id;
     std::string audio_path;
+    std::vector<float> pcm_data;    // 内存中的PCM数据（非空时不读取audio_path）
     RecognitionParams params;
     std::promise<RecognitionResult> promise;
+    std::shared_future<RecognitionResult> result_future;  // 结果，可被同步等待和异步查询多次读取
+    std::atomic<int> state{TASK_QUEUED};
     std::chrono::system_clock::time_point submit_time;
+    std::chrono::system_clock::time_point finish_time;
     int priority = 0;
+    uint64_t sequence = 0;          // 入队序号，同优先级按先后顺序处理
+    long long queue_rank_ms = 0;    // 入队时间减去优先级折算的等待时长，越小越先处理
+    std::vector<std::shared_ptr<AsyncRecognitionTask>> batch_members;  // 批量任务的成员（非空时本任务只是载体）
+};
+
+// 共享任务队列的排序规则：按入队时间与优先级折算出的排名，高优先级先处理，
+// 但排队较久的低优先级任务会排到之后到达的高优先级任务前面；排名相同时先到先处理
+struct TaskPriorityCompare {
+    bool operator()(const std::shared_ptr<AsyncRecognitionTask>& a,
+                    const std::shared_ptr<AsyncRecognitionTask>& b) const {
+        if (a->queue_rank_ms != b->queue_rank_ms) {
+            return a->queue_rank_ms > b->queue_rank_ms;
+        }
+        return a->sequence > b->sequence;
+    }
+};
+
+// 跨请求批量识别配置
+struct BatchingOptions {
+    bool enabled = false;
+    int window_ms = 20;           // 从第一个任务到达起的收集窗口
+    int max_batch_size = 8;       // 单批最多任务数
+    int max_segment_ms = 10000;   // 参与批量的单段音频最大时长，更长的直接进入任务队列
 };
 
 // 通道状态枚举
@@ -56,8 +107,11 @@ struct ChannelInfo {
 // 简单的多路识别管理器
 class SimpleMultiChannelManager {
 public:
-    SimpleMultiChannelManager(int channel_count, const std::string& model_path)
-        : channel_count_(channel_count), model_path_(model_path) {}
+    SimpleMultiChannelManager(int channel_count, std::shared_ptr<SharedWhisperModel> shared_model,
+                              const BatchingOptions& batching = BatchingOptions(),
+                              const SpeechTrimOptions& trim_options = SpeechTrimOptions())
+        : channel_count_(channel_count), shared_model_(std::move(shared_model)), batching_(batching),
+          trim_options_(trim_options) {}
     
     ~SimpleMultiChannelManager() {
         shutdown();
@@ -68,11 +122,24 @@ public:
         
         std::cout << "初始化 " << channel_count_ << " 个识别通道..." << std::endl;
         
+        // 所有通道共享同一份模型权重，每个通道只持有自己的whisper_state
+        if (!shared_model_ || !shared_model_->load()) {
+            std::cerr << "共享模型加载失败，无法初始化识别通道" << std::endl;
+            return false;
+        }
+        
         for (int i = 0; i < channel_count_; i++) {
             std::string channel_id = "channel_" + std::to_string(i);
             initializeChannel(channel_id);
         }
         
+        // 启动批量收集线程
+        if (batching_.enabled) {
+            batch_thread_ = std::thread(&SimpleMultiChannelManager::batchCollectorLoop, this);
+            std::cout << "跨请求批量识别已启用，窗口: " << batching_.window_ms << "ms, 单批最多: "
+                      << batching_.max_batch_size << " 个任务" << std::endl;
+        }
+        
         is_initialized_ = true;
         std::cout << "多路识别管理器初始化完成" << std::endl;
         return true;
@@ -81,43 +148,44 @@ public:
     std::string submitTask(const std::string& audio_path, const RecognitionParams& params, int priority = 0) {
         if (is_shutdown_) return "";
         
-        auto task = std::make_shared<AsyncRecognitionTask>();
-        task->task_id = generateTaskId();
+        auto task = createTask(params, priority);
         task->audio_path = audio_path;
-        task->params = params;
-        task->submit_time = std::chrono::system_clock::now();
-        task->priority = priority;
         
-        // 选择最空闲的通道
-        std::string selected_channel = selectBestChannel();
-        if (selected_channel.empty()) {
-            return "";
-        }
+        return enqueueTask(task);
+    }
+    
+    // 提交内存中的PCM数据（16kHz单声道），不经过临时文件
+    std::string submitPcmTask(std::vector<float> pcm_data, const RecognitionParams& params, int priority = 0) {
+        if (is_shutdown_) return "";
         
-        task->channel_id = selected_channel;
+        auto task = createTask(params, priority);
+        task->pcm_data = std::move(pcm_data);
         
-        // 添加任务到全局列表
-        {
-            std::lock_guard<std::mutex> lock(tasks_mutex_);
-            all_tasks_[task->task_id] = task;
-        }
-        
-        // 添加到通道队列
-        {
-            std::lock_guard<std::mutex> lock(channel_queues_mutex_[selected_channel]);
-            channel_task_queues_[selected_channel].push(task);
-            channel_conditions_[selected_channel].notify_one();
+        // 短音频先进入批量收集队列，与同一窗口内到达的其他任务合并识别（最后一段不等待收集窗口）
+        const size_t max_batch_samples = static_cast<size_t>(batching_.max_segment_ms) * SAMPLES_PER_MS;
+        if (batching_.enabled && task->priority < PRIORITY_FINAL && task->pcm_data.size() <= max_batch_samples) {
+            {
+                std::lock_guard<std::mutex> lock(tasks_mutex_);
+                all_tasks_[task->task_id] = task;
+            }
+            {
+                std::lock_guard<std::mutex> lock(batch_mutex_);
+                batch_pending_.push_back(task);
+            }
+            batch_cv_.notify_one();
+            return task->task_id;
         }
         
-        std::cout << "任务 " << task->task_id << " 提交到通道 " << selected_channel << std::endl;
-        return task->task_id;
+        return enqueueTask(task);
     }
     
-    std::future<RecognitionResult> getTaskResult(const std::string& task_id) {
+    // 获取任务结果；任务完成后在保留期内仍可查询
+    std::shared_future<RecognitionResult> getTaskResult(const std::string& task_id) {
         std::lock_guard<std::mutex> lock(tasks_mutex_);
+        pruneFinishedTasksLocked();
         auto it = all_tasks_.find(task_id);
         if (it != all_tasks_.end()) {
-            return it->second->promise.get_future();
+            return it->second->result_future;
         }
         
         std::promise<RecognitionResult> promise;
@@ -125,16 +193,52 @@ public:
         result.success = false;
         result.error_message = "任务不存在: " + task_id;
         promise.set_value(result);
-        return promise.get_future();
+        return promise.get_future().share();
+    }
+    
+    // 查询任务，不存在（或已过保留期）时返回nullptr
+    std::shared_ptr<AsyncRecognitionTask> findTask(const std::string& task_id) {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        pruneFinishedTasksLocked();
+        auto it = all_tasks_.find(task_id);
+        return it != all_tasks_.end() ? it->second : nullptr;
+    }
+    
+    // 同步调用方取得结果后立即释放任务，不必等待保留期
+    // 调用方已经拿到结果，无论状态如何都移除，任务对象由仍持有它的队列/通道继续引用直到结束
+    void releaseTask(const std::string& task_id) {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        all_tasks_.erase(task_id);
+    }
+    
+    // 设置已完成任务结果的保留时间（供异步查询）
+    void setResultRetention(int seconds) {
+        result_retention_seconds_ = seconds;
     }
     
     json getStatus() {
         json status;
         status["total_channels"] = channel_count_;
+        status["active_channels"] = active_channels_.load();
         status["channels"] = json::array();
         
+        // 所有通道共享一个任务队列，排队深度在顶层报告
+        {
+            std::lock_guard<std::mutex> queue_lock(pending_mutex_);
+            status["pending_tasks"] = pending_tasks_.size();
+        }
+        {
+            std::lock_guard<std::mutex> batch_lock(batch_mutex_);
+            status["batch_pending_tasks"] = batch_pending_.size();
+        }
+        
+        // active_channels是正常工作的通道数，负载看正在识别的busy_channels加上排队的任务
+        int busy_channels = 0;
         std::lock_guard<std::mutex> lock(channels_mutex_);
         for (const auto& [channel_id, channel] : channels_) {
+            if (channel->status == ChannelStatus::BUSY) {
+                ++busy_channels;
+            }
             json channel_status;
             channel_status["channel_id"] = channel_id;
             channel_status["status"] = static_cast<int>(channel->status);
@@ -142,15 +246,9 @@ public:
             channel_status["processed_tasks"] = channel->processed_tasks;
             channel_status["error_count"] = channel->error_count;
             
-            int pending_tasks = 0;
-            {
-                std::lock_guard<std::mutex> queue_lock(channel_queues_mutex_[channel_id]);
-                pending_tasks = channel_task_queues_[channel_id].size();
-            }
-            channel_status["pending_tasks"] = pending_tasks;
-            
             status["channels"].push_back(channel_status);
         }
+        status["busy_channels"] = busy_channels;
         
         return status;
     }
@@ -171,8 +269,34 @@ public:
         }
         
         // 通知所有工作线程
-        for (auto& [channel_id, condition] : channel_conditions_) {
-            condition.notify_all();
+        pending_cv_.notify_all();
+        
+        // 停止批量收集线程，尚未分发的任务直接返回错误
+        batch_cv_.notify_all();
+        if (batch_thread_.joinable()) {
+            batch_thread_.join();
+        }
+        {
+            std::lock_guard<std::mutex> lock(batch_mutex_);
+            for (auto& task : batch_pending_) {
+                failTask(task, "服务正在关闭");
+            }
+            batch_pending_.clear();
+        }
+        
+        // 队列中尚未处理的任务同样返回错误，避免等待方永久阻塞
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            while (!pending_tasks_.empty()) {
+                auto task = pending_tasks_.top();
+                pending_tasks_.pop();
+                for (auto& member : task->batch_members) {
+                    failTask(member, "服务正在关闭");
+                }
+                if (task->batch_members.empty()) {
+                    failTask(task, "服务正在关闭");
+                }
+            }
         }
         
         // 等待所有线程结束
@@ -189,8 +313,10 @@ public:
     }
 
 private:
+    static constexpr size_t SAMPLES_PER_MS = StreamingPcmDecoder::TARGET_SAMPLE_RATE / 1000;
+    
     int channel_count_;
-    std::string model_path_;
+    std::shared_ptr<SharedWhisperModel> shared_model_;
     bool is_initialized_ = false;
     std::atomic<bool> is_shutdown_{false};
     std::atomic<long long> task_id_counter_{0};
@@ -198,12 +324,27 @@ private:
     std::unordered_map<std::string, std::unique_ptr<ChannelInfo>> channels_;
     std::mutex channels_mutex_;
     
-    std::unordered_map<std::string, std::queue<std::shared_ptr<AsyncRecognitionTask>>> channel_task_queues_;
-    std::unordered_map<std::string, std::mutex> channel_queues_mutex_;
-    std::unordered_map<std::string, std::condition_variable> channel_conditions_;
+    // 所有通道共享的优先级任务队列：空闲通道主动拉取任务，长任务不会阻塞其他通道的排队任务
+    std::priority_queue<std::shared_ptr<AsyncRecognitionTask>,
+                        std::vector<std::shared_ptr<AsyncRecognitionTask>>,
+                        TaskPriorityCompare> pending_tasks_;
+    std::mutex pending_mutex_;
+    std::condition_variable pending_cv_;
+    std::atomic<uint64_t> task_sequence_{0};
+    std::atomic<int> active_channels_{0};   // 正常工作的通道数
     
     std::unordered_map<std::string, std::shared_ptr<AsyncRecognitionTask>> all_tasks_;
     std::mutex tasks_mutex_;
+    std::atomic<int> result_retention_seconds_{300};  // 已完成任务的保留时间
+    std::chrono::steady_clock::time_point last_prune_time_;  // 上次清理已完成任务的时间（受tasks_mutex_保护）
+    
+    // 跨请求批量识别
+    BatchingOptions batching_;
+    SpeechTrimOptions trim_options_;
+    std::deque<std::shared_ptr<AsyncRecognitionTask>> batch_pending_;
+    std::mutex batch_mutex_;
+    std::condition_variable batch_cv_;
+    std::thread batch_thread_;
     
     std::string generateTaskId() {
         auto now = std::chrono::system_clock::now();
@@ -212,57 +353,190 @@ private:
         return "task_" + std::to_string(timestamp) + "_" + std::to_string(counter);
     }
     
+    // 创建新任务（结果future在创建时取出，之后可被多次读取）
+    std::shared_ptr<AsyncRecognitionTask> createTask(const RecognitionParams& params, int priority) {
+        pruneFinishedTasks();
+        
+        auto task = std::make_shared<AsyncRecognitionTask>();
+        task->task_id = generateTaskId();
+        task->params = params;
+        task->submit_time = std::chrono::system_clock::now();
+        task->priority = priority;
+        task->result_future = task->promise.get_future().share();
+        return task;
+    }
+    
+    // 设置任务结果并标记完成，任务保留在全局列表中供异步查询
+    // 先在锁内标记完成再发布结果，等待方拿到结果时任务一定已是完成状态
+    void completeTask(const std::shared_ptr<AsyncRecognitionTask>& task, const RecognitionResult& result) {
+        {
+            std::lock_guard<std::mutex> lock(tasks_mutex_);
+            task->finish_time = std::chrono::system_clock::now();
+            task->state = TASK_COMPLETED;
+        }
+        task->promise.set_value(result);
+    }
+    
+    // 清理超过保留期的已完成任务
+    void pruneFinishedTasks() {
+        std::lock_guard<std::mutex> lock(tasks_mutex_);
+        pruneFinishedTasksLocked();
+    }
+    
+    // 同上，调用方需持有tasks_mutex_；提交和查询时都会调用，间隔不足1秒时跳过
+    void pruneFinishedTasksLocked() {
+        auto steady_now = std::chrono::steady_clock::now();
+        if (steady_now - last_prune_time_ < std::chrono::seconds(1)) {
+            return;
+        }
+        last_prune_time_ = steady_now;
+        
+        auto now = std::chrono::system_clock::now();
+        auto retention = std::chrono::seconds(result_retention_seconds_.load());
+        for (auto it = all_tasks_.begin(); it != all_tasks_.end();) {
+            if (it->second->state == TASK_COMPLETED && now - it->second->finish_time > retention) {
+                it = all_tasks_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    
+    // 将任务加入共享队列，返回任务ID（失败返回空字符串）
+    std::string enqueueTask(std::shared_ptr<AsyncRecognitionTask> task) {
+        if (active_channels_ == 0) {
+            std::cerr << "没有可用的识别通道" << std::endl;
+            return "";
+        }
+        
+        // 添加任务到全局列表
+        {
+            std::lock_guard<std::mutex> lock(tasks_mutex_);
+            all_tasks_[task->task_id] = task;
+        }
+        
+        pushTask(task);
+        return task->task_id;
+    }
+    
+    // 将任务放入共享优先级队列，由空闲通道拉取
+    void pushTask(std::shared_ptr<AsyncRecognitionTask> task) {
+        task->sequence = task_sequence_.fetch_add(1);
+        const long long now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        task->queue_rank_ms = now_ms - static_cast<long long>(task->priority) * PRIORITY_AGING_MS / PRIORITY_LEVEL_STEP;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            pending_tasks_.push(task);
+        }
+        pending_cv_.notify_one();
+        
+        std::cout << "任务 " << task->task_id << " 进入任务队列，优先级: " << task->priority << std::endl;
+    }
+    
+    // 以错误结果结束任务
+    void failTask(const std::shared_ptr<AsyncRecognitionTask>& task, const std::string& message) {
+        RecognitionResult result;
+        result.success = false;
+        result.error_message = message;
+        completeTask(task, result);
+    }
+    
+    // 解码参数一致的任务才能合并到同一次识别
+    static bool isBatchCompatible(const RecognitionParams& a, const RecognitionParams& b) {
+        return a.language == b.language && a.use_gpu == b.use_gpu &&
+               a.beam_size == b.beam_size && a.temperature == b.temperature;
+    }
+    
+    // 批量收集线程：从第一个任务到达起等待一个收集窗口，把兼容的短任务打包到同一个编码窗口
+    void batchCollectorLoop() {
+        const size_t window_samples = static_cast<size_t>(RecognitionService::BATCH_WINDOW_MS) * SAMPLES_PER_MS;
+        const size_t gap_samples = static_cast<size_t>(RecognitionService::BATCH_GAP_MS) * SAMPLES_PER_MS;
+        
+        while (!is_shutdown_) {
+            std::vector<std::shared_ptr<AsyncRecognitionTask>> members;
+            {
+                std::unique_lock<std::mutex> lock(batch_mutex_);
+                batch_cv_.wait(lock, [&]() { return !batch_pending_.empty() || is_shutdown_; });
+                if (is_shutdown_) break;
+                
+                // 收集窗口：凑满一批或窗口到期即分发
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(batching_.window_ms);
+                batch_cv_.wait_until(lock, deadline, [&]() {
+                    return batch_pending_.size() >= static_cast<size_t>(batching_.max_batch_size) || is_shutdown_;
+                });
+                if (is_shutdown_) break;
+                
+                // 以最早的任务为首，按到达顺序挑选参数兼容且能放进同一编码窗口的任务
+                const RecognitionParams leader_params = batch_pending_.front()->params;
+                size_t used_samples = 0;
+                for (auto it = batch_pending_.begin(); it != batch_pending_.end() &&
+                     members.size() < static_cast<size_t>(batching_.max_batch_size);) {
+                    size_t needed = (*it)->pcm_data.size() + (members.empty() ? 0 : gap_samples);
+                    if (isBatchCompatible(leader_params, (*it)->params) &&
+                        (members.empty() || used_samples + needed <= window_samples)) {
+                        used_samples += needed;
+                        members.push_back(*it);
+                        it = batch_pending_.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+            
+            if (active_channels_ == 0) {
+                for (auto& task : members) {
+                    failTask(task, "无可用的识别通道");
+                }
+                continue;
+            }
+            
+            if (members.size() == 1) {
+                pushTask(members.front());
+                continue;
+            }
+            
+            // 载体任务只用于在队列中传递整批成员，不进入全局任务列表，优先级取成员中的最高者
+            auto carrier = std::make_shared<AsyncRecognitionTask>();
+            carrier->task_id = generateTaskId() + "_batch";
+            carrier->submit_time = std::chrono::system_clock::now();
+            for (const auto& task : members) {
+                carrier->priority = std::max(carrier->priority, task->priority);
+            }
+            carrier->batch_members = std::move(members);
+            pushTask(carrier);
+        }
+    }
+    
     void initializeChannel(const std::string& channel_id) {
         auto channel = std::make_unique<ChannelInfo>();
         channel->channel_id = channel_id;
         channel->status = ChannelStatus::IDLE;
         channel->last_activity = std::chrono::system_clock::now();
-        channel->recognition_service = std::make_shared<RecognitionService>(model_path_);
+        channel->recognition_service = std::make_shared<RecognitionService>(shared_model_);
+        channel->recognition_service->setTrimOptions(trim_options_);
         
         if (!channel->recognition_service->initialize()) {
             std::cerr << "通道 " << channel_id << " 初始化失败" << std::endl;
             channel->status = ChannelStatus::ERROR;
         }
         
-        // 初始化队列和同步原语
-        channel_task_queues_[channel_id] = std::queue<std::shared_ptr<AsyncRecognitionTask>>();
-        channel_queues_mutex_.emplace(std::piecewise_construct,
-                                     std::forward_as_tuple(channel_id),
-                                     std::forward_as_tuple());
-        channel_conditions_.emplace(std::piecewise_construct,
-                                    std::forward_as_tuple(channel_id),
-                                    std::forward_as_tuple());
-        
-        // 启动工作线程
-        channel->worker_thread = std::thread(&SimpleMultiChannelManager::channelWorkerLoop, this, channel_id);
-        
+        ChannelInfo* channel_info = channel.get();
         {
             std::lock_guard<std::mutex> lock(channels_mutex_);
             channels_[channel_id] = std::move(channel);
         }
         
-        std::cout << "通道 " << channel_id << " 初始化完成" << std::endl;
-    }
-    
-    std::string selectBestChannel() {
-        std::lock_guard<std::mutex> lock(channels_mutex_);
-        
-        std::string best_channel;
-        int min_pending_tasks = INT_MAX;
-        
-        for (const auto& [channel_id, channel] : channels_) {
-            if (channel->status == ChannelStatus::IDLE || channel->status == ChannelStatus::BUSY) {
-                std::lock_guard<std::mutex> queue_lock(channel_queues_mutex_[channel_id]);
-                int pending_tasks = channel_task_queues_[channel_id].size();
-                
-                if (pending_tasks < min_pending_tasks) {
-                    min_pending_tasks = pending_tasks;
-                    best_channel = channel_id;
-                }
-            }
+        // 初始化失败的通道不启动工作线程，也不会从队列拉取任务
+        if (channel_info->status == ChannelStatus::ERROR) {
+            return;
         }
         
-        return best_channel;
+        // 启动工作线程（通道已登记，工作线程可以找到自己的通道信息）
+        active_channels_++;
+        channel_info->worker_thread = std::thread(&SimpleMultiChannelManager::channelWorkerLoop, this, channel_id);
+        
+        std::cout << "通道 " << channel_id << " 初始化完成" << std::endl;
     }
     
     void channelWorkerLoop(const std::string& channel_id) {
@@ -282,23 +556,26 @@ private:
         while (!channel_info->should_stop && !is_shutdown_) {
             std::shared_ptr<AsyncRecognitionTask> task;
             
-            // 等待任务
+            // 从共享队列拉取优先级最高的任务
             {
-                std::unique_lock<std::mutex> lock(channel_queues_mutex_[channel_id]);
-                channel_conditions_[channel_id].wait(lock, [&]() {
-                    return !channel_task_queues_[channel_id].empty() || 
-                           channel_info->should_stop || is_shutdown_;
+                std::unique_lock<std::mutex> lock(pending_mutex_);
+                pending_cv_.wait(lock, [&]() {
+                    return !pending_tasks_.empty() || channel_info->should_stop || is_shutdown_;
                 });
                 
                 if (channel_info->should_stop || is_shutdown_) break;
                 
-                if (!channel_task_queues_[channel_id].empty()) {
-                    task = channel_task_queues_[channel_id].front();
-                    channel_task_queues_[channel_id].pop();
+                if (!pending_tasks_.empty()) {
+                    task = pending_tasks_.top();
+                    pending_tasks_.pop();
                 }
             }
             
             if (task) {
+                task->channel_id = channel_id;
+                for (auto& member : task->batch_members) {
+                    member->channel_id = channel_id;
+                }
                 processTask(channel_info, task);
             }
         }
@@ -307,16 +584,25 @@ private:
     }
     
     void processTask(ChannelInfo* channel_info, std::shared_ptr<AsyncRecognitionTask> task) {
+        if (!task->batch_members.empty()) {
+            processBatchTask(channel_info, task);
+            return;
+        }
+        
         channel_info->status = ChannelStatus::BUSY;
         channel_info->current_task_id = task->task_id;
         channel_info->last_activity = std::chrono::system_clock::now();
+        task->state = TASK_PROCESSING;
         
         std::cout << "通道 " << channel_info->channel_id << " 开始处理任务 " << task->task_id << std::endl;
         
         auto start_time = std::chrono::high_resolution_clock::now();
         
         try {
-            RecognitionResult result = channel_info->recognition_service->recognize(task->audio_path, task->params);
+            // 内存PCM任务直接识别，文件任务从磁盘读取
+            RecognitionResult result = task->pcm_data.empty()
+                ? channel_info->recognition_service->recognize(task->audio_path, task->params)
+                : channel_info->recognition_service->recognizeSamples(task->pcm_data, task->params);
             
             auto end_time = std::chrono::high_resolution_clock::now();
             auto processing_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
@@ -341,7 +627,7 @@ private:
                 std::cerr << "删除临时文件失败: " << e.what() << std::endl;
             }
             
-            task->promise.set_value(result);
+            completeTask(task, result);
             
             std::cout << "通道 " << channel_info->channel_id << " 完成任务 " << task->task_id 
                       << "，耗时: " << processing_time << "ms" << std::endl;
@@ -363,17 +649,72 @@ private:
                 std::cerr << "删除临时文件失败: " << cleanup_e.what() << std::endl;
             }
             
-            task->promise.set_value(result);
+            completeTask(task, result);
             
             std::cerr << "通道 " << channel_info->channel_id << " 处理任务出错: " << e.what() << std::endl;
         }
         
-        // 从全局任务列表中移除
-        {
-            std::lock_guard<std::mutex> lock(tasks_mutex_);
-            all_tasks_.erase(task->task_id);
+        // 释放PCM数据（任务本身保留到结果被取走或超过保留期）
+        std::vector<float>().swap(task->pcm_data);
+        
+        channel_info->status = ChannelStatus::IDLE;
+        channel_info->current_task_id.clear();
+    }
+    
+    // 处理批量任务：一次识别，各成员的promise分别返回自己的结果
+    void processBatchTask(ChannelInfo* channel_info, std::shared_ptr<AsyncRecognitionTask> carrier) {
+        channel_info->status = ChannelStatus::BUSY;
+        channel_info->current_task_id = carrier->task_id;
+        channel_info->last_activity = std::chrono::system_clock::now();
+        
+        const auto& members = carrier->batch_members;
+        std::cout << "通道 " << channel_info->channel_id << " 开始批量处理 " << members.size() << " 个任务" << std::endl;
+        
+        auto start_time = std::chrono::high_resolution_clock::now();
+        
+        std::vector<const std::vector<float>*> inputs;
+        std::vector<RecognitionParams> params_list;
+        for (const auto& task : members) {
+            task->state = TASK_PROCESSING;
+            inputs.push_back(&task->pcm_data);
+            params_list.push_back(task->params);
+        }
+        
+        std::vector<RecognitionResult> results;
+        try {
+            results = channel_info->recognition_service->recognizeBatch(inputs, params_list);
+        } catch (const std::exception& e) {
+            std::cerr << "通道 " << channel_info->channel_id << " 批量处理出错: " << e.what() << std::endl;
+            results.assign(members.size(), RecognitionResult());
+            for (auto& result : results) {
+                result.success = false;
+                result.error_message = "处理任务时出错: " + std::string(e.what());
+            }
         }
         
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto processing_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        
+        for (size_t i = 0; i < members.size(); ++i) {
+            const auto& task = members[i];
+            RecognitionResult& result = results[i];
+            
+            // 同一批的任务共享一次识别的耗时
+            result.processing_time_ms = processing_time;
+            
+            channel_info->processed_tasks++;
+            if (!result.success) {
+                channel_info->error_count++;
+            }
+            
+            std::vector<float>().swap(task->pcm_data);
+            completeTask(task, result);
+        }
+        channel_info->total_processing_time_ms += processing_time;
+        
+        std::cout << "通道 " << channel_info->channel_id << " 完成批量任务 " << carrier->task_id
+                  << "，" << members.size() << " 个任务共耗时: " << processing_time << "ms" << std::endl;
+        
         channel_info->status = ChannelStatus::IDLE;
         channel_info->current_task_id.clear();
     }
@@ -396,6 +737,8 @@ struct ServerConfig {
     int port;
     int min_file_size_bytes;
     json default_recognition_params;
+    json multi_channel;
+    json vad_trim;
     json cors;
     std::string log_level;
     std::string log_file;
@@ -459,6 +802,8 @@ ServerConfig loadConfig(const std::string& config_path = "../config.json") {
             // 加载识别配置
             config.model_path = config_json["recognition"]["model_path"];
             config.default_recognition_params = config_json["recognition"]["default_params"];
+            config.multi_channel = config_json["recognition"].value("multi_channel", json::object());
+            config.vad_trim = config_json["recognition"].value("vad_trim", json::object());
             
             // 加载存储配置
             config.storage_dir = config_json["storage"]["dir"];
@@ -492,6 +837,11 @@ ServerConfig loadConfig(const std::string& config_path = "../config.json") {
         {"temperature", 0.0}
     };
     
+    // 默认多路识别设置
+    config.multi_channel = {
+        {"channel_count", 10}
+    };
+    
     // 默认CORS设置
     config.cors = {
         {"allow_origin", "*"},
@@ -506,18 +856,45 @@ ServerConfig loadConfig(const std::string& config_path = "../config.json") {
     return config;
 }
 
+// 解析静音裁剪配置（缺省字段使用默认值）
+SpeechTrimOptions parseTrimOptions(const json& trim_config) {
+    SpeechTrimOptions options;
+    options.enabled = trim_config.value("enabled", options.enabled);
+    options.mode = trim_config.value("mode", options.mode);
+    options.fvad_mode = trim_config.value("fvad_mode", options.fvad_mode);
+    options.energy_threshold_db = trim_config.value("energy_threshold_db", options.energy_threshold_db);
+    options.frame_ms = trim_config.value("frame_ms", options.frame_ms);
+    options.guard_ms = trim_config.value("guard_ms", options.guard_ms);
+    options.min_silence_ms = trim_config.value("min_silence_ms", options.min_silence_ms);
+    options.min_speech_ms = trim_config.value("min_speech_ms", options.min_speech_ms);
+    return options;
+}
+
 // 使用httplib实现真正的HTTP服务器
 class HttpServer {
 public:
     HttpServer(const std::string& host, int port, 
                std::shared_ptr<RecognitionService> recognition_service,
                std::shared_ptr<FileHandler> file_handler,
-               const std::string& model_path) 
+               std::shared_ptr<SharedWhisperModel> shared_model,
+               const json& multi_channel_config = json::object(),
+               const SpeechTrimOptions& trim_options = SpeechTrimOptions()) 
         : host_(host), port_(port), 
           recognition_service_(recognition_service), 
           file_handler_(file_handler) {
-        // 初始化多路识别管理器（10路）
-        multi_channel_manager_ = std::make_unique<SimpleMultiChannelManager>(10, model_path);
+        // 批量识别配置
+        BatchingOptions batching;
+        json batching_config = multi_channel_config.value("batching", json::object());
+        batching.enabled = batching_config.value("enabled", batching.enabled);
+        batching.window_ms = batching_config.value("window_ms", batching.window_ms);
+        batching.max_batch_size = batching_config.value("max_batch_size", batching.max_batch_size);
+        batching.max_segment_ms = batching_config.value("max_segment_ms", batching.max_segment_ms);
+        
+        // 初始化多路识别管理器（默认10路，共享同一份模型权重）
+        int channel_count = multi_channel_config.value("channel_count", 10);
+        multi_channel_manager_ = std::make_unique<SimpleMultiChannelManager>(channel_count, shared_model, batching,
+                                                                             trim_options);
+        multi_channel_manager_->setResultRetention(multi_channel_config.value("result_retention_seconds", 300));
         multi_channel_manager_->initialize();
     }
     
@@ -550,6 +927,7 @@ public:
                 {"uptime", getUptime()},
                 {"model", recognition_service_->getModelPath()},
                 {"initialized", recognition_service_->initialize()},
+                {"upload_formats", {"wav", "flac"}},
                 {"multi_channel_status", multi_channel_manager_->getStatus()}
             };
             res.set_content(response.dump(), "application/json");
@@ -623,35 +1001,68 @@ public:
                     }
                     std::cout << "文件扩展名: " << file_extension << std::endl;
                     
-                    // 生成临时文件名并保存
-                    std::string unique_filename = file_handler_->generateUniqueFileName("tmp", file_extension);
-                    std::string file_path = file_handler_->getStorageDir() + "/" + unique_filename;
-                    std::cout << "临时文件路径: " << file_path << std::endl;
+                    // FLAC压缩上传在内存中解码为PCM，不写临时文件
+                    const bool is_flac = file_extension == ".flac" ||
+                                         FlacDecoder::isFlac(file.content.data(), file.content.size());
+                    std::vector<float> flac_pcm;
+                    std::string file_path;
+                    if (is_flac) {
+                        FlacDecoder flac_decoder;
+                        if (!flac_decoder.decode(file.content.data(), file.content.size())) {
+                            std::cout << "FLAC解码失败: " << flac_decoder.getError() << std::endl;
+                            json error = {{"success", false}, {"error", "无效的FLAC数据: " + flac_decoder.getError()}};
+                            res.status = 400;
+                            res.set_content(error.dump(), "application/json");
+                            return;
+                        }
+                        if (!StreamingPcmDecoder::isValidFormat(flac_decoder.getSampleRate(), flac_decoder.getChannels())) {
+                            json error = {{"success", false}, {"error", "FLAC采样率或声道数超出支持范围: " +
+                                          std::to_string(flac_decoder.getSampleRate()) + "Hz, " +
+                                          std::to_string(flac_decoder.getChannels()) + " 声道"}};
+                            res.status = 400;
+                            res.set_content(error.dump(), "application/json");
+                            return;
+                        }
+                        flac_pcm = flac_decoder.takeSamples();
+                        if (flac_decoder.getSampleRate() != StreamingPcmDecoder::TARGET_SAMPLE_RATE) {
+                            std::cout << "FLAC重采样: " << flac_decoder.getSampleRate() << "Hz -> "
+                                      << StreamingPcmDecoder::TARGET_SAMPLE_RATE << "Hz" << std::endl;
+                            flac_pcm = AudioResampler::resample(flac_pcm, flac_decoder.getSampleRate(),
+                                                                StreamingPcmDecoder::TARGET_SAMPLE_RATE);
+                        }
+                        std::cout << "FLAC解码完成: " << flac_pcm.size() << " 个样本" << std::endl;
+                    } else {
+                        // 生成临时文件名并保存
+                        std::string unique_filename = file_handler_->generateUniqueFileName("tmp", file_extension);
+                        file_path = file_handler_->getStorageDir() + "/" + unique_filename;
+                        std::cout << "临时文件路径: " << file_path << std::endl;
                     
-                    // 保存上传的文件
-                    if (!file_handler_->saveAudioFile(file_path, file.content)) {
-                        std::cout << "保存文件失败: " << file_path << std::endl;
-                        json error = {{"success", false}, {"error", "保存文件失败"}};
-                        res.status = 500;
-                        res.set_content(error.dump(), "application/json");
-                        return;
-                    }
-                    std::cout << "文件已保存: " << file_path << std::endl;
+                        // 保存上传的文件
+                        if (!file_handler_->saveAudioFile(file_path, file.content)) {
+                            std::cout << "保存文件失败: " << file_path << std::endl;
+                            json error = {{"success", false}, {"error", "保存文件失败"}};
+                            res.status = 500;
+                            res.set_content(error.dump(), "application/json");
+                            return;
+                        }
+                        std::cout << "文件已保存: " << file_path << std::endl;
                     
-                    // 验证音频文件
-                    if (!file_handler_->validateAudioFile(file_path)) {
-                        std::cout << "无效的音频文件格式: " << file_path << std::endl;
-                        json error = {{"success", false}, {"error", "无效的音频文件格式"}};
-                        res.status = 400;
-                        res.set_content(error.dump(), "application/json");
-                        // 删除无效文件
-                        std::filesystem::remove(file_path);
-                        return;
+                        // 验证音频文件
+                        if (!file_handler_->validateAudioFile(file_path)) {
+                            std::cout << "无效的音频文件格式: " << file_path << std::endl;
+                            json error = {{"success", false}, {"error", "无效的音频文件格式"}};
+                            res.status = 400;
+                            res.set_content(error.dump(), "application/json");
+                            // 删除无效文件
+                            std::filesystem::remove(file_path);
+                            return;
+                        }
+                        std::cout << "音频文件验证通过: " << file_path << std::endl;
                     }
-                    std::cout << "音频文件验证通过: " << file_path << std::endl;
                     
-                    // 设置识别参数
+                    // 设置识别参数（上传的音频段默认按交互式任务调度）
                     RecognitionParams params;
+                    int priority = PRIORITY_INTERACTIVE;
                     
                     // 打印请求中的所有字段名
                     std::cout << "请求包含以下字段:" << std::endl;
@@ -665,40 +1076,14 @@ public:
                             const auto& paramsFile = req.get_file_value("params");
                             std::cout << "params内容: " << paramsFile.content << std::endl;
                             json paramsJson = json::parse(paramsFile.content);
-                            
-                            if (paramsJson.contains("language")) {
-                                params.language = paramsJson["language"].get<std::string>();
-                                std::cout << "设置语言: " << params.language << std::endl;
-                            }
-                            if (paramsJson.contains("use_gpu")) {
-                                params.use_gpu = paramsJson["use_gpu"].get<bool>();
-                                std::cout << "设置GPU使用: " << (params.use_gpu ? "是" : "否") << std::endl;
-                            }
-                            if (paramsJson.contains("beam_size")) {
-                                params.beam_size = paramsJson["beam_size"].get<int>();
-                                std::cout << "设置beam_size: " << params.beam_size << std::endl;
-                            }
-                            if (paramsJson.contains("temperature")) {
-                                params.temperature = paramsJson["temperature"].get<float>();
-                                std::cout << "设置temperature: " << params.temperature << std::endl;
-                            }
-                            // 文本矫正参数
-                            if (paramsJson.contains("enable_correction")) {
-                                params.enable_correction = paramsJson["enable_correction"].get<bool>();
-                                std::cout << "设置文本矫正: " << (params.enable_correction ? "启用" : "禁用") << std::endl;
-                            }
-                            if (paramsJson.contains("correction_server")) {
-                                params.correction_server = paramsJson["correction_server"].get<std::string>();
-                                std::cout << "设置矫正服务器: " << params.correction_server << std::endl;
-                            }
-                            if (paramsJson.contains("correction_temperature")) {
-                                params.correction_temperature = paramsJson["correction_temperature"].get<float>();
-                                std::cout << "设置矫正温度: " << params.correction_temperature << std::endl;
-                            }
-                            if (paramsJson.contains("correction_max_tokens")) {
-                                params.correction_max_tokens = paramsJson["correction_max_tokens"].get<int>();
-                                std::cout << "设置矫正最大tokens: " << params.correction_max_tokens << std::endl;
-                            }
+                            params = parseRecognitionParams(paramsJson);
+                            std::cout << "识别参数: 语言=" << params.language
+                                      << ", GPU=" << (params.use_gpu ? "是" : "否")
+                                      << ", beam_size=" << params.beam_size
+                                      << ", 文本矫正=" << (params.enable_correction ? "启用" : "禁用")
+                                      << ", 静音裁剪=" << (params.trim_silence < 0 ? "跟随配置" : params.trim_silence ? "开启" : "关闭")
+                                      << std::endl;
+                            priority = resolvePriority(paramsJson, priority);
                         } catch(const std::exception& e) {
                             // 如果解析失败，使用默认参数
                             std::cerr << "解析params参数失败: " << e.what() << std::endl;
@@ -710,13 +1095,22 @@ public:
                     std::cout << "开始执行识别..." << std::endl;
                     // 使用多路识别管理器执行识别（自动负载均衡）
                     std::cout << "通过多路识别管理器处理任务..." << std::endl;
-                    std::string task_id = multi_channel_manager_->submitTask(file_path, params, 0);
+                    std::string task_id = is_flac
+                        ? multi_channel_manager_->submitPcmTask(std::move(flac_pcm), params, priority)
+                        : multi_channel_manager_->submitTask(file_path, params, priority);
+                    
+                    // 异步模式：立即返回任务ID，临时文件由处理任务的通道删除
+                    if (!task_id.empty() && isAsyncRequest(req)) {
+                        sendTaskAccepted(res, task_id);
+                        return;
+                    }
                     
                     RecognitionResult result;
                     if (!task_id.empty()) {
                         // 等待识别完成
                         auto future = multi_channel_manager_->getTaskResult(task_id);
                         result = future.get(); // 阻塞等待结果
+                        multi_channel_manager_->releaseTask(task_id);
                         std::cout << "多路识别完成，结果: " << (result.success ? "成功" : "失败") << std::endl;
                     } else {
                         result.success = false;
@@ -730,34 +1124,14 @@ public:
                     }
                     
                     // 识别完成后，删除临时文件
-                    std::filesystem::remove(file_path);
-                    std::cout << "临时文件已删除: " << file_path << std::endl;
-                    
-                    // 返回结果
-                    json response = {
-                        {"success", result.success},
-                        {"text", result.text},
-                        {"original_text", result.original_text},
-                        {"confidence", result.confidence},
-                        {"language", params.language},
-                        {"processing_time_ms", result.processing_time_ms}
-                    };
-                    
-                    // 添加文本矫正相关信息
-                    if (params.enable_correction) {
-                        response["correction"] = {
-                            {"was_corrected", result.was_corrected},
-                            {"correction_confidence", result.correction_confidence},
-                            {"correction_time_ms", result.correction_time_ms}
-                        };
-                        
-                        if (!result.correction_error.empty()) {
-                            response["correction"]["error"] = result.correction_error;
-                        }
+                    if (!is_flac) {
+                        std::filesystem::remove(file_path);
+                        std::cout << "临时文件已删除: " << file_path << std::endl;
                     }
                     
+                    // 返回结果
+                    json response = buildRecognitionResponse(result, params);
                     if (!result.success) {
-                        response["error"] = result.error_message;
                         res.status = 500;
                     }
                     
@@ -787,30 +1161,30 @@ public:
                     file_path = request_data["file_path"].get<std::string>();
                 }
                 
-                // 设置识别参数
-                RecognitionParams params;
-                params.language = request_data.value("language", "auto");
-                params.use_gpu = request_data.value("use_gpu", true);
-                params.beam_size = request_data.value("beam_size", 5);
-                params.temperature = request_data.value("temperature", 0.0f);
-                
-                // 文本矫正参数
-                params.enable_correction = request_data.value("enable_correction", false);
-                params.correction_server = request_data.value("correction_server", "http://localhost:8000");
-                params.correction_temperature = request_data.value("correction_temperature", 0.3f);
-                params.correction_max_tokens = request_data.value("correction_max_tokens", 512);
+                // 设置识别参数（与multipart上传和/recognize_pcm相同的字段）
+                RecognitionParams params = parseRecognitionParams(request_data);
                 
                 std::cout << "使用JSON参数执行识别，文件: " << file_path << std::endl;
                 
+                // 按服务器上已有文件识别属于批量任务，排在实时音频段之后
+                int priority = resolvePriority(request_data, PRIORITY_BULK);
+                
                 // 使用多路识别管理器执行识别（自动负载均衡）
                 std::cout << "通过多路识别管理器处理任务..." << std::endl;
-                std::string task_id = multi_channel_manager_->submitTask(file_path, params, 0);
+                std::string task_id = multi_channel_manager_->submitTask(file_path, params, priority);
+                
+                // 异步模式：立即返回任务ID（请求体中async=true或查询参数async=1）
+                if (!task_id.empty() && (isAsyncRequest(req) || request_data.value("async", false))) {
+                    sendTaskAccepted(res, task_id);
+                    return;
+                }
                 
                 RecognitionResult result;
                 if (!task_id.empty()) {
                     // 等待识别完成
                     auto future = multi_channel_manager_->getTaskResult(task_id);
                     result = future.get(); // 阻塞等待结果
+                    multi_channel_manager_->releaseTask(task_id);
                     std::cout << "多路识别完成，结果: " << (result.success ? "成功" : "失败") << std::endl;
                 } else {
                     result.success = false;
@@ -819,30 +1193,8 @@ public:
                 }
                 
                 // 返回结果
-                json response = {
-                    {"success", result.success},
-                    {"text", result.text},
-                    {"original_text", result.original_text},
-                    {"confidence", result.confidence},
-                    {"language", params.language},
-                    {"processing_time_ms", result.processing_time_ms}
-                };
-                
-                // 添加文本矫正相关信息
-                if (params.enable_correction) {
-                    response["correction"] = {
-                        {"was_corrected", result.was_corrected},
-                        {"correction_confidence", result.correction_confidence},
-                        {"correction_time_ms", result.correction_time_ms}
-                    };
-                    
-                    if (!result.correction_error.empty()) {
-                        response["correction"]["error"] = result.correction_error;
-                    }
-                }
-                
+                json response = buildRecognitionResponse(result, params);
                 if (!result.success) {
-                    response["error"] = result.error_message;
                     res.status = 500;
                 }
                 
@@ -865,6 +1217,188 @@ public:
             }
         });
         
+        // 实现流式PCM识别接口：请求体直接解码为float样本，不写入磁盘
+        // 支持分块传输（Transfer-Encoding: chunked），上传过程中即开始解码
+        // 查询参数：format=s16le|f32le|wav，sample_rate（原始PCM，默认16000），channels（原始PCM，默认1），
+        //           params=识别参数JSON（也可通过X-Recognition-Params请求头传递）
+        server.Post("/recognize_pcm", [this](const httplib::Request& req, httplib::Response& res,
+                                             const httplib::ContentReader& content_reader) {
+            try {
+                // 确定输入格式：优先使用format参数，其次根据Content-Type判断
+                std::string format_name = req.has_param("format") ? req.get_param_value("format") : "";
+                if (format_name.empty()) {
+                    std::string content_type = req.get_header_value("Content-Type");
+                    format_name = content_type.find("wav") != std::string::npos ? "wav" : "s16le";
+                }
+                
+                PcmFormat format;
+                if (!StreamingPcmDecoder::parseFormat(format_name, format)) {
+                    json error = {{"success", false}, {"error", "不支持的音频格式: " + format_name}};
+                    res.status = 400;
+                    res.set_content(error.dump(), "application/json");
+                    return;
+                }
+                
+                // 原始PCM的采样率和声道数来自客户端，解码前校验范围
+                int sample_rate = StreamingPcmDecoder::TARGET_SAMPLE_RATE;
+                int channels = 1;
+                if ((req.has_param("sample_rate") && !parseIntParam(req.get_param_value("sample_rate"), sample_rate)) ||
+                    (req.has_param("channels") && !parseIntParam(req.get_param_value("channels"), channels)) ||
+                    !StreamingPcmDecoder::isValidFormat(sample_rate, channels)) {
+                    json error = {{"success", false},
+                                  {"error", "无效的sample_rate或channels（采样率" +
+                                            std::to_string(StreamingPcmDecoder::MIN_SAMPLE_RATE) + "-" +
+                                            std::to_string(StreamingPcmDecoder::MAX_SAMPLE_RATE) + "Hz，声道数1-" +
+                                            std::to_string(StreamingPcmDecoder::MAX_CHANNELS) + "）"}};
+                    res.status = 400;
+                    res.set_content(error.dump(), "application/json");
+                    return;
+                }
+                
+                // 解析识别参数（PCM流默认按交互式任务调度）
+                RecognitionParams params;
+                int priority = PRIORITY_INTERACTIVE;
+                std::string params_text = req.has_param("params") ? req.get_param_value("params")
+                                                                  : req.get_header_value("X-Recognition-Params");
+                if (!params_text.empty()) {
+                    try {
+                        json params_json = json::parse(params_text);
+                        params = parseRecognitionParams(params_json);
+                        priority = resolvePriority(params_json, priority);
+                    } catch (const std::exception& e) {
+                        std::cerr << "解析params参数失败: " << e.what() << std::endl;
+                    }
+                }
+                
+                // 边接收边解码
+                StreamingPcmDecoder decoder(format, sample_rate, channels);
+                size_t received_bytes = 0;
+                bool read_ok = content_reader([&](const char* data, size_t data_length) {
+                    received_bytes += data_length;
+                    return decoder.feed(data, data_length);
+                });
+                
+                if (!read_ok || !decoder.finish()) {
+                    std::string message = decoder.getError().empty() ? "读取请求体失败" : decoder.getError();
+                    json error = {{"success", false}, {"error", message}};
+                    res.status = 400;
+                    res.set_content(error.dump(), "application/json");
+                    return;
+                }
+                
+                std::vector<float> pcmf32 = decoder.takeSamples();
+                if (decoder.getSampleRate() != StreamingPcmDecoder::TARGET_SAMPLE_RATE) {
+                    std::cout << "重采样: " << decoder.getSampleRate() << "Hz -> "
+                              << StreamingPcmDecoder::TARGET_SAMPLE_RATE << "Hz" << std::endl;
+                    pcmf32 = AudioResampler::resample(pcmf32, decoder.getSampleRate(),
+                                                      StreamingPcmDecoder::TARGET_SAMPLE_RATE);
+                }
+                std::cout << "收到PCM流: " << received_bytes << " 字节, 格式: " << format_name
+                          << ", 解码样本数: " << pcmf32.size() << std::endl;
+                
+                if (pcmf32.empty()) {
+                    json error = {{"success", false}, {"error", "音频数据为空"}};
+                    res.status = 400;
+                    res.set_content(error.dump(), "application/json");
+                    return;
+                }
+                
+                // 使用多路识别管理器执行识别（自动负载均衡）
+                std::string task_id = multi_channel_manager_->submitPcmTask(std::move(pcmf32), params, priority);
+                
+                // 异步模式：立即返回任务ID
+                if (!task_id.empty() && isAsyncRequest(req)) {
+                    sendTaskAccepted(res, task_id);
+                    return;
+                }
+                
+                RecognitionResult result;
+                if (!task_id.empty()) {
+                    auto future = multi_channel_manager_->getTaskResult(task_id);
+                    result = future.get(); // 阻塞等待结果
+                    multi_channel_manager_->releaseTask(task_id);
+                } else {
+                    result.success = false;
+                    result.error_message = "无法提交任务到多路识别管理器";
+                }
+                
+                json response = buildRecognitionResponse(result, params);
+                if (!result.success) {
+                    res.status = 500;
+                }
+                
+                res.set_header("Access-Control-Allow-Origin", "*");
+                res.set_content(response.dump(4), "application/json");
+                
+            } catch (const std::exception& e) {
+                json error = {{"success", false}, {"error", std::string("处理请求时出错: ") + e.what()}};
+                res.status = 400;
+                res.set_content(error.dump(), "application/json");
+            }
+        });
+        
+        // 查询异步任务状态，wait_ms>0时长轮询：在结果就绪或超时前不返回
+        server.Get(R"(/tasks/([A-Za-z0-9_]+))", [this](const httplib::Request& req, httplib::Response& res) {
+            auto task = multi_channel_manager_->findTask(req.matches[1]);
+            if (!task) {
+                json error = {{"success", false}, {"error", "任务不存在或结果已过期"}};
+                res.status = 404;
+                res.set_content(error.dump(), "application/json");
+                return;
+            }
+            
+            int wait_ms = 0;
+            if (req.has_param("wait_ms")) {
+                wait_ms = std::clamp(std::atoi(req.get_param_value("wait_ms").c_str()), 0, MAX_LONG_POLL_MS);
+            }
+            if (wait_ms > 0) {
+                task->result_future.wait_for(std::chrono::milliseconds(wait_ms));
+            }
+            
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.set_content(buildTaskStatus(task).dump(4), "application/json");
+        });
+        
+        // 以服务器推送事件（SSE）返回任务状态变化和最终结果
+        server.Get(R"(/tasks/([A-Za-z0-9_]+)/events)", [this](const httplib::Request& req, httplib::Response& res) {
+            auto task = multi_channel_manager_->findTask(req.matches[1]);
+            if (!task) {
+                json error = {{"success", false}, {"error", "任务不存在或结果已过期"}};
+                res.status = 404;
+                res.set_content(error.dump(), "application/json");
+                return;
+            }
+            
+            auto last_state = std::make_shared<int>(-1);
+            res.set_header("Cache-Control", "no-cache");
+            res.set_header("Access-Control-Allow-Origin", "*");
+            res.set_chunked_content_provider("text/event-stream",
+                [this, task, last_state](size_t /*offset*/, httplib::DataSink& sink) {
+                    int state = observedTaskState(task);
+                    if (state != *last_state) {
+                        *last_state = state;
+                        std::string event = "event: " + std::string(state == TASK_COMPLETED ? "result" : "status") +
+                                            "\ndata: " + buildTaskStatus(task).dump() + "\n\n";
+                        if (!sink.write(event.data(), event.size())) {
+                            return false;
+                        }
+                    }
+                    
+                    if (state == TASK_COMPLETED) {
+                        sink.done();
+                        return true;
+                    }
+                    
+                    // 等待状态变化，期间发送注释行保持连接
+                    if (task->result_future.wait_for(std::chrono::seconds(1)) != std::future_status::ready &&
+                        observedTaskState(task) == *last_state) {
+                        static const std::string keep_alive = ": keep-alive\n\n";
+                        return sink.write(keep_alive.data(), keep_alive.size());
+                    }
+                    return true;
+                });
+        });
+        
         // 启动服务器
         std::cout << "正在启动HTTP服务器，监听地址: " << host_ << ":" << port_ << std::endl;
         
@@ -921,6 +1455,168 @@ private:
     std::unique_ptr<SimpleMultiChannelManager> multi_channel_manager_;
     std::chrono::system_clock::time_point start_time_ = std::chrono::system_clock::now();
     
+    static constexpr int MAX_LONG_POLL_MS = 30000;  // 长轮询最长等待时间
+    
+    // 请求是否要求异步处理（查询参数async=1/true）
+    static bool isAsyncRequest(const httplib::Request& req) {
+        if (!req.has_param("async")) {
+            return false;
+        }
+        const std::string value = req.get_param_value("async");
+        return value == "1" || value == "true";
+    }
+    
+    // 解析整数查询参数，整个字符串必须是合法的十进制整数
+    static bool parseIntParam(const std::string& text, int& value) {
+        int parsed = 0;
+        const char* end = text.data() + text.size();
+        auto [ptr, ec] = std::from_chars(text.data(), end, parsed);
+        if (text.empty() || ec != std::errc() || ptr != end) {
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+    
+    // 返回已受理的异步任务
+    static void sendTaskAccepted(httplib::Response& res, const std::string& task_id) {
+        json response = {
+            {"success", true},
+            {"task_id", task_id},
+            {"status", "queued"},
+            {"status_url", "/tasks/" + task_id},
+            {"events_url", "/tasks/" + task_id + "/events"}
+        };
+        res.status = 202;
+        res.set_header("Access-Control-Allow-Origin", "*");
+        res.set_content(response.dump(4), "application/json");
+        std::cout << "异步任务已受理: " << task_id << std::endl;
+    }
+    
+    // 对外报告的任务状态：任务先标记完成再发布结果，两者之间的短暂窗口内仍按识别中报告，避免读取结果时阻塞
+    static int observedTaskState(const std::shared_ptr<AsyncRecognitionTask>& task) {
+        const int state = task->state;
+        if (state == TASK_COMPLETED &&
+            task->result_future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return TASK_PROCESSING;
+        }
+        return state;
+    }
+    
+    // 构建任务状态，已完成的任务附带识别结果
+    static json buildTaskStatus(const std::shared_ptr<AsyncRecognitionTask>& task) {
+        static const char* state_names[] = {"queued", "processing", "completed"};
+        const int state = observedTaskState(task);
+        
+        json status = {
+            {"task_id", task->task_id},
+            {"status", state_names[state]},
+            {"priority", task->priority}
+        };
+        if (state == TASK_COMPLETED) {
+            status["result"] = buildRecognitionResponse(task->result_future.get(), task->params);
+        }
+        return status;
+    }
+    
+    // 从JSON对象解析识别参数（缺省字段使用默认值）
+    static RecognitionParams parseRecognitionParams(const json& params_json) {
+        RecognitionParams params;
+        params.language = params_json.value("language", params.language);
+        params.use_gpu = params_json.value("use_gpu", params.use_gpu);
+        params.beam_size = params_json.value("beam_size", params.beam_size);
+        params.temperature = params_json.value("temperature", params.temperature);
+        
+        // 文本矫正参数
+        params.enable_correction = params_json.value("enable_correction", params.enable_correction);
+        params.correction_server = params_json.value("correction_server", params.correction_server);
+        params.correction_temperature = params_json.value("correction_temperature", params.correction_temperature);
+        params.correction_max_tokens = params_json.value("correction_max_tokens", params.correction_max_tokens);
+        
+        // 静音裁剪：true/false或1/0，缺省跟随服务器配置
+        auto trim = params_json.find("trim_silence");
+        if (trim != params_json.end()) {
+            if (trim->is_boolean()) {
+                params.trim_silence = trim->get<bool>() ? 1 : 0;
+            } else if (trim->is_number_integer()) {
+                params.trim_silence = trim->get<int>() != 0 ? 1 : 0;
+            }
+        }
+        return params;
+    }
+    
+    // 解析任务优先级：is_final_segment=true视为最后一段；priority可为数值或bulk/interactive/final
+    // 数值按不超过它的最高档位取整，超出范围的钳制到bulk/final
+    static int resolvePriority(const json& params_json, int default_priority) {
+        if (params_json.value("is_final_segment", false)) {
+            return PRIORITY_FINAL;
+        }
+        
+        auto it = params_json.find("priority");
+        if (it == params_json.end()) {
+            return default_priority;
+        }
+        if (it->is_number_integer()) {
+            const long long value = it->get<long long>();
+            if (value >= PRIORITY_FINAL) return PRIORITY_FINAL;
+            if (value >= PRIORITY_INTERACTIVE) return PRIORITY_INTERACTIVE;
+            return PRIORITY_BULK;
+        }
+        if (it->is_string()) {
+            const std::string name = it->get<std::string>();
+            if (name == "bulk") return PRIORITY_BULK;
+            if (name == "interactive") return PRIORITY_INTERACTIVE;
+            if (name == "final") return PRIORITY_FINAL;
+        }
+        return default_priority;
+    }
+    
+    // 构建识别结果响应
+    static json buildRecognitionResponse(const RecognitionResult& result, const RecognitionParams& params) {
+        json response = {
+            {"success", result.success},
+            {"text", result.text},
+            {"original_text", result.original_text},
+            {"confidence", result.confidence},
+            {"language", params.language},
+            {"processing_time_ms", result.processing_time_ms}
+        };
+        
+        // 添加文本矫正相关信息
+        if (params.enable_correction) {
+            response["correction"] = {
+                {"was_corrected", result.was_corrected},
+                {"correction_confidence", result.correction_confidence},
+                {"correction_time_ms", result.correction_time_ms}
+            };
+            
+            if (!result.correction_error.empty()) {
+                response["correction"]["error"] = result.correction_error;
+            }
+        }
+        
+        // 分段时间戳（毫秒，相对于原始音频）
+        if (!result.segments.empty()) {
+            json segments = json::array();
+            for (const auto& segment : result.segments) {
+                segments.push_back({
+                    {"text", segment.text},
+                    {"start_ms", segment.start_ms},
+                    {"end_ms", segment.end_ms}
+                });
+            }
+            response["segments"] = segments;
+        }
+        if (result.trimmed_ms > 0) {
+            response["trimmed_ms"] = result.trimmed_ms;
+        }
+        
+        if (!result.success) {
+            response["error"] = result.error_message;
+        }
+        return response;
+    }
+    
     // 获取服务运行时间
     std::string getUptime() const {
         auto now = std::chrono::system_clock::now();
@@ -968,7 +1664,11 @@ int main(int argc, char** argv) {
         
         // 初始化服务
         std::cout << "正在初始化识别服务，模型路径: " << config.model_path << std::endl;
-        auto recognition_service = std::make_shared<RecognitionService>(config.model_path);
+        // 模型权重在整个进程中只加载一次，识别服务和各通道共享
+        auto shared_model = std::make_shared<SharedWhisperModel>(config.model_path);
+        auto recognition_service = std::make_shared<RecognitionService>(shared_model);
+        SpeechTrimOptions trim_options = parseTrimOptions(config.vad_trim);
+        recognition_service->setTrimOptions(trim_options);
         
         // 检查识别服务是否初始化成功
         if (!recognition_service->initialize()) {
@@ -988,7 +1688,8 @@ int main(int argc, char** argv) {
         std::filesystem::create_directories(std::filesystem::path(config.log_file).parent_path());
         
         // 创建HTTP服务器
-        HttpServer server(config.host, config.port, recognition_service, file_handler, config.model_path);
+        HttpServer server(config.host, config.port, recognition_service, file_handler, shared_model,
+                          config.multi_channel, trim_options);
         server.setCorsHeaders(config.cors);
         
         // 启动服务器
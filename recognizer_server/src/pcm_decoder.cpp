@@ -0,0 +1,295 @@
+#include "../include/pcm_decoder.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+
+namespace {
+
+// WAV头部（含LIST等元数据块）允许的最大字节数，防止异常请求无限缓存
+constexpr size_t MAX_WAV_HEADER_BYTES = 1024 * 1024;
+
+// WAV格式代码
+constexpr uint16_t WAV_FORMAT_PCM = 1;
+constexpr uint16_t WAV_FORMAT_IEEE_FLOAT = 3;
+constexpr uint16_t WAV_FORMAT_EXTENSIBLE = 0xFFFE;
+
+uint16_t readU16(const char* p) {
+    return static_cast<uint16_t>(static_cast<uint8_t>(p[0]) |
+                                 (static_cast<uint8_t>(p[1]) << 8));
+}
+
+uint32_t readU32(const char* p) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(p[0])) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(p[1])) << 8) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(p[2])) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(p[3])) << 24);
+}
+
+} // namespace
+
+StreamingPcmDecoder::StreamingPcmDecoder(PcmFormat format, int sample_rate, int channels)
+    : format_(format), sample_rate_(sample_rate), channels_(channels) {
+    if (format_ == PcmFormat::S16LE) {
+        bytes_per_sample_ = 2;
+        is_float_ = false;
+        header_done_ = true;
+    } else if (format_ == PcmFormat::F32LE) {
+        bytes_per_sample_ = 4;
+        is_float_ = true;
+        header_done_ = true;
+    }
+
+    if (header_done_ && !isValidFormat(sample_rate_, channels_)) {
+        fail("无效的采样率或声道数: " + std::to_string(sample_rate_) + "Hz, " + std::to_string(channels_) + "声道");
+    }
+}
+
+bool StreamingPcmDecoder::feed(const char* data, size_t size) {
+    if (!error_.empty()) {
+        return false;
+    }
+    if (size == 0) {
+        return true;
+    }
+
+    if (!header_done_) {
+        pending_.append(data, size);
+        return parseWavHeader();
+    }
+
+    consumeAudio(data, size);
+    return true;
+}
+
+bool StreamingPcmDecoder::finish() {
+    if (!error_.empty()) {
+        return false;
+    }
+
+    if (!header_done_) {
+        return fail("WAV头部不完整或缺少data块");
+    }
+
+    if (!pending_.empty()) {
+        // 原始PCM没有头部可以校验，长度不是整帧说明格式参数与数据不符
+        if (format_ != PcmFormat::WAV) {
+            return fail("PCM数据长度不是帧大小（" + std::to_string(bytes_per_sample_ * channels_) +
+                        " 字节）的整数倍");
+        }
+        std::cerr << "警告: 音频数据末尾有 " << pending_.size() << " 字节不完整的帧，已丢弃" << std::endl;
+        pending_.clear();
+    }
+
+    if (format_ == PcmFormat::WAV && !data_unbounded_ && data_remaining_ > 0) {
+        std::cerr << "警告: WAV数据块不完整，缺少 " << data_remaining_ << " 字节" << std::endl;
+    }
+
+    return true;
+}
+
+const std::vector<float>& StreamingPcmDecoder::samples() const {
+    return samples_;
+}
+
+std::vector<float> StreamingPcmDecoder::takeSamples() {
+    return std::move(samples_);
+}
+
+int StreamingPcmDecoder::getSampleRate() const {
+    return sample_rate_;
+}
+
+int StreamingPcmDecoder::getChannels() const {
+    return channels_;
+}
+
+const std::string& StreamingPcmDecoder::getError() const {
+    return error_;
+}
+
+bool StreamingPcmDecoder::isValidFormat(int sample_rate, int channels) {
+    return sample_rate >= MIN_SAMPLE_RATE && sample_rate <= MAX_SAMPLE_RATE &&
+           channels >= 1 && channels <= MAX_CHANNELS;
+}
+
+bool StreamingPcmDecoder::parseFormat(const std::string& name, PcmFormat& format) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (lower == "s16le" || lower == "pcm_s16le" || lower == "s16") {
+        format = PcmFormat::S16LE;
+    } else if (lower == "f32le" || lower == "pcm_f32le" || lower == "f32") {
+        format = PcmFormat::F32LE;
+    } else if (lower == "wav") {
+        format = PcmFormat::WAV;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool StreamingPcmDecoder::parseWavHeader() {
+    // 逐块遍历RIFF结构，而不是假设固定的44字节头部
+    if (pending_.size() < 12) {
+        return true;
+    }
+
+    const char* buf = pending_.data();
+    if (std::memcmp(buf, "RIFF", 4) != 0 || std::memcmp(buf + 8, "WAVE", 4) != 0) {
+        return fail("无效的WAV文件格式（缺少RIFF/WAVE标识）");
+    }
+
+    bool fmt_found = false;
+    size_t pos = 12;
+    while (pos + 8 <= pending_.size()) {
+        const char* chunk = buf + pos;
+        uint32_t chunk_size = readU32(chunk + 4);
+
+        if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!fmt_found) {
+                return fail("WAV文件缺少fmt块");
+            }
+
+            // 数据块长度为0或0xFFFFFFFF表示流式写出、长度未知
+            data_unbounded_ = (chunk_size == 0 || chunk_size == 0xFFFFFFFFu);
+            data_remaining_ = chunk_size;
+            header_done_ = true;
+
+            // 头部之后已到达的字节直接作为音频数据处理
+            std::string rest = pending_.substr(pos + 8);
+            pending_.clear();
+            consumeAudio(rest.data(), rest.size());
+            return true;
+        }
+
+        // 块数据按偶数字节对齐
+        size_t chunk_total = 8 + static_cast<size_t>(chunk_size) + (chunk_size & 1);
+        if (pos + chunk_total > pending_.size()) {
+            break;
+        }
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            if (chunk_size < 16) {
+                return fail("WAV fmt块长度无效");
+            }
+
+            const char* fmt = chunk + 8;
+            uint16_t audio_format = readU16(fmt);
+            uint16_t num_channels = readU16(fmt + 2);
+            uint32_t sample_rate = readU32(fmt + 4);
+            uint16_t bit_depth = readU16(fmt + 14);
+
+            // WAVE_FORMAT_EXTENSIBLE的实际格式在子格式GUID的前两个字节
+            if (audio_format == WAV_FORMAT_EXTENSIBLE && chunk_size >= 26) {
+                audio_format = readU16(fmt + 24);
+            }
+
+            if (audio_format == WAV_FORMAT_PCM && bit_depth == 16) {
+                is_float_ = false;
+            } else if (audio_format == WAV_FORMAT_IEEE_FLOAT && bit_depth == 32) {
+                is_float_ = true;
+            } else {
+                return fail("不支持的WAV格式: format=" + std::to_string(audio_format) +
+                            ", bits=" + std::to_string(bit_depth));
+            }
+
+            if (sample_rate > static_cast<uint32_t>(MAX_SAMPLE_RATE) ||
+                !isValidFormat(static_cast<int>(sample_rate), num_channels)) {
+                return fail("WAV声道数或采样率无效: " + std::to_string(sample_rate) + "Hz, " +
+                            std::to_string(num_channels) + "声道");
+            }
+
+            channels_ = num_channels;
+            sample_rate_ = static_cast<int>(sample_rate);
+            bytes_per_sample_ = bit_depth / 8;
+            fmt_found = true;
+        }
+
+        pos += chunk_total;
+    }
+
+    // 头部尚未完整，等待更多数据
+    if (pending_.size() > MAX_WAV_HEADER_BYTES) {
+        return fail("WAV头部过大");
+    }
+    return true;
+}
+
+void StreamingPcmDecoder::consumeAudio(const char* data, size_t size) {
+    // WAV数据块之后可能还有其他块，超出部分忽略
+    if (format_ == PcmFormat::WAV && !data_unbounded_) {
+        size_t allowed = static_cast<size_t>(std::min<uint64_t>(data_remaining_, size));
+        data_remaining_ -= allowed;
+        size = allowed;
+    }
+
+    const size_t frame_bytes = static_cast<size_t>(bytes_per_sample_) * channels_;
+    if (frame_bytes == 0 || size == 0) {
+        return;
+    }
+
+    // 先补齐上次残留的不完整帧
+    if (!pending_.empty()) {
+        size_t need = std::min(frame_bytes - pending_.size(), size);
+        pending_.append(data, need);
+        data += need;
+        size -= need;
+
+        if (pending_.size() == frame_bytes) {
+            decodeFrames(pending_.data(), frame_bytes);
+            pending_.clear();
+        }
+    }
+
+    // 整帧部分直接解码，剩余字节留待下次
+    size_t whole = (size / frame_bytes) * frame_bytes;
+    decodeFrames(data, whole);
+    if (whole < size) {
+        pending_.assign(data + whole, size - whole);
+    }
+}
+
+void StreamingPcmDecoder::decodeFrames(const char* data, size_t size) {
+    const size_t frame_bytes = static_cast<size_t>(bytes_per_sample_) * channels_;
+    const size_t num_frames = size / frame_bytes;
+    if (num_frames == 0) {
+        return;
+    }
+
+    size_t offset = samples_.size();
+    samples_.resize(offset + num_frames);
+    float* out = samples_.data() + offset;
+
+    if (is_float_) {
+        if (channels_ == 1) {
+            std::memcpy(out, data, num_frames * sizeof(float));
+            return;
+        }
+        for (size_t i = 0; i < num_frames; ++i) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels_; ++c) {
+                float v;
+                std::memcpy(&v, data + (i * channels_ + c) * sizeof(float), sizeof(float));
+                sum += v;
+            }
+            out[i] = sum / channels_;
+        }
+    } else {
+        // 与loadAudioFile一致：除以32768归一化，多声道取平均
+        for (size_t i = 0; i < num_frames; ++i) {
+            int sum = 0;
+            for (int c = 0; c < channels_; ++c) {
+                sum += static_cast<int16_t>(readU16(data + (i * channels_ + c) * 2));
+            }
+            out[i] = sum / (channels_ * 32768.0f);
+        }
+    }
+}
+
+bool StreamingPcmDecoder::fail(const std::string& message) {
+    error_ = message;
+    std::cerr << "PCM解码失败: " << message << std::endl;
+    return false;
+}
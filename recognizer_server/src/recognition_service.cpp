@@ -1,6 +1,8 @@
 #include "../include/recognition_service.h"
 #include "../include/text_corrector.h"
 #include "../include/cuda_memory_manager.h"
+#include "../include/audio_resampler.h"
+#include "../include/batch_segment_splitter.h"
 #include <iostream>
 #include <fstream>
 #include <chrono>
@@ -8,6 +10,7 @@
 #include <whisper.h>  // 包含whisper.cpp的头文件
 #include <functional> // 添加对std::function的支持
 #include <mutex>      // 添加互斥锁支持
+#include <algorithm>  // 批量识别时按时间戳查找所属片段
 
 // 添加CUDA相关头文件（如果可用）
 #ifdef GGML_USE_CUDA
@@ -37,6 +40,74 @@ struct WAVHeader {
     uint32_t data_bytes;
 };
 
+SharedWhisperModel::SharedWhisperModel(const std::string& model_path, int gpu_device)
+    : model_path_(model_path), gpu_device_(gpu_device), context_ptr_(nullptr) {
+}
+
+SharedWhisperModel::~SharedWhisperModel() {
+    if (context_ptr_ != nullptr) {
+        whisper_free(static_cast<whisper_context*>(context_ptr_));
+        context_ptr_ = nullptr;
+        std::cout << "释放共享语音识别模型" << std::endl;
+    }
+}
+
+bool SharedWhisperModel::load() {
+    std::lock_guard<std::mutex> lock(model_mutex_);
+    if (context_ptr_ != nullptr) {
+        return true;
+    }
+    
+    try {
+        std::cout << "加载共享语音识别模型: " << model_path_ << std::endl;
+        
+        whisper_context_params cparams = whisper_context_default_params();
+        cparams.use_gpu = true;  // 默认启用GPU，如果失败会自动回退到CPU
+        cparams.gpu_device = gpu_device_;
+        
+        // 只加载权重，不分配解码状态，状态由各通道自行创建
+        whisper_context* ctx = whisper_init_from_file_with_params_no_state(model_path_.c_str(), cparams);
+        if (ctx == nullptr) {
+            std::cerr << "无法加载共享Whisper模型: " << model_path_ << std::endl;
+            return false;
+        }
+        
+        context_ptr_ = ctx;
+        std::cout << "共享模型加载成功，GPU设备: " << cparams.gpu_device << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "加载共享模型失败: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool SharedWhisperModel::isLoaded() const {
+    std::lock_guard<std::mutex> lock(model_mutex_);
+    return context_ptr_ != nullptr;
+}
+
+std::string SharedWhisperModel::getModelPath() const {
+    return model_path_;
+}
+
+void* SharedWhisperModel::getContext() const {
+    std::lock_guard<std::mutex> lock(model_mutex_);
+    return context_ptr_;
+}
+
+void* SharedWhisperModel::createState() {
+    std::lock_guard<std::mutex> lock(model_mutex_);
+    if (context_ptr_ == nullptr) {
+        return nullptr;
+    }
+    
+    whisper_state* state = whisper_init_state(static_cast<whisper_context*>(context_ptr_));
+    if (state == nullptr) {
+        std::cerr << "创建whisper解码状态失败" << std::endl;
+    }
+    return state;
+}
+
 RecognitionService::RecognitionService(const std::string& model_path)
     : model_path_(model_path), is_initialized_(false), model_ptr_(nullptr), 
       cuda_initialized_(false), cuda_device_id_(0) {
@@ -45,6 +116,15 @@ RecognitionService::RecognitionService(const std::string& model_path)
     initialize();
 }
 
+RecognitionService::RecognitionService(std::shared_ptr<SharedWhisperModel> shared_model)
+    : model_path_(shared_model ? shared_model->getModelPath() : std::string()), 
+      is_initialized_(false), model_ptr_(nullptr), shared_model_(std::move(shared_model)),
+      cuda_initialized_(false), cuda_device_id_(0) {
+    // 初始化文本矫正器
+    text_corrector_ = std::make_unique<TextCorrector>();
+    initialize();
+}
+
 RecognitionService::~RecognitionService() {
     unloadModel();
     cleanupCUDA();
@@ -91,6 +171,34 @@ RecognitionResult RecognitionService::recognize(const std::string& audio_path, c
         return result;
     }
     
+    // 调用内部识别方法
+    return recognizeInternal(audio_path, prepareDeviceParams(params));
+}
+
+RecognitionResult RecognitionService::recognizeSamples(const std::vector<float>& pcmf32, const RecognitionParams& params) {
+    // 与recognize相同的加锁策略
+    std::lock_guard<std::mutex> lock(recognition_mutex_);
+    
+    RecognitionResult result;
+    
+    // 检查初始化状态
+    if (!is_initialized_ && !initialize()) {
+        result.success = false;
+        result.error_message = "识别服务未初始化";
+        return result;
+    }
+    
+    if (pcmf32.empty()) {
+        result.success = false;
+        result.error_message = "音频数据为空";
+        return result;
+    }
+    
+    std::cout << "执行语音识别，内存音频: " << pcmf32.size() << " 样本" << std::endl;
+    return recognizeSamplesInternal(pcmf32, prepareDeviceParams(params));
+}
+
+RecognitionParams RecognitionService::prepareDeviceParams(const RecognitionParams& params) {
     // 如果使用GPU，确保CUDA设备状态正常
     if (params.use_gpu) {
         auto& cuda_manager = CUDAMemoryManager::getInstance();
@@ -99,7 +207,7 @@ RecognitionResult RecognitionService::recognize(const std::string& audio_path, c
                 std::cerr << "CUDA设备初始化失败，切换到CPU模式" << std::endl;
                 RecognitionParams cpu_params = params;
                 cpu_params.use_gpu = false;
-                return recognizeInternal(audio_path, cpu_params);
+                return cpu_params;
             }
         }
         
@@ -112,13 +220,12 @@ RecognitionResult RecognitionService::recognize(const std::string& audio_path, c
                 std::cerr << "CUDA内存清理后仍然异常，切换到CPU模式" << std::endl;
                 RecognitionParams cpu_params = params;
                 cpu_params.use_gpu = false;
-                return recognizeInternal(audio_path, cpu_params);
+                return cpu_params;
             }
         }
     }
     
-    // 调用内部识别方法
-    return recognizeInternal(audio_path, params);
+    return params;
 }
 
 RecognitionResult RecognitionService::recognizeInternal(const std::string& audio_path, const RecognitionParams& params) {
@@ -134,30 +241,6 @@ RecognitionResult RecognitionService::recognizeInternal(const std::string& audio
         }
         
         std::cout << "执行语音识别，文件: " << audio_path << std::endl;
-        std::cout << "识别参数: 语言=" << params.language 
-                 << ", 使用GPU=" << (params.use_gpu ? "是" : "否")
-                 << ", beam大小=" << params.beam_size
-                 << ", 温度=" << params.temperature << std::endl;
-        
-        // 获取whisper上下文
-        whisper_context* ctx = static_cast<whisper_context*>(model_ptr_);
-        if (ctx == nullptr) {
-            result.success = false;
-            result.error_message = "Whisper模型未正确加载";
-            return result;
-        }
-        
-        // 创建whisper全局参数
-        whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
-        
-        // 设置语言
-        if (params.language != "auto") {
-            wparams.language = params.language.c_str();
-        }
-        
-        // 设置beam大小和温度
-        wparams.n_threads = params.beam_size; // 使用线程数替代beam_size
-        wparams.temperature = params.temperature;
         
         // 加载音频文件
         std::vector<float> pcmf32;
@@ -166,46 +249,58 @@ RecognitionResult RecognitionService::recognizeInternal(const std::string& audio
             result.error_message = "无法加载音频文件: " + audio_path;
             return result;
         }
+        
+        return recognizeSamplesInternal(pcmf32, params);
+    } catch (const std::exception& e) {
+        result.success = false;
+        result.error_message = std::string("识别过程中出错: ") + e.what();
+        return result;
+    }
+}
 
+RecognitionResult RecognitionService::recognizeSamplesInternal(const std::vector<float>& pcmf32, const RecognitionParams& params) {
+    RecognitionResult result;
+    
+    try {
         // 记录开始时间
         auto start_time = std::chrono::high_resolution_clock::now();
         
-        // 在GPU模式下，确保CUDA同步
-        if (params.use_gpu) {
-            auto& cuda_manager = CUDAMemoryManager::getInstance();
-            cuda_manager.synchronizeDevice();
+        // 推理前裁剪静音，整段都是静音时不必运行模型
+        SpeechTrimResult trim = trimSilence(pcmf32, params);
+        const std::vector<float>& input = trim.trimmed ? trim.samples : pcmf32;
+        if (trim.trimmed) {
+            result.trimmed_ms = static_cast<long long>(pcmf32.size() - input.size()) * 1000 / WHISPER_SAMPLE_RATE;
         }
         
-        // 运行识别
-        int whisper_result = whisper_full(ctx, wparams, pcmf32.data(), pcmf32.size());
-        
-        // 在GPU模式下，识别完成后再次同步
-        if (params.use_gpu) {
-            auto& cuda_manager = CUDAMemoryManager::getInstance();
-            cuda_manager.synchronizeDevice();
-        }
-        
-        if (whisper_result != 0) {
-            result.success = false;
-            result.error_message = "Whisper识别失败，错误代码: " + std::to_string(whisper_result);
-            return result;
+        std::vector<TranscriptSegment> segments;
+        if (!trim.has_speech) {
+            result.trimmed_ms = static_cast<long long>(pcmf32.size()) * 1000 / WHISPER_SAMPLE_RATE;
+            std::cout << "未检测到语音，跳过识别" << std::endl;
+        } else {
+            std::string error_message;
+            if (!runWhisper(input, params, error_message)) {
+                result.success = false;
+                result.error_message = error_message;
+                return result;
+            }
+            segments = collectSegments();
         }
         
         // 计算处理时间
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
 
-        // 获取识别结果
-        const int n_segments = whisper_full_n_segments(ctx);
+        // 获取识别结果，片段时间换算回原始音频
         std::string transcript;
-        
-        for (int i = 0; i < n_segments; ++i) {
-            const char* segment_text = whisper_full_get_segment_text(ctx, i);
-            transcript += segment_text;
-            if (i < n_segments - 1) {
+        for (size_t i = 0; i < segments.size(); ++i) {
+            segments[i].start_ms = trim.toSourceMs(segments[i].start_ms, WHISPER_SAMPLE_RATE);
+            segments[i].end_ms = trim.toSourceMs(segments[i].end_ms, WHISPER_SAMPLE_RATE);
+            transcript += segments[i].text;
+            if (i + 1 < segments.size()) {
                 transcript += " ";
             }
         }
+        result.segments = std::move(segments);
 
         // 设置基本识别结果
         result.success = true;
@@ -217,52 +312,7 @@ RecognitionResult RecognitionService::recognizeInternal(const std::string& audio
         std::cout << "识别完成，处理时间: " << duration << "ms, 文本长度: " << transcript.length() << std::endl;
         
         // 如果启用了文本矫正，进行矫正处理
-        if (params.enable_correction && !transcript.empty()) {
-            try {
-                // 初始化文本矫正器（如果需要）
-                if (!text_corrector_->isServiceAvailable()) {
-                    if (!text_corrector_->initialize(params.correction_server)) {
-                        std::cerr << "文本矫正服务初始化失败，跳过矫正" << std::endl;
-                        result.correction_error = "矫正服务初始化失败";
-                        return result;
-                    }
-                }
-                
-                // 构建矫正参数
-                CorrectionParams correction_params;
-                correction_params.enable_correction = true;
-                correction_params.temperature = params.correction_temperature;
-                correction_params.max_tokens = params.correction_max_tokens;
-                
-                // 执行文本矫正
-                std::cout << "正在执行文本矫正..." << std::endl;
-                auto correction_result = text_corrector_->correct(transcript, correction_params);
-                
-                if (correction_result.success) {
-                    result.text = correction_result.corrected_text;  // 使用矫正后的文本
-                    result.was_corrected = correction_result.was_corrected;
-                    result.correction_confidence = correction_result.correction_confidence;
-                    result.correction_time_ms = correction_result.correction_time_ms;
-                    
-                    if (correction_result.was_corrected) {
-                        std::cout << "文本矫正成功，耗时: " << correction_result.correction_time_ms << "ms" << std::endl;
-                        std::cout << "原文: " << transcript << std::endl;
-                        std::cout << "矫正: " << correction_result.corrected_text << std::endl;
-                    } else {
-                        std::cout << "文本无需矫正" << std::endl;
-                    }
-                } else {
-                    std::cerr << "文本矫正失败: " << correction_result.error_message << std::endl;
-                    result.correction_error = correction_result.error_message;
-                    // 矫正失败时保持原始识别结果
-                }
-                
-            } catch (const std::exception& e) {
-                std::cerr << "文本矫正过程中出错: " << e.what() << std::endl;
-                result.correction_error = std::string("矫正过程出错: ") + e.what();
-                // 矫正出错时保持原始识别结果
-            }
-        }
+        applyTextCorrection(result, params);
         
         return result;
     } catch (const std::exception& e) {
@@ -272,14 +322,299 @@ RecognitionResult RecognitionService::recognizeInternal(const std::string& audio
     }
 }
 
+std::vector<RecognitionResult> RecognitionService::recognizeBatch(const std::vector<const std::vector<float>*>& inputs,
+                                                                  const std::vector<RecognitionParams>& params_list) {
+    std::lock_guard<std::mutex> lock(recognition_mutex_);
+    
+    std::vector<RecognitionResult> results(inputs.size());
+    if (inputs.empty() || params_list.size() != inputs.size()) {
+        for (auto& result : results) {
+            result.success = false;
+            result.error_message = "批量识别参数无效";
+        }
+        return results;
+    }
+    
+    // 检查初始化状态
+    if (!is_initialized_ && !initialize()) {
+        for (auto& result : results) {
+            result.success = false;
+            result.error_message = "识别服务未初始化";
+        }
+        return results;
+    }
+    
+    RecognitionParams params = prepareDeviceParams(params_list[0]);
+    if (inputs.size() == 1) {
+        results[0] = recognizeSamplesInternal(*inputs[0], params);
+        return results;
+    }
+    
+    // 将各段音频依次拼接，段间插入静音间隔，使whisper在间隔处切分片段
+    // 启用静音裁剪时先去掉各段的静音，没有语音的段不参与拼接
+    const size_t gap_samples = static_cast<size_t>(BATCH_GAP_MS) * WHISPER_SAMPLE_RATE / 1000;
+    std::vector<SpeechTrimResult> trims(inputs.size());
+    std::vector<float> packed;
+    std::vector<BatchClipSpan> clips;
+    std::vector<size_t> clip_index;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        trims[i] = trimSilence(*inputs[i], params_list[i]);
+        if (!trims[i].has_speech) {
+            continue;
+        }
+        const std::vector<float>& input = trims[i].trimmed ? trims[i].samples : *inputs[i];
+        
+        if (!packed.empty()) {
+            packed.insert(packed.end(), gap_samples, 0.0f);
+        }
+        BatchClipSpan clip;
+        clip.start_ms = static_cast<long long>(packed.size()) * 1000 / WHISPER_SAMPLE_RATE;
+        packed.insert(packed.end(), input.begin(), input.end());
+        clip.end_ms = static_cast<long long>(packed.size()) * 1000 / WHISPER_SAMPLE_RATE;
+        clips.push_back(clip);
+        clip_index.push_back(i);
+    }
+    
+    std::cout << "批量识别: " << inputs.size() << " 段音频合并为 " << packed.size() << " 样本" << std::endl;
+    
+    auto start_time = std::chrono::high_resolution_clock::now();
+    
+    std::string error_message;
+    if (!packed.empty() && !runWhisper(packed, params, error_message)) {
+        // 合并识别失败时逐段识别，保证每个任务都有结果
+        std::cerr << "批量识别失败，改为逐段识别: " << error_message << std::endl;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            results[i] = recognizeSamplesInternal(*inputs[i], prepareDeviceParams(params_list[i]));
+        }
+        return results;
+    }
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+    
+    // 按时间把片段分配回对应的输入，跨越段边界的片段无法确定归属，涉及的段单独重新识别
+    BatchSplitResult split = splitBatchSegments(
+        packed.empty() ? std::vector<TranscriptSegment>() : collectSegments(), clips);
+    std::vector<bool> rerun(inputs.size(), false);
+    for (size_t clip = 0; clip < clips.size(); ++clip) {
+        const size_t index = clip_index[clip];
+        if (split.needs_rerun[clip]) {
+            rerun[index] = true;
+            continue;
+        }
+        
+        const SpeechTrimResult& trim = trims[index];
+        for (auto& segment : split.clip_segments[clip]) {
+            segment.start_ms = trim.toSourceMs(segment.start_ms, WHISPER_SAMPLE_RATE);
+            segment.end_ms = trim.toSourceMs(segment.end_ms, WHISPER_SAMPLE_RATE);
+        }
+        results[index].segments = std::move(split.clip_segments[clip]);
+    }
+    
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (rerun[i]) {
+            std::cout << "批量识别片段跨越段边界，第 " << i << " 段单独重新识别" << std::endl;
+            results[i] = recognizeSamplesInternal(*inputs[i], prepareDeviceParams(params_list[i]));
+            continue;
+        }
+        
+        std::string transcript;
+        for (const auto& segment : results[i].segments) {
+            if (!transcript.empty()) {
+                transcript += " ";
+            }
+            transcript += segment.text;
+        }
+        
+        RecognitionResult& result = results[i];
+        result.success = true;
+        result.original_text = transcript;
+        result.text = transcript;
+        result.confidence = 1.0f;
+        result.processing_time_ms = duration;
+        if (!trims[i].has_speech) {
+            result.trimmed_ms = static_cast<long long>(inputs[i]->size()) * 1000 / WHISPER_SAMPLE_RATE;
+        } else if (trims[i].trimmed) {
+            result.trimmed_ms = static_cast<long long>(inputs[i]->size() - trims[i].samples.size()) * 1000 / WHISPER_SAMPLE_RATE;
+        }
+        applyTextCorrection(result, params_list[i]);
+    }
+    
+    std::cout << "批量识别完成，处理时间: " << duration << "ms, 段数: " << inputs.size() << std::endl;
+    return results;
+}
+
+bool RecognitionService::runWhisper(const std::vector<float>& pcmf32, const RecognitionParams& params,
+                                    std::string& error_message) {
+    std::cout << "识别参数: 语言=" << params.language 
+             << ", 使用GPU=" << (params.use_gpu ? "是" : "否")
+             << ", beam大小=" << params.beam_size
+             << ", 温度=" << params.temperature << std::endl;
+    
+    // 获取whisper上下文（共享模型模式下同时使用本实例的解码状态）
+    whisper_context* ctx = static_cast<whisper_context*>(model_ptr_);
+    whisper_state* state = static_cast<whisper_state*>(state_ptr_);
+    if (ctx == nullptr || (shared_model_ && state == nullptr)) {
+        error_message = "Whisper模型未正确加载";
+        return false;
+    }
+    
+    // 创建whisper全局参数
+    whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    
+    // 设置语言
+    if (params.language != "auto") {
+        wparams.language = params.language.c_str();
+    }
+    
+    // 设置beam大小和温度
+    wparams.n_threads = params.beam_size; // 使用线程数替代beam_size
+    wparams.temperature = params.temperature;
+    
+    // 不把上一次识别的文本作为提示，避免不同任务（或批量识别的不同段）之间串文本
+    wparams.no_context = true;
+    
+    // 在GPU模式下，确保CUDA同步
+    if (params.use_gpu) {
+        auto& cuda_manager = CUDAMemoryManager::getInstance();
+        cuda_manager.synchronizeDevice();
+    }
+    
+    // 运行识别
+    int whisper_result = state != nullptr
+        ? whisper_full_with_state(ctx, state, wparams, pcmf32.data(), pcmf32.size())
+        : whisper_full(ctx, wparams, pcmf32.data(), pcmf32.size());
+    
+    // 在GPU模式下，识别完成后再次同步
+    if (params.use_gpu) {
+        auto& cuda_manager = CUDAMemoryManager::getInstance();
+        cuda_manager.synchronizeDevice();
+    }
+    
+    if (whisper_result != 0) {
+        error_message = "Whisper识别失败，错误代码: " + std::to_string(whisper_result);
+        return false;
+    }
+    return true;
+}
+
+std::vector<TranscriptSegment> RecognitionService::collectSegments() const {
+    whisper_context* ctx = static_cast<whisper_context*>(model_ptr_);
+    whisper_state* state = static_cast<whisper_state*>(state_ptr_);
+    
+    const int n_segments = state != nullptr
+        ? whisper_full_n_segments_from_state(state)
+        : whisper_full_n_segments(ctx);
+    
+    std::vector<TranscriptSegment> segments;
+    segments.reserve(n_segments);
+    for (int i = 0; i < n_segments; ++i) {
+        TranscriptSegment segment;
+        if (state != nullptr) {
+            segment.text = whisper_full_get_segment_text_from_state(state, i);
+            segment.start_ms = whisper_full_get_segment_t0_from_state(state, i) * 10;  // whisper时间单位为10ms
+            segment.end_ms = whisper_full_get_segment_t1_from_state(state, i) * 10;
+        } else {
+            segment.text = whisper_full_get_segment_text(ctx, i);
+            segment.start_ms = whisper_full_get_segment_t0(ctx, i) * 10;
+            segment.end_ms = whisper_full_get_segment_t1(ctx, i) * 10;
+        }
+        segments.push_back(std::move(segment));
+    }
+    return segments;
+}
+
+void RecognitionService::applyTextCorrection(RecognitionResult& result, const RecognitionParams& params) {
+    const std::string transcript = result.original_text;
+    if (!params.enable_correction || transcript.empty()) {
+        return;
+    }
+    
+    try {
+        // 初始化文本矫正器（如果需要）
+        if (!text_corrector_->isServiceAvailable()) {
+            if (!text_corrector_->initialize(params.correction_server)) {
+                std::cerr << "文本矫正服务初始化失败，跳过矫正" << std::endl;
+                result.correction_error = "矫正服务初始化失败";
+                return;
+            }
+        }
+        
+        // 构建矫正参数
+        CorrectionParams correction_params;
+        correction_params.enable_correction = true;
+        correction_params.temperature = params.correction_temperature;
+        correction_params.max_tokens = params.correction_max_tokens;
+        
+        // 执行文本矫正
+        std::cout << "正在执行文本矫正..." << std::endl;
+        auto correction_result = text_corrector_->correct(transcript, correction_params);
+        
+        if (correction_result.success) {
+            result.text = correction_result.corrected_text;  // 使用矫正后的文本
+            result.was_corrected = correction_result.was_corrected;
+            result.correction_confidence = correction_result.correction_confidence;
+            result.correction_time_ms = correction_result.correction_time_ms;
+            
+            if (correction_result.was_corrected) {
+                std::cout << "文本矫正成功，耗时: " << correction_result.correction_time_ms << "ms" << std::endl;
+                std::cout << "原文: " << transcript << std::endl;
+                std::cout << "矫正: " << correction_result.corrected_text << std::endl;
+            } else {
+                std::cout << "文本无需矫正" << std::endl;
+            }
+        } else {
+            std::cerr << "文本矫正失败: " << correction_result.error_message << std::endl;
+            result.correction_error = correction_result.error_message;
+            // 矫正失败时保持原始识别结果
+        }
+        
+    } catch (const std::exception& e) {
+        std::cerr << "文本矫正过程中出错: " << e.what() << std::endl;
+        result.correction_error = std::string("矫正过程出错: ") + e.what();
+        // 矫正出错时保持原始识别结果
+    }
+}
+
+void RecognitionService::setTrimOptions(const SpeechTrimOptions& options) {
+    std::lock_guard<std::mutex> lock(recognition_mutex_);
+    speech_trimmer_ = SpeechTrimmer(options);
+}
+
+bool RecognitionService::shouldTrimSilence(const RecognitionParams& params) const {
+    if (params.trim_silence >= 0) {
+        return params.trim_silence != 0;
+    }
+    return speech_trimmer_.getOptions().enabled;
+}
+
+SpeechTrimResult RecognitionService::trimSilence(const std::vector<float>& pcmf32, const RecognitionParams& params) const {
+    if (!shouldTrimSilence(params)) {
+        SpeechTrimResult result;
+        result.source_samples = pcmf32.size();
+        return result;
+    }
+    
+    SpeechTrimResult result = speech_trimmer_.trim(pcmf32, WHISPER_SAMPLE_RATE);
+    if (!result.has_speech) {
+        std::cout << "静音裁剪: " << pcmf32.size() * 1000 / WHISPER_SAMPLE_RATE << "ms 音频中未检测到语音" << std::endl;
+    } else if (result.trimmed) {
+        std::cout << "静音裁剪: " << pcmf32.size() * 1000 / WHISPER_SAMPLE_RATE << "ms -> "
+                  << result.samples.size() * 1000 / WHISPER_SAMPLE_RATE << "ms, 语音段数: "
+                  << result.spans.size() << std::endl;
+    }
+    return result;
+}
+
 std::string RecognitionService::getModelPath() const {
     return model_path_;
 }
 
 void RecognitionService::setModelPath(const std::string& model_path) {
     if (model_path_ != model_path) {
-        // 如果模型路径改变，需要重新加载
+        // 如果模型路径改变，需要重新加载（脱离共享模型，改为独占加载）
         unloadModel();
+        shared_model_.reset();
         model_path_ = model_path;
         is_initialized_ = false;
         initialize();
@@ -287,6 +622,23 @@ void RecognitionService::setModelPath(const std::string& model_path) {
 }
 
 bool RecognitionService::loadModel() {
+    // 共享模型模式：权重只加载一次，本实例仅创建自己的解码状态
+    if (shared_model_) {
+        if (!shared_model_->load()) {
+            return false;
+        }
+        
+        void* state = shared_model_->createState();
+        if (state == nullptr) {
+            return false;
+        }
+        
+        model_ptr_ = shared_model_->getContext();
+        state_ptr_ = state;
+        std::cout << "已为共享模型创建独立解码状态: " << model_path_ << std::endl;
+        return true;
+    }
+    
     try {
         std::cout << "加载语音识别模型: " << model_path_ << std::endl;
         
@@ -313,6 +665,13 @@ bool RecognitionService::loadModel() {
 }
 
 void RecognitionService::unloadModel() {
+    if (state_ptr_ != nullptr) {
+        // 只释放本实例的解码状态，共享权重由SharedWhisperModel管理
+        whisper_free_state(static_cast<whisper_state*>(state_ptr_));
+        state_ptr_ = nullptr;
+        model_ptr_ = nullptr;
+        std::cout << "释放语音识别解码状态" << std::endl;
+    }
     if (model_ptr_ != nullptr) {
         // 释放whisper模型资源
         whisper_free(static_cast<whisper_context*>(model_ptr_));
@@ -353,13 +712,6 @@ bool RecognitionService::loadAudioFile(const std::string& audio_path, std::vecto
             return false;
         }
 
-        // 检查采样率
-        if (header.sample_rate != WHISPER_SAMPLE_RATE) {
-            std::cerr << "警告: WAV文件采样率(" << header.sample_rate 
-                     << ")与Whisper要求的采样率(" << WHISPER_SAMPLE_RATE << ")不匹配，可能需要重采样" << std::endl;
-            // 这里应该进行重采样，但为简化实现，我们暂时忽略这个问题
-        }
-
         // 读取音频数据
         const size_t num_samples = header.data_bytes / (header.bit_depth / 8) / header.num_channels;
         pcmf32.resize(num_samples);
@@ -399,6 +751,12 @@ bool RecognitionService::loadAudioFile(const std::string& audio_path, std::vecto
             return false;
         }
 
+        // 采样率与Whisper要求不一致时重采样
+        if (header.sample_rate != WHISPER_SAMPLE_RATE) {
+            std::cout << "重采样: " << header.sample_rate << "Hz -> " << WHISPER_SAMPLE_RATE << "Hz" << std::endl;
+            pcmf32 = AudioResampler::resample(pcmf32, static_cast<int>(header.sample_rate), WHISPER_SAMPLE_RATE);
+        }
+
         return true;
     } catch (const std::exception& e) {
         std::cerr << "加载音频文件时出错: " << e.what() << std::endl;
@@ -0,0 +1,217 @@
+#include "../include/speech_trimmer.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#ifdef HAVE_FVAD
+extern "C" {
+#include <fvad.h>
+}
+#endif
+
+long long SpeechTrimResult::toSourceMs(long long output_ms, int sample_rate) const {
+    if (!trimmed || spans.empty()) {
+        return output_ms;
+    }
+
+    size_t output_sample = static_cast<size_t>(std::max<long long>(output_ms, 0)) * sample_rate / 1000;
+    auto it = std::upper_bound(spans.begin(), spans.end(), output_sample,
+                               [](size_t value, const TrimSpan& span) { return value < span.output_offset; });
+    const TrimSpan& span = it == spans.begin() ? spans.front() : *(it - 1);
+
+    size_t within = std::min(output_sample - std::min(output_sample, span.output_offset), span.length);
+    return static_cast<long long>(span.source_offset + within) * 1000 / sample_rate;
+}
+
+SpeechTrimmer::SpeechTrimmer(const SpeechTrimOptions& options)
+    : options_(options) {
+    // WebRTC VAD只接受10/20/30ms的帧
+    if (options_.frame_ms != 10 && options_.frame_ms != 20 && options_.frame_ms != 30) {
+        std::cerr << "静音裁剪帧长无效: " << options_.frame_ms << "ms，改用30ms" << std::endl;
+        options_.frame_ms = 30;
+    }
+    if (options_.mode == "fvad" && !isFvadAvailable()) {
+        if (options_.enabled) {
+            std::cerr << "未编译libfvad，静音裁剪改用能量门限" << std::endl;
+        }
+        options_.mode = "energy";
+    }
+}
+
+const SpeechTrimOptions& SpeechTrimmer::getOptions() const {
+    return options_;
+}
+
+bool SpeechTrimmer::isFvadAvailable() {
+#ifdef HAVE_FVAD
+    return true;
+#else
+    return false;
+#endif
+}
+
+SpeechTrimResult SpeechTrimmer::trim(const std::vector<float>& pcmf32, int sample_rate) const {
+    SpeechTrimResult result;
+    result.source_samples = pcmf32.size();
+
+    const size_t frame_samples = static_cast<size_t>(sample_rate) * options_.frame_ms / 1000;
+    if (frame_samples == 0 || pcmf32.size() < frame_samples) {
+        return result;
+    }
+
+    std::vector<bool> speech = detectFrames(pcmf32, sample_rate, frame_samples);
+    smoothDecisions(speech, options_.frame_ms);
+
+    // 语音帧区间前后扩展保护带，重叠的区间合并
+    const size_t guard_samples = static_cast<size_t>(sample_rate) * options_.guard_ms / 1000;
+    std::vector<std::pair<size_t, size_t>> regions;
+    for (size_t i = 0; i < speech.size();) {
+        if (!speech[i]) {
+            ++i;
+            continue;
+        }
+        size_t j = i;
+        while (j < speech.size() && speech[j]) {
+            ++j;
+        }
+
+        size_t begin = i * frame_samples;
+        size_t end = std::min(j * frame_samples, pcmf32.size());
+        begin = begin > guard_samples ? begin - guard_samples : 0;
+        end = std::min(end + guard_samples, pcmf32.size());
+        // 最后一个不完整帧没有参与检测，紧邻语音时一并保留
+        if (j == speech.size()) {
+            end = pcmf32.size();
+        }
+
+        if (!regions.empty() && begin <= regions.back().second) {
+            regions.back().second = std::max(regions.back().second, end);
+        } else {
+            regions.emplace_back(begin, end);
+        }
+        i = j;
+    }
+
+    if (regions.empty()) {
+        result.has_speech = false;
+        return result;
+    }
+
+    size_t kept = 0;
+    for (const auto& region : regions) {
+        kept += region.second - region.first;
+    }
+
+    // 只去掉很少的静音时不值得复制，直接使用原始音频
+    if (kept + frame_samples * 2 >= pcmf32.size()) {
+        return result;
+    }
+
+    result.trimmed = true;
+    result.samples.reserve(kept);
+    result.spans.reserve(regions.size());
+    for (const auto& region : regions) {
+        TrimSpan span;
+        span.source_offset = region.first;
+        span.output_offset = result.samples.size();
+        span.length = region.second - region.first;
+        result.spans.push_back(span);
+        result.samples.insert(result.samples.end(), pcmf32.begin() + region.first, pcmf32.begin() + region.second);
+    }
+    return result;
+}
+
+std::vector<bool> SpeechTrimmer::detectFrames(const std::vector<float>& pcmf32, int sample_rate,
+                                              size_t frame_samples) const {
+    if (options_.mode == "fvad") {
+        return detectFramesFvad(pcmf32, sample_rate, frame_samples);
+    }
+    return detectFramesEnergy(pcmf32, frame_samples);
+}
+
+std::vector<bool> SpeechTrimmer::detectFramesFvad(const std::vector<float>& pcmf32, int sample_rate,
+                                                  size_t frame_samples) const {
+#ifdef HAVE_FVAD
+    Fvad* vad = fvad_new();
+    if (vad == nullptr || fvad_set_sample_rate(vad, sample_rate) != 0 ||
+        fvad_set_mode(vad, std::clamp(options_.fvad_mode, 0, 3)) != 0) {
+        std::cerr << "WebRTC VAD初始化失败，改用能量门限" << std::endl;
+        if (vad != nullptr) {
+            fvad_free(vad);
+        }
+        return detectFramesEnergy(pcmf32, frame_samples);
+    }
+
+    const size_t frame_count = pcmf32.size() / frame_samples;
+    std::vector<bool> speech(frame_count, false);
+    std::vector<int16_t> frame(frame_samples);
+    for (size_t f = 0; f < frame_count; ++f) {
+        const float* src = pcmf32.data() + f * frame_samples;
+        for (size_t i = 0; i < frame_samples; ++i) {
+            float v = std::clamp(src[i], -1.0f, 1.0f);
+            frame[i] = static_cast<int16_t>(std::lrint(v * 32767.0f));
+        }
+        // 检测出错时按语音处理，宁可多保留也不丢内容
+        speech[f] = fvad_process(vad, frame.data(), frame_samples) != 0;
+    }
+
+    fvad_free(vad);
+    return speech;
+#else
+    (void)sample_rate;
+    return detectFramesEnergy(pcmf32, frame_samples);
+#endif
+}
+
+std::vector<bool> SpeechTrimmer::detectFramesEnergy(const std::vector<float>& pcmf32, size_t frame_samples) const {
+    const size_t frame_count = pcmf32.size() / frame_samples;
+    std::vector<bool> speech(frame_count, false);
+
+    // 比较均方能量，避免逐帧开方和取对数
+    const double threshold = std::pow(10.0, options_.energy_threshold_db / 10.0);
+    for (size_t f = 0; f < frame_count; ++f) {
+        const float* src = pcmf32.data() + f * frame_samples;
+        double energy = 0.0;
+        for (size_t i = 0; i < frame_samples; ++i) {
+            energy += static_cast<double>(src[i]) * src[i];
+        }
+        speech[f] = energy / frame_samples > threshold;
+    }
+    return speech;
+}
+
+void SpeechTrimmer::smoothDecisions(std::vector<bool>& speech, int frame_ms) const {
+    const size_t min_silence_frames = static_cast<size_t>(std::max(options_.min_silence_ms, 0) / frame_ms);
+    const size_t min_speech_frames = static_cast<size_t>(std::max(options_.min_speech_ms, 0) / frame_ms);
+
+    // 语音之间的短停顿视为语音（首尾静音不受影响）
+    size_t last_speech_end = 0;
+    bool seen_speech = false;
+    for (size_t i = 0; i < speech.size(); ++i) {
+        if (!speech[i]) {
+            continue;
+        }
+        if (seen_speech && i - last_speech_end < min_silence_frames) {
+            std::fill(speech.begin() + last_speech_end, speech.begin() + i, true);
+        }
+        seen_speech = true;
+        last_speech_end = i + 1;
+    }
+
+    // 去掉孤立的短促噪声
+    for (size_t i = 0; i < speech.size();) {
+        if (!speech[i]) {
+            ++i;
+            continue;
+        }
+        size_t j = i;
+        while (j < speech.size() && speech[j]) {
+            ++j;
+        }
+        if (j - i < min_speech_frames) {
+            std::fill(speech.begin() + i, speech.begin() + j, false);
+        }
+        i = j;
+    }
+}
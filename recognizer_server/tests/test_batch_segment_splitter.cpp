@@ -0,0 +1,133 @@
+// splitBatchSegments单元测试：两段语音都一直持续到静音间隔边缘，
+// 检查片段按段分配、跨越段边界的片段触发单独重新识别
+#include "../include/batch_segment_splitter.h"
+#include <iostream>
+#include <string>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": 检查失败: " #cond << std::endl; \
+            ++failures; \
+        } \
+    } while (0)
+
+static TranscriptSegment makeSegment(const std::string& text, long long start_ms, long long end_ms) {
+    TranscriptSegment segment;
+    segment.text = text;
+    segment.start_ms = start_ms;
+    segment.end_ms = end_ms;
+    return segment;
+}
+
+// 两段4秒语音，中间是1秒静音间隔：[0, 4000) 间隔 [5000, 9000)
+static std::vector<BatchClipSpan> twoClips() {
+    BatchClipSpan first;
+    first.start_ms = 0;
+    first.end_ms = 4000;
+    BatchClipSpan second;
+    second.start_ms = 5000;
+    second.end_ms = 9000;
+    return {first, second};
+}
+
+// whisper在间隔处切分：各段拿到自己的文本，时间相对该段起点
+static void testSplitAtGap() {
+    std::vector<TranscriptSegment> segments = {
+        makeSegment("first", 0, 4000),
+        makeSegment("second", 5000, 9000),
+    };
+    BatchSplitResult result = splitBatchSegments(segments, twoClips());
+    
+    CHECK(!result.needs_rerun[0]);
+    CHECK(!result.needs_rerun[1]);
+    CHECK(result.clip_segments[0].size() == 1);
+    CHECK(result.clip_segments[1].size() == 1);
+    CHECK(result.clip_segments[0][0].text == "first");
+    CHECK(result.clip_segments[1][0].text == "second");
+    CHECK(result.clip_segments[1][0].start_ms == 0);
+    CHECK(result.clip_segments[1][0].end_ms == 4000);
+}
+
+// 片段结束时间落进静音间隔但没到下一段：仍归前一段，时间截断到段长度
+static void testSegmentEndingInGap() {
+    std::vector<TranscriptSegment> segments = {
+        makeSegment("first", 0, 4600),
+        makeSegment("second", 5000, 9000),
+    };
+    BatchSplitResult result = splitBatchSegments(segments, twoClips());
+    
+    CHECK(!result.needs_rerun[0]);
+    CHECK(!result.needs_rerun[1]);
+    CHECK(result.clip_segments[0].size() == 1);
+    CHECK(result.clip_segments[0][0].end_ms == 4000);
+    CHECK(result.clip_segments[1].size() == 1);
+}
+
+// 片段整个落在静音间隔内：按中点归入前一段
+static void testSegmentInsideGap() {
+    std::vector<TranscriptSegment> segments = {
+        makeSegment("first", 0, 4000),
+        makeSegment("tail", 4200, 4800),
+        makeSegment("second", 5000, 9000),
+    };
+    BatchSplitResult result = splitBatchSegments(segments, twoClips());
+    
+    CHECK(result.clip_segments[0].size() == 2);
+    CHECK(result.clip_segments[1].size() == 1);
+    CHECK(result.clip_segments[0][1].text == "tail");
+}
+
+// whisper没有在间隔处切分，一个片段覆盖两段语音：两段都需要重新识别，不分配任何文本
+static void testSegmentAcrossGap() {
+    std::vector<TranscriptSegment> segments = {
+        makeSegment("first", 0, 3000),
+        makeSegment("first tail second head", 3000, 6000),
+        makeSegment("second", 6000, 9000),
+    };
+    BatchSplitResult result = splitBatchSegments(segments, twoClips());
+    
+    CHECK(result.needs_rerun[0]);
+    CHECK(result.needs_rerun[1]);
+    CHECK(result.clip_segments[0].empty());
+    CHECK(result.clip_segments[1].empty());
+}
+
+// 只有跨越边界的相邻两段需要重新识别，其余段保持拆分结果
+static void testOnlyCrossedClipsRerun() {
+    std::vector<BatchClipSpan> clips = twoClips();
+    BatchClipSpan third;
+    third.start_ms = 10000;
+    third.end_ms = 12000;
+    clips.push_back(third);
+    
+    std::vector<TranscriptSegment> segments = {
+        makeSegment("first second", 2000, 7000),
+        makeSegment("third", 10000, 12000),
+    };
+    BatchSplitResult result = splitBatchSegments(segments, clips);
+    
+    CHECK(result.needs_rerun[0]);
+    CHECK(result.needs_rerun[1]);
+    CHECK(!result.needs_rerun[2]);
+    CHECK(result.clip_segments[2].size() == 1);
+    CHECK(result.clip_segments[2][0].start_ms == 0);
+    CHECK(result.clip_segments[2][0].end_ms == 2000);
+}
+
+int main() {
+    testSplitAtGap();
+    testSegmentEndingInGap();
+    testSegmentInsideGap();
+    testSegmentAcrossGap();
+    testOnlyCrossedClipsRerun();
+    
+    if (failures != 0) {
+        std::cerr << failures << " 项检查失败" << std::endl;
+        return 1;
+    }
+    std::cout << "batch_segment_splitter: 全部通过" << std::endl;
+    return 0;
+}
@@ -99,19 +99,21 @@ bool AudioCapture::start() {
 
 // 重命名并修改为线程安全的异步处理方法
 void AudioCapture::processAudioInThread(void* stream, int frames_per_buffer, int sample_rate) {
-    std::vector<float> buffer(frames_per_buffer);
     LOG_INFO("Audio capture started (async thread mode), segment length: " + 
             std::to_string(frames_per_buffer * 1000.0 / sample_rate) + " 毫秒");
     
+    // 直接读入缓冲区；推入队列后换回的是队列预分配的存储，循环中不再分配内存
+    AudioBuffer audio_buffer;
+    uint64_t dropped_buffers = 0;
+    
     while (running) {
-        PaError err = Pa_ReadStream(stream, buffer.data(), frames_per_buffer);
+        audio_buffer.data.resize(frames_per_buffer);
+        PaError err = Pa_ReadStream(stream, audio_buffer.data.data(), frames_per_buffer);
         if (err != paNoError) {
             LOG_ERROR("读取音频数据失败: " + std::string(Pa_GetErrorText(err)));
             break;
         }
         
-        AudioBuffer audio_buffer;
-        audio_buffer.data = buffer;
         audio_buffer.sample_rate = sample_rate;
         audio_buffer.channels = 1;
         audio_buffer.timestamp = std::chrono::system_clock::now();
@@ -121,10 +123,12 @@ void AudioCapture::processAudioInThread(void* stream, int frames_per_buffer, int
         // 根据是否启用分段选择单一处理路径，避免重复处理
         if (segmentation_enabled && segment_handler) {
             // 启用分段时，只发送到分段处理器
-            segment_handler->addBuffer(audio_buffer);
+            segment_handler->addBuffer(std::move(audio_buffer));
         } else {
-            // 未启用分段时，发送到音频队列
-            queue->push(audio_buffer);
+            // 未启用分段时，发送到音频队列；队列满说明消费者跟不上，丢弃该帧而不阻塞采集
+            if (!queue->push(std::move(audio_buffer)) && (dropped_buffers++ % 100) == 0) {
+                LOG_WARNING("音频队列已满，丢弃采集缓冲区（累计 " + std::to_string(dropped_buffers) + " 个）");
+            }
         }
         
         // 添加短暂延迟，避免CPU占用过高
@@ -138,10 +142,10 @@ void AudioCapture::processAudioInThread(void* stream, int frames_per_buffer, int
         
         if (segmentation_enabled && segment_handler) {
             // 启用分段时，只发送到分段处理器
-            segment_handler->addBuffer(last_buffer);
+            segment_handler->addBuffer(std::move(last_buffer));
         } else {
             // 未启用分段时，发送到音频队列
-            queue->push(last_buffer);
+            queue->push(std::move(last_buffer), true);
         }
     }
     
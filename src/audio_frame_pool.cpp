@@ -0,0 +1,80 @@
+#include "audio_frame_pool.h"
+#include "log_utils.h"
+#include <algorithm>
+
+// 归还时容量超过默认值的该倍数则收缩，避免偶发的大缓冲区长期占用内存
+static constexpr size_t MAX_CAPACITY_FACTOR = 8;
+
+AudioFramePool& AudioFramePool::getInstance() {
+    // 有意不析构：静态对象析构时可能仍有帧被引用
+    static AudioFramePool* instance = new AudioFramePool();
+    return *instance;
+}
+
+AudioFramePool::AudioFramePool(size_t frame_samples, size_t frames_per_slab)
+    : frame_samples(frame_samples)
+    , frames_per_slab(std::max<size_t>(frames_per_slab, 1)) {
+}
+
+AudioFramePool::~AudioFramePool() {
+    if (frames_in_use > 0) {
+        LOG_WARNING("音频帧池销毁时仍有 " + std::to_string(frames_in_use) + " 个帧未归还");
+    }
+}
+
+AudioFrameRef AudioFramePool::acquire() {
+    AudioFrame* frame = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!free_list) {
+            addSlab();
+        }
+        frame = free_list;
+        free_list = frame->next_free;
+        frame->next_free = nullptr;
+
+        frames_in_use++;
+        peak_in_use = std::max(peak_in_use, frames_in_use);
+    }
+    return AudioFrameRef(frame);
+}
+
+void AudioFramePool::release(AudioFrame* frame) {
+    // 在锁外清理存储
+    if (frame->samples.capacity() > frame_samples * MAX_CAPACITY_FACTOR) {
+        std::vector<float>().swap(frame->samples);
+        frame->samples.reserve(frame_samples);
+    } else {
+        frame->samples.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    frame->next_free = free_list;
+    free_list = frame;
+    frames_in_use--;
+}
+
+void AudioFramePool::addSlab() {
+    std::unique_ptr<AudioFrame[]> slab(new AudioFrame[frames_per_slab]);
+    for (size_t i = 0; i < frames_per_slab; ++i) {
+        AudioFrame& frame = slab[i];
+        frame.pool = this;
+        frame.samples.reserve(frame_samples);
+        frame.next_free = free_list;
+        free_list = &frame;
+    }
+    slabs.push_back(std::move(slab));
+
+    LOG_INFO("音频帧池扩容: " + std::to_string(slabs.size()) + " 个slab，共 " +
+             std::to_string(slabs.size() * frames_per_slab) + " 帧");
+}
+
+AudioFramePoolStats AudioFramePool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    AudioFramePoolStats stats;
+    stats.slabs = slabs.size();
+    stats.frames_total = slabs.size() * frames_per_slab;
+    stats.frames_in_use = frames_in_use;
+    stats.peak_in_use = peak_in_use;
+    return stats;
+}
@@ -1,12 +1,14 @@
 ﻿#include "audio_handlers.h"
 #include "audio_processor.h"  // 包含 AudioProcessor 以获取 RecognitionMode
 #include "log_utils.h"
+#include "audio_resampler.h"
 #include <fstream>
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <vector>
 #include <cstring>
+#include <algorithm>
 
 // FileAudioInput 实现
 FileAudioInput::FileAudioInput(AudioQueue* queue, bool fast_mode)
@@ -38,6 +40,13 @@ void FileAudioInput::setFastMode(bool fast_mode) {
     // 如果文件处理正在进行中，可能需要重新启动处理才能完全应用新设置
 }
 
+void FileAudioInput::setDownmixMode(DownmixMode mode, int channel) {
+    downmix_mode = mode;
+    downmix_channel = channel;
+    LOG_INFO(std::string("File downmix mode set to: ") + ChannelDownmixer::getModeName(mode) +
+             (mode == DownmixMode::SelectChannel ? " " + std::to_string(channel) : ""));
+}
+
 // 实现seekToPosition方法用于视频同步
 void FileAudioInput::seekToPosition(qint64 position_ms) {
     // 更新当前位置
@@ -115,48 +124,34 @@ void FileAudioInput::processFile() {
         std::this_thread::sleep_for(std::chrono::milliseconds(1000));
         LOG_INFO("开始处理音频文件: " + file_path + "（与播放器同步）");
         
-        // 串行化文件访问 - 避免并发内存分配
-        std::unique_ptr<std::ifstream> file;
-        try {
-            file = std::make_unique<std::ifstream>(file_path, std::ios::binary);
-        } catch (const std::exception& e) {
-            LOG_ERROR("Failed to create file stream: " + std::string(e.what()));
-            is_running = false;
-            return;
-        }
-        
-        if (!file->is_open()) {
-            LOG_ERROR("Failed to open audio file: " + file_path);
+        // 按RIFF块解析WAV文件，数据块位置和格式均以文件实际内容为准
+        WavReader reader;
+        if (!reader.open(file_path)) {
+            LOG_ERROR("Failed to open audio file: " + file_path + " (" + reader.getError() + ")");
             is_running = false;
             return;
         }
         
-        // 获取文件大小
-        file->seekg(0, std::ios::end);
-        size_t fileSize = file->tellg();
-        file->seekg(0, std::ios::beg);
-        
-        // 串行化WAV头读取 - 预分配固定大小内存
-        constexpr size_t WAV_HEADER_SIZE = 44;  // 标准WAV头大小
-        std::vector<char> header;
-        header.reserve(WAV_HEADER_SIZE); // 预分配，避免动态扩展
-        header.resize(WAV_HEADER_SIZE);  // 设置为固定大小
-        
-        file->read(header.data(), WAV_HEADER_SIZE);
-        
-        // 提取采样率、位深度和通道数等信息
-        // 这里简化处理，实际应用可能需要更详细的WAV头解析
-        int sampleRate = *reinterpret_cast<int*>(&header[24]);
-        int channels = *reinterpret_cast<short*>(&header[22]);
-        int bitsPerSample = *reinterpret_cast<short*>(&header[34]);
+        const WavFormat& format = reader.getFormat();
+        const int sampleRate = format.sample_rate;
+        const int channels = format.channels;
+        const uint64_t totalFrames = reader.getTotalFrames();
         
         LOG_INFO("Processing audio file: " + file_path);
         LOG_INFO("Sample rate: " + std::to_string(sampleRate) + ", Channels: " + 
-                 std::to_string(channels) + ", Bits per sample: " + std::to_string(bitsPerSample));
-        
-        // 计算每个样本的字节数
-        int bytesPerSample = bitsPerSample / 8;
-        int bytesPerFrame = bytesPerSample * channels;
+                 std::to_string(channels) + ", Bits per sample: " + std::to_string(format.bits_per_sample) +
+                 (format.is_float ? " (float)" : "") + ", Frames: " + std::to_string(totalFrames));
+        
+        // 多声道文件按配置下混为单声道
+        ChannelDownmixer downmixer;
+        downmixer.setMode(downmix_mode, downmix_channel);
+        if (channels > 1) {
+            std::string downmix_desc = ChannelDownmixer::getModeName(downmix_mode);
+            if (downmix_mode == DownmixMode::SelectChannel) {
+                downmix_desc += " " + std::to_string(std::min(downmix_channel, channels - 1));
+            }
+            LOG_INFO("Downmixing " + std::to_string(channels) + " channels to mono: " + downmix_desc);
+        }
         
         // 根据模式确定缓冲区大小
         // 快速模式使用更大的缓冲区，实时模式使用较小的缓冲区以模拟实时输入
@@ -164,15 +159,15 @@ void FileAudioInput::processFile() {
         constexpr size_t BUFFER_FRAMES_REALTIME = 1600; // 实时模式下的帧数（0.1秒，1600帧@16kHz）
         
         size_t bufferFrames = fast_mode ? BUFFER_FRAMES_FAST : BUFFER_FRAMES_REALTIME;
-        size_t bufferSize = bufferFrames * bytesPerFrame;
+        // 按文件采样率换算，保证每个缓冲区的时长与16kHz时相同
+        if (sampleRate > 16000) {
+            bufferFrames = bufferFrames * sampleRate / 16000;
+        }
         
-        // 串行化缓冲区分配 - 预分配所有必要的内存
-        std::vector<char> buffer;
-        buffer.reserve(bufferSize);
-        buffer.resize(bufferSize);
+        // 各声道平面，读取器在调用之间复用其存储
+        std::vector<std::vector<float>> planes;
         
         // 用于统计处理进度
-        size_t totalBytesRead = WAV_HEADER_SIZE;
         int progressPercent = 0;
         int lastReportedPercent = 0;
         
@@ -185,15 +180,19 @@ void FileAudioInput::processFile() {
         auto lastProcessTime = std::chrono::steady_clock::now();
         auto lastYieldTime = std::chrono::steady_clock::now(); // 添加定期释放控制权的计时器
         
-        // 串行化音频数据处理内存 - 预分配转换缓冲区
-        const size_t MAX_AUDIO_SAMPLES = bufferSize / bytesPerSample;
+        // 串行化音频数据处理内存 - 预分配下混后的单声道缓冲区
+        const size_t MAX_AUDIO_SAMPLES = bufferFrames;
         std::vector<float> audioData;
         audioData.reserve(MAX_AUDIO_SAMPLES); // 预分配最大可能大小
         
-        // 串行化批处理转换内存 - 预分配批处理缓冲区
-        const size_t CONVERSION_BATCH_SIZE = 4096;
+        // 识别链路固定为16kHz，其他采样率的文件在读取时流式重采样
+        std::unique_ptr<AudioResampler> resampler;
+        if (sampleRate > 0 && sampleRate != 16000) {
+            resampler = std::make_unique<AudioResampler>(sampleRate, 16000);
+            LOG_INFO("Resampling audio file from " + std::to_string(sampleRate) + " Hz to 16000 Hz");
+        }
         
-        while (is_running && file->good() && !file->eof()) {
+        while (is_running) {
             // 定期检查是否需要释放控制权，避免长时间占用CPU
             auto now = std::chrono::steady_clock::now();
             auto yield_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -205,19 +204,20 @@ void FileAudioInput::processFile() {
                 lastYieldTime = now;
             }
             
-            // 读取音频数据
-            file->read(buffer.data(), bufferSize);
-            size_t bytesRead = file->gcount();
+            // 读取音频数据，转换为浮点并拆分为各声道平面
+            size_t framesRead = reader.readFrames(bufferFrames, planes);
             
-            if (bytesRead == 0) {
+            if (framesRead == 0) {
+                if (!reader.getError().empty()) {
+                    LOG_ERROR("Failed to read audio file: " + reader.getError());
+                }
                 // 文件结束，退出循环
-                LOG_INFO("Reached end of file (bytesRead == 0), breaking from reading loop");
+                LOG_INFO("Reached end of file (framesRead == 0), breaking from reading loop");
                 break;
             }
             
             // 更新进度（减少日志频率以避免过多输出）
-            totalBytesRead += bytesRead;
-            int newProgressPercent = static_cast<int>(100.0 * totalBytesRead / fileSize);
+            int newProgressPercent = totalFrames > 0 ? static_cast<int>(100.0 * reader.getPosition() / totalFrames) : 100;
             if (newProgressPercent > progressPercent) {
                 progressPercent = newProgressPercent;
                 // 减少日志输出频率，只在25%的倍数时报告进度
@@ -227,65 +227,17 @@ void FileAudioInput::processFile() {
                 }
             }
             
-            // 串行化音频数据转换 - 计算实际样本数，避免重复分配
-            size_t actualSamples = bytesRead / bytesPerSample;
-            if (audioData.size() != actualSamples) {
-                audioData.resize(actualSamples); // 只在必要时调整大小
-            }
-            
-            // 串行化批处理音频转换，避免一次处理过多数据
-            size_t totalSamples = audioData.size();
-            
-            for (size_t batch_start = 0; batch_start < totalSamples; batch_start += CONVERSION_BATCH_SIZE) {
-                size_t batch_end = std::min(batch_start + CONVERSION_BATCH_SIZE, totalSamples);
-            
-            // 转换为浮点数，支持不同位深度
-            if (bitsPerSample == 16) {
-                const int16_t* samples = reinterpret_cast<const int16_t*>(buffer.data());
-                    for (size_t i = batch_start; i < batch_end; ++i) {
-                    audioData[i] = samples[i] / 32768.0f;
-                }
-            } else if (bitsPerSample == 32) {
-                const int32_t* samples = reinterpret_cast<const int32_t*>(buffer.data());
-                    for (size_t i = batch_start; i < batch_end; ++i) {
-                    audioData[i] = samples[i] / 2147483648.0f;
-                }
-            } else if (bitsPerSample == 8) {
-                const uint8_t* samples = reinterpret_cast<const uint8_t*>(buffer.data());
-                    for (size_t i = batch_start; i < batch_end; ++i) {
-                    audioData[i] = (samples[i] - 128) / 128.0f;
-                }
-            } else {
-                LOG_ERROR("Unsupported bits per sample: " + std::to_string(bitsPerSample));
-                is_running = false;
-                return;
-                }
-                
-                // 在每个批次之间稍作停顿，避免CPU过载
-                if (batch_end < totalSamples && (batch_end - batch_start) == CONVERSION_BATCH_SIZE) {
-                    std::this_thread::sleep_for(std::chrono::microseconds(100));
-                }
-            }
+            // 下混为单声道（单声道文件直接复制）
+            downmixer.process(planes, framesRead, audioData);
+            std::vector<float> processedAudioData = std::move(audioData);
             
-            // 串行化单声道转换 - 预分配单声道缓冲区
-            std::vector<float> processedAudioData;
-            if (channels > 1) {
-                size_t monoSamples = audioData.size() / channels;
-                processedAudioData.reserve(monoSamples); // 预分配
-                processedAudioData.resize(monoSamples);  // 设置大小
-                
-                // 串行化复制，仅保留第一个通道的数据（单声道）
-                for (size_t i = 0; i < monoSamples; ++i) {
-                    processedAudioData[i] = audioData[i * channels]; // 只保留第一个通道
-                }
-            } else {
-                // 单声道，直接移动数据避免复制
-                processedAudioData = std::move(audioData);
+            // 非16kHz的数据重采样到16kHz，重采样器跨块保留状态，块边界连续
+            if (resampler) {
+                std::vector<float> resampledAudioData;
+                resampler->process(processedAudioData, resampledAudioData);
+                processedAudioData = std::move(resampledAudioData);
             }
             
-            // 注意：假设输入音频已经是16000Hz采样率（视频预处理时已转换）
-            // 如果实际采样率不是16000Hz，可能需要在上层进行预处理
-            
             // 串行化创建音频缓冲区 - 避免多次内存分配
             AudioBuffer audio_buffer;
             audio_buffer.data = std::move(processedAudioData); // 移动语义，避免复制
@@ -331,11 +283,11 @@ void FileAudioInput::processFile() {
                     }
                     
                     // 发送到segment_handler
-                    segment_handler->addBuffer(audio_buffer);
+                    segment_handler->addBuffer(std::move(audio_buffer));
                     //LOG_INFO("文件音频缓冲区发送到实时分段处理器（保持实时速度）");
                 } else {
                     LOG_ERROR("实时分段已启用但segment_handler为空，回退到队列处理");
-                    queue->push(audio_buffer);
+                    queue->push(std::move(audio_buffer), true);
                 }
             } else {
                 // 未启用实时分段：使用传统的队列处理路径
@@ -347,7 +299,7 @@ void FileAudioInput::processFile() {
                 // 当积累足够的缓冲区时，串行推送所有数据
                 if (batchBuffers.size() >= batchSize) {
                     for (auto& buf : batchBuffers) {
-                        queue->push(buf);
+                        queue->push(std::move(buf), true);
                     }
                     batchBuffers.clear();
                     // 重新预分配以保持容量
@@ -378,28 +330,33 @@ void FileAudioInput::processFile() {
                 }
                 
                 // 推送缓冲区
-                queue->push(audio_buffer);
+                queue->push(std::move(audio_buffer), true);
                 
                 // 更新处理时间
                 lastProcessTime = std::chrono::steady_clock::now();
                 }
             }
             
+            // 回收队列交还的预分配存储，下一轮转换时无需重新分配
+            if (audioData.capacity() == 0) {
+                audioData.swap(audio_buffer.data);
+            }
+            
             // 检查是否需要跳转到特定位置
             qint64 target_pos = current_position.load();
             if (target_pos > 0) {
-                // 计算文件位置
-                int64_t sample_pos = (target_pos * sampleRate) / 1000; // 毫秒转换为样本
-                int64_t byte_pos = WAV_HEADER_SIZE + sample_pos * bytesPerFrame;
+                // 计算帧位置
+                uint64_t frame_pos = static_cast<uint64_t>(target_pos) * sampleRate / 1000; // 毫秒转换为帧
                 
                 // 确保位置在文件范围内
-                if (byte_pos < fileSize) {
-                    //LOG_INFO("Seeking to position: " + std::to_string(target_pos) + " ms (byte: " + std::to_string(byte_pos) + ")");
-                    file->clear(); // 清除可能的EOF标志
-                    file->seekg(byte_pos);
+                if (frame_pos < totalFrames && reader.seekToFrame(frame_pos)) {
+                    //LOG_INFO("Seeking to position: " + std::to_string(target_pos) + " ms (frame: " + std::to_string(frame_pos) + ")");
                     
-                    // 重置进度状态
-                    totalBytesRead = byte_pos;
+                    // 跳转后的数据与之前不连续，清空重采样历史和声道能量统计
+                    if (resampler) {
+                        resampler->reset();
+                    }
+                    downmixer.reset();
                     
                     // 清空批次缓冲区，确保新位置的数据立即处理
                     batchBuffers.clear();
@@ -438,19 +395,19 @@ void FileAudioInput::processFile() {
                 
                 if (segment_handler) {
                     for (auto& buf : batchBuffers) {
-                        segment_handler->addBuffer(buf);
+                        segment_handler->addBuffer(std::move(buf));
                     }
                     LOG_INFO("Remaining buffers sent to segment handler");
                 } else {
                     LOG_ERROR("实时分段已启用但segment_handler为空，回退到队列处理");
                     for (auto& buf : batchBuffers) {
-                        queue->push(buf);
+                        queue->push(std::move(buf), true);
                     }
                 }
             } else {
                 // 未启用实时分段：发送到队列
             for (auto& buf : batchBuffers) {
-                queue->push(buf);
+                queue->push(std::move(buf), true);
                 }
             }
             
@@ -492,16 +449,16 @@ void FileAudioInput::processFile() {
             auto segment_handler = processor->getSegmentHandler();
             
             if (segment_handler) {
-                segment_handler->addBuffer(last_buffer);
+                segment_handler->addBuffer(std::move(last_buffer));
                 LOG_INFO("Sending final end-of-file marker to segment handler");
             } else {
                 LOG_ERROR("实时分段已启用但segment_handler为空，回退到队列处理");
-                queue->push(last_buffer);
+                queue->push(std::move(last_buffer), true);
                 LOG_INFO("Sending final end-of-file marker to audio queue (fallback)");
             }
         } else {
             // 未启用实时分段：发送到队列
-            queue->push(last_buffer);
+            queue->push(std::move(last_buffer), true);
         LOG_INFO("Sending final end-of-file marker to audio queue");
         }
         
@@ -627,20 +584,6 @@ void Translator::setDualLanguage(bool enable) {
     // 如果正在进行翻译，可能需要重新启动翻译器才能完全应用新设置
 }
 
-// 实现AudioQueue的reset方法
-void AudioQueue::reset() {
-    std::lock_guard<std::mutex> lock(mutex);
-    // 清空队列
-    std::queue<AudioBuffer> empty;
-    std::swap(queue, empty);
-    // 重置终止标志
-    terminated = false;
-    // 通知所有等待的线程
-    condition.notify_all();
-    
-    LOG_INFO("Audio queue reset completed");
-}
-
 // 实现ResultQueue的reset方法
 void ResultQueue::reset() {
     std::lock_guard<std::mutex> lock(mutex);
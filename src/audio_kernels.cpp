@@ -0,0 +1,980 @@
+#include "audio_kernels.h"
+#include "log_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 逐位一致依赖于乘法和加法不被合并为FMA（MSVC的/fp:precise默认不合并）
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define AUDIO_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__GNUC__)
+#define AUDIO_KERNELS_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AUDIO_KERNELS_AVX2_TARGET
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define AUDIO_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr size_t LANES = 8;  // 平方和的交错累加路数，与AVX2的一个寄存器、SSE2/NEON的两个寄存器对应
+constexpr float INT16_TO_FLOAT = 1.0f / 32768.0f;  // 2的幂，乘法与除以32768结果相同
+
+inline float clampUnit(float value) {
+    return (value < -1.0f) ? -1.0f : (1.0f < value) ? 1.0f : value;
+}
+
+// 固定的合并顺序，所有实现共用
+inline float combineLanes(const float* lanes) {
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+}
+
+inline float combinePeaks(const float* peaks) {
+    float peak = 0.0f;
+    for (size_t j = 0; j < LANES; ++j) {
+        peak = std::max(peak, peaks[j]);
+    }
+    return peak;
+}
+
+inline float pointwiseSample(float value, const PointwiseChainParams& params, float slope) {
+    if (params.apply_gain) {
+        value = clampUnit(value * params.gain);
+    }
+    if (params.apply_compression) {
+        const float magnitude = std::fabs(value);
+        if (magnitude > params.compression_threshold) {
+            const float reduction = 1.0f + (params.compression_threshold - magnitude) * slope /
+                                    params.compression_threshold;
+            value *= reduction;
+        }
+        value = clampUnit(value);
+    }
+    if (params.apply_final_gain) {
+        value = clampUnit(value * params.final_gain);
+    }
+    return value;
+}
+
+inline float compressionSlope(const PointwiseChainParams& params) {
+    return 1.0f - 1.0f / params.compression_ratio;
+}
+
+// 预加重的尾部与头部：按样本从后往前处理，保证读取的前一个样本仍是原始值
+// 顺序为：尾部（不足8个的部分）-> 完整块（从后往前）-> 第一个块 -> 第0个样本
+void preEmphasisRange(float* data, size_t first, size_t last, float coef, float* lanes) {
+    for (size_t i = last; i >= first && i > 0; --i) {
+        const float value = data[i] - coef * data[i - 1];
+        data[i] = value;
+        lanes[i % LANES] += value * value;
+        if (i == first) {
+            break;
+        }
+    }
+}
+
+// ============ 标量实现 ============
+
+AudioBufferStats analyzeScalar(const float* data, size_t count) {
+    float lanes[LANES] = {};
+    float peaks[LANES] = {};
+    for (size_t i = 0; i < count; ++i) {
+        const float value = data[i];
+        lanes[i % LANES] += value * value;
+        peaks[i % LANES] = std::max(peaks[i % LANES], std::fabs(value));
+    }
+    AudioBufferStats stats;
+    stats.sum_squares = combineLanes(lanes);
+    stats.peak = combinePeaks(peaks);
+    return stats;
+}
+
+float preEmphasisScalar(float* data, size_t count, float coef) {
+    if (count == 0) {
+        return 0.0f;
+    }
+    float lanes[LANES] = {};
+    const size_t full = count / LANES * LANES;
+    if (count > std::max<size_t>(full, 1)) {
+        preEmphasisRange(data, std::max<size_t>(full, 1), count - 1, coef, lanes);
+    }
+    for (size_t block = full / LANES; block-- > 1;) {
+        preEmphasisRange(data, block * LANES, block * LANES + LANES - 1, coef, lanes);
+    }
+    if (full >= LANES) {
+        preEmphasisRange(data, 1, LANES - 1, coef, lanes);
+    }
+    lanes[0] += data[0] * data[0];
+    return combineLanes(lanes);
+}
+
+float scaleClampScalar(float* data, size_t count, float scale) {
+    float lanes[LANES] = {};
+    for (size_t i = 0; i < count; ++i) {
+        const float value = clampUnit(data[i] * scale);
+        data[i] = value;
+        lanes[i % LANES] += value * value;
+    }
+    return combineLanes(lanes);
+}
+
+AudioBufferStats pointwiseScalar(float* data, size_t count, const PointwiseChainParams& params) {
+    const float slope = compressionSlope(params);
+    float lanes[LANES] = {};
+    float peaks[LANES] = {};
+    for (size_t i = 0; i < count; ++i) {
+        const float value = pointwiseSample(data[i], params, slope);
+        data[i] = value;
+        lanes[i % LANES] += value * value;
+        peaks[i % LANES] = std::max(peaks[i % LANES], std::fabs(value));
+    }
+    AudioBufferStats stats;
+    stats.sum_squares = combineLanes(lanes);
+    stats.peak = combinePeaks(peaks);
+    return stats;
+}
+
+void floatToInt16Scalar(const float* input, size_t count, int16_t* output) {
+    for (size_t i = 0; i < count; ++i) {
+        output[i] = static_cast<int16_t>(clampUnit(input[i]) * 32767.0f);
+    }
+}
+
+void int16ToFloatScalar(const int16_t* input, size_t count, float* output) {
+    for (size_t i = 0; i < count; ++i) {
+        output[i] = static_cast<float>(input[i]) * INT16_TO_FLOAT;
+    }
+}
+
+// 拆分第first到last-1帧，向量实现用它处理不足一个块的尾部
+void deinterleaveRange(const float* input, size_t first, size_t last, int channels, float* const* planes) {
+    for (int c = 0; c < channels; ++c) {
+        float* plane = planes[c];
+        for (size_t i = first; i < last; ++i) {
+            plane[i] = input[i * channels + c];
+        }
+    }
+}
+
+void deinterleaveScalar(const float* input, size_t frames, int channels, float* const* planes) {
+    deinterleaveRange(input, 0, frames, channels, planes);
+}
+
+// 按声道顺序累加后乘1/channels，向量实现的每个通道做同样的运算
+void averageChannelsRange(const float* const* planes, int channels, size_t first, size_t last, float* output) {
+    const float scale = 1.0f / static_cast<float>(channels);
+    for (size_t i = first; i < last; ++i) {
+        float sum = planes[0][i];
+        for (int c = 1; c < channels; ++c) {
+            sum += planes[c][i];
+        }
+        output[i] = sum * scale;
+    }
+}
+
+void averageChannelsScalar(const float* const* planes, int channels, size_t frames, float* output) {
+    averageChannelsRange(planes, channels, 0, frames, output);
+}
+
+// 尾部样本（不足一个完整块）按标量方式累加到各路
+void finishTail(float* data, size_t start, size_t count, float* lanes, float* peaks,
+                const PointwiseChainParams* params) {
+    const float slope = params ? compressionSlope(*params) : 0.0f;
+    for (size_t i = start; i < count; ++i) {
+        float value = data[i];
+        if (params) {
+            value = pointwiseSample(value, *params, slope);
+            data[i] = value;
+        }
+        lanes[i % LANES] += value * value;
+        peaks[i % LANES] = std::max(peaks[i % LANES], std::fabs(value));
+    }
+}
+
+#if defined(AUDIO_KERNELS_X86)
+
+// ============ SSE2实现（x64基线指令集）============
+
+inline __m128 clampUnitSse(__m128 value) {
+    // 操作数顺序保证NaN的传播与标量clamp一致
+    return _mm_min_ps(_mm_set1_ps(1.0f), _mm_max_ps(_mm_set1_ps(-1.0f), value));
+}
+
+inline __m128 absSse(__m128 value) {
+    return _mm_and_ps(value, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+}
+
+inline __m128 pointwiseSse(__m128 value, const PointwiseChainParams& params, float slope) {
+    if (params.apply_gain) {
+        value = clampUnitSse(_mm_mul_ps(value, _mm_set1_ps(params.gain)));
+    }
+    if (params.apply_compression) {
+        const __m128 threshold = _mm_set1_ps(params.compression_threshold);
+        const __m128 magnitude = absSse(value);
+        const __m128 mask = _mm_cmpgt_ps(magnitude, threshold);
+        const __m128 reduction = _mm_add_ps(_mm_set1_ps(1.0f),
+            _mm_div_ps(_mm_mul_ps(_mm_sub_ps(threshold, magnitude), _mm_set1_ps(slope)), threshold));
+        const __m128 compressed = _mm_mul_ps(value, reduction);
+        value = clampUnitSse(_mm_or_ps(_mm_and_ps(mask, compressed), _mm_andnot_ps(mask, value)));
+    }
+    if (params.apply_final_gain) {
+        value = clampUnitSse(_mm_mul_ps(value, _mm_set1_ps(params.final_gain)));
+    }
+    return value;
+}
+
+AudioBufferStats analyzeSse2(const float* data, size_t count) {
+    __m128 acc_lo = _mm_setzero_ps(), acc_hi = _mm_setzero_ps();
+    __m128 peak_lo = _mm_setzero_ps(), peak_hi = _mm_setzero_ps();
+    const size_t full = count / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        const __m128 lo = _mm_loadu_ps(data + i);
+        const __m128 hi = _mm_loadu_ps(data + i + 4);
+        acc_lo = _mm_add_ps(acc_lo, _mm_mul_ps(lo, lo));
+        acc_hi = _mm_add_ps(acc_hi, _mm_mul_ps(hi, hi));
+        peak_lo = _mm_max_ps(absSse(lo), peak_lo);
+        peak_hi = _mm_max_ps(absSse(hi), peak_hi);
+    }
+    float lanes[LANES], peaks[LANES];
+    _mm_storeu_ps(lanes, acc_lo);
+    _mm_storeu_ps(lanes + 4, acc_hi);
+    _mm_storeu_ps(peaks, peak_lo);
+    _mm_storeu_ps(peaks + 4, peak_hi);
+    finishTail(const_cast<float*>(data), full, count, lanes, peaks, nullptr);
+
+    AudioBufferStats stats;
+    stats.sum_squares = combineLanes(lanes);
+    stats.peak = combinePeaks(peaks);
+    return stats;
+}
+
+float preEmphasisSse2(float* data, size_t count, float coef) {
+    if (count == 0) {
+        return 0.0f;
+    }
+    float lanes[LANES] = {};
+    const size_t full = count / LANES * LANES;
+    if (count > std::max<size_t>(full, 1)) {
+        preEmphasisRange(data, std::max<size_t>(full, 1), count - 1, coef, lanes);
+    }
+
+    __m128 acc_lo = _mm_loadu_ps(lanes), acc_hi = _mm_loadu_ps(lanes + 4);
+    const __m128 c = _mm_set1_ps(coef);
+    for (size_t block = full / LANES; block-- > 1;) {
+        float* p = data + block * LANES;
+        const __m128 lo = _mm_sub_ps(_mm_loadu_ps(p), _mm_mul_ps(c, _mm_loadu_ps(p - 1)));
+        const __m128 hi = _mm_sub_ps(_mm_loadu_ps(p + 4), _mm_mul_ps(c, _mm_loadu_ps(p + 3)));
+        _mm_storeu_ps(p, lo);
+        _mm_storeu_ps(p + 4, hi);
+        acc_lo = _mm_add_ps(acc_lo, _mm_mul_ps(lo, lo));
+        acc_hi = _mm_add_ps(acc_hi, _mm_mul_ps(hi, hi));
+    }
+    _mm_storeu_ps(lanes, acc_lo);
+    _mm_storeu_ps(lanes + 4, acc_hi);
+
+    if (full >= LANES) {
+        preEmphasisRange(data, 1, LANES - 1, coef, lanes);
+    }
+    lanes[0] += data[0] * data[0];
+    return combineLanes(lanes);
+}
+
+float scaleClampSse2(float* data, size_t count, float scale) {
+    __m128 acc_lo = _mm_setzero_ps(), acc_hi = _mm_setzero_ps();
+    const __m128 s = _mm_set1_ps(scale);
+    const size_t full = count / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        const __m128 lo = clampUnitSse(_mm_mul_ps(_mm_loadu_ps(data + i), s));
+        const __m128 hi = clampUnitSse(_mm_mul_ps(_mm_loadu_ps(data + i + 4), s));
+        _mm_storeu_ps(data + i, lo);
+        _mm_storeu_ps(data + i + 4, hi);
+        acc_lo = _mm_add_ps(acc_lo, _mm_mul_ps(lo, lo));
+        acc_hi = _mm_add_ps(acc_hi, _mm_mul_ps(hi, hi));
+    }
+    float lanes[LANES];
+    _mm_storeu_ps(lanes, acc_lo);
+    _mm_storeu_ps(lanes + 4, acc_hi);
+    for (size_t i = full; i < count; ++i) {
+        const float value = clampUnit(data[i] * scale);
+        data[i] = value;
+        lanes[i % LANES] += value * value;
+    }
+    return combineLanes(lanes);
+}
+
+AudioBufferStats pointwiseSse2(float* data, size_t count, const PointwiseChainParams& params) {
+    const float slope = compressionSlope(params);
+    __m128 acc_lo = _mm_setzero_ps(), acc_hi = _mm_setzero_ps();
+    __m128 peak_lo = _mm_setzero_ps(), peak_hi = _mm_setzero_ps();
+    const size_t full = count / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        const __m128 lo = pointwiseSse(_mm_loadu_ps(data + i), params, slope);
+        const __m128 hi = pointwiseSse(_mm_loadu_ps(data + i + 4), params, slope);
+        _mm_storeu_ps(data + i, lo);
+        _mm_storeu_ps(data + i + 4, hi);
+        acc_lo = _mm_add_ps(acc_lo, _mm_mul_ps(lo, lo));
+        acc_hi = _mm_add_ps(acc_hi, _mm_mul_ps(hi, hi));
+        peak_lo = _mm_max_ps(absSse(lo), peak_lo);
+        peak_hi = _mm_max_ps(absSse(hi), peak_hi);
+    }
+    float lanes[LANES], peaks[LANES];
+    _mm_storeu_ps(lanes, acc_lo);
+    _mm_storeu_ps(lanes + 4, acc_hi);
+    _mm_storeu_ps(peaks, peak_lo);
+    _mm_storeu_ps(peaks + 4, peak_hi);
+    finishTail(data, full, count, lanes, peaks, &params);
+
+    AudioBufferStats stats;
+    stats.sum_squares = combineLanes(lanes);
+    stats.peak = combinePeaks(peaks);
+    return stats;
+}
+
+void floatToInt16Sse2(const float* input, size_t count, int16_t* output) {
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const size_t full = count / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        // 限幅后不会超出int16范围，饱和打包与直接截断结果相同
+        const __m128i lo = _mm_cvttps_epi32(_mm_mul_ps(clampUnitSse(_mm_loadu_ps(input + i)), scale));
+        const __m128i hi = _mm_cvttps_epi32(_mm_mul_ps(clampUnitSse(_mm_loadu_ps(input + i + 4)), scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_packs_epi32(lo, hi));
+    }
+    floatToInt16Scalar(input + full, count - full, output + full);
+}
+
+void int16ToFloatSse2(const int16_t* input, size_t count, float* output) {
+    const __m128 scale = _mm_set1_ps(INT16_TO_FLOAT);
+    const size_t full = count / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        // 与自身交错后算术右移16位，完成符号扩展
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    int16ToFloatScalar(input + full, count - full, output + full);
+}
+
+// 只有立体声按块拆分，其他声道数的步长不规则，按标量处理
+void deinterleaveSse2(const float* input, size_t frames, int channels, float* const* planes) {
+    if (channels != 2) {
+        deinterleaveScalar(input, frames, channels, planes);
+        return;
+    }
+    const size_t full = frames / 4 * 4;
+    for (size_t i = 0; i < full; i += 4) {
+        const __m128 a = _mm_loadu_ps(input + 2 * i);      // L0 R0 L1 R1
+        const __m128 b = _mm_loadu_ps(input + 2 * i + 4);  // L2 R2 L3 R3
+        _mm_storeu_ps(planes[0] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(planes[1] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    deinterleaveRange(input, full, frames, channels, planes);
+}
+
+void averageChannelsSse2(const float* const* planes, int channels, size_t frames, float* output) {
+    const __m128 scale = _mm_set1_ps(1.0f / static_cast<float>(channels));
+    const size_t full = frames / 4 * 4;
+    for (size_t i = 0; i < full; i += 4) {
+        __m128 sum = _mm_loadu_ps(planes[0] + i);
+        for (int c = 1; c < channels; ++c) {
+            sum = _mm_add_ps(sum, _mm_loadu_ps(planes[c] + i));
+        }
+        _mm_storeu_ps(output + i, _mm_mul_ps(sum, scale));
+    }
+    averageChannelsRange(planes, channels, full, frames, output);
+}
+
+// ============ AVX2实现（运行时检测后启用）============
+
+AUDIO_KERNELS_AVX2_TARGET inline __m256 clampUnitAvx(__m256 value) {
+    return _mm256_min_ps(_mm256_set1_ps(1.0f), _mm256_max_ps(_mm256_set1_ps(-1.0f), value));
+}
+
+AUDIO_KERNELS_AVX2_TARGET inline __m256 absAvx(__m256 value) {
+    return _mm256_and_ps(value, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+}
+
+AUDIO_KERNELS_AVX2_TARGET inline __m256 pointwiseAvx(__m256 value, const PointwiseChainParams& params, float slope) {
+    if (params.apply_gain) {
+        value = clampUnitAvx(_mm256_mul_ps(value, _mm256_set1_ps(params.gain)));
+    }
+    if (params.apply_compression) {
+        const __m256 threshold = _mm256_set1_ps(params.compression_threshold);
+        const __m256 magnitude = absAvx(value);
+        const __m256 mask = _mm256_cmp_ps(magnitude, threshold, _CMP_GT_OQ);
+        const __m256 reduction = _mm256_add_ps(_mm256_set1_ps(1.0f),
+            _mm256_div_ps(_mm256_mul_ps(_mm256_sub_ps(threshold, magnitude), _mm256_set1_ps(slope)), threshold));
+        const __m256 compressed = _mm256_mul_ps(value, reduction);
+        value = clampUnitAvx(_mm256_blendv_ps(value, compressed, mask));
+    }
+    if (params.apply_final_gain) {
+        value = clampUnitAvx(_mm256_mul_ps(value, _mm256_set1_ps(params.final_gain)));
+    }
+    return value;
+}
+
+AUDIO_KERNELS_AVX2_TARGET AudioBufferStats analyzeAvx2(const float* data, size_t count) {
+    __m256 acc = _mm256_setzero_ps();
+    __m256 peak = _mm256_setzero_ps();
+    const size_t full = count / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        const __m256 value = _mm256_loadu_ps(data + i);
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(value, value));
+        peak = _mm256_max_ps(absAvx(value), peak);
+    }
+    float lanes[LANES], peaks[LANES];
+    _mm256_storeu_ps(lanes, acc);
+    _mm256_storeu_ps(peaks, peak);
+    finishTail(const_cast<float*>(data), full, count, lanes, peaks, nullptr);
+
+    AudioBufferStats stats;
+    stats.sum_squares = combineLanes(lanes);
+    stats.peak = combinePeaks(peaks);
+    return stats;
+}
+
+AUDIO_KERNELS_AVX2_TARGET float preEmphasisAvx2(float* data, size_t count, float coef) {
+    if (count == 0) {
+        return 0.0f;
+    }
+    float lanes[LANES] = {};
+    const size_t full = count / LANES * LANES;
+    if (count > std::max<size_t>(full, 1)) {
+        preEmphasisRange(data, std::max<size_t>(full, 1), count - 1, coef, lanes);
+    }
+
+    __m256 acc = _mm256_loadu_ps(lanes);
+    const __m256 c = _mm256_set1_ps(coef);
+    for (size_t block = full / LANES; block-- > 1;) {
+        float* p = data + block * LANES;
+        const __m256 value = _mm256_sub_ps(_mm256_loadu_ps(p), _mm256_mul_ps(c, _mm256_loadu_ps(p - 1)));
+        _mm256_storeu_ps(p, value);
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(value, value));
+    }
+    _mm256_storeu_ps(lanes, acc);
+
+    if (full >= LANES) {
+        preEmphasisRange(data, 1, LANES - 1, coef, lanes);
+    }
+    lanes[0] += data[0] * data[0];
+    return combineLanes(lanes);
+}
+
+AUDIO_KERNELS_AVX2_TARGET float scaleClampAvx2(float* data, size_t count, float scale) {
+    __m256 acc = _mm256_setzero_ps();
+    const __m256 s = _mm256_set1_ps(scale);
+    const size_t full = count / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        const __m256 value = clampUnitAvx(_mm256_mul_ps(_mm256_loadu_ps(data + i), s));
+        _mm256_storeu_ps(data + i, value);
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(value, value));
+    }
+    float lanes[LANES];
+    _mm256_storeu_ps(lanes, acc);
+    for (size_t i = full; i < count; ++i) {
+        const float value = clampUnit(data[i] * scale);
+        data[i] = value;
+        lanes[i % LANES] += value * value;
+    }
+    return combineLanes(lanes);
+}
+
+AUDIO_KERNELS_AVX2_TARGET AudioBufferStats pointwiseAvx2(float* data, size_t count, const PointwiseChainParams& params) {
+    const float slope = compressionSlope(params);
+    __m256 acc = _mm256_setzero_ps();
+    __m256 peak = _mm256_setzero_ps();
+    const size_t full = count / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        const __m256 value = pointwiseAvx(_mm256_loadu_ps(data + i), params, slope);
+        _mm256_storeu_ps(data + i, value);
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(value, value));
+        peak = _mm256_max_ps(absAvx(value), peak);
+    }
+    float lanes[LANES], peaks[LANES];
+    _mm256_storeu_ps(lanes, acc);
+    _mm256_storeu_ps(peaks, peak);
+    finishTail(data, full, count, lanes, peaks, &params);
+
+    AudioBufferStats stats;
+    stats.sum_squares = combineLanes(lanes);
+    stats.peak = combinePeaks(peaks);
+    return stats;
+}
+
+AUDIO_KERNELS_AVX2_TARGET void floatToInt16Avx2(const float* input, size_t count, int16_t* output) {
+    const __m256 scale = _mm256_set1_ps(32767.0f);
+    const size_t block = LANES * 2;
+    const size_t full = count / block * block;
+    for (size_t i = 0; i < full; i += block) {
+        const __m256i lo = _mm256_cvttps_epi32(_mm256_mul_ps(clampUnitAvx(_mm256_loadu_ps(input + i)), scale));
+        const __m256i hi = _mm256_cvttps_epi32(_mm256_mul_ps(clampUnitAvx(_mm256_loadu_ps(input + i + LANES)), scale));
+        // packs按128位分半交错，再按64位重排恢复顺序
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), packed);
+    }
+    floatToInt16Scalar(input + full, count - full, output + full);
+}
+
+AUDIO_KERNELS_AVX2_TARGET void int16ToFloatAvx2(const int16_t* input, size_t count, float* output) {
+    const __m256 scale = _mm256_set1_ps(INT16_TO_FLOAT);
+    const size_t full = count / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        const __m256i wide = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)));
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_cvtepi32_ps(wide), scale));
+    }
+    int16ToFloatScalar(input + full, count - full, output + full);
+}
+
+AUDIO_KERNELS_AVX2_TARGET void deinterleaveAvx2(const float* input, size_t frames, int channels, float* const* planes) {
+    if (channels != 2) {
+        deinterleaveScalar(input, frames, channels, planes);
+        return;
+    }
+    const size_t full = frames / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        const __m256 a = _mm256_loadu_ps(input + 2 * i);
+        const __m256 b = _mm256_loadu_ps(input + 2 * i + LANES);
+        // shuffle按128位分半进行，得到帧0 1 4 5 | 2 3 6 7，再按64位重排恢复顺序
+        const __m256 left = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256 right = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm256_storeu_ps(planes[0] + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(left), 0xD8)));
+        _mm256_storeu_ps(planes[1] + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(right), 0xD8)));
+    }
+    deinterleaveRange(input, full, frames, channels, planes);
+}
+
+AUDIO_KERNELS_AVX2_TARGET void averageChannelsAvx2(const float* const* planes, int channels, size_t frames, float* output) {
+    const __m256 scale = _mm256_set1_ps(1.0f / static_cast<float>(channels));
+    const size_t full = frames / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        __m256 sum = _mm256_loadu_ps(planes[0] + i);
+        for (int c = 1; c < channels; ++c) {
+            sum = _mm256_add_ps(sum, _mm256_loadu_ps(planes[c] + i));
+        }
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(sum, scale));
+    }
+    averageChannelsRange(planes, channels, full, frames, output);
+}
+
+bool cpuSupportsAvx2() {
+#if defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool os_saves_ymm = (info[2] & (1 << 27)) != 0;
+    const bool has_avx = (info[2] & (1 << 28)) != 0;
+    if (!os_saves_ymm || !has_avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // AUDIO_KERNELS_X86
+
+#if defined(AUDIO_KERNELS_NEON)
+
+// ============ NEON实现（AArch64）============
+
+inline float32x4_t clampUnitNeon(float32x4_t value) {
+    return vminq_f32(vdupq_n_f32(1.0f), vmaxq_f32(vdupq_n_f32(-1.0f), value));
+}
+
+inline float32x4_t pointwiseNeon(float32x4_t value, const PointwiseChainParams& params, float slope) {
+    if (params.apply_gain) {
+        value = clampUnitNeon(vmulq_f32(value, vdupq_n_f32(params.gain)));
+    }
+    if (params.apply_compression) {
+        const float32x4_t threshold = vdupq_n_f32(params.compression_threshold);
+        const float32x4_t magnitude = vabsq_f32(value);
+        const uint32x4_t mask = vcgtq_f32(magnitude, threshold);
+        const float32x4_t reduction = vaddq_f32(vdupq_n_f32(1.0f),
+            vdivq_f32(vmulq_f32(vsubq_f32(threshold, magnitude), vdupq_n_f32(slope)), threshold));
+        const float32x4_t compressed = vmulq_f32(value, reduction);
+        value = clampUnitNeon(vbslq_f32(mask, compressed, value));
+    }
+    if (params.apply_final_gain) {
+        value = clampUnitNeon(vmulq_f32(value, vdupq_n_f32(params.final_gain)));
+    }
+    return value;
+}
+
+AudioBufferStats analyzeNeon(const float* data, size_t count) {
+    float32x4_t acc_lo = vdupq_n_f32(0.0f), acc_hi = vdupq_n_f32(0.0f);
+    float32x4_t peak_lo = vdupq_n_f32(0.0f), peak_hi = vdupq_n_f32(0.0f);
+    const size_t full = count / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        const float32x4_t lo = vld1q_f32(data + i);
+        const float32x4_t hi = vld1q_f32(data + i + 4);
+        acc_lo = vaddq_f32(acc_lo, vmulq_f32(lo, lo));
+        acc_hi = vaddq_f32(acc_hi, vmulq_f32(hi, hi));
+        peak_lo = vmaxq_f32(vabsq_f32(lo), peak_lo);
+        peak_hi = vmaxq_f32(vabsq_f32(hi), peak_hi);
+    }
+    float lanes[LANES], peaks[LANES];
+    vst1q_f32(lanes, acc_lo);
+    vst1q_f32(lanes + 4, acc_hi);
+    vst1q_f32(peaks, peak_lo);
+    vst1q_f32(peaks + 4, peak_hi);
+    finishTail(const_cast<float*>(data), full, count, lanes, peaks, nullptr);
+
+    AudioBufferStats stats;
+    stats.sum_squares = combineLanes(lanes);
+    stats.peak = combinePeaks(peaks);
+    return stats;
+}
+
+float preEmphasisNeon(float* data, size_t count, float coef) {
+    if (count == 0) {
+        return 0.0f;
+    }
+    float lanes[LANES] = {};
+    const size_t full = count / LANES * LANES;
+    if (count > std::max<size_t>(full, 1)) {
+        preEmphasisRange(data, std::max<size_t>(full, 1), count - 1, coef, lanes);
+    }
+
+    float32x4_t acc_lo = vld1q_f32(lanes), acc_hi = vld1q_f32(lanes + 4);
+    const float32x4_t c = vdupq_n_f32(coef);
+    for (size_t block = full / LANES; block-- > 1;) {
+        float* p = data + block * LANES;
+        const float32x4_t lo = vsubq_f32(vld1q_f32(p), vmulq_f32(c, vld1q_f32(p - 1)));
+        const float32x4_t hi = vsubq_f32(vld1q_f32(p + 4), vmulq_f32(c, vld1q_f32(p + 3)));
+        vst1q_f32(p, lo);
+        vst1q_f32(p + 4, hi);
+        acc_lo = vaddq_f32(acc_lo, vmulq_f32(lo, lo));
+        acc_hi = vaddq_f32(acc_hi, vmulq_f32(hi, hi));
+    }
+    vst1q_f32(lanes, acc_lo);
+    vst1q_f32(lanes + 4, acc_hi);
+
+    if (full >= LANES) {
+        preEmphasisRange(data, 1, LANES - 1, coef, lanes);
+    }
+    lanes[0] += data[0] * data[0];
+    return combineLanes(lanes);
+}
+
+float scaleClampNeon(float* data, size_t count, float scale) {
+    float32x4_t acc_lo = vdupq_n_f32(0.0f), acc_hi = vdupq_n_f32(0.0f);
+    const float32x4_t s = vdupq_n_f32(scale);
+    const size_t full = count / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        const float32x4_t lo = clampUnitNeon(vmulq_f32(vld1q_f32(data + i), s));
+        const float32x4_t hi = clampUnitNeon(vmulq_f32(vld1q_f32(data + i + 4), s));
+        vst1q_f32(data + i, lo);
+        vst1q_f32(data + i + 4, hi);
+        acc_lo = vaddq_f32(acc_lo, vmulq_f32(lo, lo));
+        acc_hi = vaddq_f32(acc_hi, vmulq_f32(hi, hi));
+    }
+    float lanes[LANES];
+    vst1q_f32(lanes, acc_lo);
+    vst1q_f32(lanes + 4, acc_hi);
+    for (size_t i = full; i < count; ++i) {
+        const float value = clampUnit(data[i] * scale);
+        data[i] = value;
+        lanes[i % LANES] += value * value;
+    }
+    return combineLanes(lanes);
+}
+
+AudioBufferStats pointwiseNeon(float* data, size_t count, const PointwiseChainParams& params) {
+    const float slope = compressionSlope(params);
+    float32x4_t acc_lo = vdupq_n_f32(0.0f), acc_hi = vdupq_n_f32(0.0f);
+    float32x4_t peak_lo = vdupq_n_f32(0.0f), peak_hi = vdupq_n_f32(0.0f);
+    const size_t full = count / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        const float32x4_t lo = pointwiseNeon(vld1q_f32(data + i), params, slope);
+        const float32x4_t hi = pointwiseNeon(vld1q_f32(data + i + 4), params, slope);
+        vst1q_f32(data + i, lo);
+        vst1q_f32(data + i + 4, hi);
+        acc_lo = vaddq_f32(acc_lo, vmulq_f32(lo, lo));
+        acc_hi = vaddq_f32(acc_hi, vmulq_f32(hi, hi));
+        peak_lo = vmaxq_f32(vabsq_f32(lo), peak_lo);
+        peak_hi = vmaxq_f32(vabsq_f32(hi), peak_hi);
+    }
+    float lanes[LANES], peaks[LANES];
+    vst1q_f32(lanes, acc_lo);
+    vst1q_f32(lanes + 4, acc_hi);
+    vst1q_f32(peaks, peak_lo);
+    vst1q_f32(peaks + 4, peak_hi);
+    finishTail(data, full, count, lanes, peaks, &params);
+
+    AudioBufferStats stats;
+    stats.sum_squares = combineLanes(lanes);
+    stats.peak = combinePeaks(peaks);
+    return stats;
+}
+
+void floatToInt16Neon(const float* input, size_t count, int16_t* output) {
+    const float32x4_t scale = vdupq_n_f32(32767.0f);
+    const size_t full = count / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        const int32x4_t lo = vcvtq_s32_f32(vmulq_f32(clampUnitNeon(vld1q_f32(input + i)), scale));
+        const int32x4_t hi = vcvtq_s32_f32(vmulq_f32(clampUnitNeon(vld1q_f32(input + i + 4)), scale));
+        vst1q_s16(output + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+    floatToInt16Scalar(input + full, count - full, output + full);
+}
+
+void int16ToFloatNeon(const int16_t* input, size_t count, float* output) {
+    const float32x4_t scale = vdupq_n_f32(INT16_TO_FLOAT);
+    const size_t full = count / LANES * LANES;
+    for (size_t i = 0; i < full; i += LANES) {
+        const int16x8_t packed = vld1q_s16(input + i);
+        vst1q_f32(output + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(packed))), scale));
+        vst1q_f32(output + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(packed))), scale));
+    }
+    int16ToFloatScalar(input + full, count - full, output + full);
+}
+
+void deinterleaveNeon(const float* input, size_t frames, int channels, float* const* planes) {
+    if (channels != 2) {
+        deinterleaveScalar(input, frames, channels, planes);
+        return;
+    }
+    const size_t full = frames / 4 * 4;
+    for (size_t i = 0; i < full; i += 4) {
+        const float32x4x2_t pair = vld2q_f32(input + 2 * i);
+        vst1q_f32(planes[0] + i, pair.val[0]);
+        vst1q_f32(planes[1] + i, pair.val[1]);
+    }
+    deinterleaveRange(input, full, frames, channels, planes);
+}
+
+void averageChannelsNeon(const float* const* planes, int channels, size_t frames, float* output) {
+    const float32x4_t scale = vdupq_n_f32(1.0f / static_cast<float>(channels));
+    const size_t full = frames / 4 * 4;
+    for (size_t i = 0; i < full; i += 4) {
+        float32x4_t sum = vld1q_f32(planes[0] + i);
+        for (int c = 1; c < channels; ++c) {
+            sum = vaddq_f32(sum, vld1q_f32(planes[c] + i));
+        }
+        vst1q_f32(output + i, vmulq_f32(sum, scale));
+    }
+    averageChannelsRange(planes, channels, full, frames, output);
+}
+
+#endif // AUDIO_KERNELS_NEON
+
+// ============ 运行时分派 ============
+
+struct KernelTable {
+    const char* name;
+    AudioBufferStats (*analyze)(const float*, size_t);
+    float (*pre_emphasis)(float*, size_t, float);
+    float (*scale_clamp)(float*, size_t, float);
+    AudioBufferStats (*pointwise)(float*, size_t, const PointwiseChainParams&);
+    void (*float_to_int16)(const float*, size_t, int16_t*);
+    void (*int16_to_float)(const int16_t*, size_t, float*);
+    void (*deinterleave)(const float*, size_t, int, float* const*);
+    void (*average_channels)(const float* const*, int, size_t, float*);
+};
+
+const KernelTable SCALAR_KERNELS = {"Scalar", analyzeScalar, preEmphasisScalar, scaleClampScalar, pointwiseScalar,
+                                    floatToInt16Scalar, int16ToFloatScalar, deinterleaveScalar,
+                                    averageChannelsScalar};
+
+bool sameBits(float a, float b) {
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+bool sameBits(const std::vector<float>& a, const std::vector<float>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+// 用合成数据对比候选实现与标量实现，长度取非8的倍数以覆盖尾部处理
+bool matchesScalar(const KernelTable& kernels) {
+    std::vector<float> input(1037);
+    uint32_t seed = 12345;
+    for (float& sample : input) {
+        seed = seed * 1664525u + 1013904223u;
+        sample = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 3.0f;
+    }
+
+    PointwiseChainParams params;
+    params.apply_gain = true;
+    params.gain = 1.7f;
+    params.apply_compression = true;
+    params.compression_threshold = 0.5f;
+    params.compression_ratio = 2.0f;
+    params.apply_final_gain = true;
+    params.final_gain = 1.3f;
+
+    for (size_t count : {input.size(), size_t(7), size_t(16)}) {
+        std::vector<float> expected(input.begin(), input.begin() + count);
+        std::vector<float> actual = expected;
+
+        std::vector<int16_t> expected_pcm(count), actual_pcm(count);
+        SCALAR_KERNELS.float_to_int16(expected.data(), count, expected_pcm.data());
+        kernels.float_to_int16(actual.data(), count, actual_pcm.data());
+        if (expected_pcm != actual_pcm) {
+            return false;
+        }
+
+        AudioBufferStats a = SCALAR_KERNELS.analyze(expected.data(), count);
+        AudioBufferStats b = kernels.analyze(actual.data(), count);
+        if (!sameBits(a.sum_squares, b.sum_squares) || !sameBits(a.peak, b.peak)) {
+            return false;
+        }
+        if (!sameBits(SCALAR_KERNELS.pre_emphasis(expected.data(), count, 0.97f),
+                      kernels.pre_emphasis(actual.data(), count, 0.97f)) || !sameBits(expected, actual)) {
+            return false;
+        }
+        if (!sameBits(SCALAR_KERNELS.scale_clamp(expected.data(), count, 1.9f),
+                      kernels.scale_clamp(actual.data(), count, 1.9f)) || !sameBits(expected, actual)) {
+            return false;
+        }
+        a = SCALAR_KERNELS.pointwise(expected.data(), count, params);
+        b = kernels.pointwise(actual.data(), count, params);
+        if (!sameBits(a.sum_squares, b.sum_squares) || !sameBits(a.peak, b.peak) || !sameBits(expected, actual)) {
+            return false;
+        }
+
+        std::vector<int16_t> pcm(count);
+        for (size_t i = 0; i < count; ++i) {
+            pcm[i] = static_cast<int16_t>(input[i] * 21845.0f);
+        }
+        SCALAR_KERNELS.int16_to_float(pcm.data(), count, expected.data());
+        kernels.int16_to_float(pcm.data(), count, actual.data());
+        if (!sameBits(expected, actual)) {
+            return false;
+        }
+
+        for (int channels : {1, 2, 3, 6}) {
+            const size_t frames = count / channels;
+            std::vector<float> expected_planes(count), actual_planes(count);
+            std::vector<float*> expected_ptrs(channels), actual_ptrs(channels);
+            for (int c = 0; c < channels; ++c) {
+                expected_ptrs[c] = expected_planes.data() + c * frames;
+                actual_ptrs[c] = actual_planes.data() + c * frames;
+            }
+            SCALAR_KERNELS.deinterleave(input.data(), frames, channels, expected_ptrs.data());
+            kernels.deinterleave(input.data(), frames, channels, actual_ptrs.data());
+            if (!sameBits(expected_planes, actual_planes)) {
+                return false;
+            }
+
+            const std::vector<const float*> planes(expected_ptrs.begin(), expected_ptrs.end());
+            std::vector<float> expected_mono(frames), actual_mono(frames);
+            SCALAR_KERNELS.average_channels(planes.data(), channels, frames, expected_mono.data());
+            kernels.average_channels(planes.data(), channels, frames, actual_mono.data());
+            if (!sameBits(expected_mono, actual_mono)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+const KernelTable& selectKernels() {
+    const KernelTable* candidate = &SCALAR_KERNELS;
+#if defined(AUDIO_KERNELS_X86)
+    static const KernelTable avx2 = {"AVX2", analyzeAvx2, preEmphasisAvx2, scaleClampAvx2, pointwiseAvx2,
+                                     floatToInt16Avx2, int16ToFloatAvx2, deinterleaveAvx2,
+                                     averageChannelsAvx2};
+    static const KernelTable sse2 = {"SSE2", analyzeSse2, preEmphasisSse2, scaleClampSse2, pointwiseSse2,
+                                     floatToInt16Sse2, int16ToFloatSse2, deinterleaveSse2,
+                                     averageChannelsSse2};
+    candidate = cpuSupportsAvx2() ? &avx2 : &sse2;
+#elif defined(AUDIO_KERNELS_NEON)
+    static const KernelTable neon = {"NEON", analyzeNeon, preEmphasisNeon, scaleClampNeon, pointwiseNeon,
+                                     floatToInt16Neon, int16ToFloatNeon, deinterleaveNeon,
+                                     averageChannelsNeon};
+    candidate = &neon;
+#endif
+
+    if (candidate != &SCALAR_KERNELS && !matchesScalar(*candidate)) {
+        LOG_WARNING(std::string("预处理内核 ") + candidate->name + " 与标量实现结果不一致，改用标量实现");
+        candidate = &SCALAR_KERNELS;
+    }
+    LOG_INFO(std::string("预处理内核: ") + candidate->name);
+    return *candidate;
+}
+
+const KernelTable& kernels() {
+    static const KernelTable& selected = selectKernels();
+    return selected;
+}
+
+} // namespace
+
+AudioBufferStats AudioKernels::analyze(const float* data, size_t count) {
+    return kernels().analyze(data, count);
+}
+
+float AudioKernels::preEmphasis(float* data, size_t count, float coef) {
+    return kernels().pre_emphasis(data, count, coef);
+}
+
+float AudioKernels::scaleAndHighPass(float* data, size_t count,
+                                     bool apply_scale, float scale,
+                                     bool apply_high_pass, float alpha, float* hp_state) {
+    if (!apply_high_pass) {
+        return apply_scale ? kernels().scale_clamp(data, count, scale) : kernels().analyze(data, count).sum_squares;
+    }
+
+    // 递归滤波无法跨样本并行，缩放、滤波和平方和在同一次遍历中按样本顺序完成
+    float lanes[LANES] = {};
+    float output = hp_state[0];
+    float previous_input = hp_state[1];
+    for (size_t i = 0; i < count; ++i) {
+        float value = data[i];
+        if (apply_scale) {
+            value = clampUnit(value * scale);
+        }
+        output = alpha * (output + value - previous_input);
+        previous_input = value;
+        data[i] = output;
+        lanes[i % LANES] += output * output;
+    }
+    hp_state[0] = output;
+    hp_state[1] = previous_input;
+    return combineLanes(lanes);
+}
+
+AudioBufferStats AudioKernels::applyPointwise(float* data, size_t count, const PointwiseChainParams& params) {
+    return kernels().pointwise(data, count, params);
+}
+
+void AudioKernels::floatToInt16(const float* input, size_t count, int16_t* output) {
+    kernels().float_to_int16(input, count, output);
+}
+
+void AudioKernels::int16ToFloat(const int16_t* input, size_t count, float* output) {
+    kernels().int16_to_float(input, count, output);
+}
+
+void AudioKernels::deinterleave(const float* input, size_t frames, int channels, float* const* planes) {
+    kernels().deinterleave(input, frames, channels, planes);
+}
+
+void AudioKernels::averageChannels(const float* const* planes, int channels, size_t frames, float* output) {
+    kernels().average_channels(planes, channels, frames, output);
+}
+
+const char* AudioKernels::getActiveImplementation() {
+    return kernels().name;
+}
@@ -1,4 +1,5 @@
 ﻿#include "audio_preprocessor.h"
+#include "audio_kernels.h"
 #include <cmath>
 #include <algorithm>
 #include <cstring>
@@ -18,21 +19,12 @@ constexpr const T& clamp(const T& v, const T& lo, const T& hi) {
     return (v < lo) ? lo : (hi < v) ? hi : v;
 }
 
-// RNNoise头文件（需要下载并包含）
-// 如果没有安装RNNoise，这里会编译错误，可以注释掉相关代码
-#ifdef RNNOISE_AVAILABLE
-extern "C" {
-    #include "rnnoise.h"
+// 一阶高通滤波系数
+static float highPassAlpha(float cutoff_freq, int sample_rate) {
+    float rc = 1.0f / (2.0f * M_PI * cutoff_freq);
+    float dt = 1.0f / sample_rate;
+    return rc / (rc + dt);
 }
-#define RNNOISE_FRAME_SIZE 480  // RNNoise固定帧大小（48kHz采样率下10ms）
-#else
-// 如果RNNoise不可用，定义空的结构体和函数以避免编译错误
-struct DenoiseState {};
-#define RNNOISE_FRAME_SIZE 480
-inline float rnnoise_process_frame(DenoiseState* st, float* x, float* out) { return 0.0f; }
-inline DenoiseState* rnnoise_create(void* model) { return nullptr; }
-inline void rnnoise_destroy(DenoiseState* st) {}
-#endif
 
 AudioPreprocessor::AudioPreprocessor() 
     : use_pre_emphasis(false)         // 🔧 临时禁用预加重
@@ -79,153 +71,64 @@ AudioPreprocessor::~AudioPreprocessor() {
 }
 
 bool AudioPreprocessor::initializeNoiseSuppressor() {
-#ifdef RNNOISE_AVAILABLE
     if (noise_suppressor) {
         return true; // 已经初始化
     }
     
-    try {
-        DenoiseState* state = rnnoise_create(nullptr);
-        if (state) {
-            noise_suppressor = static_cast<void*>(state);
-            std::cout << "[AudioPreprocessor] RNNoise初始化成功" << std::endl;
-            return true;
-        } else {
-            std::cerr << "[AudioPreprocessor] RNNoise初始化失败" << std::endl;
-            return false;
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "[AudioPreprocessor] RNNoise初始化异常: " << e.what() << std::endl;
+    // 每个预处理器对应一路流，持有自己的RNNoise状态
+    auto denoiser = std::make_unique<StreamingDenoiser>(16000);
+    if (!denoiser->initialize()) {
         return false;
     }
-#else
-    std::cout << "[AudioPreprocessor] RNNoise库未编译，噪声抑制功能不可用" << std::endl;
-    return false;
-#endif
+    noise_suppressor = std::move(denoiser);
+    std::cout << "[AudioPreprocessor] RNNoise初始化成功，降噪延迟: "
+              << noise_suppressor->getLatencyMs() << "ms" << std::endl;
+    return true;
 }
 
 void AudioPreprocessor::destroyNoiseSuppressor() {
-#ifdef RNNOISE_AVAILABLE
     if (noise_suppressor) {
-        DenoiseState* state = static_cast<DenoiseState*>(noise_suppressor);
-        rnnoise_destroy(state);
-        noise_suppressor = nullptr;
+        noise_suppressor.reset();
         std::cout << "[AudioPreprocessor] RNNoise已销毁" << std::endl;
     }
-#endif
 }
 
 bool AudioPreprocessor::isNoiseSuppressionAvailable() const {
-#ifdef RNNOISE_AVAILABLE
     return noise_suppressor != nullptr;
-#else
-    return false;
-#endif
 }
 
-void AudioPreprocessor::convertFloatToPCM16(const std::vector<float>& float_buffer, std::vector<short>& pcm_buffer) {
-    if (float_buffer.empty()) {
-        pcm_buffer.clear();
-        return;
-    }
-    
-    pcm_buffer.resize(float_buffer.size());
-    for (size_t i = 0; i < float_buffer.size(); ++i) {
-        // 🔧 添加数值有效性检查
-        if (std::isfinite(float_buffer[i])) {
-            // 将float范围[-1.0, 1.0]转换为PCM16范围[-32768, 32767]
-            float sample = clamp(float_buffer[i], -1.0f, 1.0f);
-            pcm_buffer[i] = static_cast<short>(sample * 32767.0f);
-        } else {
-            // 无效数值时使用静音
-            pcm_buffer[i] = 0;
-        }
-    }
-}
-
-void AudioPreprocessor::convertPCM16ToFloat(const std::vector<short>& pcm_buffer, std::vector<float>& float_buffer) {
-    if (pcm_buffer.empty()) {
-        float_buffer.clear();
-        return;
-    }
-    
-    float_buffer.resize(pcm_buffer.size());
-    for (size_t i = 0; i < pcm_buffer.size(); ++i) {
-        // 将PCM16范围[-32768, 32767]转换为float范围[-1.0, 1.0]
-        float converted = static_cast<float>(pcm_buffer[i]) / 32767.0f;
-        // 🔧 添加数值有效性检查和范围限制
-        if (std::isfinite(converted)) {
-            float_buffer[i] = clamp(converted, -1.0f, 1.0f);
-        } else {
-            float_buffer[i] = 0.0f; // 无效数值时使用静音
-        }
-    }
+size_t AudioPreprocessor::getNoiseSuppressionLatency() const {
+    return (use_noise_suppression && noise_suppressor) ? noise_suppressor->getLatencySamples() : 0;
 }
 
 void AudioPreprocessor::applyPreEmphasis(std::vector<float>& audio_buffer, float pre_emphasis) {
     if (audio_buffer.empty()) return;
     
-    // 保存原始RMS值用于增益补偿
-    float original_rms = 0.0f;
-    for (float sample : audio_buffer) {
-        original_rms += sample * sample;
-    }
-    original_rms = std::sqrt(original_rms / audio_buffer.size());
+    const size_t count = audio_buffer.size();
     
-    // 应用预加重
-    float prev = audio_buffer[0];
-    for (size_t i = 1; i < audio_buffer.size(); i++) {
-        float current = audio_buffer[i];
-        audio_buffer[i] = current - pre_emphasis * prev;
-        prev = current;
-    }
+    // 保存原始RMS值用于增益补偿
+    float original_rms = std::sqrt(AudioKernels::analyze(audio_buffer.data(), count).sum_squares / count);
     
-    // 计算预加重后的RMS值
-    float processed_rms = 0.0f;
-    for (float sample : audio_buffer) {
-        processed_rms += sample * sample;
-    }
-    processed_rms = std::sqrt(processed_rms / audio_buffer.size());
+    // 应用预加重，同时得到预加重后的RMS值
+    float processed_rms = std::sqrt(AudioKernels::preEmphasis(audio_buffer.data(), count, pre_emphasis) / count);
     
     // 计算并应用增益补偿
     if (processed_rms > 0.0f) {
         float gain_compensation = original_rms / processed_rms;
         gain_compensation = clamp(gain_compensation, 0.5f, 2.0f);
-        
-        for (float& sample : audio_buffer) {
-            sample *= gain_compensation;
-            sample = clamp(sample, -1.0f, 1.0f);
-        }
+        AudioKernels::scaleAndHighPass(audio_buffer.data(), count, true, gain_compensation, false, 0.0f, nullptr);
     }
 }
 
 void AudioPreprocessor::applyHighPassFilter(std::vector<float>& audio_buffer, float cutoff_freq, int sample_rate) {
     if (audio_buffer.empty()) return;
     
-    // 计算滤波器系数
-    float rc = 1.0f / (2.0f * M_PI * cutoff_freq);
-    float dt = 1.0f / sample_rate;
-    float alpha = rc / (rc + dt);
-    
     // 应用高通滤波
-    for (float& sample : audio_buffer) {
-        float prev = hp_filter_state[0];
-        hp_filter_state[0] = alpha * (hp_filter_state[0] + sample - hp_filter_state[1]);
-        hp_filter_state[1] = sample;
-        sample = hp_filter_state[0];
-    }
+    AudioKernels::scaleAndHighPass(audio_buffer.data(), audio_buffer.size(), false, 1.0f,
+                                   true, highPassAlpha(cutoff_freq, sample_rate), hp_filter_state);
 }
 
-void AudioPreprocessor::applyAGC(std::vector<float>& audio_buffer, float target_level) {
-    if (audio_buffer.empty()) return;
-    
-    // 计算当前音频的RMS值
-    float sum_squared = 0.0f;
-    for (float sample : audio_buffer) {
-        sum_squared += sample * sample;
-    }
-    float rms = std::sqrt(sum_squared / audio_buffer.size());
-    
+float AudioPreprocessor::updateAGCGain(float rms, float target_level) {
     // 计算基本增益
     float desired_gain = target_level / (rms + 1e-6f);
     desired_gain = clamp(desired_gain, min_gain, max_gain);
@@ -233,28 +136,30 @@ void AudioPreprocessor::applyAGC(std::vector<float>& audio_buffer, float target_
     // 应用平滑
     float alpha_attack = (rms > current_gain * rms) ? attack_time : release_time;
     current_gain = alpha_attack * desired_gain + (1.0f - alpha_attack) * current_gain;
+    return current_gain;
+}
+
+void AudioPreprocessor::applyAGC(std::vector<float>& audio_buffer, float target_level) {
+    if (audio_buffer.empty()) return;
+    
+    // 计算当前音频的RMS值
+    float rms = calculateRMS(audio_buffer);
     
     // 应用增益
-    for (float& sample : audio_buffer) {
-        sample *= current_gain;
-        sample = clamp(sample, -1.0f, 1.0f);
-    }
+    PointwiseChainParams chain;
+    chain.apply_gain = true;
+    chain.gain = updateAGCGain(rms, target_level);
+    AudioKernels::applyPointwise(audio_buffer.data(), audio_buffer.size(), chain);
 }
 
 void AudioPreprocessor::applyCompression(std::vector<float>& audio_buffer) {
     if (audio_buffer.empty()) return;
     
-    for (float& sample : audio_buffer) {
-        float abs_sample = std::abs(sample);
-        
-        if (abs_sample > compression_threshold) {
-            float gain_reduction = 1.0f + (compression_threshold - abs_sample) * 
-                                  (1.0f - 1.0f/compression_ratio) / compression_threshold;
-            sample *= gain_reduction;
-        }
-        
-        sample = clamp(sample, -1.0f, 1.0f);
-    }
+    PointwiseChainParams chain;
+    chain.apply_compression = true;
+    chain.compression_threshold = compression_threshold;
+    chain.compression_ratio = compression_ratio;
+    AudioKernels::applyPointwise(audio_buffer.data(), audio_buffer.size(), chain);
 }
 
 void AudioPreprocessor::applyNoiseSuppression(std::vector<float>& audio_buffer) {
@@ -279,13 +184,6 @@ void AudioPreprocessor::applyNoiseSuppression(std::vector<float>& audio_buffer)
         return;
     }
     
-    // 🔧 修复：使用预分配的缓冲区避免动态内存分配
-    static thread_local std::vector<float> original_buffer_cache;
-    original_buffer_cache.clear();
-    original_buffer_cache.reserve(audio_buffer.size());
-    original_buffer_cache.assign(audio_buffer.begin(), audio_buffer.end());
-
-#ifdef RNNOISE_AVAILABLE
     // 🔧 修复：增加安全检查，如果noise_suppressor为空但use_noise_suppression为true，尝试自动初始化
     if (!noise_suppressor) {
         std::cout << "[AudioPreprocessor] 检测到噪声抑制器未初始化，尝试自动初始化..." << std::endl;
@@ -301,47 +199,19 @@ void AudioPreprocessor::applyNoiseSuppression(std::vector<float>& audio_buffer)
         return;
     }
     
-    DenoiseState* state = static_cast<DenoiseState*>(noise_suppressor);
-    
-    // 方案选择：针对16kHz音频的RNNoise处理
-    // 方案1: 使用专用16kHz RNNoise库 (推荐)
-    // 方案2: 高质量重采样到48kHz处理后再下采样
-    // 方案3: 直接处理16kHz (当前实现)
-    
-    const bool use_16k_native = true;  // 设为true使用16kHz原生处理
-    const bool use_high_quality_resampling = false;  // 设为true使用高质量重采样
-    
-    if (use_16k_native) {
-        // 方案1&3: 16kHz原生处理
-        // 对于专用16kHz RNNoise库，帧大小应该是160样本(10ms@16kHz)
-        // 对于原版RNNoise，我们仍然使用480样本但做适配处理
-        
-        const size_t frame_size_16k = 160;  // 16kHz下的帧大小
-        const bool is_16k_specialized = false;  // TODO: 检测是否为16kHz专用库
-        
-        if (is_16k_specialized) {
-            // 使用16kHz专用库的原生处理
-            processWithNative16k(audio_buffer, state, frame_size_16k);
-        } else {
-            // 使用原版库的适配处理
-            processWithAdapted48k(audio_buffer, state);
-        }
-    } else if (use_high_quality_resampling) {
-        // 方案2: 高质量重采样方法
-        processWithHighQualityResampling(audio_buffer, state);
-    } else {
-        // 备用方案：简单处理
-        processWithSimpleMethod(audio_buffer, state);
-    }
+    // 流式降噪：不足一帧的尾部样本留到下次调用，输出与输入等长但整体延迟固定的样本数；
+    // 同时取得同样延迟的原始音频，混合时与降噪结果逐样本对齐
+    dry_buffer.resize(audio_buffer.size());
+    noise_suppressor->process(audio_buffer.data(), audio_buffer.size(), audio_buffer.data(), dry_buffer.data());
     
     std::cout << "[AudioPreprocessor] RNNoise处理完成，样本数: " << audio_buffer.size() << std::endl;
     
     // 🔧 新增：应用自适应噪声抑制和混合处理
     if (use_adaptive_suppression) {
-        applyAdaptiveNoiseSuppression(audio_buffer, original_buffer_cache);
+        applyAdaptiveNoiseSuppression(audio_buffer, dry_buffer);
     } else {
         // 简单混合模式：根据mix_ratio混合原始音频和处理音频
-        mixAudioBuffers(audio_buffer, original_buffer_cache, noise_suppression_mix_ratio);
+        mixAudioBuffers(audio_buffer, dry_buffer, noise_suppression_mix_ratio);
     }
     
     // 调试：输出最终处理后的音频信息
@@ -362,304 +232,26 @@ void AudioPreprocessor::applyNoiseSuppression(std::vector<float>& audio_buffer)
             std::cout << "[AudioPreprocessor] ✅ 处理后信号能量正常，VAD应能正确识别" << std::endl;
         }
     }
-    
-#else
-    // 如果RNNoise编译时不可用
-    std::cout << "[AudioPreprocessor] RNNoise编译时不可用，保持原始音频不变" << std::endl;
-#endif
-}
-
-// 16kHz专用库的原生处理方法
-void AudioPreprocessor::processWithNative16k(std::vector<float>& audio_buffer, void* state, size_t frame_size) {
-    // 为16kHz专用RNNoise库设计的处理方法
-    DenoiseState* denoise_state = static_cast<DenoiseState*>(state);
-    
-    // 确保缓冲区大小是帧大小的倍数
-    size_t padded_size = ((audio_buffer.size() + frame_size - 1) / frame_size) * frame_size;
-    size_t original_size = audio_buffer.size();
-    audio_buffer.resize(padded_size, 0.0f);
-    
-    // 按160样本分帧处理
-    for (size_t i = 0; i + frame_size <= audio_buffer.size(); i += frame_size) {
-        float frame_data[160];  // 16kHz专用库的帧大小
-        
-        // 复制数据到处理缓冲区
-        for (size_t j = 0; j < frame_size; ++j) {
-            frame_data[j] = audio_buffer[i + j];
-        }
-        
-        // 调用16kHz专用的RNNoise处理函数
-        // 注意：16kHz专用库可能有不同的函数名，如rnnoise_process_frame_16k
-        rnnoise_process_frame(denoise_state, frame_data, frame_data);
-        
-        // 复制处理后的数据回缓冲区
-        for (size_t j = 0; j < frame_size; ++j) {
-            audio_buffer[i + j] = frame_data[j];
-        }
-    }
-    
-    // 恢复原始大小
-    audio_buffer.resize(original_size);
-    
-    std::cout << "[AudioPreprocessor] 使用16kHz专用RNNoise处理" << std::endl;
-}
-
-// 🔧 修复：原版库的适配处理方法（内存安全版本）
-void AudioPreprocessor::processWithAdapted48k(std::vector<float>& audio_buffer, void* state) {
-    DenoiseState* denoise_state = static_cast<DenoiseState*>(state);
-    
-    // 🔧 使用thread_local缓存避免频繁分配
-    static thread_local std::vector<short> pcm_buffer_cache;
-    static thread_local std::vector<float> float_buffer_cache;
-    
-    // 转换为PCM16格式（原版RNNoise期望的格式）
-    convertFloatToPCM16(audio_buffer, pcm_buffer_cache);
-    
-    // 确保缓冲区大小是480的倍数
-    const size_t frame_size = RNNOISE_FRAME_SIZE;  // 480
-    size_t padded_size = ((pcm_buffer_cache.size() + frame_size - 1) / frame_size) * frame_size;
-    pcm_buffer_cache.resize(padded_size, 0);
-    
-    // 分块处理
-    for (size_t i = 0; i + frame_size <= pcm_buffer_cache.size(); i += frame_size) {
-        float frame_data[RNNOISE_FRAME_SIZE];
-        
-        // 转换为float格式
-        for (size_t j = 0; j < frame_size; ++j) {
-            frame_data[j] = static_cast<float>(pcm_buffer_cache[i + j]);
-        }
-        
-        // 应用RNNoise
-        rnnoise_process_frame(denoise_state, frame_data, frame_data);
-        
-        // 转换回PCM16格式，添加安全检查
-        for (size_t j = 0; j < frame_size; ++j) {
-            if (std::isfinite(frame_data[j])) {
-                pcm_buffer_cache[i + j] = static_cast<short>(clamp(frame_data[j], -32768.0f, 32767.0f));
-            } else {
-                pcm_buffer_cache[i + j] = 0; // 无效数值时使用静音
-            }
-        }
-    }
-    
-    // 转换回float格式
-    convertPCM16ToFloat(pcm_buffer_cache, float_buffer_cache);
-    
-    // 安全复制结果
-    if (float_buffer_cache.size() != audio_buffer.size()) {
-        audio_buffer.resize(float_buffer_cache.size());
-    }
-    std::copy(float_buffer_cache.begin(), float_buffer_cache.end(), audio_buffer.begin());
-    
-    std::cout << "[AudioPreprocessor] 使用原版RNNoise适配处理" << std::endl;
-}
-
-// 高质量重采样处理方法
-void AudioPreprocessor::processWithHighQualityResampling(std::vector<float>& audio_buffer, void* state) {
-    DenoiseState* denoise_state = static_cast<DenoiseState*>(state);
-    
-    // 计算原始RMS用于质量检查
-    float original_rms = calculateRMS(audio_buffer);
-    
-    // 🔧 修复：使用thread_local缓存避免大量内存分配
-    static thread_local std::vector<float> upsampled_cache;
-    static thread_local std::vector<float> downsampled_cache;
-    
-    // 高质量上采样：16kHz -> 48kHz (使用Lanczos重采样)
-    upsampled_cache = upsampleLanczos(audio_buffer, 16000, 48000);
-    
-    // 确保大小是480的倍数
-    const size_t frame_size = RNNOISE_FRAME_SIZE;
-    size_t padded_size = ((upsampled_cache.size() + frame_size - 1) / frame_size) * frame_size;
-    upsampled_cache.resize(padded_size, 0.0f);
-    
-    // 分帧处理48kHz数据
-    for (size_t i = 0; i + frame_size <= upsampled_cache.size(); i += frame_size) {
-        float frame_data[RNNOISE_FRAME_SIZE];
-        
-        // 复制数据
-        for (size_t j = 0; j < frame_size; ++j) {
-            frame_data[j] = upsampled_cache[i + j];
-        }
-        
-        // 应用RNNoise
-        rnnoise_process_frame(denoise_state, frame_data, frame_data);
-        
-        // 复制回去
-        for (size_t j = 0; j < frame_size; ++j) {
-            upsampled_cache[i + j] = frame_data[j];
-        }
-    }
-    
-    // 高质量下采样：48kHz -> 16kHz
-    downsampled_cache = downsampleLanczos(upsampled_cache, 48000, 16000);
-    
-    // 🔧 修复：安全复制结果，避免重新分配
-    if (downsampled_cache.size() != audio_buffer.size()) {
-        audio_buffer.resize(downsampled_cache.size());
-    }
-    std::copy(downsampled_cache.begin(), downsampled_cache.end(), audio_buffer.begin());
-    
-    // 质量检查
-    float processed_rms = calculateRMS(audio_buffer);
-    if (processed_rms < original_rms * 0.1f) {
-        std::cout << "[AudioPreprocessor] 警告: 处理后信号能量显著降低" << std::endl;
-    }
-    
-    std::cout << "[AudioPreprocessor] 使用高质量重采样RNNoise处理" << std::endl;
-}
-
-// 🔧 修复：简单处理方法（内存安全版本）
-void AudioPreprocessor::processWithSimpleMethod(std::vector<float>& audio_buffer, void* state) {
-    // 使用用户修改后的简单方法
-    DenoiseState* denoise_state = static_cast<DenoiseState*>(state);
-    
-    // 🔧 使用thread_local缓存避免频繁分配
-    static thread_local std::vector<short> pcm_buffer_cache;
-    static thread_local std::vector<float> float_buffer_cache;
-    
-    // 转换为PCM16格式
-    convertFloatToPCM16(audio_buffer, pcm_buffer_cache);
-    
-    // 分块处理
-    const size_t frame_size = RNNOISE_FRAME_SIZE;
-    for (size_t i = 0; i + frame_size <= pcm_buffer_cache.size(); i += frame_size) {
-        float frame_data[RNNOISE_FRAME_SIZE];
-        
-        // 转换为float格式
-        for (size_t j = 0; j < frame_size; ++j) {
-            frame_data[j] = static_cast<float>(pcm_buffer_cache[i + j]);
-        }
-        
-        // 应用RNNoise
-        rnnoise_process_frame(denoise_state, frame_data, frame_data);
-        
-        // 转换回PCM16格式，添加安全检查
-        for (size_t j = 0; j < frame_size; ++j) {
-            if (std::isfinite(frame_data[j])) {
-                pcm_buffer_cache[i + j] = static_cast<short>(clamp(frame_data[j], -32768.0f, 32767.0f));
-            } else {
-                pcm_buffer_cache[i + j] = 0; // 无效数值时使用静音
-            }
-        }
-    }
-    
-    // 转换回float格式
-    convertPCM16ToFloat(pcm_buffer_cache, float_buffer_cache);
-    
-    // 安全复制结果
-    if (float_buffer_cache.size() != audio_buffer.size()) {
-        audio_buffer.resize(float_buffer_cache.size());
-    }
-    std::copy(float_buffer_cache.begin(), float_buffer_cache.end(), audio_buffer.begin());
-    
-    std::cout << "[AudioPreprocessor] 使用简单适配RNNoise处理" << std::endl;
 }
 
 // 辅助函数：计算RMS
 float AudioPreprocessor::calculateRMS(const std::vector<float>& buffer) {
     if (buffer.empty()) return 0.0f;
     
-    float sum_squares = 0.0f;
-    for (float sample : buffer) {
-        sum_squares += sample * sample;
-    }
+    float sum_squares = AudioKernels::analyze(buffer.data(), buffer.size()).sum_squares;
     return std::sqrt(sum_squares / buffer.size());
 }
 
-// 🔧 修复：Lanczos上采样（内存安全版本）
-std::vector<float> AudioPreprocessor::upsampleLanczos(const std::vector<float>& input, int orig_sr, int target_sr) {
-    if (input.empty()) {
-        return std::vector<float>();
-    }
-    
-    // 简化的Lanczos重采样实现
-    float ratio = static_cast<float>(target_sr) / orig_sr;
-    size_t output_size = static_cast<size_t>(input.size() * ratio);
-    
-    // 🔧 使用thread_local缓存避免频繁分配
-    static thread_local std::vector<float> output_cache;
-    output_cache.clear();
-    output_cache.reserve(output_size);
-    output_cache.resize(output_size);
-    
-    const int a = 3;  // Lanczos参数
-    
-    for (size_t i = 0; i < output_size; ++i) {
-        float src_pos = i / ratio;
-        int src_idx = static_cast<int>(src_pos);
-        
-        float sum = 0.0f;
-        float weight_sum = 0.0f;
-        
-        for (int j = src_idx - a + 1; j <= src_idx + a; ++j) {
-            if (j >= 0 && j < static_cast<int>(input.size())) {
-                float x = src_pos - j;
-                float weight = (x == 0) ? 1.0f : (a * std::sin(M_PI * x) * std::sin(M_PI * x / a)) / (M_PI * M_PI * x * x);
-                if (std::isfinite(weight)) {
-                    sum += input[j] * weight;
-                    weight_sum += weight;
-                }
-            }
-        }
-        
-        output_cache[i] = (weight_sum > 0) ? sum / weight_sum : 0.0f;
-    }
-    
-    return output_cache;
-}
-
-// 🔧 修复：Lanczos下采样（内存安全版本）
-std::vector<float> AudioPreprocessor::downsampleLanczos(const std::vector<float>& input, int orig_sr, int target_sr) {
-    if (input.empty()) {
-        return std::vector<float>();
-    }
-    
-    // 简化的Lanczos重采样实现
-    float ratio = static_cast<float>(target_sr) / orig_sr;
-    size_t output_size = static_cast<size_t>(input.size() * ratio);
-    
-    // 🔧 使用thread_local缓存避免频繁分配
-    static thread_local std::vector<float> output_cache;
-    output_cache.clear();
-    output_cache.reserve(output_size);
-    output_cache.resize(output_size);
-    
-    const int a = 3;  // Lanczos参数
-    
-    for (size_t i = 0; i < output_size; ++i) {
-        float src_pos = i / ratio;
-        int src_idx = static_cast<int>(src_pos);
-        
-        float sum = 0.0f;
-        float weight_sum = 0.0f;
-        
-        for (int j = src_idx - a + 1; j <= src_idx + a; ++j) {
-            if (j >= 0 && j < static_cast<int>(input.size())) {
-                float x = src_pos - j;
-                float weight = (x == 0) ? 1.0f : (a * std::sin(M_PI * x) * std::sin(M_PI * x / a)) / (M_PI * M_PI * x * x);
-                if (std::isfinite(weight)) {
-                    sum += input[j] * weight;
-                    weight_sum += weight;
-                }
-            }
-        }
-        
-        output_cache[i] = (weight_sum > 0) ? sum / weight_sum : 0.0f;
-    }
-    
-    return output_cache;
-}
-
 void AudioPreprocessor::process(std::vector<float>& audio_buffer, int sample_rate) {
     if (audio_buffer.empty()) return;
     
-    // 计算原始音频信息
-    float original_rms = calculateRMS(audio_buffer);
-    float original_max = 0.0f;
-    for (float sample : audio_buffer) {
-        original_max = std::max(original_max, std::abs(sample));
-    }
+    float* data = audio_buffer.data();
+    const size_t count = audio_buffer.size();
+    
+    // 计算原始音频信息：平方和与峰值一次遍历得到，预加重的增益补偿也使用这一结果
+    const AudioBufferStats input_stats = AudioKernels::analyze(data, count);
+    float original_rms = std::sqrt(input_stats.sum_squares / count);
+    float original_max = input_stats.peak;
     
     // 日志优化：只在显著变化或每100次处理时输出
     log_counter++;
@@ -681,50 +273,84 @@ void AudioPreprocessor::process(std::vector<float>& audio_buffer, int sample_rat
     }
     
     // 按照处理顺序应用各个预处理步骤 
+    // 结果与依次调用applyPreEmphasis/applyHighPassFilter/applyAGC/applyCompression逐位一致，
+    // 但相邻阶段合并到同一次遍历中，并顺带统计下一阶段需要的平方和
     std::string processing_steps;
     
+    // 进入AGC之前的平方和
+    float stage_sum_squares = input_stats.sum_squares;
+    
+    // 预加重：滤波与平方和一次完成，增益补偿推迟到下一遍与高通一起进行
+    bool apply_compensation = false;
+    float gain_compensation = 1.0f;
     if (use_pre_emphasis) {
-        applyPreEmphasis(audio_buffer, pre_emphasis_coef);
+        stage_sum_squares = AudioKernels::preEmphasis(data, count, pre_emphasis_coef);
+        float processed_rms = std::sqrt(stage_sum_squares / count);
+        if (processed_rms > 0.0f) {
+            apply_compensation = true;
+            gain_compensation = clamp(original_rms / processed_rms, 0.5f, 2.0f);
+        }
         if (should_log) processing_steps += "预加重→";
     }
     
-    if (use_high_pass) {
-        applyHighPassFilter(audio_buffer, high_pass_cutoff, sample_rate);
-        if (should_log) processing_steps += "高通→";
+    if (apply_compensation || use_high_pass) {
+        stage_sum_squares = AudioKernels::scaleAndHighPass(
+            data, count, apply_compensation, gain_compensation,
+            use_high_pass, highPassAlpha(high_pass_cutoff, sample_rate), hp_filter_state);
+        if (use_high_pass && should_log) processing_steps += "高通→";
     }
     
+    // AGC、压缩、整体增益都是逐点运算，合并为一次遍历；降噪位于压缩和整体增益之间，启用时拆成两遍
+    PointwiseChainParams chain;
     if (use_agc) {
-        applyAGC(audio_buffer, target_level);
+        chain.apply_gain = true;
+        chain.gain = updateAGCGain(std::sqrt(stage_sum_squares / count), target_level);
         if (should_log) processing_steps += "AGC→";
     }
     
     if (use_compression) {
-        applyCompression(audio_buffer);
+        chain.apply_compression = true;
+        chain.compression_threshold = compression_threshold;
+        chain.compression_ratio = compression_ratio;
         if (should_log) processing_steps += "压缩→";
     }
     
+    AudioBufferStats final_stats;
+    bool final_stats_valid = false;
     if (use_noise_suppression) {
+        if (chain.apply_gain || chain.apply_compression) {
+            AudioKernels::applyPointwise(data, count, chain);
+            chain = PointwiseChainParams();
+        }
         applyNoiseSuppression(audio_buffer);
+        // 降噪可能改变缓冲区
+        data = audio_buffer.data();
         if (should_log) processing_steps += "降噪→";
+    } else if (!use_pre_emphasis && !use_high_pass && !chain.apply_gain && !chain.apply_compression) {
+        // 缓冲区尚未改变，最终统计即输入统计
+        final_stats = input_stats;
+        final_stats_valid = true;
     }
     
-    // 最后进行整体音量放大（如果启用）
+    // 最后进行整体音量放大（如果启用），乘后限幅到[-1.0, 1.0]防止削波
     if (use_final_gain && final_gain_factor != 1.0f) {
-        for (float& sample : audio_buffer) {
-            sample *= final_gain_factor;
-            // 防止削波，限制在[-1.0, 1.0]范围内
-            sample = clamp(sample, -1.0f, 1.0f);
-        }
+        chain.apply_final_gain = true;
+        chain.final_gain = final_gain_factor;
         if (should_log) processing_steps += "增益→";
     }
     
+    if (chain.apply_gain || chain.apply_compression || chain.apply_final_gain) {
+        final_stats = AudioKernels::applyPointwise(data, audio_buffer.size(), chain);
+        final_stats_valid = true;
+    }
+    
     // 只在需要记录日志时计算最终信息
     if (should_log) {
-        float final_rms = calculateRMS(audio_buffer);
-        float final_max = 0.0f;
-        for (float sample : audio_buffer) {
-            final_max = std::max(final_max, std::abs(sample));
+        if (!final_stats_valid && !audio_buffer.empty()) {
+            final_stats = AudioKernels::analyze(audio_buffer.data(), audio_buffer.size());
         }
+        float final_rms = audio_buffer.empty() ? 0.0f : std::sqrt(final_stats.sum_squares / audio_buffer.size());
+        float final_max = final_stats.peak;
         
         // 移除末尾的箭头
         if (!processing_steps.empty() && processing_steps.back() == 0x2192) { // →的Unicode
@@ -72,6 +72,7 @@ namespace {
 #include <condition_variable> // 添加条件变量支持
 #include <deque>   // 添加双端队列支持
 #include "memory_serializer.h" // 添加串行内存分配器
+#include "silero_vad_engine.h"
 
 // 添加CUDA头文件用于内存同步
 #ifdef GGML_USE_CUDA
@@ -392,6 +393,12 @@ AudioProcessor::~AudioProcessor() {
         
         // 停止矫正线程
         stopCorrectionThread();
+        
+        // 离线摄取线程可能已自然结束但尚未回收
+        offline_cancel = true;
+        if (offline_thread.joinable()) {
+            offline_thread.join();
+        }
 
         // 断开所有信号连接，防止析构过程中的回调
         if (gui) {
@@ -488,6 +495,7 @@ AudioProcessor::~AudioProcessor() {
             try {
             parallel_processor->stop();
                 parallel_processor.reset();
+                result_merger.reset();
                 LOG_INFO("Parallel processor cleaned up");
             } catch (const std::exception& e) {
                 LOG_ERROR("Error cleaning parallel processor: " + std::string(e.what()));
@@ -495,6 +503,9 @@ AudioProcessor::~AudioProcessor() {
         }
         
         // 然后清理识别器（添加CUDA同步以避免内存池错误）
+        // 流式识别器使用快速识别器的模型，需先停止
+        stopStreamingRecognizer();
+        streaming_recognizer.reset();
         if (fast_recognizer) {
             try {
                 LOG_INFO("正在清理Fast recognizer...");
@@ -589,6 +600,7 @@ AudioProcessor::~AudioProcessor() {
             if (voice_detector) voice_detector.reset();
             if (audio_preprocessor) audio_preprocessor.reset();
             if (segment_handler) segment_handler.reset();
+            if (segment_voice_detector) segment_voice_detector.reset();
             LOG_INFO("Audio processing resources cleaned up");
         } catch (const std::exception& e) {
             LOG_ERROR("Error cleaning audio processing resources: " + std::string(e.what()));
@@ -1474,6 +1486,7 @@ void AudioProcessor::startProcessing() {
         // 步骤3: 设置固定VAD阈值
         if (voice_detector) {
             voice_detector->setThreshold(0.04f);
+            syncSegmentVoiceDetector();
             LOG_INFO("VAD阈值已设置为0.04");
         }
         
@@ -1531,6 +1544,7 @@ void AudioProcessor::startProcessing() {
         use_realtime_segments = should_use_realtime_segments;
         
         // 步骤8: 根据输入模式串行启动相应的输入源
+        offline_ingest_path.clear();
         switch (current_input_mode) {
             case InputMode::MICROPHONE:
                 {
@@ -1588,6 +1602,15 @@ void AudioProcessor::startProcessing() {
                     throw std::runtime_error("Audio file does not exist: " + current_file_path);
                 }
                 
+                // 离线摄取不经过文件输入源，也不播放，处理线程启动后整文件切分
+                if (fast_mode && use_offline_ingest) {
+                    offline_ingest_path = current_file_path;
+                    if (gui) {
+                        logMessage(gui, "文件输入使用离线整文件摄取: " + current_file_path);
+                    }
+                    break;
+                }
+                
                     // 串行创建或重用文件输入源
                 if (!file_input) {
                     // 将fast_mode传递给文件输入源，控制读取方式
@@ -1598,6 +1621,7 @@ void AudioProcessor::startProcessing() {
                     file_input->setFastMode(fast_mode);
                     LOG_INFO("Reusing existing file input instance");
                 }
+                file_input->setDownmixMode(file_downmix_mode, file_downmix_channel);
                 
                 // 为文件输入启用实时分段处理（根据Fast Mode设置决定）
                 if (use_realtime_segments) {
@@ -1641,6 +1665,15 @@ void AudioProcessor::startProcessing() {
                     throw std::runtime_error("No extracted audio file available for video");
                 }
                 
+                // 离线摄取只转写提取出的音频，不设置视频播放
+                if (fast_mode && use_offline_ingest) {
+                    offline_ingest_path = temp_wav_path;
+                    if (gui) {
+                        logMessage(gui, "视频音频使用离线整文件摄取: " + temp_wav_path);
+                    }
+                    break;
+                }
+                
                     // 串行创建或重用文件输入源（用于视频音频）
                 if (!file_input) {
                     // 将fast_mode传递给文件输入源，控制读取方式
@@ -1651,6 +1684,7 @@ void AudioProcessor::startProcessing() {
                     file_input->setFastMode(fast_mode);
                     LOG_INFO("Reusing existing file input instance for video audio");
                 }
+                file_input->setDownmixMode(file_downmix_mode, file_downmix_channel);
                 
                 // 为视频文件输入启用实时分段处理（根据Fast Mode设置决定）
                 if (use_realtime_segments) {
@@ -2103,6 +2137,7 @@ void AudioProcessor::startProcessing() {
                     connect(precise_network_manager, &QNetworkAccessManager::finished,
                             this, &AudioProcessor::handlePreciseServerReply);
                 }
+                getPreciseServerPool();
         
         if (gui) {
                     logMessage(gui, "Server-based precise recognition mode initialized (single-thread)");
@@ -2125,8 +2160,20 @@ void AudioProcessor::startProcessing() {
                     parallel_processor = std::make_unique<ParallelOpenAIProcessor>(this);
                     parallel_processor->setModelName(openai_model);
                     parallel_processor->setServerURL(openai_server_url);
+                    parallel_processor->setUploadFormat(openai_upload_format);
                     parallel_processor->setMaxParallelRequests(15);
                     parallel_processor->setBatchProcessing(false);
+                    
+                    // 并行请求的完成顺序不定，结果经合并器按段序号排序、去除重叠后再输出
+                    result_merger = std::make_unique<ResultMerger>();
+                    connect(parallel_processor.get(), &ParallelOpenAIProcessor::resultReady, result_merger.get(),
+                            qOverload<const QString&, const std::chrono::system_clock::time_point&>(&ResultMerger::addResult));
+                    connect(result_merger.get(), &ResultMerger::resultReady, this, [this](const QString& text) {
+                        // 失败段的空结果只用于推进序号
+                        if (!text.isEmpty()) {
+                            openAIResultReady(text);
+                        }
+                    });
                     parallel_processor->start();
                 }
                 
@@ -2144,6 +2191,16 @@ void AudioProcessor::startProcessing() {
         process_thread = std::thread([this]() { this->processAudio(); });
         LOG_INFO("处理线程已启动");
         
+        // 离线摄取需要识别组件已就绪，最后启动
+        if (!offline_ingest_path.empty()) {
+            if (offline_thread.joinable()) {
+                offline_thread.join();
+            }
+            offline_cancel = false;
+            offline_thread = std::thread([this, path = offline_ingest_path]() { runOfflineIngest(path); });
+            LOG_INFO("离线摄取线程已启动");
+        }
+        
             if (gui) {
         logMessage(gui, "Audio processing system started (串行初始化完成)");
     }
@@ -2827,6 +2884,7 @@ void AudioProcessor::setVADThreshold(float threshold) {
     if (voice_detector) {
         try {
         voice_detector->setThreshold(threshold);
+            syncSegmentVoiceDetector();
             LOG_INFO("VAD threshold updated successfully: " + std::to_string(threshold));
             
             if (gui) {
@@ -3035,7 +3093,7 @@ void AudioProcessor::onSegmentReady(const AudioSegment& segment) {
             ", 是否最后段: " + (segment.is_last ? "是" : "否") + ")");
     
     // 检查是否为空的最后段标记
-    if (segment.is_last && segment.filepath.empty()) {
+    if (segment.is_last && !segment.hasAudio()) {
                         LOG_INFO("Received empty final segment marker, starting delay processing to wait for previous audio segment recognition results");
         startFinalSegmentDelayProcessing();
         return;
@@ -3047,21 +3105,22 @@ void AudioProcessor::onSegmentReady(const AudioSegment& segment) {
         return;
     }
     
-    // 获取音频数据用于进一步处理
-    std::vector<float> audio_data;
-    
-    // 如果文件路径不为空，加载音频数据
-    if (!segment.filepath.empty()) {
-        if (!WavFileUtils::loadWavFile(segment.filepath, audio_data)) {
+    // 内存段直接引用PCM块，否则从WAV文件加载
+    PcmBlockPtr audio = segment.pcm;
+    if (!audio && !segment.filepath.empty()) {
+        std::vector<float> file_data;
+        if (!WavFileUtils::loadWavFile(segment.filepath, file_data)) {
             LOG_ERROR("无法加载音频段文件: " + segment.filepath);
             return;
         }
+        audio = PcmBlock::create(std::move(file_data), SAMPLE_RATE);
     }
     
-    LOG_INFO("音频段加载成功，样本数: " + std::to_string(audio_data.size()));
+    const size_t segment_samples = audio ? audio->size() : 0;
+    LOG_INFO("音频段加载成功，样本数: " + std::to_string(segment_samples));
     
     // 处理空音频数据的情况
-    if (audio_data.empty()) {
+    if (segment_samples == 0) {
         // 如果是最后一段且音频数据为空，说明可能是因为处理的音频段太短
         if (segment.is_last) {
             LOG_INFO("Final segment audio data is empty, starting delay processing");
@@ -3074,9 +3133,9 @@ void AudioProcessor::onSegmentReady(const AudioSegment& segment) {
     
     // 检查音频质量
     size_t min_samples = 1600;  // 最小100ms的音频（16000Hz * 0.1s）
-    if (audio_data.size() < min_samples) {
-        LOG_INFO("音频段太短 (" + std::to_string(audio_data.size()) + " 样本，" + 
-                std::to_string(audio_data.size() * 1000.0f / 16000) + "ms), 跳过处理");
+    if (segment_samples < min_samples) {
+        LOG_INFO("音频段太短 (" + std::to_string(segment_samples) + " 样本，" + 
+                std::to_string(segment_samples * 1000.0f / 16000) + "ms), 跳过处理");
         
         // 如果是最后一段，即使太短也要启动延迟处理
         if (segment.is_last) {
@@ -3087,15 +3146,12 @@ void AudioProcessor::onSegmentReady(const AudioSegment& segment) {
     }
     
     // 进入待处理队列管理逻辑
-    pending_audio_data.insert(pending_audio_data.end(), audio_data.begin(), audio_data.end());
-    pending_audio_samples += audio_data.size();
+    pending_audio_blocks.push_back(audio);
+    pending_audio_samples += segment_samples;
     
     // 处理逻辑：检查是否需要与待处理数据合并
     bool should_process_immediately = false;
     
-    // 计算当前段的时长（毫秒）
-    float segment_duration_ms = audio_data.size() * 1000.0f / sample_rate;
-    
     // 如果是最后一段音频，且有待处理数据，合并处理
     if (segment.is_last && pending_audio_samples > 0) {
         LOG_INFO("Received final audio segment, merging with pending queue for processing");
@@ -3103,19 +3159,15 @@ void AudioProcessor::onSegmentReady(const AudioSegment& segment) {
         // 处理合并后的数据 - 对最后段进一步放宽要求
         if (pending_audio_samples >= min_processing_samples / 4) {  // 对结束段大幅放宽要求到1/4
             LOG_INFO("Processing merged final audio segment with relaxed threshold, calling processAudioDataByMode");
-            processAudioDataByMode(pending_audio_data);
+            processAudioDataByMode(takePendingAudio(), true);
         } else {
             LOG_INFO("Merged audio segment still too short (" + 
                     std::to_string(pending_audio_samples * 1000.0f / sample_rate) + 
                     "ms), but forcing processing for final segment");
             // 即使很短，最后段也要强制处理，避免丢失
-            processAudioDataByMode(pending_audio_data);
+            processAudioDataByMode(takePendingAudio(), true);
         }
         
-        // 清空待处理队列
-        pending_audio_data.clear();
-        pending_audio_samples = 0;
-        
         // 启动延迟处理，确保最后一个段的识别结果有足够时间返回
         LOG_INFO("Final segment processing completed, starting delay processing to wait for recognition results");
         startFinalSegmentDelayProcessing();
@@ -3138,11 +3190,7 @@ void AudioProcessor::onSegmentReady(const AudioSegment& segment) {
     
     if (should_process_immediately) {
         LOG_INFO("处理合并音频段，调用processAudioDataByMode，样本数: " + std::to_string(pending_audio_samples));
-        processAudioDataByMode(pending_audio_data);
-        
-        // 重置待处理队列
-        pending_audio_data.clear();
-        pending_audio_samples = 0;
+        processAudioDataByMode(takePendingAudio());
     } else {
         LOG_INFO("音频段加入待处理队列，当前总样本数: " + std::to_string(pending_audio_samples) + 
                 " (需要达到 " + std::to_string(min_processing_samples) + " 才开始处理)");
@@ -3212,6 +3260,7 @@ std::string AudioProcessor::process_audio_batch(const std::vector<float>& audio_
         openai_processor = std::make_unique<ParallelOpenAIProcessor>(this);
         openai_processor->setModelName(openai_model);
         openai_processor->setServerURL(openai_server_url);
+        openai_processor->setUploadFormat(openai_upload_format);
         
         // 设置并行请求数和批处理
         openai_processor->setMaxParallelRequests(15); // 提高并行请求数到15
@@ -3444,7 +3493,7 @@ void AudioProcessor::processBufferForMicrophone(const AudioBuffer& buffer) {
             }
         }
         
-        segment_handler->addBuffer(processed_buffer);
+        segment_handler->addBuffer(std::move(processed_buffer));
         return;
     }
     
@@ -3487,11 +3536,7 @@ void AudioProcessor::processBufferForMicrophone(const AudioBuffer& buffer) {
                         }
                         break;
             }
-            
-            // 只有在未启用实时分段时才添加到队列，避免重复处理
-            if (!use_realtime_segments && audio_queue) {
-            audio_queue->push(processed_buffer);
-    }
+    // 处理后的缓冲区不再放回audio_queue：本函数运行在队列的消费者线程上，放回会被重复处理
 }
 
 void AudioProcessor::processBufferForFile(const AudioBuffer& buffer) {
@@ -3563,7 +3608,7 @@ void AudioProcessor::processBufferForFile(const AudioBuffer& buffer) {
         if (use_realtime_segments && segment_handler) {
             AudioBuffer end_marker = buffer;
             end_marker.is_last = true;
-            segment_handler->addBuffer(end_marker);
+            segment_handler->addBuffer(std::move(end_marker));
         }
         
         return;
@@ -3613,7 +3658,7 @@ void AudioProcessor::processBufferForFile(const AudioBuffer& buffer) {
         }
         
        //LOG_INFO("文件缓冲区发送到基于VAD的实时分段处理器");
-        segment_handler->addBuffer(processed_buffer);
+        segment_handler->addBuffer(std::move(processed_buffer));
         
         // 修复：当使用实时分段处理器时，不要重复添加到audio_queue
         // 避免同一音频数据被两个不同路径并行处理导致的音频帧乱序问题
@@ -3679,17 +3724,7 @@ void AudioProcessor::processBufferForFile(const AudioBuffer& buffer) {
         current_batch.clear();
     }
     
-    // 只有在未启用实时分段时才添加到音频队列，避免重复处理
-    if (!use_realtime_segments) {
-    if (audio_queue) {
-        audio_queue->push(processed_buffer);
-    } else {
-        LOG_ERROR("音频队列未初始化，无法添加处理后的缓冲区");
-        }
-    } else {
-        // 使用实时分段时，音频已经通过segment_handler处理，不需要重复添加到队列
-        LOG_DEBUG("实时分段模式：跳过向audio_queue添加数据，避免重复处理");
-    }
+    // 处理后的缓冲区不再放回audio_queue：本函数运行在队列的消费者线程上，放回会被重复处理
 }
 
 // 实现setRealtimeMode方法
@@ -3744,15 +3779,25 @@ void AudioProcessor::initializeRealtimeSegments() {
     // 显式禁用重叠处理，避免重复处理音频
     segment_handler->setUseOverlapProcessing(false);
     
+    // 段以内存PCM块交付，避免临时WAV文件的写入和重新解码
+    segment_handler->setInMemorySegments(true);
+    
+    // 流式部分结果
+    startStreamingRecognizer();
+    
     // 设置音频预处理器和VAD检测器
     if (audio_preprocessor) {
         segment_handler->setAudioPreprocessor(audio_preprocessor.get());
         LOG_INFO("已为实时分段处理器设置音频预处理器");
     }
     
+    // 分段处理器检测预处理后的音频，本类检测原始音频；两路音频交替送入同一个检测器
+    // 会把各自跨调用的帧缓存和平滑状态拼接在一起，因此分段处理器使用独立的检测器
     if (voice_detector) {
-        segment_handler->setVoiceActivityDetector(voice_detector.get());
-        LOG_INFO("已为实时分段处理器设置VAD检测器");
+        segment_voice_detector = std::make_unique<VoiceActivityDetector>(vad_threshold);
+        segment_voice_detector->copySettingsFrom(*voice_detector);
+        segment_handler->setVoiceActivityDetector(segment_voice_detector.get());
+        LOG_INFO("已为实时分段处理器设置独立的VAD检测器");
     }
     
     // 启动分段处理器
@@ -3770,6 +3815,232 @@ void AudioProcessor::initializeRealtimeSegments() {
     }
 }
 
+void AudioProcessor::setStreamingPartials(bool enable) {
+    use_streaming_partials = enable;
+    LOG_INFO("流式部分结果 " + std::string(enable ? "已启用" : "已禁用"));
+    
+    // 处理中切换时立即对当前分段处理器生效
+    if (is_processing && segment_handler) {
+        if (enable) {
+            startStreamingRecognizer();
+        } else {
+            stopStreamingRecognizer();
+        }
+    }
+}
+
+void AudioProcessor::setFileDownmix(DownmixMode mode, int channel) {
+    file_downmix_mode = mode;
+    file_downmix_channel = std::max(0, channel);
+    if (file_input) {
+        file_input->setDownmixMode(file_downmix_mode, file_downmix_channel);
+    }
+}
+
+void AudioProcessor::setOfflineIngest(bool enable) {
+    use_offline_ingest = enable;
+    LOG_INFO(std::string("离线整文件摄取: ") + (enable ? "启用" : "禁用") +
+            (enable && !fast_mode ? "（需开启Fast Mode才生效）" : ""));
+}
+
+void AudioProcessor::runOfflineIngest(const std::string& file_path) {
+    OfflineIngestOptions options = offline_ingest_options;
+    options.downmix_mode = file_downmix_mode;
+    options.downmix_channel = file_downmix_channel;
+    
+    OfflineFileIngestor ingestor(options);
+    if (!ingestor.load(file_path, &offline_cancel)) {
+        if (!offline_cancel) {
+            LOG_ERROR("离线摄取失败: " + ingestor.getError());
+            if (gui) {
+                logMessage(gui, "离线摄取失败: " + ingestor.getError(), true);
+            }
+        }
+    } else {
+        const auto& segments = ingestor.getSegments();
+        if (gui) {
+            logMessage(gui, "离线摄取切出" + std::to_string(segments.size()) + "个语音段，开始识别");
+        }
+        
+        if (current_recognition_mode == RecognitionMode::FAST_RECOGNITION) {
+            transcribeOfflineParallel(segments);
+        } else {
+            for (size_t i = 0; i < segments.size() && !offline_cancel && is_processing; ++i) {
+                dispatchOfflineSegment(segments[i], i + 1 == segments.size());
+            }
+        }
+    }
+    
+    // 与文件输入源读完文件时一样，发送最后一个缓冲区标记，由处理线程完成收尾
+    if (!offline_cancel && audio_queue) {
+        AudioBuffer last_buffer;
+        last_buffer.is_last = true;
+        last_buffer.timestamp = std::chrono::system_clock::now();
+        audio_queue->push(std::move(last_buffer), true);
+        LOG_INFO("离线摄取已分发全部语音段，发送结束标记");
+    }
+}
+
+void AudioProcessor::transcribeOfflineParallel(const std::vector<OfflineSpeechSegment>& segments) {
+    if (!fast_recognizer || segments.empty()) {
+        return;
+    }
+    
+    // 每个状态分到约4个线程时吞吐最好，状态再多只会增加内存占用
+    int states = offline_parallel_states;
+    if (states <= 0) {
+        states = std::max(1, std::min(8, static_cast<int>(std::thread::hardware_concurrency()) / 4));
+    }
+    if (use_gpu) {
+        states = std::min(states, 2);  // 多个状态争用同一块GPU，并行收益有限
+    }
+    
+    std::vector<PcmBlockPtr> blocks;
+    blocks.reserve(segments.size());
+    for (const auto& segment : segments) {
+        blocks.push_back(segment.pcm);
+    }
+    
+    const auto start_time = std::chrono::steady_clock::now();
+    SegmentStitcher stitcher;
+    size_t emitted = 0;
+    fast_recognizer->process_blocks_parallel(blocks, states,
+        [this, &segments, &stitcher, &emitted](size_t index, const std::string& text) {
+            const OfflineSpeechSegment& segment = segments[index];
+            RecognitionResult result;
+            result.text = text;
+            result.timestamp = segment.timestamp();
+            result.duration = static_cast<qint64>(segment.pcm->durationMs());
+            
+            const size_t emitted_before = emitted;
+            for (auto& ready : stitcher.add(segment.sequence_number, std::move(result), segment.overlap_ms)) {
+                if (!ready.text.empty() && final_results) {
+                    final_results->push(ready);
+                }
+                ++emitted;
+            }
+            if (gui && emitted / 20 != emitted_before / 20) {
+                logMessage(gui, "离线识别进度: " + std::to_string(emitted) + "/" + std::to_string(segments.size()));
+            }
+        }, &offline_cancel);
+    
+    LOG_INFO("离线并行识别完成: " + std::to_string(emitted) + "/" + std::to_string(segments.size()) +
+            "段，耗时" + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start_time).count()) + "ms");
+}
+
+void AudioProcessor::dispatchOfflineSegment(const OfflineSpeechSegment& segment, bool is_last) {
+    const auto timestamp = segment.timestamp();
+    
+    switch (current_recognition_mode) {
+        case RecognitionMode::PRECISE_RECOGNITION:
+            {
+                // 在途上传达到上限时等待，避免把整个文件的语音段同时压给服务器
+                while (!offline_cancel && is_processing) {
+                    size_t in_flight = static_cast<size_t>(offline_queued_uploads.load());
+                    {
+                        std::lock_guard<std::mutex> lock(active_requests_mutex);
+                        in_flight += active_requests.size();
+                    }
+                    if (in_flight < static_cast<size_t>(offline_max_uploads)) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                }
+                if (offline_cancel || !is_processing) {
+                    break;
+                }
+                
+                RecognitionParams params;
+                params.language = current_language;
+                params.use_gpu = use_gpu;
+                params.is_final_segment = is_last;
+                
+                // 上传在主线程发起，发起后才计入active_requests，在此之前单独计数
+                PcmBlockPtr pcm = segment.pcm;
+                offline_queued_uploads++;
+                QMetaObject::invokeMethod(this, [this, pcm, params]() {
+                    if (is_processing) {
+                        sendToPreciseServer(pcm, params);
+                    }
+                    offline_queued_uploads--;
+                }, Qt::QueuedConnection);
+            }
+            break;
+            
+        case RecognitionMode::OPENAI_RECOGNITION:
+            if (parallel_processor) {
+                AudioSegment audio_segment;
+                audio_segment.pcm = segment.pcm;
+                audio_segment.sequence_number = segment.sequence_number;
+                audio_segment.timestamp = timestamp;
+                audio_segment.duration_ms = segment.pcm->durationMs();
+                audio_segment.has_overlap = segment.overlap_ms > 0;
+                audio_segment.overlap_ms = segment.overlap_ms;
+                audio_segment.is_last = is_last;
+                parallel_processor->addSegment(audio_segment);
+            }
+            break;
+            
+        default:
+            break;
+    }
+}
+
+void AudioProcessor::startStreamingRecognizer() {
+    stopStreamingRecognizer();
+    if (!use_streaming_partials || !segment_handler) {
+        return;
+    }
+    
+    // 部分结果需要对同一段音频反复解码，只有本地快速模型适合这样做
+    if (current_recognition_mode != RecognitionMode::FAST_RECOGNITION) {
+        LOG_INFO("流式部分结果仅在快速识别模式下可用，当前模式不启用");
+        return;
+    }
+    
+    if (!streaming_recognizer) {
+        streaming_recognizer = std::make_unique<StreamingRecognizer>(
+            [this](const std::vector<float>& audio, std::string& text) {
+                return fast_recognizer && fast_recognizer->decodePartial(audio, text);
+            },
+            [this](const std::string& committed, const std::string& tentative) {
+                // whisper输出的开头带有空格，显示前去掉
+                QString committed_text = QString::fromStdString(committed);
+                QString tentative_text = QString::fromStdString(tentative);
+                while (committed_text.startsWith(' ')) committed_text.remove(0, 1);
+                if (committed_text.isEmpty()) {
+                    while (tentative_text.startsWith(' ')) tentative_text.remove(0, 1);
+                }
+                emit partialResultReady(committed_text, tentative_text);
+            },
+            streaming_window_ms,
+            sample_rate);
+    }
+    streaming_recognizer->start();
+    
+    segment_handler->setPartialAudioCallback([this](size_t segment_id, const std::vector<float>& audio, bool segment_ended) {
+        if (!streaming_recognizer) {
+            return;
+        }
+        if (segment_ended) {
+            streaming_recognizer->endSegment(segment_id);
+        } else {
+            streaming_recognizer->submit(segment_id, audio);
+        }
+    });
+    segment_handler->setStreamingPartials(true, streaming_step_ms);
+}
+
+void AudioProcessor::stopStreamingRecognizer() {
+    if (segment_handler) {
+        segment_handler->setStreamingPartials(false, streaming_step_ms);
+    }
+    if (streaming_recognizer) {
+        streaming_recognizer->stop();
+    }
+}
+
 // 在AudioProcessor::getTempAudioPath后添加
 std::string AudioProcessor::getTemporaryDirectory(const std::string& subdir) const {
     QDir temp_dir = QDir::temp();
@@ -4033,6 +4304,7 @@ void AudioProcessor::initializeParameters() {
     if (voice_detector) {
         voice_detector->setVADMode(2);  // 改为模式2（质量模式），平衡敏感度和准确性
         voice_detector->setThreshold(0.04f);  // 使用固定的0.04阈值进行分段
+        syncSegmentVoiceDetector();
     }
     
     
@@ -4059,7 +4331,7 @@ void AudioProcessor::initializeParameters() {
     segment_overlap_ms = 0;  // 不使用重叠，避免重复字
     
     // 初始化待处理音频队列
-    pending_audio_data.clear();
+    pending_audio_blocks.clear();
     pending_audio_samples = 0;
     
     // 初始化防重复推送缓存
@@ -4098,6 +4370,158 @@ void AudioProcessor::initializeParameters() {
         LOG_INFO("使用默认输出矫正配置");
     }
     
+    // 加载流式部分结果配置
+    try {
+        const nlohmann::json& config_data = config.getConfigData();
+        if (config_data.contains("recognition") && config_data["recognition"].contains("streaming")) {
+            const auto& streaming_config = config_data["recognition"]["streaming"];
+            use_streaming_partials = streaming_config.value("enabled", false);
+            streaming_step_ms = streaming_config.value("step_ms", 500);
+            streaming_window_ms = streaming_config.value("window_ms", 15000);
+            
+            LOG_INFO("流式部分结果: " + std::string(use_streaming_partials ? "启用" : "禁用") +
+                    "，步长: " + std::to_string(streaming_step_ms) + "ms，窗口: " +
+                    std::to_string(streaming_window_ms) + "ms");
+        }
+    } catch (const std::exception& e) {
+        LOG_WARNING("加载流式部分结果配置时出错: " + std::string(e.what()));
+    }
+    
+    // 加载多声道文件下混配置
+    try {
+        const nlohmann::json& config_data = config.getConfigData();
+        if (config_data.contains("audio") && config_data["audio"].contains("file_downmix")) {
+            const auto& downmix_config = config_data["audio"]["file_downmix"];
+            DownmixMode mode = DownmixMode::Average;
+            const std::string mode_name = downmix_config.value("mode", std::string("average"));
+            if (!ChannelDownmixer::parseMode(mode_name, mode)) {
+                LOG_WARNING("未知的下混方式: " + mode_name + "，使用average");
+            }
+            setFileDownmix(mode, downmix_config.value("channel", 0));
+            
+            LOG_INFO("文件下混方式: " + std::string(ChannelDownmixer::getModeName(file_downmix_mode)) +
+                    (file_downmix_mode == DownmixMode::SelectChannel ?
+                     "，声道: " + std::to_string(file_downmix_channel) : ""));
+        }
+    } catch (const std::exception& e) {
+        LOG_WARNING("加载文件下混配置时出错: " + std::string(e.what()));
+    }
+    
+    // 加载离线整文件摄取配置
+    try {
+        const nlohmann::json& config_data = config.getConfigData();
+        if (config_data.contains("audio") && config_data["audio"].contains("offline_ingest")) {
+            const auto& ingest_config = config_data["audio"]["offline_ingest"];
+            OfflineIngestOptions& options = offline_ingest_options;
+            options.vad_mode = ingest_config.value("vad_mode", options.vad_mode);
+            options.min_silence_ms = ingest_config.value("min_silence_ms", options.min_silence_ms);
+            options.min_speech_ms = ingest_config.value("min_speech_ms", options.min_speech_ms);
+            options.max_segment_ms = ingest_config.value("max_segment_ms", options.max_segment_ms);
+            options.padding_ms = ingest_config.value("padding_ms", options.padding_ms);
+            options.split_overlap_ms = ingest_config.value("split_overlap_ms", options.split_overlap_ms);
+            offline_max_uploads = std::max(1, ingest_config.value("max_parallel_uploads", offline_max_uploads));
+            offline_parallel_states = std::max(0, ingest_config.value("parallel_states", offline_parallel_states));
+            setOfflineIngest(ingest_config.value("enabled", false));
+            
+            LOG_INFO("离线摄取参数: VAD模式=" + std::to_string(options.vad_mode) +
+                    "，最大段长=" + std::to_string(options.max_segment_ms) + "ms" +
+                    "，并行上传=" + std::to_string(offline_max_uploads) +
+                    "，并行状态=" + (offline_parallel_states > 0 ? std::to_string(offline_parallel_states) : std::string("自动")));
+        }
+    } catch (const std::exception& e) {
+        LOG_WARNING("加载离线摄取配置时出错: " + std::string(e.what()));
+    }
+    
+    // 加载精确识别服务器池配置（在服务器池创建前生效）
+    try {
+        const nlohmann::json& config_data = config.getConfigData();
+        if (config_data.contains("recognition") && config_data["recognition"].contains("precise_server_pool")) {
+            const auto& pool_config = config_data["recognition"]["precise_server_pool"];
+            precise_extra_endpoints.clear();
+            if (pool_config.contains("endpoints") && pool_config["endpoints"].is_array()) {
+                for (const auto& url : pool_config["endpoints"]) {
+                    if (url.is_string() && !url.get<std::string>().empty()) {
+                        precise_extra_endpoints.push_back(url.get<std::string>());
+                    }
+                }
+            }
+            const std::string routing_name = pool_config.value("routing", std::string("least_outstanding"));
+            if (!PreciseServerPool::parseRouting(routing_name, precise_routing)) {
+                LOG_WARNING("未知的服务器路由方式: " + routing_name + "，使用least_outstanding");
+                precise_routing = PreciseRouting::LeastOutstanding;
+            }
+            
+            LOG_INFO("精确识别服务器池: 额外服务器 " + std::to_string(precise_extra_endpoints.size()) + " 台" +
+                    "，路由方式 " + PreciseServerPool::getRoutingName(precise_routing));
+        }
+    } catch (const std::exception& e) {
+        LOG_WARNING("加载服务器池配置时出错: " + std::string(e.what()));
+    }
+    
+    // 加载上传格式配置：flac为无损压缩，需要服务器支持
+    try {
+        const nlohmann::json& config_data = config.getConfigData();
+        if (config_data.contains("recognition")) {
+            const auto& recognition_config = config_data["recognition"];
+            auto load_format = [](const nlohmann::json& section, const char* key, std::string& format) {
+                const std::string value = section.value(key, format);
+                if (value == "wav" || value == "flac") {
+                    format = value;
+                } else {
+                    LOG_WARNING("未知的上传格式: " + value + "，使用" + format);
+                }
+            };
+            load_format(recognition_config, "precise_upload_format", precise_upload_format);
+            if (recognition_config.contains("openai_mode")) {
+                load_format(recognition_config["openai_mode"], "upload_format", openai_upload_format);
+            }
+            LOG_INFO("上传格式: 精确识别 " + precise_upload_format + "，OpenAI " + openai_upload_format);
+        }
+    } catch (const std::exception& e) {
+        LOG_WARNING("加载上传格式配置时出错: " + std::string(e.what()));
+    }
+    
+    // 加载精确识别服务器健康监测配置（在健康监测创建前生效）
+    try {
+        const nlohmann::json& config_data = config.getConfigData();
+        if (config_data.contains("recognition") && config_data["recognition"].contains("precise_health_check")) {
+            const auto& health_config = config_data["recognition"]["precise_health_check"];
+            HealthCheckOptions& options = precise_health_options;
+            options.interval_ms = std::max(500, health_config.value("interval_ms", options.interval_ms));
+            options.timeout_ms = std::max(100, health_config.value("timeout_ms", options.timeout_ms));
+            options.failure_threshold = std::max(1, health_config.value("failure_threshold", options.failure_threshold));
+            options.open_ms = std::max(100, health_config.value("open_ms", options.open_ms));
+            options.max_open_ms = std::max(options.open_ms, health_config.value("max_open_ms", options.max_open_ms));
+            options.track_load = health_config.value("track_load", options.track_load);
+            
+            LOG_INFO("精确识别服务器健康监测: 探测间隔 " + std::to_string(options.interval_ms) + "ms" +
+                    "，连续失败 " + std::to_string(options.failure_threshold) + " 次后熔断" +
+                    "，熔断等待 " + std::to_string(options.open_ms) + "-" + std::to_string(options.max_open_ms) + "ms" +
+                    (options.track_load ? "，持续跟踪服务器排队深度" : "，有上传成功时跳过探测"));
+        }
+    } catch (const std::exception& e) {
+        LOG_WARNING("加载健康监测配置时出错: " + std::string(e.what()));
+    }
+    
+    // 加载Silero VAD共享引擎配置（需在创建VAD检测器之前设置）
+    try {
+        const nlohmann::json& config_data = config.getConfigData();
+        if (config_data.contains("audio") && config_data["audio"].contains("silero_engine")) {
+            const auto& engine_config = config_data["audio"]["silero_engine"];
+            SileroEngineOptions engine_options = SileroVADEngine::getDefaultOptions();
+            engine_options.intra_op_threads = engine_config.value("intra_op_threads", engine_options.intra_op_threads);
+            engine_options.max_batch = engine_config.value("max_batch", engine_options.max_batch);
+            engine_options.batch_wait_us = engine_config.value("batch_wait_us", engine_options.batch_wait_us);
+            SileroVADEngine::setDefaultOptions(engine_options);
+            
+            LOG_INFO("Silero VAD共享引擎: 算子内线程数 " + std::to_string(engine_options.intra_op_threads) +
+                    "，最大批大小 " + std::to_string(engine_options.max_batch) +
+                    "，凑批等待 " + std::to_string(engine_options.batch_wait_us) + "us");
+        }
+    } catch (const std::exception& e) {
+        LOG_WARNING("加载Silero VAD共享引擎配置时出错: " + std::string(e.what()));
+    }
+    
     // 记录配置加载情况
     LOG_INFO("配置已从ConfigManager加载：");
     LOG_INFO("语言: " + current_language);
@@ -4203,17 +4627,39 @@ void AudioProcessor::setPreEmphasisCoefficient(float coef) {
 // 实现发送到精确识别服务器的方法
 bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path, 
                                       const RecognitionParams& params) {
+    return postToPreciseServer(audio_file_path, nullptr, params);
+}
+
+bool AudioProcessor::sendToPreciseServer(const PcmBlockPtr& audio, 
+                                      const RecognitionParams& params) {
+    if (!audio || audio->empty()) {
+        LOG_ERROR("Precise recognition: in-memory audio block is empty");
+        return false;
+    }
+    return postToPreciseServer("", audio, params);
+}
+
+bool AudioProcessor::postToPreciseServer(const std::string& audio_file_path, 
+                                      const PcmBlockPtr& audio,
+                                      const RecognitionParams& params,
+                                      const PreciseEndpointPtr& failed_endpoint) {
     // 确保网络操作在主线程中进行
     if (QThread::currentThread() != this->thread()) {
         // 如果不在主线程，异步调用
-        QMetaObject::invokeMethod(this, [this, audio_file_path, params]() {
-            sendToPreciseServer(audio_file_path, params);
+        QMetaObject::invokeMethod(this, [this, audio_file_path, audio, params, failed_endpoint]() {
+            postToPreciseServer(audio_file_path, audio, params, failed_endpoint);
         }, Qt::QueuedConnection);
         return true;
     }
     
+    // 内存段没有文件路径，日志和上传文件名使用统一的描述
+    const std::string audio_desc = audio
+        ? "in-memory segment (" + std::to_string(audio->size()) + " samples)"
+        : audio_file_path;
+    
     // 验证服务器URL
-    if (precise_server_url.empty()) {
+    PreciseServerPool* server_pool = getPreciseServerPool();
+    if (server_pool->size() == 0) {
         LOG_ERROR("Precise server URL is empty, cannot send request");
         if (gui) {
             QMetaObject::invokeMethod(gui, "appendLogMessage", 
@@ -4224,31 +4670,15 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
         return false;
     }
     
-    LOG_INFO("Using precise server URL: " + precise_server_url);
-    LOG_INFO("Sending audio file: " + audio_file_path);
+    LOG_INFO("Sending audio: " + audio_desc);
     LOG_INFO("Parameters - Language: " + params.language + ", GPU: " + std::string(params.use_gpu ? "true" : "false"));
     
-    // 首先测试服务器连通性
-    LOG_INFO("Starting to test precise recognition server connection: " + precise_server_url);
-    
-    LOG_INFO("Testing server connectivity before file upload...");
-    
-    if (!testPreciseServerConnection()) {
-        LOG_ERROR("Server connectivity test failed, aborting file upload");
-        if (gui) {
-            QMetaObject::invokeMethod(gui, "appendLogMessage", 
-                Qt::QueuedConnection, 
-                Q_ARG(QString, QString("Error: Cannot connect to precision server")),
-                Q_ARG(bool, true));
-        }
-        return false;
-    }
-    LOG_INFO("Server connectivity test passed, proceeding with file upload");
-    
+    PreciseEndpointPtr endpoint;
+    bool request_sent = false;
     try {
-        // 检查音频文件是否存在
+        // 检查音频文件是否存在（内存段无需检查）
     QFileInfo fileInfo(QString::fromStdString(audio_file_path));
-        if (!fileInfo.exists()) {
+        if (!audio && !fileInfo.exists()) {
             std::string error = "Audio file does not exist: " + audio_file_path;
             
             // 异步更新日志
@@ -4261,30 +4691,57 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
         return false;
     }
     
-        // 检查文件大小（如果太大可能导致上传失败）
-        qint64 fileSize = fileInfo.size();
-        LOG_INFO("Audio file size: " + std::to_string(fileSize) + " bytes (" + std::to_string(fileSize / 1024) + " KB)");
-        
-        if (fileSize > 50 * 1024 * 1024) { // 50MB限制
-            LOG_WARNING("Audio file is very large (" + std::to_string(fileSize / 1024 / 1024) + " MB), upload may fail");
+        // 内存段的上传格式要等选定服务器后才能确定，这里只按样本数检查是否为空，不提前编码
+        qint64 fileSize = audio ? 0 : fileInfo.size();
+        if (audio ? audio->empty() : fileSize == 0) {
+            LOG_ERROR("Audio file is empty");
             if (gui) {
                 QMetaObject::invokeMethod(gui, "appendLogMessage", 
                     Qt::QueuedConnection, 
-                    Q_ARG(QString, QString("Warning: Large file size may cause upload issues (%1 MB)").arg(fileSize / 1024 / 1024)),
-                    Q_ARG(bool, false));
+                    Q_ARG(QString, QString("Error: Audio file is empty")),
+                    Q_ARG(bool, true));
             }
+            return false;
         }
         
-        if (fileSize == 0) {
-            LOG_ERROR("Audio file is empty");
+        // 服务器连通性由后台健康监测维护，这里只按缓存的熔断状态和负载选择服务器，不再为每个段同步请求一次/health
+        endpoint = server_pool->acquire(failed_endpoint);
+        if (!endpoint) {
+            LOG_ERROR("No precise server available, aborting upload: " + audio_desc + " - " + server_pool->describe());
             if (gui) {
                 QMetaObject::invokeMethod(gui, "appendLogMessage", 
                     Qt::QueuedConnection, 
-                    Q_ARG(QString, QString("Error: Audio file is empty")),
+                    Q_ARG(QString, QString("Error: Cannot connect to precision server")),
                     Q_ARG(bool, true));
             }
             return false;
         }
+        LOG_INFO("Using precise server URL: " + endpoint->getUrl() +
+                 " (outstanding: " + std::to_string(endpoint->getOutstanding()) + ")");
+        
+        // 服务器在/health中声明支持FLAC时压缩上传内存段，否则保持WAV
+        const bool upload_flac = audio && precise_upload_format == "flac" &&
+                                 endpoint->getMonitor().supportsUploadFormat("flac");
+        if (audio) {
+            // 只编码实际上传的格式，大小和超时都按上传的字节数计算
+            fileSize = static_cast<qint64>(upload_flac ? audio->flacBytes().size() : audio->wavBytes().size());
+            if (upload_flac) {
+                LOG_INFO("Uploading as FLAC");
+            }
+        }
+        
+        // 检查上传大小（如果太大可能导致上传失败）
+        LOG_INFO("Audio file size: " + std::to_string(fileSize) + " bytes (" + std::to_string(fileSize / 1024) + " KB)");
+        
+        if (fileSize > 50 * 1024 * 1024) { // 50MB限制
+            LOG_WARNING("Audio file is very large (" + std::to_string(fileSize / 1024 / 1024) + " MB), upload may fail");
+            if (gui) {
+                QMetaObject::invokeMethod(gui, "appendLogMessage", 
+                    Qt::QueuedConnection, 
+                    Q_ARG(QString, QString("Warning: Large file size may cause upload issues (%1 MB)").arg(fileSize / 1024 / 1024)),
+                    Q_ARG(bool, false));
+            }
+        }
         
         // 生成唯一请求ID
         int request_id = next_request_id.fetch_add(1);
@@ -4296,10 +4753,7 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
     }
     
         // 获取文件大小用于动态超时计算
-        qint64 file_size = 0;
-        if (std::filesystem::exists(audio_file_path)) {
-            file_size = std::filesystem::file_size(audio_file_path);
-        }
+        qint64 file_size = fileSize;
         
         // 保存请求信息用于重试机制
         {
@@ -4307,9 +4761,12 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
             RequestInfo& info = active_requests[request_id];
             info.start_time = std::chrono::system_clock::now();
             info.file_path = audio_file_path;
+            info.audio = audio;
             info.params = params;
+            info.is_final_segment = params.is_final_segment;
             info.file_size = file_size;
             info.retry_count = 0;
+            info.endpoint = endpoint;
         }
         
         // 添加网络超时设置 - 使用动态超时
@@ -4321,11 +4778,12 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
         LOG_INFO("Set dynamic timeout: " + std::to_string(dynamic_timeout/1000) + " seconds for file size: " + std::to_string(file_size) + " bytes");
         
         // 构建服务器URL
-        QString serverUrl = QString::fromStdString(precise_server_url + "/recognize");
+        QString serverUrl = QString::fromStdString(endpoint->getUrl() + "/recognize");
         QUrl apiUrl(serverUrl);
         
         if (!apiUrl.isValid()) {
-            std::string error = "Invalid server URL: " + precise_server_url;
+            std::string error = "Invalid server URL: " + endpoint->getUrl();
+            server_pool->release(endpoint, PreciseServerPool::Outcome::Cancelled, -1.0);
             
             // 异步更新日志
             if (gui) {
@@ -4345,18 +4803,27 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
         QHttpMultiPart* multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
         
         // 添加音频文件部分
+        QString uploadName = audio ? QString(upload_flac ? "segment_%1.flac" : "segment_%1.wav").arg(request_id)
+                                   : fileInfo.fileName();
         QHttpPart filePart;
         filePart.setHeader(QNetworkRequest::ContentDispositionHeader, 
                            QVariant("form-data; name=\"file\"; filename=\"" + 
-                               fileInfo.fileName() + "\""));
-        filePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("audio/wav"));
-        
+                               uploadName + "\""));
+        filePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant(upload_flac ? "audio/flac" : "audio/wav"));
+        
+        if (audio) {
+            // 内存段：直接使用缓存的WAV/FLAC字节流，不经过磁盘
+            const std::string& bytes = upload_flac ? audio->flacBytes() : audio->wavBytes();
+            filePart.setBody(QByteArray(bytes.data(), static_cast<qsizetype>(bytes.size())));
+            multiPart->append(filePart);
+        } else {
         QFile *file = new QFile(QString::fromStdString(audio_file_path));
         if (!file->open(QIODevice::ReadOnly)) {
             delete multiPart;
             delete file;
             
             std::string error = "Failed to open audio file: " + audio_file_path;
+            server_pool->release(endpoint, PreciseServerPool::Outcome::Cancelled, -1.0);
             
             // 异步更新日志
             if (gui) {
@@ -4371,6 +4838,7 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
         filePart.setBodyDevice(file);
         file->setParent(multiPart); // 当multiPart被删除时，file也会被删除
         multiPart->append(filePart);
+        }
         
         // 添加参数部分
         QJsonObject paramsObject;
@@ -4378,6 +4846,7 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
         paramsObject["use_gpu"] = params.use_gpu;
         paramsObject["beam_size"] = params.beam_size;
         paramsObject["temperature"] = params.temperature;
+        paramsObject["is_final_segment"] = params.is_final_segment;
         
         QJsonDocument paramsDoc(paramsObject);
         QByteArray paramsData = paramsDoc.toJson();
@@ -4392,6 +4861,8 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
         // 发送异步请求
         QNetworkReply* reply = precise_network_manager->post(request, multiPart);
         multiPart->setParent(reply);
+        request_sent = true;
+        const auto sent_at = std::chrono::steady_clock::now();
         
         // 添加详细的请求调试信息
         LOG_INFO("Sending POST request to: " + apiUrl.toString().toStdString());
@@ -4399,7 +4870,7 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
         for (const auto& header : request.rawHeaderList()) {
             LOG_INFO("  " + header.toStdString() + ": " + request.rawHeader(header).toStdString());
         }
-        LOG_INFO("Audio file size: " + std::to_string(fileInfo.size()) + " bytes");
+        LOG_INFO("Audio upload size: " + std::to_string(fileSize) + " bytes");
         LOG_INFO("Request ID: " + std::to_string(request_id));
         
         // 添加网络超时设置
@@ -4455,7 +4926,7 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
         });
         
         // 连接超时处理 - 使用安全的指针检查和重试逻辑，对最后段的请求延长超时时间
-        connect(timeoutTimer, &QTimer::timeout, this, [this, safeReply, request_id, safeTimer]() {
+        connect(timeoutTimer, &QTimer::timeout, this, [this, safeReply, request_id, safeTimer, endpoint]() {
             // 检查处理状态，如果处理已经停止，不延长超时
             if (!is_processing) {
                 LOG_INFO("Request " + std::to_string(request_id) + " timeout after processing stopped, canceling request");
@@ -4498,6 +4969,7 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
             }
             
             LOG_ERROR("Request " + std::to_string(request_id) + " timed out");
+            endpoint->getMonitor().recordFailure(endpoint->getUrl() + ": request " + std::to_string(request_id) + " timed out");
             
             // 检查是否应该重试
             if (shouldRetryRequest(request_id, QNetworkReply::TimeoutError)) {
@@ -4562,7 +5034,7 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
         
         
         // 异步处理完成信号
-        connect(reply, &QNetworkReply::finished, this, [this, request_id, reply]() {
+        connect(reply, &QNetworkReply::finished, this, [this, request_id, reply, endpoint, sent_at]() {
             // 清理请求时间戳
             {
                 std::lock_guard<std::mutex> lock(request_mutex);
@@ -4575,6 +5047,21 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
                 active_requests.erase(request_id);
             }
             
+            // 请求结果反馈给服务器池：服务器有响应即视为存活，连接错误和5xx计为失败；主动中止（含超时）的请求不计入
+            if (precise_server_pool) {
+                const int status_code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+                PreciseServerPool::Outcome outcome = PreciseServerPool::Outcome::Success;
+                if (reply->error() == QNetworkReply::OperationCanceledError) {
+                    outcome = PreciseServerPool::Outcome::Cancelled;
+                } else if (status_code >= 500 || (status_code == 0 && reply->error() != QNetworkReply::NoError)) {
+                    outcome = PreciseServerPool::Outcome::Failure;
+                }
+                const double latency_ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - sent_at).count();
+                precise_server_pool->release(endpoint, outcome, latency_ms,
+                                             "request " + std::to_string(request_id) + " failed: " + reply->errorString().toStdString());
+            }
+            
             if (reply->error() == QNetworkReply::NoError) {
                 QByteArray response = reply->readAll();
                 
@@ -4618,12 +5105,15 @@ bool AudioProcessor::sendToPreciseServer(const std::string& audio_file_path,
             QMetaObject::invokeMethod(gui, "appendLogMessage", 
                 Qt::QueuedConnection, 
                 Q_ARG(QString, QString("Sending precise recognition request (ID: %1): %2")
-                                     .arg(request_id).arg(QString::fromStdString(audio_file_path))));
+                                     .arg(request_id).arg(QString::fromStdString(audio_desc))));
         }
     
     return true;
     } catch (const std::exception& e) {
         std::cerr << "Error sending request to precise server: " << e.what() << std::endl;
+        if (endpoint && !request_sent) {
+            server_pool->release(endpoint, PreciseServerPool::Outcome::Cancelled, -1.0);
+        }
         if (gui) {
             QMetaObject::invokeMethod(gui, "appendLogMessage", 
                 Qt::QueuedConnection, 
@@ -5006,6 +5496,9 @@ void AudioProcessor::setRecognitionMode(RecognitionMode mode) {
 // 添加精确服务器URL设置方法
 void AudioProcessor::setPreciseServerURL(const std::string& url) {
     precise_server_url = url;
+    if (precise_server_pool) {
+        precise_server_pool->setEndpoints(getPreciseEndpointUrls());
+    }
     
     // 更新配置文件
     try {
@@ -5058,6 +5551,9 @@ void AudioProcessor::setPreciseServerURL(const std::string& url) {
 // 添加精确服务器连接测试方法
 bool AudioProcessor::testPreciseServerConnection() {
     LOG_INFO("开始测试精确识别服务器连接: " + precise_server_url);
+    
+    // 手动测试的结果同样反馈给该服务器的健康监测
+    PreciseEndpointPtr tested_endpoint = precise_server_pool ? precise_server_pool->find(precise_server_url) : nullptr;
 
     try {
         // 初始化网络管理器（如果需要）
@@ -5106,6 +5602,9 @@ bool AudioProcessor::testPreciseServerConnection() {
             if (reply->error() == QNetworkReply::NoError) {
                 QByteArray responseData = reply->readAll();
                 LOG_INFO("Server health check response: " + std::string(responseData.constData(), responseData.size()));
+                if (tested_endpoint) {
+                    tested_endpoint->getMonitor().recordSuccess();
+                }
                 
                 // 清理并返回成功
                 reply->deleteLater();
@@ -5113,6 +5612,9 @@ bool AudioProcessor::testPreciseServerConnection() {
             } else {
                 QString errorString = reply->errorString();
                 LOG_ERROR("Server health check error: " + errorString.toStdString());
+                if (tested_endpoint) {
+                    tested_endpoint->getMonitor().recordFailure("Server health check error: " + errorString.toStdString());
+                }
                 
                 // 清理并返回失败
                 reply->deleteLater();
@@ -5121,6 +5623,9 @@ bool AudioProcessor::testPreciseServerConnection() {
         } else {
             // 请求超时
             LOG_ERROR("Server health check timeout");
+            if (tested_endpoint) {
+                tested_endpoint->getMonitor().recordFailure("Server health check timeout");
+            }
             reply->abort();
             reply->deleteLater();
             return false;
@@ -5134,6 +5639,24 @@ bool AudioProcessor::testPreciseServerConnection() {
     }
 }
 
+std::vector<std::string> AudioProcessor::getPreciseEndpointUrls() const {
+    // 界面上设置的服务器在前，其余为配置中的额外服务器，重复的由服务器池去掉
+    std::vector<std::string> urls;
+    urls.push_back(precise_server_url);
+    urls.insert(urls.end(), precise_extra_endpoints.begin(), precise_extra_endpoints.end());
+    return urls;
+}
+
+PreciseServerPool* AudioProcessor::getPreciseServerPool() {
+    if (!precise_server_pool) {
+        precise_server_pool = std::make_unique<PreciseServerPool>(precise_health_options);
+        precise_server_pool->setRouting(precise_routing);
+        precise_server_pool->setEndpoints(getPreciseEndpointUrls());
+        precise_server_pool->start();
+    }
+    return precise_server_pool.get();
+}
+
 void AudioProcessor::stopProcessing() {
     if (!is_processing) {
         LOG_INFO("Audio processing not running, nothing to stop");
@@ -5167,6 +5690,13 @@ void AudioProcessor::stopProcessing() {
             LOG_INFO("File input stopped");
         }
         
+        // 离线摄取线程最多再完成正在识别的一段
+        offline_cancel = true;
+        if (offline_thread.joinable() && offline_thread.get_id() != std::this_thread::get_id()) {
+            offline_thread.join();
+            LOG_INFO("Offline ingest thread stopped");
+        }
+        
         // 停止所有处理组件，但保持组件实例
         if (gui) {
             logMessage(gui, "Stopping processing components...");
@@ -5275,6 +5805,7 @@ void AudioProcessor::stopProcessing() {
             segment_handler->stop();
             LOG_INFO("Segment handler stopped");
         }
+        stopStreamingRecognizer();
         
         // 清理队列内容，但保持队列对象完整
         if (audio_queue) {
@@ -5302,7 +5833,7 @@ void AudioProcessor::stopProcessing() {
         is_paused = false;
         
         // 清理待处理的音频数据
-        pending_audio_data.clear();
+        pending_audio_blocks.clear();
         pending_audio_samples = 0;
         
         // 确保网络管理器准备就绪
@@ -5375,6 +5906,9 @@ void AudioProcessor::processAudio() {
         // 处理开始标志
         bool processing_started = false;
         
+        // 出队时buffer的存储交还给队列复用，因此在循环外声明
+        AudioBuffer buffer;
+        
         // 循环处理直到收到停止信号或出现错误
         while (local_is_processing && is_processing) {
             // 检查是否暂停
@@ -5389,7 +5923,6 @@ void AudioProcessor::processAudio() {
             }
             
             // 从音频队列中获取音频数据
-            AudioBuffer buffer;
             bool has_data = audio_queue->pop(buffer, false); // 非阻塞方式
             
             if (!has_data) {
@@ -5628,19 +6161,19 @@ void AudioProcessor::processAudio() {
     LOG_INFO("音频处理线程准备结束，检查是否有剩余数据需要处理");
     
     // 处理待处理音频数据中的剩余内容
-    if (!pending_audio_data.empty() && pending_audio_samples > 0) {
+    if (!pending_audio_blocks.empty() && pending_audio_samples > 0) {
         LOG_INFO("处理线程结束时的剩余待处理音频数据: " + std::to_string(pending_audio_samples) + " 样本");
         
         try {
             // 强制处理剩余数据，即使很短
-            processAudioDataByMode(pending_audio_data);
+            processAudioDataByMode(takePendingAudio(), true);
             LOG_INFO("成功处理了线程结束时的剩余音频数据");
         } catch (const std::exception& e) {
             LOG_ERROR("处理线程结束时的剩余音频数据失败: " + std::string(e.what()));
         }
         
         // 清理
-        pending_audio_data.clear();
+        pending_audio_blocks.clear();
         pending_audio_samples = 0;
     }
     
@@ -5654,7 +6187,7 @@ void AudioProcessor::processAudio() {
         final_marker.data.clear();  // 空数据，只作为结束标记
         final_marker.timestamp = std::chrono::system_clock::now();
         
-        segment_handler->addBuffer(final_marker);
+        segment_handler->addBuffer(std::move(final_marker));
         
         // 给分段处理器一些时间来处理最后的数据
         int wait_count = 0;
@@ -5866,7 +6399,7 @@ void AudioProcessor::processAudioFrame(const std::vector<float>& frame_data) {
     
     // 将缓冲区添加到分段处理器
     if (segment_handler) {
-        segment_handler->addBuffer(buffer);
+        segment_handler->addBuffer(std::move(buffer));
     }
     
     // ... existing code ...
@@ -6084,12 +6617,32 @@ void AudioProcessor::connectMediaPlayerSignals() {
 }
 
 // 添加根据识别模式处理音频数据的方法
-void AudioProcessor::processAudioDataByMode(const std::vector<float>& audio_data) {
+PcmBlockPtr AudioProcessor::takePendingAudio() {
+    PcmBlockPtr merged;
+    if (pending_audio_blocks.size() == 1) {
+        merged = std::move(pending_audio_blocks.front());
+    } else if (!pending_audio_blocks.empty()) {
+        // 短段凑够处理长度时才合并，只在这里复制一次
+        std::vector<float> samples;
+        samples.reserve(pending_audio_samples);
+        for (const PcmBlockPtr& block : pending_audio_blocks) {
+            samples.insert(samples.end(), block->data(), block->data() + block->size());
+        }
+        merged = PcmBlock::create(std::move(samples), SAMPLE_RATE);
+    }
+    pending_audio_blocks.clear();
+    pending_audio_samples = 0;
+    return merged;
+}
+
+void AudioProcessor::processAudioDataByMode(const PcmBlockPtr& audio, bool is_final_segment) {
+    const size_t sample_count = audio ? audio->size() : 0;
+    
     // 计算音频长度（毫秒）
-    float audio_length_ms = audio_data.size() * 1000.0f / sample_rate;
+    float audio_length_ms = sample_count * 1000.0f / sample_rate;
     
     LOG_INFO("Processing audio data by mode: " + std::to_string(audio_length_ms) + "ms (" + 
-            std::to_string(audio_data.size()) + " samples), mode: " + 
+            std::to_string(sample_count) + " samples), mode: " + 
             std::to_string(static_cast<int>(current_recognition_mode)));
     
     // 添加模式名称的详细日志
@@ -6129,32 +6682,25 @@ void AudioProcessor::processAudioDataByMode(const std::vector<float>& audio_data
     LOG_INFO("Stream URL: " + (current_stream_url.empty() ? "(empty)" : current_stream_url));
     
     // 检查音频数据是否有效
-    if (audio_data.empty()) {
+    if (sample_count == 0) {
         LOG_INFO("Audio data is empty, skipping processing");
         return;
     }
     
-    // 创建批处理数组
-    std::vector<AudioBuffer> batch;
-    
-    // 将数据拆分为多个小缓冲区（每个不超过16000样本）
-    const size_t max_buffer_size = 16000;
-    size_t offset = 0;
-    
-    while (offset < audio_data.size()) {
-        size_t chunk_size = std::min(max_buffer_size, audio_data.size() - offset);
-        
-        AudioBuffer buffer;
-        buffer.data.resize(chunk_size);
-        std::copy(audio_data.begin() + offset, audio_data.begin() + offset + chunk_size, buffer.data.begin());
-        
-        batch.push_back(buffer);
-        offset += chunk_size;
-    }
-    
     // 根据当前识别模式选择处理方式
     switch (current_recognition_mode) {
         case RecognitionMode::FAST_RECOGNITION:
+        {
+            // 快速识别器按缓冲区批处理，只有这里需要拆分复制（每个不超过16000样本）
+            std::vector<AudioBuffer> batch;
+            const size_t max_buffer_size = 16000;
+            for (size_t offset = 0; offset < sample_count; offset += max_buffer_size) {
+                const size_t chunk_size = std::min(max_buffer_size, sample_count - offset);
+                AudioBuffer buffer;
+                buffer.data.assign(audio->data() + offset, audio->data() + offset + chunk_size);
+                batch.push_back(std::move(buffer));
+            }
+            
             if (fast_recognizer) {
                 LOG_INFO("VAD-based segments sent to fast recognizer: " + std::to_string(batch.size()) + " buffers");
                 fast_recognizer->process_audio_batch(batch);
@@ -6180,67 +6726,38 @@ void AudioProcessor::processAudioDataByMode(const std::vector<float>& audio_data
                 }
             }
             break;
+        }
             
         case RecognitionMode::PRECISE_RECOGNITION:
             LOG_INFO("VAD-based segments sent to precise recognition service");
             {
-                std::string temp_wav = getTempAudioPath();
-                LOG_INFO("Preparing to save WAV file: " + temp_wav + ", batch size: " + std::to_string(batch.size()) + " buffers");
+                LOG_INFO("Preparing in-memory segment, total samples: " + std::to_string(sample_count));
                 
                 try {
-                    // 检查批次是否为空
-                    if (batch.empty()) {
-                        LOG_INFO("Audio batch is empty, skipping processing");
-                        break;
-                    }
-                    
-                    // 计算总样本数以进行验证
-                    size_t total_samples = 0;
-                    for (const auto& buffer : batch) {
-                        total_samples += buffer.data.size();
-                    }
-                    LOG_INFO("Total samples: " + std::to_string(total_samples));
-                    
-                    if (total_samples == 0) {
-                        LOG_INFO("Total samples is 0, skipping processing");
-                        break;
-                    }
-                    
-                    if (WavFileUtils::saveWavBatch(temp_wav, batch, SAMPLE_RATE)) {
-                        LOG_INFO("WAV file saved successfully: " + temp_wav);
-                        RecognitionParams params;
-                        params.language = current_language;
-                        params.use_gpu = use_gpu;
-                        bool sent = sendToPreciseServer(temp_wav, params);
-                        LOG_INFO("Send to precise server result: " + std::string(sent ? "success" : "failed"));
-                    } else {
-                        LOG_ERROR("Failed to save WAV file: " + temp_wav);
-                    }
+                    // 直接以内存PCM块上传，不再写入临时WAV文件，也不复制样本
+                    RecognitionParams params;
+                    params.language = current_language;
+                    params.use_gpu = use_gpu;
+                    params.is_final_segment = is_final_segment;
+                    bool sent = sendToPreciseServer(audio, params);
+                    LOG_INFO("Send to precise server result: " + std::string(sent ? "success" : "failed"));
                 } catch (const std::exception& e) {
                     LOG_ERROR("Exception occurred while processing precise recognition: " + std::string(e.what()));
-                    LOG_ERROR("File path: " + temp_wav);
-                    LOG_ERROR("Batch size: " + std::to_string(batch.size()));
                 } catch (...) {
                     LOG_ERROR("Unknown exception occurred while processing precise recognition");
-                    LOG_ERROR("File path: " + temp_wav);
-                    LOG_ERROR("Batch size: " + std::to_string(batch.size()));
                 }
             }
             break;
             
         case RecognitionMode::OPENAI_RECOGNITION:
             if (parallel_processor) {
-                LOG_INFO("VAD-based segments sent to OpenAI processor");
-                std::string temp_file = getTempAudioPath();
-                if (WavFileUtils::saveWavBatch(temp_file, batch, SAMPLE_RATE)) {
-                    AudioSegment segment;
-                    segment.filepath = temp_file;
-                    segment.timestamp = std::chrono::system_clock::now();
-                    segment.is_last = false;
-                    parallel_processor->addSegment(segment);
-                } else {
-                    LOG_ERROR("Failed to save temporary audio file: " + temp_file);
-                }
+                LOG_INFO("VAD-based segments sent to OpenAI processor (in-memory)");
+                AudioSegment segment;
+                segment.pcm = audio;
+                segment.duration_ms = segment.pcm->durationMs();
+                segment.timestamp = std::chrono::system_clock::now();
+                segment.is_last = false;
+                parallel_processor->addSegment(segment);
             } else {
                 LOG_INFO("OpenAI processor not initialized, cannot process audio segment");
             }
@@ -6499,13 +7016,21 @@ void AudioProcessor::retryRequest(int request_id) {
     int delay_ms = 1000 * std::pow(2, info.retry_count - 1); // 1s, 2s, 4s
     delay_ms = std::min(delay_ms, 10000); // 最大延迟10秒
     
+    // 还有其他可用的服务器时立即转移过去，不必等待
+    if (info.endpoint && precise_server_pool && precise_server_pool->hasAlternative(info.endpoint)) {
+        delay_ms = 0;
+        LOG_INFO("请求 " + std::to_string(request_id) + " 转移到其他服务器（原服务器: " + info.endpoint->getUrl() + "）");
+    }
+    
     // 异步延迟重试
     QTimer::singleShot(delay_ms, this, [this, request_id, info]() {
         LOG_INFO("执行重试请求 " + std::to_string(request_id));
         
-        // 重新发送请求
-        if (std::filesystem::exists(info.file_path)) {
-            sendToPreciseServer(info.file_path, info.params);
+        // 重新发送请求（内存段直接复用同一PCM块），避开刚失败的服务器
+        if (info.audio) {
+            postToPreciseServer("", info.audio, info.params, info.endpoint);
+        } else if (std::filesystem::exists(info.file_path)) {
+            postToPreciseServer(info.file_path, nullptr, info.params, info.endpoint);
         } else {
             LOG_ERROR("重试时文件不存在: " + info.file_path);
             
@@ -6755,6 +7280,13 @@ bool AudioProcessor::isVADInitialized() const {
     return voice_detector && voice_detector->isVADInitialized();
 }
 
+// 把voice_detector的配置同步到分段处理器的VAD（只同步配置，两者的检测状态各自独立）
+void AudioProcessor::syncSegmentVoiceDetector() {
+    if (voice_detector && segment_voice_detector) {
+        segment_voice_detector->copySettingsFrom(*voice_detector);
+    }
+}
+
 // 启动最后段延迟处理，确保最后一个音频段的识别结果有足够时间返回
 void AudioProcessor::startFinalSegmentDelayProcessing() {
     LOG_INFO("Starting final segment delay processing, waiting for recognition results");
@@ -6877,6 +7409,7 @@ void AudioProcessor::resetForRestart() {
         // 设置固定VAD阈值
         if (voice_detector) {
             voice_detector->setThreshold(0.04f);
+            syncSegmentVoiceDetector();
             LOG_INFO("VAD threshold set to 0.04 while preserving instance");
         }
         
@@ -7137,17 +7670,21 @@ bool AudioProcessor::startStreamAudioExtraction() {
                                     
                                     // 根据是否启用实时分段，选择单一处理路径避免重复
                                     if (use_realtime_segments && segment_handler) {
-                                        segment_handler->addBuffer(buffer);
+                                        const bool voice_end = buffer.voice_end;
+                                        segment_handler->addBuffer(std::move(buffer));
                                         if (data_count % 50 == 1) {  // 每50次数据块记录一次，减少日志量
-                                            LOG_INFO("Audio buffer sent to segment handler: " + std::to_string(float_samples.size()) + " samples, voice_end: " + (buffer.voice_end ? "true" : "false"));
+                                            LOG_INFO("Audio buffer sent to segment handler: " + std::to_string(float_samples.size()) + " samples, voice_end: " + (voice_end ? "true" : "false"));
                                         }
                                     } else if (use_realtime_segments && !segment_handler) {
                                         LOG_ERROR("Realtime segments enabled but segment_handler is null!");
                                         // 回退到音频队列处理
-                                        audio_queue->push(buffer);
+                                        audio_queue->push(std::move(buffer));
                                     } else {
                                         // 未启用实时分段，使用传统的音频队列处理
-                                        audio_queue->push(buffer);
+                                        // 流是实时输入，队列满时丢弃而不阻塞读取
+                                        if (!audio_queue->push(std::move(buffer))) {
+                                            LOG_WARNING("音频队列已满，丢弃流音频缓冲区");
+                                        }
                                         LOG_DEBUG("Realtime segments disabled, using audio queue");
                                     }
                                 } catch (const std::exception& e) {
@@ -7213,7 +7750,7 @@ bool AudioProcessor::startStreamAudioExtraction() {
                                     empty_buffer.timestamp = std::chrono::system_clock::now();
                                     empty_buffer.voice_end = false; // 不标记为语音结束，让时间逻辑处理
                                     
-                                    segment_handler->addBuffer(empty_buffer);
+                                    segment_handler->addBuffer(std::move(empty_buffer));
                                     LOG_DEBUG("Sent empty buffer to trigger force segmentation check");
                                 }
                             }
@@ -7247,10 +7784,10 @@ bool AudioProcessor::startStreamAudioExtraction() {
                         
                         // 根据是否启用实时分段，选择单一处理路径发送结束标记
                         if (use_realtime_segments && segment_handler) {
-                            segment_handler->addBuffer(final_buffer);
+                            segment_handler->addBuffer(std::move(final_buffer));
                             LOG_INFO("Sent end-of-stream marker to segment handler");
                         } else {
-                            audio_queue->push(final_buffer);
+                            audio_queue->push(std::move(final_buffer), true);
                             LOG_INFO("Sent end-of-stream marker to audio queue");
                         }
                     }
@@ -7333,6 +7870,7 @@ void AudioProcessor::enableAudioTruncationProtection(bool enable) {
         voice_detector->setSilenceDuration(400); // 恢复到较短的400ms
         LOG_INFO("已禁用音频截断保护：VAD静音检测时长恢复为400ms");
     }
+    syncSegmentVoiceDetector();
 }
 
 // 验证音频段的完整性
@@ -7365,20 +7903,16 @@ void AudioProcessor::processPendingAudioData() {
     LOG_INFO("强制处理待处理的音频数据");
     
     // 检查是否有待处理的音频数据
-    if (pending_audio_data.empty()) {
+    if (pending_audio_blocks.empty()) {
         LOG_INFO("没有待处理的音频数据");
         return;
     }
     
-    LOG_INFO("处理 " + std::to_string(pending_audio_data.size()) + " 个待处理的音频样本");
+    LOG_INFO("处理 " + std::to_string(pending_audio_samples) + " 个待处理的音频样本");
     
     try {
         // 根据当前识别模式处理音频数据
-        processAudioDataByMode(pending_audio_data);
-        
-        // 清理已处理的数据
-        pending_audio_data.clear();
-        pending_audio_samples = 0;
+        processAudioDataByMode(takePendingAudio());
         
         LOG_INFO("待处理音频数据处理完成");
     } catch (const std::exception& e) {
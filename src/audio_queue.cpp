@@ -1,34 +1,105 @@
 ﻿#include <audio_processor.h>
 #include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <utility>
+#include "log_utils.h"
 
-bool AudioQueue::pop(AudioBuffer& buffer, bool wait) {
-    std::unique_lock<std::mutex> lock(mutex);
-    if (wait) {
-        condition.wait(lock, [this]() {
-            return !queue.empty() || terminated;
-        });
+AudioQueue::AudioQueue(size_t capacity, size_t frame_samples) {
+    size_t rounded = 2;
+    while (rounded < capacity) {
+        rounded <<= 1;
     }
-    
-    if (queue.empty()) {
-        return false;
+    ring.resize(rounded);
+    mask = rounded - 1;
+
+    // 预分配每个槽位的存储，稳定运行后存储在生产者、队列和消费者之间循环使用
+    for (auto& slot : ring) {
+        slot.data.reserve(frame_samples);
     }
-    
-    buffer = std::move(queue.front());
-    queue.pop();
+}
+
+bool AudioQueue::pop(AudioBuffer& buffer, bool wait) {
+    const size_t h = head.load(std::memory_order_relaxed);
+    if (tail.load(std::memory_order_acquire) == h) {
+        if (!wait) {
+            return false;
+        }
+
+        std::unique_lock<std::mutex> lock(wait_mutex);
+        while (tail.load(std::memory_order_seq_cst) == h) {
+            if (terminated) {
+                return false;
+            }
+            consumer_waiting.store(true, std::memory_order_seq_cst);
+            if (tail.load(std::memory_order_seq_cst) == h && !terminated) {
+                // 带超时等待，即使错过唤醒也只延迟一个周期
+                wait_condition.wait_for(lock, std::chrono::milliseconds(10));
+            }
+            consumer_waiting.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    AudioBuffer& slot = ring[h & mask];
+    std::swap(buffer, slot);
+    slot.data.clear();
+    head.store(h + 1, std::memory_order_release);
+    popped_count.fetch_add(1, std::memory_order_relaxed);
     return true;
 }
 
-void AudioQueue::push(const AudioBuffer& buffer) {
-    {
-        std::unique_lock<std::mutex> lock(mutex);
-        queue.push(buffer);
+bool AudioQueue::push(AudioBuffer&& buffer, bool wait) {
+    const size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) > mask) {
+        if (!wait) {
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // 背压：先让出时间片，仍然满时再短暂休眠
+        full_wait_count.fetch_add(1, std::memory_order_relaxed);
+        int spins = 0;
+        while (t - head.load(std::memory_order_acquire) > mask) {
+            if (terminated) {
+                dropped_count.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (++spins < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    AudioBuffer& slot = ring[t & mask];
+    std::swap(slot, buffer);
+    buffer.data.clear();
+    tail.store(t + 1, std::memory_order_seq_cst);
+
+    pushed_count.fetch_add(1, std::memory_order_relaxed);
+    const size_t depth = t + 1 - head.load(std::memory_order_relaxed);
+    if (depth > high_watermark.load(std::memory_order_relaxed)) {
+        high_watermark.store(depth, std::memory_order_relaxed);
     }
-    condition.notify_one();
+
+    if (consumer_waiting.load(std::memory_order_seq_cst)) {
+        notifyConsumer();
+    }
+    return true;
+}
+
+void AudioQueue::notifyConsumer() {
+    std::lock_guard<std::mutex> lock(wait_mutex);
+    wait_condition.notify_one();
 }
 
 size_t AudioQueue::size() const {
-    std::unique_lock<std::mutex> lock(mutex);
-    return queue.size();}
+    // 先读head再读tail，保证结果不会为负
+    const size_t h = head.load(std::memory_order_acquire);
+    const size_t t = tail.load(std::memory_order_acquire);
+    return t - h;
+}
 
 bool AudioQueue::is_terminated() const {
     return terminated;
@@ -36,8 +107,51 @@ bool AudioQueue::is_terminated() const {
 
 void AudioQueue::terminate() {
     {
-        std::unique_lock<std::mutex> lock(mutex);
+        std::lock_guard<std::mutex> lock(wait_mutex);
         terminated = true;
     }
-    condition.notify_all();
-} 
\ No newline at end of file
+    wait_condition.notify_all();
+}
+
+void AudioQueue::reset() {
+    AudioQueueStats stats = getStats();
+    if (stats.pushed > 0) {
+        LOG_INFO("音频队列统计: 入队 " + std::to_string(stats.pushed) +
+                 ", 出队 " + std::to_string(stats.popped) +
+                 ", 丢弃 " + std::to_string(stats.dropped) +
+                 ", 满队列等待 " + std::to_string(stats.full_waits) +
+                 ", 最大深度 " + std::to_string(stats.high_watermark) + "/" + std::to_string(ring.size()));
+    }
+
+    std::lock_guard<std::mutex> lock(wait_mutex);
+    // 清空队列，保留槽位已分配的存储
+    for (auto& slot : ring) {
+        slot.data.clear();
+        slot.is_last = false;
+        slot.is_silence = false;
+        slot.voice_end = false;
+    }
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    pushed_count = 0;
+    popped_count = 0;
+    dropped_count = 0;
+    full_wait_count = 0;
+    high_watermark = 0;
+    // 重置终止标志
+    terminated = false;
+    // 通知所有等待的线程
+    wait_condition.notify_all();
+    
+    LOG_INFO("Audio queue reset completed");
+}
+
+AudioQueueStats AudioQueue::getStats() const {
+    AudioQueueStats stats;
+    stats.pushed = pushed_count.load(std::memory_order_relaxed);
+    stats.popped = popped_count.load(std::memory_order_relaxed);
+    stats.dropped = dropped_count.load(std::memory_order_relaxed);
+    stats.full_waits = full_wait_count.load(std::memory_order_relaxed);
+    stats.high_watermark = high_watermark.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,194 @@
+#include "audio_resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double KAISER_BETA = 8.0;     // 阻带衰减约80dB
+constexpr double CUTOFF_ROLLOFF = 0.92; // 截止频率相对于较低奈奎斯特频率的比例
+
+// 第一类零阶修正贝塞尔函数（级数展开）
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    const double half_x = x / 2.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= (half_x / k) * (half_x / k);
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+} // namespace
+
+AudioResampler::AudioResampler(int input_rate, int output_rate, int taps_per_phase)
+    : input_rate(input_rate)
+    , output_rate(output_rate) {
+    if (input_rate < MIN_SAMPLE_RATE || input_rate > MAX_SAMPLE_RATE ||
+        output_rate < MIN_SAMPLE_RATE || output_rate > MAX_SAMPLE_RATE) {
+        throw std::invalid_argument("采样率超出支持范围（" + std::to_string(MIN_SAMPLE_RATE) + "-" +
+                                    std::to_string(MAX_SAMPLE_RATE) + "Hz）");
+    }
+
+    const int divisor = std::gcd(input_rate, output_rate);
+    up = output_rate / divisor;
+    down = input_rate / divisor;
+
+    // 抽头数取4的倍数，点积按4路累加
+    taps = std::max(4, (taps_per_phase + 3) / 4 * 4);
+    table = getFilterTable(up, down, taps);
+    reset();
+}
+
+void AudioResampler::reset() {
+    history.assign(static_cast<size_t>(taps - 1), 0.0f);
+    position = static_cast<uint64_t>(taps - 1) * up;
+}
+
+size_t AudioResampler::getLatency() const {
+    // 滤波器中心位于N/2（N = taps * up），群延迟为整数个上采样样本
+    const uint64_t delay_up = static_cast<uint64_t>(taps) * up / 2;
+    return static_cast<size_t>((delay_up + down / 2) / down);
+}
+
+void AudioResampler::process(const float* input, size_t count, std::vector<float>& output) {
+    if (count == 0) {
+        return;
+    }
+
+    history.insert(history.end(), input, input + count);
+
+    const size_t available = history.size();
+    const uint64_t end_position = static_cast<uint64_t>(available) * up;
+    if (position < end_position) {
+        output.reserve(output.size() + static_cast<size_t>((end_position - position + down - 1) / down));
+    }
+
+    const float* coeffs = table->coeffs.data();
+    const float* samples = history.data();
+    while (position < end_position) {
+        const size_t newest = static_cast<size_t>(position / up);
+        const size_t phase = static_cast<size_t>(position % up);
+        const float* c = coeffs + phase * taps;
+        const float* x = samples + newest - (taps - 1);
+
+        // 4路累加，打破依赖链，编译器可生成SIMD乘加
+        float acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+        for (int m = 0; m < taps; m += 4) {
+            acc0 += c[m] * x[m];
+            acc1 += c[m + 1] * x[m + 1];
+            acc2 += c[m + 2] * x[m + 2];
+            acc3 += c[m + 3] * x[m + 3];
+        }
+        output.push_back((acc0 + acc1) + (acc2 + acc3));
+        position += down;
+    }
+
+    // 只保留下一次需要的taps-1个历史样本
+    const size_t consumed = available - static_cast<size_t>(taps - 1);
+    history.erase(history.begin(), history.begin() + consumed);
+    position -= static_cast<uint64_t>(consumed) * up;
+}
+
+void AudioResampler::flush(std::vector<float>& output) {
+    // 补足覆盖群延迟的零输入
+    const size_t pad = static_cast<size_t>(taps / 2 + 1);
+    std::vector<float> zeros(pad, 0.0f);
+    process(zeros.data(), zeros.size(), output);
+}
+
+std::vector<float> AudioResampler::resample(const std::vector<float>& input, int input_rate, int output_rate,
+                                            int taps_per_phase) {
+    if (input.empty() || input_rate == output_rate) {
+        return input;
+    }
+
+    AudioResampler resampler(input_rate, output_rate, taps_per_phase);
+    const size_t expected = static_cast<size_t>(
+        (static_cast<uint64_t>(input.size()) * resampler.up + resampler.down - 1) / resampler.down);
+
+    // 整段处理时可以向后看：起点后移一个群延迟，输出与输入在时间上精确对齐
+    resampler.position += static_cast<uint64_t>(resampler.taps) * resampler.up / 2;
+
+    std::vector<float> output;
+    output.reserve(expected + static_cast<size_t>(resampler.taps));
+    resampler.process(input, output);
+    resampler.flush(output);
+
+    if (output.size() > expected) {
+        output.resize(expected);
+    }
+    return output;
+}
+
+std::shared_ptr<const AudioResampler::FilterTable> AudioResampler::getFilterTable(int up, int down, int taps) {
+    // 按最近使用排序（表头最新），实际用到的比例只有少数几种，线性查找即可
+    static std::mutex cache_mutex;
+    static std::list<std::shared_ptr<const FilterTable>> cache;
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        const FilterTable& cached = **it;
+        if (cached.up == up && cached.down == down && cached.taps == taps) {
+            cache.splice(cache.begin(), cache, it);
+            return cache.front();
+        }
+    }
+
+    // 被淘汰的表仍由正在使用它的实例持有，不影响这些实例
+    auto table = designFilterTable(up, down, taps);
+    cache.push_front(table);
+    if (cache.size() > MAX_CACHED_TABLES) {
+        cache.pop_back();
+    }
+    return table;
+}
+
+std::shared_ptr<const AudioResampler::FilterTable> AudioResampler::designFilterTable(int up, int down, int taps) {
+    auto table = std::make_shared<FilterTable>();
+    table->up = up;
+    table->down = down;
+    table->taps = taps;
+
+    // 原型低通滤波器工作在上采样率上，截止频率取输入/输出中较低的奈奎斯特频率
+    const size_t length = static_cast<size_t>(taps) * up;
+    const double cutoff = CUTOFF_ROLLOFF * 0.5 / std::max(up, down);  // 周期/样本
+    // 中心取N/2（窗口按N+1点对称，最后一点落在窗口边缘被省略），群延迟为整数
+    const double center = length / 2.0;
+    const double window_norm = besselI0(KAISER_BETA);
+
+    std::vector<double> prototype(length);
+    for (size_t n = 0; n < length; ++n) {
+        const double t = n - center;
+        const double sinc = (t == 0.0) ? 1.0 : std::sin(2.0 * PI * cutoff * t) / (2.0 * PI * cutoff * t);
+        const double ratio = t / center;
+        const double window = besselI0(KAISER_BETA * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / window_norm;
+        prototype[n] = 2.0 * cutoff * sinc * window;
+    }
+
+    // 拆分为up个相位；每个相位单独归一化直流增益，消除相位间的增益起伏
+    table->coeffs.resize(length);
+    for (int phase = 0; phase < up; ++phase) {
+        double sum = 0.0;
+        for (int j = 0; j < taps; ++j) {
+            sum += prototype[phase + static_cast<size_t>(j) * up];
+        }
+        const double scale = (std::abs(sum) > 1e-12) ? 1.0 / sum : 0.0;
+
+        // h[phase + j*up]作用于第newest-j个输入，倒序存放后与输入按内存顺序对齐
+        float* dst = table->coeffs.data() + static_cast<size_t>(phase) * taps;
+        for (int j = 0; j < taps; ++j) {
+            dst[taps - 1 - j] = static_cast<float>(prototype[phase + static_cast<size_t>(j) * up] * scale);
+        }
+    }
+    return table;
+}
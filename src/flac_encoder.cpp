@@ -0,0 +1,332 @@
+#include "flac_encoder.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr int BITS_PER_SAMPLE = 16;
+constexpr int MAX_FIXED_ORDER = 4;
+constexpr int MAX_PARTITION_ORDER = 8;
+constexpr int MAX_RICE_PARAM = 14;   // 4位Rice参数的上限（15为转义码）
+constexpr int MAX_RICE2_PARAM = 30;  // 5位Rice参数的上限（31为转义码）
+
+// 按位写入，高位在前
+class BitWriter {
+public:
+    void write(uint32_t value, int bits) {
+        if (bits <= 0) {
+            return;
+        }
+        const uint64_t mask = (uint64_t(1) << bits) - 1;
+        accumulator = (accumulator << bits) | (value & mask);
+        pending_bits += bits;
+        while (pending_bits >= 8) {
+            pending_bits -= 8;
+            bytes.push_back(static_cast<uint8_t>(accumulator >> pending_bits));
+        }
+        accumulator &= (uint64_t(1) << pending_bits) - 1;
+    }
+
+    void writeSigned(int32_t value, int bits) {
+        write(static_cast<uint32_t>(value), bits);
+    }
+
+    // zeros个0后跟一个1
+    void writeUnary(uint32_t zeros) {
+        while (zeros >= 32) {
+            write(0, 32);
+            zeros -= 32;
+        }
+        write(1, static_cast<int>(zeros) + 1);
+    }
+
+    void alignToByte() {
+        if (pending_bits > 0) {
+            write(0, 8 - pending_bits);
+        }
+    }
+
+    std::vector<uint8_t> bytes;
+
+private:
+    uint64_t accumulator = 0;
+    int pending_bits = 0;
+};
+
+uint8_t crc8(const uint8_t* data, size_t size) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint16_t crc16(const uint8_t* data, size_t size) {
+    uint16_t crc = 0;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x8005) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// 帧头中的采样率编码，非标准采样率为0（取STREAMINFO中的值）
+uint32_t sampleRateCode(int sample_rate) {
+    switch (sample_rate) {
+        case 8000: return 4;
+        case 16000: return 5;
+        case 22050: return 6;
+        case 24000: return 7;
+        case 32000: return 8;
+        case 44100: return 9;
+        case 48000: return 10;
+        case 96000: return 11;
+        default: return 0;
+    }
+}
+
+// 帧号使用UTF-8方式的变长编码
+void writeFrameNumber(BitWriter& writer, uint32_t number) {
+    if (number < 0x80) {
+        writer.write(number, 8);
+        return;
+    }
+    static const uint32_t prefixes[] = {0, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC};
+    int continuation = 1;
+    while (continuation < 5 && number >= (uint32_t(1) << (6 - continuation + 6 * continuation))) {
+        ++continuation;
+    }
+    writer.write(prefixes[continuation] | (number >> (6 * continuation)), 8);
+    for (int i = continuation - 1; i >= 0; --i) {
+        writer.write(0x80 | ((number >> (6 * i)) & 0x3F), 8);
+    }
+}
+
+// 固定预测器的残差，前order个样本为预热样本，不产生残差
+void fixedResidual(const int32_t* x, size_t n, int order, std::vector<int32_t>& residual) {
+    residual.resize(n - order);
+    for (size_t i = order; i < n; ++i) {
+        int32_t r = 0;
+        switch (order) {
+            case 0: r = x[i]; break;
+            case 1: r = x[i] - x[i - 1]; break;
+            case 2: r = x[i] - 2 * x[i - 1] + x[i - 2]; break;
+            case 3: r = x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3]; break;
+            default: r = x[i] - 4 * x[i - 1] + 6 * x[i - 2] - 4 * x[i - 3] + x[i - 4]; break;
+        }
+        residual[i - order] = r;
+    }
+}
+
+uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+struct RicePlan {
+    int partition_order = 0;
+    bool wide_params = false;   // 使用5位参数（RICE2）
+    std::vector<int> params;
+    uint64_t bits = UINT64_MAX;  // 残差部分的总位数，含编码方式和分区阶数
+};
+
+uint64_t riceBits(const uint32_t* values, size_t count, int param) {
+    uint64_t bits = static_cast<uint64_t>(count) * (param + 1);
+    for (size_t i = 0; i < count; ++i) {
+        bits += values[i] >> param;
+    }
+    return bits;
+}
+
+// 为一个分区选出位数最少的Rice参数，先按均值估计再在邻近值中比较
+int bestRiceParam(const uint32_t* values, size_t count, uint64_t& bits) {
+    if (count == 0) {
+        bits = 0;
+        return 0;
+    }
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += values[i];
+    }
+    int estimate = 0;
+    while (estimate < MAX_RICE2_PARAM && (static_cast<uint64_t>(count) << (estimate + 1)) < sum) {
+        ++estimate;
+    }
+    int best = estimate;
+    bits = riceBits(values, count, estimate);
+    for (int param : {estimate - 1, estimate + 1}) {
+        if (param < 0 || param > MAX_RICE2_PARAM) {
+            continue;
+        }
+        const uint64_t candidate = riceBits(values, count, param);
+        if (candidate < bits) {
+            bits = candidate;
+            best = param;
+        }
+    }
+    return best;
+}
+
+RicePlan planResidual(const std::vector<uint32_t>& values, size_t block_size, int predictor_order) {
+    RicePlan best;
+    for (int order = 0; order <= MAX_PARTITION_ORDER; ++order) {
+        const size_t partitions = size_t(1) << order;
+        if (block_size % partitions != 0 || (block_size >> order) <= static_cast<size_t>(predictor_order)) {
+            break;
+        }
+        RicePlan plan;
+        plan.partition_order = order;
+        plan.bits = 2 + 4;
+        size_t offset = 0;
+        for (size_t p = 0; p < partitions; ++p) {
+            const size_t count = (block_size >> order) - (p == 0 ? predictor_order : 0);
+            uint64_t bits = 0;
+            plan.params.push_back(bestRiceParam(values.data() + offset, count, bits));
+            plan.bits += bits;
+            offset += count;
+        }
+        plan.wide_params = *std::max_element(plan.params.begin(), plan.params.end()) > MAX_RICE_PARAM;
+        plan.bits += partitions * (plan.wide_params ? 5 : 4);
+        if (plan.bits < best.bits) {
+            best = std::move(plan);
+        }
+    }
+    return best;
+}
+
+void writeResidual(BitWriter& writer, const std::vector<uint32_t>& values, size_t block_size,
+                   int predictor_order, const RicePlan& plan) {
+    writer.write(plan.wide_params ? 1 : 0, 2);
+    writer.write(plan.partition_order, 4);
+    size_t offset = 0;
+    for (size_t p = 0; p < plan.params.size(); ++p) {
+        const size_t count = (block_size >> plan.partition_order) - (p == 0 ? predictor_order : 0);
+        const int param = plan.params[p];
+        writer.write(param, plan.wide_params ? 5 : 4);
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t value = values[offset + i];
+            writer.writeUnary(value >> param);
+            writer.write(value, param);
+        }
+        offset += count;
+    }
+}
+
+// 写入一个子帧：全部相同时用CONSTANT，否则在VERBATIM和0-4阶FIXED中取位数最少的
+void writeSubframe(BitWriter& writer, const int32_t* x, size_t n) {
+    if (std::all_of(x, x + n, [x](int32_t value) { return value == x[0]; })) {
+        writer.write(0, 8);
+        writer.writeSigned(x[0], BITS_PER_SAMPLE);
+        return;
+    }
+
+    int best_order = -1;
+    RicePlan best_plan;
+    std::vector<uint32_t> best_values;
+    uint64_t best_bits = static_cast<uint64_t>(n) * BITS_PER_SAMPLE;
+
+    std::vector<int32_t> residual;
+    std::vector<uint32_t> values;
+    for (int order = 0; order <= MAX_FIXED_ORDER && static_cast<size_t>(order) < n; ++order) {
+        fixedResidual(x, n, order, residual);
+        values.resize(residual.size());
+        std::transform(residual.begin(), residual.end(), values.begin(), zigzag);
+        RicePlan plan = planResidual(values, n, order);
+        if (plan.params.empty()) {
+            continue;
+        }
+        const uint64_t bits = static_cast<uint64_t>(order) * BITS_PER_SAMPLE + plan.bits;
+        if (bits < best_bits) {
+            best_bits = bits;
+            best_order = order;
+            best_plan = std::move(plan);
+            best_values.swap(values);
+        }
+    }
+
+    if (best_order < 0) {
+        writer.write(1 << 1, 8);
+        for (size_t i = 0; i < n; ++i) {
+            writer.writeSigned(x[i], BITS_PER_SAMPLE);
+        }
+        return;
+    }
+
+    writer.write((8 + best_order) << 1, 8);
+    for (int i = 0; i < best_order; ++i) {
+        writer.writeSigned(x[i], BITS_PER_SAMPLE);
+    }
+    writeResidual(writer, best_values, n, best_order, best_plan);
+}
+
+void writeFrame(std::string& output, const int32_t* x, size_t n, uint32_t frame_number, int sample_rate) {
+    BitWriter writer;
+    writer.write(0x3FFE, 14);
+    writer.write(0, 1);  // 保留位
+    writer.write(0, 1);  // 固定块大小
+    const bool standard_block = n == static_cast<size_t>(FlacEncoder::BLOCK_SIZE);
+    writer.write(standard_block ? 12 : 7, 4);  // 4096或帧头末尾的16位块大小
+    writer.write(sampleRateCode(sample_rate), 4);
+    writer.write(0, 4);  // 单声道
+    writer.write(4, 3);  // 16位
+    writer.write(0, 1);  // 保留位
+    writeFrameNumber(writer, frame_number);
+    if (!standard_block) {
+        writer.write(static_cast<uint32_t>(n - 1), 16);
+    }
+    writer.write(crc8(writer.bytes.data(), writer.bytes.size()), 8);
+
+    writeSubframe(writer, x, n);
+    writer.alignToByte();
+    writer.write(crc16(writer.bytes.data(), writer.bytes.size()), 16);
+
+    output.append(reinterpret_cast<const char*>(writer.bytes.data()), writer.bytes.size());
+}
+
+} // namespace
+
+std::string FlacEncoder::encode(const float* samples, size_t count, int sample_rate) {
+    // 与WAV编码相同的16位量化
+    std::vector<int32_t> pcm(count);
+    for (size_t i = 0; i < count; ++i) {
+        const float sample = std::max(-1.0f, std::min(1.0f, samples[i]));
+        pcm[i] = static_cast<int16_t>(sample * 32767.0f);
+    }
+
+    // "fLaC"标记和STREAMINFO元数据块
+    BitWriter header;
+    for (char c : std::string("fLaC")) {
+        header.write(static_cast<uint8_t>(c), 8);
+    }
+    header.write(1, 1);   // 最后一个元数据块
+    header.write(0, 7);   // STREAMINFO
+    header.write(34, 24);
+    const uint32_t block_size = static_cast<uint32_t>(
+        std::min<size_t>(BLOCK_SIZE, std::max<size_t>(count, 16)));
+    header.write(block_size, 16);  // 最小块大小
+    header.write(block_size, 16);  // 最大块大小
+    header.write(0, 24);           // 最小帧大小（未知）
+    header.write(0, 24);           // 最大帧大小（未知）
+    header.write(static_cast<uint32_t>(sample_rate), 20);
+    header.write(0, 3);                       // 声道数-1
+    header.write(BITS_PER_SAMPLE - 1, 5);
+    header.write(static_cast<uint32_t>(static_cast<uint64_t>(count) >> 32), 4);
+    header.write(static_cast<uint32_t>(count), 32);
+    for (int i = 0; i < 4; ++i) {
+        header.write(0, 32);  // MD5未计算
+    }
+
+    std::string output(header.bytes.begin(), header.bytes.end());
+    output.reserve(output.size() + count);
+    uint32_t frame_number = 0;
+    for (size_t offset = 0; offset < count; offset += BLOCK_SIZE) {
+        const size_t n = std::min<size_t>(BLOCK_SIZE, count - offset);
+        writeFrame(output, pcm.data() + offset, n, frame_number++, sample_rate);
+    }
+    return output;
+}
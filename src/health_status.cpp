@@ -0,0 +1,53 @@
+#include "health_status.h"
+#include <nlohmann/json.hpp>
+
+namespace {
+
+constexpr int CHANNEL_STATUS_BUSY = 1;  // 与服务器ChannelStatus::BUSY一致
+
+int countBusyChannels(const nlohmann::json& status) {
+    if (status.contains("busy_channels") && status["busy_channels"].is_number_integer()) {
+        return status["busy_channels"].get<int>();
+    }
+    int busy = 0;
+    if (status.contains("channels") && status["channels"].is_array()) {
+        for (const auto& channel : status["channels"]) {
+            if (channel.is_object() && channel.value("status", -1) == CHANNEL_STATUS_BUSY) {
+                ++busy;
+            }
+        }
+    }
+    return busy;
+}
+
+} // namespace
+
+bool parseServerHealthStatus(const std::string& body, ServerHealthStatus& result) {
+    const nlohmann::json doc = nlohmann::json::parse(body, nullptr, false);
+    if (!doc.is_object()) {
+        return false;
+    }
+    result = ServerHealthStatus();
+
+    if (doc.contains("upload_formats") && doc["upload_formats"].is_array()) {
+        for (const auto& format : doc["upload_formats"]) {
+            if (format.is_string()) {
+                result.upload_formats.push_back(format.get<std::string>());
+            }
+        }
+    }
+
+    const nlohmann::json* status = &doc;
+    if (doc.contains("multi_channel_status") && doc["multi_channel_status"].is_object()) {
+        status = &doc["multi_channel_status"];
+    }
+    if (!status->contains("total_channels")) {
+        return true;
+    }
+    result.has_load = true;
+    result.capacity = status->value("total_channels", 0);
+    result.load = countBusyChannels(*status) +
+                  status->value("pending_tasks", 0) +
+                  status->value("batch_pending_tasks", 0);
+    return true;
+}
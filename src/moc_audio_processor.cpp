@@ -1,444 +0,0 @@
-/****************************************************************************
-** Meta object code from reading C++ file 'audio_processor.h'
-**
-** Created by: The Qt Meta Object Compiler version 68 (Qt 6.8.3)
-**
-** WARNING! All changes made in this file will be lost!
-*****************************************************************************/
-
-#include "../include/audio_processor.h"
-#include <QtCore/qmetatype.h>
-
-#include <QtCore/qtmochelpers.h>
-
-#include <memory>
-
-
-#include <QtCore/qxptype_traits.h>
-#if !defined(Q_MOC_OUTPUT_REVISION)
-#error "The header file 'audio_processor.h' doesn't include <QObject>."
-#elif Q_MOC_OUTPUT_REVISION != 68
-#error "This file was generated using the moc from 6.8.3. It"
-#error "cannot be used with the include files from this version of Qt."
-#error "(The moc has changed too much.)"
-#endif
-
-#ifndef Q_CONSTINIT
-#define Q_CONSTINIT
-#endif
-
-QT_WARNING_PUSH
-QT_WARNING_DISABLE_DEPRECATED
-QT_WARNING_DISABLE_GCC("-Wuseless-cast")
-namespace {
-struct qt_meta_tag_ZN14AudioProcessorE_t {};
-} // unnamed namespace
-
-
-#ifdef QT_MOC_HAS_STRINGDATA
-static constexpr auto qt_meta_stringdata_ZN14AudioProcessorE = QtMocHelpers::stringData(
-    "AudioProcessor",
-    "playbackStateChanged",
-    "",
-    "QMediaPlayer::PlaybackState",
-    "state",
-    "durationChanged",
-    "duration",
-    "positionChanged",
-    "position",
-    "errorOccurred",
-    "error",
-    "temporaryFileCreated",
-    "filePath",
-    "openAIResultReceived",
-    "result",
-    "preciseServerResultReady",
-    "text",
-    "recognitionResultReady",
-    "subtitlePreviewReady",
-    "timestamp",
-    "processingFullyStopped",
-    "correctionEnabledChanged",
-    "enabled",
-    "lineCorrectionEnabledChanged",
-    "correctionStatusUpdated",
-    "status",
-    "openAIResultReady",
-    "preciseResultReceived",
-    "request_id",
-    "success",
-    "fastResultReady",
-    "handlePreciseServerReply",
-    "QNetworkReply*",
-    "reply"
-);
-#else  // !QT_MOC_HAS_STRINGDATA
-#error "qtmochelpers.h not found or too old."
-#endif // !QT_MOC_HAS_STRINGDATA
-
-Q_CONSTINIT static const uint qt_meta_data_ZN14AudioProcessorE[] = {
-
- // content:
-      12,       // revision
-       0,       // classname
-       0,    0, // classinfo
-      17,   14, // methods
-       0,    0, // properties
-       0,    0, // enums/sets
-       0,    0, // constructors
-       0,       // flags
-      13,       // signalCount
-
- // signals: name, argc, parameters, tag, flags, initial metatype offsets
-       1,    1,  116,    2, 0x06,    1 /* Public */,
-       5,    1,  119,    2, 0x06,    3 /* Public */,
-       7,    1,  122,    2, 0x06,    5 /* Public */,
-       9,    1,  125,    2, 0x06,    7 /* Public */,
-      11,    1,  128,    2, 0x06,    9 /* Public */,
-      13,    1,  131,    2, 0x06,   11 /* Public */,
-      15,    1,  134,    2, 0x06,   13 /* Public */,
-      17,    1,  137,    2, 0x06,   15 /* Public */,
-      18,    3,  140,    2, 0x06,   17 /* Public */,
-      20,    0,  147,    2, 0x06,   21 /* Public */,
-      21,    1,  148,    2, 0x06,   22 /* Public */,
-      23,    1,  151,    2, 0x06,   24 /* Public */,
-      24,    1,  154,    2, 0x06,   26 /* Public */,
-
- // slots: name, argc, parameters, tag, flags, initial metatype offsets
-      26,    1,  157,    2, 0x0a,   28 /* Public */,
-      27,    3,  160,    2, 0x0a,   30 /* Public */,
-      30,    0,  167,    2, 0x0a,   34 /* Public */,
-      31,    1,  168,    2, 0x08,   35 /* Private */,
-
- // signals: parameters
-    QMetaType::Void, 0x80000000 | 3,    4,
-    QMetaType::Void, QMetaType::LongLong,    6,
-    QMetaType::Void, QMetaType::LongLong,    8,
-    QMetaType::Void, QMetaType::QString,   10,
-    QMetaType::Void, QMetaType::QString,   12,
-    QMetaType::Void, QMetaType::QString,   14,
-    QMetaType::Void, QMetaType::QString,   16,
-    QMetaType::Void, QMetaType::QString,   16,
-    QMetaType::Void, QMetaType::QString, QMetaType::LongLong, QMetaType::LongLong,   16,   19,    6,
-    QMetaType::Void,
-    QMetaType::Void, QMetaType::Bool,   22,
-    QMetaType::Void, QMetaType::Bool,   22,
-    QMetaType::Void, QMetaType::QString,   25,
-
- // slots: parameters
-    QMetaType::Void, QMetaType::QString,   14,
-    QMetaType::Void, QMetaType::Int, QMetaType::QString, QMetaType::Bool,   28,   14,   29,
-    QMetaType::Void,
-    QMetaType::Void, 0x80000000 | 32,   33,
-
-       0        // eod
-};
-
-Q_CONSTINIT const QMetaObject AudioProcessor::staticMetaObject = { {
-    QMetaObject::SuperData::link<QObject::staticMetaObject>(),
-    qt_meta_stringdata_ZN14AudioProcessorE.offsetsAndSizes,
-    qt_meta_data_ZN14AudioProcessorE,
-    qt_static_metacall,
-    nullptr,
-    qt_incomplete_metaTypeArray<qt_meta_tag_ZN14AudioProcessorE_t,
-        // Q_OBJECT / Q_GADGET
-        QtPrivate::TypeAndForceComplete<AudioProcessor, std::true_type>,
-        // method 'playbackStateChanged'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<QMediaPlayer::PlaybackState, std::false_type>,
-        // method 'durationChanged'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<qint64, std::false_type>,
-        // method 'positionChanged'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<qint64, std::false_type>,
-        // method 'errorOccurred'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<const QString &, std::false_type>,
-        // method 'temporaryFileCreated'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<const QString &, std::false_type>,
-        // method 'openAIResultReceived'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<const QString &, std::false_type>,
-        // method 'preciseServerResultReady'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<const QString &, std::false_type>,
-        // method 'recognitionResultReady'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<const QString &, std::false_type>,
-        // method 'subtitlePreviewReady'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<const QString &, std::false_type>,
-        QtPrivate::TypeAndForceComplete<qint64, std::false_type>,
-        QtPrivate::TypeAndForceComplete<qint64, std::false_type>,
-        // method 'processingFullyStopped'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        // method 'correctionEnabledChanged'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<bool, std::false_type>,
-        // method 'lineCorrectionEnabledChanged'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<bool, std::false_type>,
-        // method 'correctionStatusUpdated'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<QString, std::false_type>,
-        // method 'openAIResultReady'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<const QString &, std::false_type>,
-        // method 'preciseResultReceived'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<int, std::false_type>,
-        QtPrivate::TypeAndForceComplete<const QString &, std::false_type>,
-        QtPrivate::TypeAndForceComplete<bool, std::false_type>,
-        // method 'fastResultReady'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        // method 'handlePreciseServerReply'
-        QtPrivate::TypeAndForceComplete<void, std::false_type>,
-        QtPrivate::TypeAndForceComplete<QNetworkReply *, std::false_type>
-    >,
-    nullptr
-} };
-
-void AudioProcessor::qt_static_metacall(QObject *_o, QMetaObject::Call _c, int _id, void **_a)
-{
-    auto *_t = static_cast<AudioProcessor *>(_o);
-    if (_c == QMetaObject::InvokeMetaMethod) {
-        switch (_id) {
-        case 0: _t->playbackStateChanged((*reinterpret_cast< std::add_pointer_t<QMediaPlayer::PlaybackState>>(_a[1]))); break;
-        case 1: _t->durationChanged((*reinterpret_cast< std::add_pointer_t<qint64>>(_a[1]))); break;
-        case 2: _t->positionChanged((*reinterpret_cast< std::add_pointer_t<qint64>>(_a[1]))); break;
-        case 3: _t->errorOccurred((*reinterpret_cast< std::add_pointer_t<QString>>(_a[1]))); break;
-        case 4: _t->temporaryFileCreated((*reinterpret_cast< std::add_pointer_t<QString>>(_a[1]))); break;
-        case 5: _t->openAIResultReceived((*reinterpret_cast< std::add_pointer_t<QString>>(_a[1]))); break;
-        case 6: _t->preciseServerResultReady((*reinterpret_cast< std::add_pointer_t<QString>>(_a[1]))); break;
-        case 7: _t->recognitionResultReady((*reinterpret_cast< std::add_pointer_t<QString>>(_a[1]))); break;
-        case 8: _t->subtitlePreviewReady((*reinterpret_cast< std::add_pointer_t<QString>>(_a[1])),(*reinterpret_cast< std::add_pointer_t<qint64>>(_a[2])),(*reinterpret_cast< std::add_pointer_t<qint64>>(_a[3]))); break;
-        case 9: _t->processingFullyStopped(); break;
-        case 10: _t->correctionEnabledChanged((*reinterpret_cast< std::add_pointer_t<bool>>(_a[1]))); break;
-        case 11: _t->lineCorrectionEnabledChanged((*reinterpret_cast< std::add_pointer_t<bool>>(_a[1]))); break;
-        case 12: _t->correctionStatusUpdated((*reinterpret_cast< std::add_pointer_t<QString>>(_a[1]))); break;
-        case 13: _t->openAIResultReady((*reinterpret_cast< std::add_pointer_t<QString>>(_a[1]))); break;
-        case 14: _t->preciseResultReceived((*reinterpret_cast< std::add_pointer_t<int>>(_a[1])),(*reinterpret_cast< std::add_pointer_t<QString>>(_a[2])),(*reinterpret_cast< std::add_pointer_t<bool>>(_a[3]))); break;
-        case 15: _t->fastResultReady(); break;
-        case 16: _t->handlePreciseServerReply((*reinterpret_cast< std::add_pointer_t<QNetworkReply*>>(_a[1]))); break;
-        default: ;
-        }
-    }
-    if (_c == QMetaObject::IndexOfMethod) {
-        int *result = reinterpret_cast<int *>(_a[0]);
-        {
-            using _q_method_type = void (AudioProcessor::*)(QMediaPlayer::PlaybackState );
-            if (_q_method_type _q_method = &AudioProcessor::playbackStateChanged; *reinterpret_cast<_q_method_type *>(_a[1]) == _q_method) {
-                *result = 0;
-                return;
-            }
-        }
-        {
-            using _q_method_type = void (AudioProcessor::*)(qint64 );
-            if (_q_method_type _q_method = &AudioProcessor::durationChanged; *reinterpret_cast<_q_method_type *>(_a[1]) == _q_method) {
-                *result = 1;
-                return;
-            }
-        }
-        {
-            using _q_method_type = void (AudioProcessor::*)(qint64 );
-            if (_q_method_type _q_method = &AudioProcessor::positionChanged; *reinterpret_cast<_q_method_type *>(_a[1]) == _q_method) {
-                *result = 2;
-                return;
-            }
-        }
-        {
-            using _q_method_type = void (AudioProcessor::*)(const QString & );
-            if (_q_method_type _q_method = &AudioProcessor::errorOccurred; *reinterpret_cast<_q_method_type *>(_a[1]) == _q_method) {
-                *result = 3;
-                return;
-            }
-        }
-        {
-            using _q_method_type = void (AudioProcessor::*)(const QString & );
-            if (_q_method_type _q_method = &AudioProcessor::temporaryFileCreated; *reinterpret_cast<_q_method_type *>(_a[1]) == _q_method) {
-                *result = 4;
-                return;
-            }
-        }
-        {
-            using _q_method_type = void (AudioProcessor::*)(const QString & );
-            if (_q_method_type _q_method = &AudioProcessor::openAIResultReceived; *reinterpret_cast<_q_method_type *>(_a[1]) == _q_method) {
-                *result = 5;
-                return;
-            }
-        }
-        {
-            using _q_method_type = void (AudioProcessor::*)(const QString & );
-            if (_q_method_type _q_method = &AudioProcessor::preciseServerResultReady; *reinterpret_cast<_q_method_type *>(_a[1]) == _q_method) {
-                *result = 6;
-                return;
-            }
-        }
-        {
-            using _q_method_type = void (AudioProcessor::*)(const QString & );
-            if (_q_method_type _q_method = &AudioProcessor::recognitionResultReady; *reinterpret_cast<_q_method_type *>(_a[1]) == _q_method) {
-                *result = 7;
-                return;
-            }
-        }
-        {
-            using _q_method_type = void (AudioProcessor::*)(const QString & , qint64 , qint64 );
-            if (_q_method_type _q_method = &AudioProcessor::subtitlePreviewReady; *reinterpret_cast<_q_method_type *>(_a[1]) == _q_method) {
-                *result = 8;
-                return;
-            }
-        }
-        {
-            using _q_method_type = void (AudioProcessor::*)();
-            if (_q_method_type _q_method = &AudioProcessor::processingFullyStopped; *reinterpret_cast<_q_method_type *>(_a[1]) == _q_method) {
-                *result = 9;
-                return;
-            }
-        }
-        {
-            using _q_method_type = void (AudioProcessor::*)(bool );
-            if (_q_method_type _q_method = &AudioProcessor::correctionEnabledChanged; *reinterpret_cast<_q_method_type *>(_a[1]) == _q_method) {
-                *result = 10;
-                return;
-            }
-        }
-        {
-            using _q_method_type = void (AudioProcessor::*)(bool );
-            if (_q_method_type _q_method = &AudioProcessor::lineCorrectionEnabledChanged; *reinterpret_cast<_q_method_type *>(_a[1]) == _q_method) {
-                *result = 11;
-                return;
-            }
-        }
-        {
-            using _q_method_type = void (AudioProcessor::*)(QString );
-            if (_q_method_type _q_method = &AudioProcessor::correctionStatusUpdated; *reinterpret_cast<_q_method_type *>(_a[1]) == _q_method) {
-                *result = 12;
-                return;
-            }
-        }
-    }
-}
-
-const QMetaObject *AudioProcessor::metaObject() const
-{
-    return QObject::d_ptr->metaObject ? QObject::d_ptr->dynamicMetaObject() : &staticMetaObject;
-}
-
-void *AudioProcessor::qt_metacast(const char *_clname)
-{
-    if (!_clname) return nullptr;
-    if (!strcmp(_clname, qt_meta_stringdata_ZN14AudioProcessorE.stringdata0))
-        return static_cast<void*>(this);
-    return QObject::qt_metacast(_clname);
-}
-
-int AudioProcessor::qt_metacall(QMetaObject::Call _c, int _id, void **_a)
-{
-    _id = QObject::qt_metacall(_c, _id, _a);
-    if (_id < 0)
-        return _id;
-    if (_c == QMetaObject::InvokeMetaMethod) {
-        if (_id < 17)
-            qt_static_metacall(this, _c, _id, _a);
-        _id -= 17;
-    }
-    if (_c == QMetaObject::RegisterMethodArgumentMetaType) {
-        if (_id < 17)
-            *reinterpret_cast<QMetaType *>(_a[0]) = QMetaType();
-        _id -= 17;
-    }
-    return _id;
-}
-
-// SIGNAL 0
-void AudioProcessor::playbackStateChanged(QMediaPlayer::PlaybackState _t1)
-{
-    void *_a[] = { nullptr, const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t1))) };
-    QMetaObject::activate(this, &staticMetaObject, 0, _a);
-}
-
-// SIGNAL 1
-void AudioProcessor::durationChanged(qint64 _t1)
-{
-    void *_a[] = { nullptr, const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t1))) };
-    QMetaObject::activate(this, &staticMetaObject, 1, _a);
-}
-
-// SIGNAL 2
-void AudioProcessor::positionChanged(qint64 _t1)
-{
-    void *_a[] = { nullptr, const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t1))) };
-    QMetaObject::activate(this, &staticMetaObject, 2, _a);
-}
-
-// SIGNAL 3
-void AudioProcessor::errorOccurred(const QString & _t1)
-{
-    void *_a[] = { nullptr, const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t1))) };
-    QMetaObject::activate(this, &staticMetaObject, 3, _a);
-}
-
-// SIGNAL 4
-void AudioProcessor::temporaryFileCreated(const QString & _t1)
-{
-    void *_a[] = { nullptr, const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t1))) };
-    QMetaObject::activate(this, &staticMetaObject, 4, _a);
-}
-
-// SIGNAL 5
-void AudioProcessor::openAIResultReceived(const QString & _t1)
-{
-    void *_a[] = { nullptr, const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t1))) };
-    QMetaObject::activate(this, &staticMetaObject, 5, _a);
-}
-
-// SIGNAL 6
-void AudioProcessor::preciseServerResultReady(const QString & _t1)
-{
-    void *_a[] = { nullptr, const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t1))) };
-    QMetaObject::activate(this, &staticMetaObject, 6, _a);
-}
-
-// SIGNAL 7
-void AudioProcessor::recognitionResultReady(const QString & _t1)
-{
-    void *_a[] = { nullptr, const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t1))) };
-    QMetaObject::activate(this, &staticMetaObject, 7, _a);
-}
-
-// SIGNAL 8
-void AudioProcessor::subtitlePreviewReady(const QString & _t1, qint64 _t2, qint64 _t3)
-{
-    void *_a[] = { nullptr, const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t1))), const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t2))), const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t3))) };
-    QMetaObject::activate(this, &staticMetaObject, 8, _a);
-}
-
-// SIGNAL 9
-void AudioProcessor::processingFullyStopped()
-{
-    QMetaObject::activate(this, &staticMetaObject, 9, nullptr);
-}
-
-// SIGNAL 10
-void AudioProcessor::correctionEnabledChanged(bool _t1)
-{
-    void *_a[] = { nullptr, const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t1))) };
-    QMetaObject::activate(this, &staticMetaObject, 10, _a);
-}
-
-// SIGNAL 11
-void AudioProcessor::lineCorrectionEnabledChanged(bool _t1)
-{
-    void *_a[] = { nullptr, const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t1))) };
-    QMetaObject::activate(this, &staticMetaObject, 11, _a);
-}
-
-// SIGNAL 12
-void AudioProcessor::correctionStatusUpdated(QString _t1)
-{
-    void *_a[] = { nullptr, const_cast<void*>(reinterpret_cast<const void*>(std::addressof(_t1))) };
-    QMetaObject::activate(this, &staticMetaObject, 12, _a);
-}
-QT_WARNING_POP
@@ -0,0 +1,254 @@
+#include "offline_file_ingestor.h"
+#include "audio_utils.h"
+#include "audio_kernels.h"
+#include "audio_resampler.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+extern "C" {
+#include <fvad.h>
+}
+
+namespace {
+
+constexpr int FRAME_MS = 30;  // WebRTC VAD在30ms帧上最准确
+constexpr size_t FRAME_SAMPLES = OfflineFileIngestor::SAMPLE_RATE * FRAME_MS / 1000;
+constexpr size_t CANCEL_CHECK_FRAMES = 1000;  // VAD每处理这么多帧检查一次取消
+
+size_t msToFrames(int ms) {
+    return static_cast<size_t>(std::max(0, ms) + FRAME_MS - 1) / FRAME_MS;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool isCancelled(const std::atomic<bool>* cancel) {
+    return cancel && cancel->load();
+}
+
+} // namespace
+
+OfflineFileIngestor::OfflineFileIngestor(const OfflineIngestOptions& options)
+    : options(options) {
+}
+
+double OfflineFileIngestor::getDurationMs() const {
+    return audio ? audio->durationMs() : 0.0;
+}
+
+bool OfflineFileIngestor::load(const std::string& path, const std::atomic<bool>* cancel) {
+    audio.reset();
+    speech_flags.clear();
+    frame_energy.clear();
+    segments.clear();
+    error.clear();
+
+    auto start = std::chrono::steady_clock::now();
+    if (!decodeFile(path, cancel)) {
+        return false;
+    }
+    decode_ms = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    if (!detectSpeech(cancel)) {
+        return false;
+    }
+    buildSegments();
+    vad_ms = elapsedMs(start);
+
+    std::cout << "[OfflineIngest] " << path << ": " << static_cast<int>(getDurationMs()) << "ms音频，"
+              << segments.size() << "个语音段，解码" << static_cast<int>(decode_ms) << "ms，VAD"
+              << static_cast<int>(vad_ms) << "ms" << std::endl;
+    return true;
+}
+
+bool OfflineFileIngestor::decodeFile(const std::string& path, const std::atomic<bool>* cancel) {
+    WavReader reader;
+    if (!reader.open(path, true)) {
+        error = reader.getError();
+        return false;
+    }
+
+    const WavFormat& format = reader.getFormat();
+    const uint64_t total_frames = reader.getTotalFrames();
+
+    ChannelDownmixer downmixer;
+    downmixer.setMode(options.downmix_mode, options.downmix_channel);
+
+    std::unique_ptr<AudioResampler> resampler;
+    uint64_t expected = total_frames;
+    if (format.sample_rate != SAMPLE_RATE) {
+        if (format.sample_rate < AudioResampler::MIN_SAMPLE_RATE || format.sample_rate > AudioResampler::MAX_SAMPLE_RATE) {
+            error = "不支持的采样率: " + std::to_string(format.sample_rate);
+            return false;
+        }
+        resampler = std::make_unique<AudioResampler>(format.sample_rate, SAMPLE_RATE);
+        expected = (total_frames * SAMPLE_RATE + format.sample_rate - 1) / format.sample_rate;
+    }
+
+    std::vector<float> samples;
+    samples.reserve(static_cast<size_t>(expected) + (resampler ? resampler->getLatency() * 2 : 0));
+
+    // 每次读取一秒，映射的页面直接解码到声道平面
+    const size_t block_frames = static_cast<size_t>(format.sample_rate);
+    std::vector<std::vector<float>> planes;
+    std::vector<float> mono;
+    size_t frames = 0;
+    while ((frames = reader.readFrames(block_frames, planes)) > 0) {
+        if (isCancelled(cancel)) {
+            error = "已取消";
+            return false;
+        }
+
+        const float* block = planes[0].data();
+        if (format.channels > 1) {
+            downmixer.process(planes, frames, mono);
+            block = mono.data();
+        }
+
+        if (resampler) {
+            resampler->process(block, frames, samples);
+        } else {
+            samples.insert(samples.end(), block, block + frames);
+        }
+    }
+    if (!reader.getError().empty()) {
+        error = reader.getError();
+        return false;
+    }
+
+    if (resampler) {
+        // 整段处理可以补偿滤波器延迟，使样本位置与文件时间精确对应
+        resampler->flush(samples);
+        const size_t latency = std::min(resampler->getLatency(), samples.size());
+        samples.erase(samples.begin(), samples.begin() + latency);
+        if (samples.size() > expected) {
+            samples.resize(static_cast<size_t>(expected));
+        }
+    }
+
+    audio = PcmBlock::create(std::move(samples), SAMPLE_RATE);
+    return true;
+}
+
+bool OfflineFileIngestor::detectSpeech(const std::atomic<bool>* cancel) {
+    Fvad* vad = fvad_new();
+    if (!vad) {
+        error = "无法创建VAD实例";
+        return false;
+    }
+    fvad_set_sample_rate(vad, SAMPLE_RATE);
+    if (fvad_set_mode(vad, std::max(0, std::min(3, options.vad_mode))) < 0) {
+        fvad_set_mode(vad, 2);
+    }
+
+    const size_t frame_count = audio->size() / FRAME_SAMPLES;
+    speech_flags.assign(frame_count, 0);
+    frame_energy.assign(frame_count, 0.0f);
+
+    int16_t pcm[FRAME_SAMPLES];
+    for (size_t f = 0; f < frame_count; ++f) {
+        if (f % CANCEL_CHECK_FRAMES == 0 && isCancelled(cancel)) {
+            fvad_free(vad);
+            error = "已取消";
+            return false;
+        }
+
+        const float* frame = audio->data() + f * FRAME_SAMPLES;
+        AudioKernels::floatToInt16(frame, FRAME_SAMPLES, pcm);
+        const int result = fvad_process(vad, pcm, FRAME_SAMPLES);
+        if (result < 0) {
+            fvad_free(vad);
+            error = "fvad_process返回错误: " + std::to_string(result);
+            return false;
+        }
+        speech_flags[f] = static_cast<uint8_t>(result);
+
+        frame_energy[f] = AudioKernels::analyze(frame, FRAME_SAMPLES).sum_squares / FRAME_SAMPLES;
+    }
+
+    fvad_free(vad);
+    return true;
+}
+
+size_t OfflineFileIngestor::findQuietestFrame(size_t begin, size_t end) const {
+    size_t quietest = begin;
+    for (size_t f = begin + 1; f < end; ++f) {
+        if (frame_energy[f] < frame_energy[quietest]) {
+            quietest = f;
+        }
+    }
+    return quietest;
+}
+
+void OfflineFileIngestor::buildSegments() {
+    struct Run {
+        size_t begin;  // 帧序号，左闭右开
+        size_t end;
+        bool split;    // 起点是强制切开处而不是静音
+    };
+
+    // 连续的语音帧，间隔短于最小静音的合并为一段
+    const size_t min_silence = msToFrames(options.min_silence_ms);
+    std::vector<Run> runs;
+    for (size_t f = 0; f < speech_flags.size(); ++f) {
+        if (!speech_flags[f]) {
+            continue;
+        }
+        if (!runs.empty() && f - runs.back().end < min_silence) {
+            runs.back().end = f + 1;
+        } else {
+            runs.push_back({f, f + 1, false});
+        }
+    }
+
+    // 丢弃过短的段，过长的段在后半部分能量最低的帧处切开
+    const size_t min_speech = msToFrames(options.min_speech_ms);
+    const size_t padding = static_cast<size_t>(std::max(0, options.padding_ms)) * SAMPLE_RATE / 1000;
+    // 为前后补的静音和切开处的重叠留出余量，补完后不超过最大段长
+    const size_t max_frames = msToFrames(options.max_segment_ms);
+    const size_t reserved_frames = 2 * msToFrames(options.padding_ms) + msToFrames(options.split_overlap_ms);
+    const size_t max_length = max_frames > reserved_frames + 2 ? max_frames - reserved_frames
+                                                               : std::max<size_t>(2, max_frames);
+    std::vector<Run> pieces;
+    for (Run run : runs) {
+        if (run.end - run.begin < min_speech) {
+            continue;
+        }
+        while (run.end - run.begin > max_length) {
+            const size_t cut = findQuietestFrame(run.begin + max_length / 2, run.begin + max_length);
+            pieces.push_back({run.begin, cut, run.split});
+            run.begin = cut;
+            run.split = true;
+        }
+        pieces.push_back(run);
+    }
+
+    // 前后补静音，补出的部分不与上一段重叠；强制切开的段则有意向前重叠，避免切断的字两边都识别不全
+    const size_t overlap = static_cast<size_t>(std::max(0, options.split_overlap_ms)) * SAMPLE_RATE / 1000;
+    size_t previous_end = 0;
+    for (const Run& piece : pieces) {
+        const size_t speech_begin = piece.begin * FRAME_SAMPLES;
+        size_t begin = std::max(previous_end, speech_begin > padding ? speech_begin - padding : 0);
+        if (piece.split && !segments.empty()) {
+            begin = speech_begin > overlap ? speech_begin - overlap : 0;
+        }
+        const size_t end = std::min(audio->size(), piece.end * FRAME_SAMPLES + padding);
+        if (end <= begin) {
+            continue;
+        }
+
+        OfflineSpeechSegment segment;
+        segment.pcm = PcmBlock::slice(audio, begin, end - begin);
+        segment.start_sample = begin;
+        segment.sequence_number = static_cast<int>(segments.size());
+        if (begin < previous_end) {
+            segment.overlap_ms = static_cast<int>((previous_end - begin) * 1000 / SAMPLE_RATE);
+        }
+        segments.push_back(std::move(segment));
+        previous_end = end;
+    }
+}
@@ -9,10 +9,12 @@
 #include <QFile>
 #include <QHttpPart>
 #include <QTimer>
+#include <QThread>
 #include <QDateTime>
 #include <fstream>
 #include <chrono>
 #include <iomanip>
+#include <algorithm>
 
 // Batch processing related constants
 const size_t DEFAULT_BATCH_SIZE = 1;        // Default batch size (minimized for real-time processing)
@@ -22,6 +24,12 @@ const int MIN_BATCH_INTERVAL_MS = 10;       // Minimum batch interval (milliseco
 const size_t DEFAULT_PARALLEL_REQUESTS = 16;  // Default parallel request count (maximized parallelism)
 const size_t MAX_PARALLEL_REQUESTS = 20;     // Maximum parallel request count (increased maximum parallelism)
 
+// Retry related constants
+const int MAX_RETRIES = 3;                  // Attempts per segment, including the first one
+const int RETRY_BASE_DELAY_MS = 500;        // Backoff before the first retry (doubled on each retry)
+const int RETRY_MAX_DELAY_MS = 8000;        // Backoff upper bound
+const int REQUEST_TIMEOUT_MS = 60000;       // Transfer timeout of a single request
+
 // Add performance monitoring log
 void log_performance(const std::string& action, const std::string& detail, 
                     std::chrono::steady_clock::time_point start_time) {
@@ -106,14 +114,25 @@ void ParallelOpenAIProcessor::start() {
     }
 
     running = true;
-    for (size_t i = 0; i < max_parallel_requests; ++i) {
-        worker_threads.emplace_back(&ParallelOpenAIProcessor::workerThread, this);
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        next_sequence_number = 0;
     }
     
+    // 网络线程上只有一个长期存在的QNetworkAccessManager，所有请求共用它的连接池
+    network_thread = new QThread();
+    network_manager = new QNetworkAccessManager();
+    network_manager->moveToThread(network_thread);
+    connect(network_thread, &QThread::finished, network_manager, &QObject::deleteLater);
+    network_thread->start();
+    
     // Start batch processing timer
     batch_timer->start();
     
-    LOG_INFO("Parallel OpenAI processor started, worker thread count: " + std::to_string(max_parallel_requests));
+    // 启动前已入队的段
+    scheduleDispatch();
+    
+    LOG_INFO("Parallel OpenAI processor started, max in-flight requests: " + std::to_string(max_parallel_requests));
     log_performance("Start", "Parallel OpenAI processor startup", start_time);
 }
 
@@ -130,14 +149,24 @@ void ParallelOpenAIProcessor::stop() {
     }
     
     running = false;
-    queue_cv.notify_all();
 
-    for (auto& thread : worker_threads) {
-        if (thread.joinable()) {
-            thread.join();
-        }
+    if (network_thread) {
+        // 中止未完成的请求，回调中看到running为false后直接释放名额；等待重试的定时器随线程退出丢弃
+        const Qt::ConnectionType type = QThread::currentThread() == network_thread
+            ? Qt::DirectConnection : Qt::BlockingQueuedConnection;
+        QMetaObject::invokeMethod(network_manager, [this]() {
+            for (QNetworkReply* reply : network_manager->findChildren<QNetworkReply*>()) {
+                reply->abort();
+            }
+        }, type);
+        
+        network_thread->quit();
+        network_thread->wait();
+        delete network_thread;
+        network_thread = nullptr;
+        network_manager = nullptr;  // 线程结束时已通过deleteLater释放
+        in_flight = 0;
     }
-    worker_threads.clear();
 
     // Clear queue
     {
@@ -156,21 +185,23 @@ void ParallelOpenAIProcessor::stop() {
 void ParallelOpenAIProcessor::join() {
     auto start_time = std::chrono::steady_clock::now();
     
-    for (auto& thread : worker_threads) {
-        if (thread.joinable()) {
-            thread.join();
-        }
+    if (network_thread) {
+        network_thread->wait();
     }
     
-    log_performance("Join", "Worker threads completed", start_time);
+    log_performance("Join", "Network thread completed", start_time);
 }
 
-void ParallelOpenAIProcessor::addSegment(const AudioSegment& segment) {
+void ParallelOpenAIProcessor::addSegment(const AudioSegment& input_segment) {
     auto start_time = std::chrono::steady_clock::now();
     
     {
         std::lock_guard<std::mutex> lock(queue_mutex);
         
+        // 直接处理时新段排在队列前面，请求完成的顺序也不定，结果按加入顺序的编号重新排序
+        AudioSegment segment = input_segment;
+        segment.sequence_number = next_sequence_number++;
+        
         // Add to batch queue or process directly
         if (enable_batch_processing) {
             pending_batch.push_back(segment);
@@ -219,7 +250,7 @@ void ParallelOpenAIProcessor::addSegment(const AudioSegment& segment) {
             
             // 交换回原始队列
             std::swap(processing_queue, temp_queue);
-            queue_cv.notify_one(); // Notify a worker thread to process
+            scheduleDispatch(); // 在网络线程上发出请求
 
             LOG_INFO("Directly added segment to processing queue (batch processing disabled): " + segment.filepath + 
                     (segment.is_last ? " (last segment)" : ""));
@@ -267,9 +298,6 @@ void ParallelOpenAIProcessor::processPendingBatchInternal() {
         // Add segment to processing queue
         processing_queue.push(pending_batch[i]);
         
-        // Notify once for each added segment to ensure timely processing
-        queue_cv.notify_one();
-        
         // Log detailed information
         LOG_INFO("Added segment to processing queue: " + pending_batch[i].filepath + 
                  (pending_batch[i].is_last ? " (last segment)" : ""));
@@ -278,57 +306,67 @@ void ParallelOpenAIProcessor::processPendingBatchInternal() {
     // Clear batch queue
     pending_batch.clear();
     
-    // Ensure all worker threads are notified
-    queue_cv.notify_all();
+    // 在并发上限内发出请求
+    scheduleDispatch();
     
     log_performance("ProcessBatch", "Processed batch data: " + std::to_string(batch_count) + " segments", start_time);
 }
 
-void ParallelOpenAIProcessor::workerThread() {
+void ParallelOpenAIProcessor::scheduleDispatch() {
+    if (network_manager) {
+        QMetaObject::invokeMethod(network_manager, [this]() { dispatchPending(); }, Qt::QueuedConnection);
+    }
+}
+
+void ParallelOpenAIProcessor::dispatchPending() {
+    // 在并发上限内从队列取段发出请求，其余段留在队列中，等有请求完成时再发
     while (running) {
         AudioSegment segment;
-        bool has_segment = false;
-        
         {
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            queue_cv.wait(lock, [this] { 
-                return !processing_queue.empty() || !running; 
-            });
-            
-            if (!running) break;
-            if (processing_queue.empty()) continue;
-            
-            auto thread_start = std::chrono::steady_clock::now();
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (processing_queue.empty() || in_flight >= max_parallel_requests) {
+                return;
+            }
             segment = processing_queue.front();
             processing_queue.pop();
-            has_segment = true;
-            
-            log_performance("SegmentDequeue", "Thread retrieved segment from queue: " + segment.filepath, thread_start);
         }
+        ++in_flight;
+        
+        const int sequence_number = resolveSequenceNumber(segment);
+        LOG_INFO("Processing audio segment: sequence number=" + std::to_string(sequence_number) +
+                 (segment.is_last ? " (last segment)" : "") +
+                 ", in-flight requests=" + std::to_string(in_flight));
+        processSegmentWithOpenAI(segment, sequence_number, 0, std::chrono::steady_clock::now());
+    }
+}
 
-        if (has_segment) {
-            auto process_start = std::chrono::steady_clock::now();
-            processSegmentWithOpenAI(segment);
-            log_performance("ProcessSegment", "Thread completed segment processing: " + segment.filepath, process_start);
-        }
+void ParallelOpenAIProcessor::finishSegment() {
+    if (in_flight > 0) {
+        --in_flight;
     }
+    dispatchPending();
 }
 
-void ParallelOpenAIProcessor::processSegmentWithOpenAI(const AudioSegment& segment) {
-    auto total_start = std::chrono::steady_clock::now();
-    
-    // Set maximum retry count
-    const int max_retries = 3;
-    int retry_count = 0;
-    bool success = false;
-    
-    // Log processing start
-    LOG_INFO("Starting to process audio segment: " + segment.filepath + 
-             (segment.is_last ? " (last segment)" : ""));
-    
+int ParallelOpenAIProcessor::nextRetryDelayMs(int attempt) {
+    // 指数退避，在[delay/2, delay]内随机取值，避免同时失败的请求在同一时刻一起重试
+    const int delay = std::min(RETRY_MAX_DELAY_MS, RETRY_BASE_DELAY_MS << std::min(attempt, 8));
+    std::uniform_int_distribution<int> jitter(delay / 2, delay);
+    return jitter(retry_rng);
+}
+
+int ParallelOpenAIProcessor::resolveSequenceNumber(const AudioSegment& segment) {
     // Use sequence number from segment object instead of parsing from filename
     int sequence_number = segment.sequence_number;
     
+    // Use static counter as fallback
+    static std::atomic<int> fallback_sequence{0};
+    
+    // In-memory segments carry no filename to parse
+    if (sequence_number < 0 && segment.filepath.empty()) {
+        sequence_number = fallback_sequence.fetch_add(1);
+        LOG_INFO("Using fallback sequence number: " + std::to_string(sequence_number));
+    }
+    
     // If sequence number is invalid (-1), try to extract from filename
     if (sequence_number < 0) {
         try {
@@ -358,218 +396,279 @@ void ParallelOpenAIProcessor::processSegmentWithOpenAI(const AudioSegment& segme
             }
         } catch (const std::exception& e) {
             LOG_WARNING("Failed to extract sequence number from filename: " + std::string(e.what()));
-            // Use static counter as fallback
-            static std::atomic<int> fallback_sequence{0};
             sequence_number = fallback_sequence.fetch_add(1);
             LOG_INFO("Using fallback sequence number: " + std::to_string(sequence_number));
         }
     }
     
-    LOG_INFO("Processing audio segment: " + segment.filepath + ", sequence number=" + std::to_string(sequence_number));
+    return sequence_number;
+}
+
+QHttpMultiPart* ParallelOpenAIProcessor::buildMultiPart(const AudioSegment& segment, int sequence_number) {
+    // Create multipart form data - 使用更简单和稳固的方法
+    QHttpMultiPart *multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
     
-    // Perform multiple retries
-    while (retry_count < max_retries && !success) {
-        try {
-            std::string server_url_str = server_url;
-            
-            // 确保URL包含/transcribe端点
-            if (server_url_str.find("/transcribe") == std::string::npos) {
-                if (server_url_str.back() == '/') {
-                    server_url_str += "transcribe";
+    // 记录详细的请求信息
+    LOG_INFO("Creating multipart request with the following parts:");
+    
+    // Add file - 内存段直接使用缓存的WAV/FLAC字节，否则从磁盘读取
+    QFile* file = nullptr;
+    QString fileName;
+    bool flac = false;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        flac = upload_flac;
+    }
+    const std::string* pcm_bytes = nullptr;
+    if (segment.pcm) {
+        pcm_bytes = flac ? &segment.pcm->flacBytes() : &segment.pcm->wavBytes();
+        fileName = QString(flac ? "segment_%1.flac" : "segment_%1.wav").arg(sequence_number);
+        LOG_INFO("File part - Name: 'file', Filename: '" + fileName.toStdString() + "', Size: " + std::to_string(pcm_bytes->size()) + " bytes (in-memory)");
     } else {
-                    server_url_str += "/transcribe";
-                }
-                LOG_INFO("Adding /transcribe endpoint to URL: " + server_url_str);
-            }
-            
-            // 创建更符合Werkzeug要求的请求头
-            QNetworkRequest request(QUrl(QString::fromStdString(server_url_str)));
-            
-            // 不要指定Content-Type，让Qt自动添加正确的multipart boundary
-            // request.setHeader(QNetworkRequest::ContentTypeHeader, "multipart/form-data");
-            
-            // 添加一些用户代理信息帮助调试
-            request.setHeader(QNetworkRequest::UserAgentHeader, "StreamRecognizer/1.0");
-            
-            // 添加调试日志，显示完整请求URL
-            LOG_INFO("Sending request to: " + server_url_str);
-            
-            // Create multipart form data - 使用更简单和稳固的方法
-            QHttpMultiPart *multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
-            
-            // 记录详细的请求信息
-            LOG_INFO("Creating multipart request with the following parts:");
-            
-            // Add file - 修复文件部分的问题
-            QFile* file = new QFile(QString::fromStdString(segment.filepath));
-            if (!file->open(QIODevice::ReadOnly)) {
-                throw std::runtime_error("Cannot open audio file: " + segment.filepath);
-            }
-            
-            // 获取文件名（不包含路径）
-            QString fileName = QFileInfo(file->fileName()).fileName();
-            LOG_INFO("File part - Name: 'file', Filename: '" + fileName.toStdString() + "', Size: " + std::to_string(file->size()) + " bytes");
-            
-            // 确保使用正确的Content-Disposition格式
-            QHttpPart filePart;
-            filePart.setHeader(QNetworkRequest::ContentDispositionHeader, 
-                              QString("form-data; name=\"file\"; filename=\"%1\"").arg(fileName));
-            
-            // 设置适当的内容类型
-            QString contentType;
-            if (fileName.endsWith(".wav", Qt::CaseInsensitive)) {
-                contentType = "audio/wav";
-            } else if (fileName.endsWith(".mp3", Qt::CaseInsensitive)) {
-                contentType = "audio/mpeg";
-            } else if (fileName.endsWith(".ogg", Qt::CaseInsensitive)) {
-                contentType = "audio/ogg";
-            } else if (fileName.endsWith(".flac", Qt::CaseInsensitive)) {
-                contentType = "audio/flac";
-            } else {
-                contentType = "application/octet-stream";
-            }
-            filePart.setHeader(QNetworkRequest::ContentTypeHeader, contentType);
-            
-            filePart.setBodyDevice(file);
-            file->setParent(multiPart); // Ensure file is cleaned up with multiPart
-            multiPart->append(filePart);
-            
-            // Add model parameter - 使用更一致的格式
-            QHttpPart modelPart;
-            modelPart.setHeader(QNetworkRequest::ContentDispositionHeader, 
-                               QString("form-data; name=\"model\""));
-            modelPart.setBody(model_name.c_str());
-            multiPart->append(modelPart);
-            LOG_INFO("Model part - Name: 'model', Value: '" + model_name + "'");
-            
-            // Add sequence number parameter - 使用更一致的格式
-            QHttpPart sequencePart;
-            sequencePart.setHeader(QNetworkRequest::ContentDispositionHeader, 
-                                  QString("form-data; name=\"sequence\""));
-            sequencePart.setBody(std::to_string(sequence_number).c_str());
-            multiPart->append(sequencePart);
-            LOG_INFO("Sequence part - Name: 'sequence', Value: '" + std::to_string(sequence_number) + "'");
-
-            // Perform network request with improved error handling
-            QNetworkAccessManager manager;
-            QEventLoop loop;
-            
-            QNetworkReply* reply = manager.post(request, multiPart);
-            multiPart->setParent(reply); // Ensure multiPart is cleaned up with reply
-            
-            // 添加网络请求的详细日志
-            QObject::connect(reply, &QNetworkReply::uploadProgress, 
-                           [this, &segment](qint64 bytesSent, qint64 bytesTotal) {
-                LOG_INFO("Upload progress for segment " + std::to_string(segment.sequence_number) + 
-                         ": " + std::to_string(bytesSent) + "/" + std::to_string(bytesTotal) + 
-                         " bytes (" + std::to_string(bytesTotal > 0 ? (bytesSent * 100 / bytesTotal) : 0) + "%)");
-            });
-            
-            QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-            loop.exec(); // Wait for request to complete
-            
-            // Handle response with more detailed error information
-            if (reply->error() == QNetworkReply::NoError) {
-                // 成功处理逻辑保持不变
-                QByteArray response_data = reply->readAll();
-                QString result = QString::fromUtf8(response_data);
-                
-                // 日志记录响应数据长度
-                LOG_INFO("Received response: " + std::to_string(response_data.size()) + " bytes");
-                
-                // 首先尝试解析响应是否为JSON
-                QJsonParseError parseError;
-                QJsonDocument jsonDoc = QJsonDocument::fromJson(result.toUtf8(), &parseError);
-                QJsonObject resultObj;
-                
-                if (parseError.error == QJsonParseError::NoError && jsonDoc.isObject()) {
-                    // 已经是JSON格式，提取text字段
-                    resultObj = jsonDoc.object();
-                    
-                    LOG_INFO("Response is already in JSON format");
-                    // 确保text字段是一个字符串，不是嵌套的JSON对象
-                    if (resultObj.contains("text") && resultObj["text"].isString()) {
-                        QString textContent = resultObj["text"].toString();
-                        // 检查text内容是否是嵌套的JSON (开头是{，结尾是})
-                        if (textContent.startsWith('{') && textContent.endsWith('}')) {
-                            LOG_INFO("Text field appears to contain nested JSON, flattening");
-                            // 尝试解析嵌套的JSON
-                            QJsonDocument nestedDoc = QJsonDocument::fromJson(textContent.toUtf8());
-                            if (!nestedDoc.isNull() && nestedDoc.isObject()) {
-                                // 从嵌套JSON中提取text字段
-                                QJsonObject nestedObj = nestedDoc.object();
-                                if (nestedObj.contains("text")) {
-                                    // 替换外层JSON的text字段为嵌套JSON中的text字段
-                                    resultObj["text"] = nestedObj["text"];
-                                    // 可以保留嵌套JSON中的其他字段，添加前缀
-                                    if (nestedObj.contains("timestamp")) {
-                                        resultObj["inner_timestamp"] = nestedObj["timestamp"];
-                                    }
-                                }
+        file = new QFile(QString::fromStdString(segment.filepath));
+        if (!file->open(QIODevice::ReadOnly)) {
+            LOG_ERROR("Cannot open audio file: " + segment.filepath);
+            delete file;
+            delete multiPart;
+            return nullptr;
+        }
+        
+        // 获取文件名（不包含路径）
+        fileName = QFileInfo(file->fileName()).fileName();
+        LOG_INFO("File part - Name: 'file', Filename: '" + fileName.toStdString() + "', Size: " + std::to_string(file->size()) + " bytes");
+    }
+    
+    // 确保使用正确的Content-Disposition格式
+    QHttpPart filePart;
+    filePart.setHeader(QNetworkRequest::ContentDispositionHeader, 
+                      QString("form-data; name=\"file\"; filename=\"%1\"").arg(fileName));
+    
+    // 设置适当的内容类型
+    QString contentType;
+    if (fileName.endsWith(".wav", Qt::CaseInsensitive)) {
+        contentType = "audio/wav";
+    } else if (fileName.endsWith(".mp3", Qt::CaseInsensitive)) {
+        contentType = "audio/mpeg";
+    } else if (fileName.endsWith(".ogg", Qt::CaseInsensitive)) {
+        contentType = "audio/ogg";
+    } else if (fileName.endsWith(".flac", Qt::CaseInsensitive)) {
+        contentType = "audio/flac";
+    } else {
+        contentType = "application/octet-stream";
+    }
+    filePart.setHeader(QNetworkRequest::ContentTypeHeader, contentType);
+    
+    if (pcm_bytes) {
+        filePart.setBody(QByteArray(pcm_bytes->data(), static_cast<qsizetype>(pcm_bytes->size())));
+    } else {
+        filePart.setBodyDevice(file);
+        file->setParent(multiPart); // Ensure file is cleaned up with multiPart
+    }
+    multiPart->append(filePart);
+    
+    // Add model parameter - 使用更一致的格式
+    QHttpPart modelPart;
+    modelPart.setHeader(QNetworkRequest::ContentDispositionHeader, 
+                       QString("form-data; name=\"model\""));
+    modelPart.setBody(model_name.c_str());
+    multiPart->append(modelPart);
+    LOG_INFO("Model part - Name: 'model', Value: '" + model_name + "'");
+    
+    // Add sequence number parameter - 使用更一致的格式
+    QHttpPart sequencePart;
+    sequencePart.setHeader(QNetworkRequest::ContentDispositionHeader, 
+                          QString("form-data; name=\"sequence\""));
+    sequencePart.setBody(std::to_string(sequence_number).c_str());
+    multiPart->append(sequencePart);
+    LOG_INFO("Sequence part - Name: 'sequence', Value: '" + std::to_string(sequence_number) + "'");
+    
+    return multiPart;
+}
+
+void ParallelOpenAIProcessor::processSegmentWithOpenAI(const AudioSegment& segment, int sequence_number, int attempt,
+                                                       std::chrono::steady_clock::time_point segment_start) {
+    std::string server_url_str;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        server_url_str = server_url;
+    }
+    
+    // 确保URL包含/transcribe端点
+    if (server_url_str.find("/transcribe") == std::string::npos) {
+        if (!server_url_str.empty() && server_url_str.back() == '/') {
+            server_url_str += "transcribe";
+        } else {
+            server_url_str += "/transcribe";
+        }
+    }
+    
+    QNetworkRequest request(QUrl(QString::fromStdString(server_url_str)));
+    
+    // 不要指定Content-Type，让Qt自动添加正确的multipart boundary
+    request.setHeader(QNetworkRequest::UserAgentHeader, "StreamRecognizer/1.0");
+    
+    // 所有段共用同一个QNetworkAccessManager，保持连接复用；HTTPS端点通过ALPN协商HTTP/2后在一条连接上多路复用
+    request.setRawHeader("Connection", "keep-alive");
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    
+    // 请求占用并发名额，挂起的连接必须超时释放
+    request.setTransferTimeout(REQUEST_TIMEOUT_MS);
+    
+    QHttpMultiPart* multiPart = buildMultiPart(segment, sequence_number);
+    if (!multiPart) {
+        // 读取本地文件失败，重试也无济于事
+        LOG_ERROR("Failed to process segment #" + std::to_string(sequence_number) + ": cannot build request");
+        finishSegment();
+        return;
+    }
+    
+    LOG_INFO("Sending request to: " + server_url_str +
+             (attempt > 0 ? " (retry " + std::to_string(attempt) + ")" : ""));
+    
+    QNetworkReply* reply = network_manager->post(request, multiPart);
+    multiPart->setParent(reply); // Ensure multiPart is cleaned up with reply
+    
+    // 添加网络请求的详细日志
+    QObject::connect(reply, &QNetworkReply::uploadProgress, reply,
+                     [sequence_number](qint64 bytesSent, qint64 bytesTotal) {
+        LOG_INFO("Upload progress for segment " + std::to_string(sequence_number) + 
+                 ": " + std::to_string(bytesSent) + "/" + std::to_string(bytesTotal) + 
+                 " bytes (" + std::to_string(bytesTotal > 0 ? (bytesSent * 100 / bytesTotal) : 0) + "%)");
+    });
+    
+    QObject::connect(reply, &QNetworkReply::finished, network_manager,
+                     [this, reply, segment, sequence_number, attempt, segment_start]() {
+        handleReply(reply, segment, sequence_number, attempt, segment_start);
+    });
+}
+
+void ParallelOpenAIProcessor::handleReply(QNetworkReply* reply, const AudioSegment& segment, int sequence_number,
+                                          int attempt, std::chrono::steady_clock::time_point segment_start) {
+    reply->deleteLater();
+    
+    // 停止时中止的请求直接释放名额
+    if (!running) {
+        finishSegment();
+        return;
+    }
+    
+    if (reply->error() == QNetworkReply::NoError) {
+        QByteArray response_data = reply->readAll();
+        QString result = QString::fromUtf8(response_data);
+        
+        // 日志记录响应数据长度
+        LOG_INFO("Received response: " + std::to_string(response_data.size()) + " bytes");
+        
+        // 首先尝试解析响应是否为JSON
+        QJsonParseError parseError;
+        QJsonDocument jsonDoc = QJsonDocument::fromJson(result.toUtf8(), &parseError);
+        QJsonObject resultObj;
+        
+        if (parseError.error == QJsonParseError::NoError && jsonDoc.isObject()) {
+            // 已经是JSON格式，提取text字段
+            resultObj = jsonDoc.object();
+            
+            LOG_INFO("Response is already in JSON format");
+            // 确保text字段是一个字符串，不是嵌套的JSON对象
+            if (resultObj.contains("text") && resultObj["text"].isString()) {
+                QString textContent = resultObj["text"].toString();
+                // 检查text内容是否是嵌套的JSON (开头是{，结尾是})
+                if (textContent.startsWith('{') && textContent.endsWith('}')) {
+                    LOG_INFO("Text field appears to contain nested JSON, flattening");
+                    // 尝试解析嵌套的JSON
+                    QJsonDocument nestedDoc = QJsonDocument::fromJson(textContent.toUtf8());
+                    if (!nestedDoc.isNull() && nestedDoc.isObject()) {
+                        // 从嵌套JSON中提取text字段
+                        QJsonObject nestedObj = nestedDoc.object();
+                        if (nestedObj.contains("text")) {
+                            // 替换外层JSON的text字段为嵌套JSON中的text字段
+                            resultObj["text"] = nestedObj["text"];
+                            // 可以保留嵌套JSON中的其他字段，添加前缀
+                            if (nestedObj.contains("timestamp")) {
+                                resultObj["inner_timestamp"] = nestedObj["timestamp"];
                             }
                         }
                     }
-                } else {
-                    // 非JSON格式，创建一个新的JSON对象
-                    resultObj["text"] = result;
-                }
-                
-                // 添加或更新元数据
-                resultObj["sequence"] = sequence_number;
-                resultObj["filename"] = QString::fromStdString(segment.filepath);
-                resultObj["is_last"] = segment.is_last;
-                
-                // 转换为JSON字符串
-                QJsonDocument finalDoc(resultObj);
-                QString jsonResult = finalDoc.toJson(QJsonDocument::Compact);
-                
-                LOG_INFO("Final processed result for sequence #" + std::to_string(sequence_number) + 
-                         ", JSON length: " + std::to_string(jsonResult.length()));
-                
-                // 发送结果给结果合并器，确保序列号已经在 JSON 中
-                LOG_INFO("发送 resultReady 信号，序列号: " + std::to_string(sequence_number));
-                emit resultReady(jsonResult, segment.timestamp);
-                
-                // 发送原始文本用于显示，如果有text字段则使用，否则使用原始结果
-                QString displayText = resultObj.contains("text") ? resultObj["text"].toString() : result;
-                emit resultForDisplay(displayText);
-                
-                success = true;
-            } else {
-                // 增强的错误处理和日志记录
-                QByteArray errorData = reply->readAll();
-                QString errorString = reply->errorString();
-                int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-                
-                LOG_ERROR("OpenAI API request failed: HTTP " + std::to_string(statusCode) + 
-                          " - " + errorString.toStdString());
-                LOG_ERROR("Error details: " + QString::fromUtf8(errorData).toStdString());
-                LOG_ERROR("Request URL: " + server_url_str);
-                LOG_ERROR("Content-Type: " + request.header(QNetworkRequest::ContentTypeHeader).toString().toStdString());
-                
-                // 服务器返回400错误时，可能是请求格式问题
-                if (statusCode == 400) {
-                    LOG_ERROR("Server returned 400 error, which usually means incorrect request format. Check if multipart/form-data format is correct.");
-                    LOG_ERROR("Ensure Python server is running and the 'file' field name matches what is expected in the Python code.");
                 }
-                
-                ++retry_count;
-                QThread::msleep(1000); // Wait 1 second before retry
             }
-            
-            reply->deleteLater();
-        } catch (const std::exception& e) {
-            LOG_ERROR("OpenAI processing exception: " + std::string(e.what()));
-            ++retry_count;
-            QThread::msleep(1000); // Wait 1 second before retry
+        } else {
+            // 非JSON格式，创建一个新的JSON对象
+            resultObj["text"] = result;
         }
+        
+        // 添加或更新元数据
+        resultObj["sequence"] = sequence_number;
+        resultObj["filename"] = QString::fromStdString(segment.filepath);
+        resultObj["is_last"] = segment.is_last;
+        resultObj["has_overlap"] = segment.has_overlap;
+        resultObj["overlap_ms"] = segment.overlap_ms;
+        
+        // 转换为JSON字符串
+        QJsonDocument finalDoc(resultObj);
+        QString jsonResult = finalDoc.toJson(QJsonDocument::Compact);
+        
+        LOG_INFO("Final processed result for sequence #" + std::to_string(sequence_number) + 
+                 ", JSON length: " + std::to_string(jsonResult.length()));
+        
+        // 发送结果给结果合并器，确保序列号已经在 JSON 中
+        LOG_INFO("发送 resultReady 信号，序列号: " + std::to_string(sequence_number));
+        emit resultReady(jsonResult, segment.timestamp);
+        
+        // 发送原始文本用于显示，如果有text字段则使用，否则使用原始结果
+        QString displayText = resultObj.contains("text") ? resultObj["text"].toString() : result;
+        emit resultForDisplay(displayText);
+        
+        log_performance("ProcessSegmentWithOpenAI", "Complete audio segment processing: #" + std::to_string(sequence_number), segment_start);
+        finishSegment();
+        return;
     }
     
-    if (!success) {
-        LOG_ERROR("Failed to process segment, max retries exhausted: " + segment.filepath);
+    QByteArray errorData = reply->readAll();
+    QString errorString = reply->errorString();
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    
+    LOG_ERROR("OpenAI API request failed: HTTP " + std::to_string(statusCode) + 
+              " - " + errorString.toStdString());
+    LOG_ERROR("Error details: " + QString::fromUtf8(errorData).toStdString());
+    LOG_ERROR("Request URL: " + reply->url().toString().toStdString());
+    LOG_ERROR("Content-Type: " + reply->request().header(QNetworkRequest::ContentTypeHeader).toString().toStdString());
+    
+    // 服务器返回400错误时，可能是请求格式问题
+    if (statusCode == 400) {
+        LOG_ERROR("Server returned 400 error, which usually means incorrect request format. Check if multipart/form-data format is correct.");
+        LOG_ERROR("Ensure Python server is running and the 'file' field name matches what is expected in the Python code.");
     }
     
-    log_performance("ProcessSegmentWithOpenAI", "Complete audio segment processing: " + segment.filepath, total_start);
+    // 连接失败、超时、限流和服务器错误可以重试，其余4xx说明请求本身有问题
+    const bool retryable = statusCode == 0 || statusCode == 408 || statusCode == 429 || statusCode >= 500;
+    if (retryable && attempt + 1 < MAX_RETRIES) {
+        const int delay_ms = nextRetryDelayMs(attempt);
+        LOG_WARNING("Retrying segment #" + std::to_string(sequence_number) + " in " + std::to_string(delay_ms) +
+                    "ms (attempt " + std::to_string(attempt + 2) + "/" + std::to_string(MAX_RETRIES) + ")");
+        
+        // 等待重试期间仍占用并发名额，避免后端出错时继续涌入新请求
+        QTimer::singleShot(delay_ms, network_manager, [this, segment, sequence_number, attempt, segment_start]() {
+            if (!running) {
+                finishSegment();
+                return;
+            }
+            processSegmentWithOpenAI(segment, sequence_number, attempt + 1, segment_start);
+        });
+        return;
+    }
+    
+    LOG_ERROR("Failed to process segment #" + std::to_string(sequence_number) + ", giving up after " +
+              std::to_string(attempt + 1) + " attempt(s): " + segment.filepath);
+    log_performance("ProcessSegmentWithOpenAI", "Failed audio segment processing: #" + std::to_string(sequence_number), segment_start);
+    
+    // 空结果占住这个序号，合并器不必等待超时就能输出后面的段
+    QJsonObject resultObj;
+    resultObj["text"] = QString();
+    resultObj["sequence"] = sequence_number;
+    resultObj["is_last"] = segment.is_last;
+    resultObj["error"] = true;
+    emit resultReady(QJsonDocument(resultObj).toJson(QJsonDocument::Compact), segment.timestamp);
+    finishSegment();
 }
 
 // Add model setting method
@@ -579,6 +678,12 @@ void ParallelOpenAIProcessor::setModelName(const std::string& model) {
     LOG_INFO("ParallelOpenAIProcessor model set to: " + model_name);
 }
 
+void ParallelOpenAIProcessor::setUploadFormat(const std::string& format) {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    upload_flac = format == "flac";
+    LOG_INFO("ParallelOpenAIProcessor upload format set to: " + std::string(upload_flac ? "flac" : "wav"));
+}
+
 // Add server URL setting method
 void ParallelOpenAIProcessor::setServerURL(const std::string& url) {
     std::lock_guard<std::mutex> lock(queue_mutex);
@@ -666,9 +771,6 @@ bool ParallelOpenAIProcessor::processAudioSegment(const std::string& audio_file,
         task_queue.push(task);
     }
     
-    // 通知工作线程
-    queue_cv.notify_one();
-    
     // 记录队列提交时间
     log_performance("队列提交", "音频段 #" + std::to_string(sequence_number), start_time);
     
@@ -0,0 +1,257 @@
+#include "precise_server_pool.h"
+#include "log_utils.h"
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+constexpr double UPLOAD_LATENCY_EWMA_ALPHA = 0.2;  // 新样本在上传耗时滑动平均中的权重
+
+} // namespace
+
+PreciseEndpoint::PreciseEndpoint(const std::string& url, const HealthCheckOptions& options)
+    : url(url)
+    , monitor(options) {
+    monitor.setServerUrl(url);
+}
+
+PreciseServerPool::PreciseServerPool(const HealthCheckOptions& options)
+    : options(options) {
+}
+
+void PreciseServerPool::setEndpoints(const std::vector<std::string>& urls) {
+    std::vector<PreciseEndpointPtr> updated;
+    std::vector<PreciseEndpointPtr> added;
+    std::vector<PreciseEndpointPtr> removed;
+    bool is_running = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const std::string& url : urls) {
+            if (url.empty()) {
+                continue;
+            }
+            auto same_url = [&url](const PreciseEndpointPtr& endpoint) { return endpoint->url == url; };
+            if (std::any_of(updated.begin(), updated.end(), same_url)) {
+                continue;
+            }
+            auto existing = std::find_if(endpoints.begin(), endpoints.end(), same_url);
+            if (existing != endpoints.end()) {
+                updated.push_back(*existing);
+            } else {
+                updated.push_back(std::make_shared<PreciseEndpoint>(url, options));
+                added.push_back(updated.back());
+            }
+        }
+        for (const PreciseEndpointPtr& endpoint : endpoints) {
+            if (std::find(updated.begin(), updated.end(), endpoint) == updated.end()) {
+                removed.push_back(endpoint);
+            }
+        }
+        if (added.empty() && removed.empty() && updated == endpoints) {
+            return;
+        }
+        endpoints.swap(updated);
+        next_index = 0;
+        is_running = running;
+    }
+
+    // 移除的端点可能还有请求未完成，只停止探测，对象随最后一个请求释放
+    for (const PreciseEndpointPtr& endpoint : removed) {
+        endpoint->monitor.stop();
+    }
+    if (is_running) {
+        for (const PreciseEndpointPtr& endpoint : added) {
+            endpoint->monitor.start();
+        }
+    }
+
+    LOG_INFO("[ServerPool] 识别服务器: " + describe());
+}
+
+std::vector<PreciseEndpointPtr> PreciseServerPool::getEndpoints() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return endpoints;
+}
+
+PreciseEndpointPtr PreciseServerPool::find(const std::string& url) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const PreciseEndpointPtr& endpoint : endpoints) {
+        if (endpoint->url == url) {
+            return endpoint;
+        }
+    }
+    return nullptr;
+}
+
+size_t PreciseServerPool::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return endpoints.size();
+}
+
+void PreciseServerPool::setRouting(PreciseRouting value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    routing = value;
+}
+
+PreciseRouting PreciseServerPool::getRouting() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return routing;
+}
+
+void PreciseServerPool::start() {
+    std::vector<PreciseEndpointPtr> current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running) {
+            return;
+        }
+        running = true;
+        current = endpoints;
+    }
+    for (const PreciseEndpointPtr& endpoint : current) {
+        endpoint->monitor.start();
+    }
+}
+
+void PreciseServerPool::stop() {
+    std::vector<PreciseEndpointPtr> current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+        current = endpoints;
+    }
+    for (const PreciseEndpointPtr& endpoint : current) {
+        endpoint->monitor.stop();
+    }
+}
+
+double PreciseServerPool::score(const PreciseEndpoint& endpoint) const {
+    // 服务器上报的负载包含了本客户端已到达的请求，取两者较大值而不是相加
+    double pending = endpoint.outstanding;
+    int load = 0;
+    int capacity = 0;
+    if (endpoint.monitor.getServerLoad(load, capacity)) {
+        pending = std::max(pending, static_cast<double>(load));
+    }
+    const double utilization = pending / std::max(1, capacity);
+
+    if (routing == PreciseRouting::LeastOutstanding) {
+        return utilization;
+    }
+
+    // 还没有上传样本时用探测延迟，都没有时视为0，让新加入的服务器先分到请求
+    double latency = endpoint.upload_latency_ms;
+    if (latency < 0.0) {
+        latency = std::max(0.0, endpoint.monitor.getLatencyMs());
+    }
+    return (latency + 1.0) * (1.0 + utilization);
+}
+
+PreciseEndpointPtr PreciseServerPool::acquire(const PreciseEndpointPtr& avoid) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const size_t count = endpoints.size();
+    PreciseEndpointPtr best;
+    PreciseEndpointPtr fallback;
+    double best_score = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        const PreciseEndpointPtr& endpoint = endpoints[(next_index + i) % count];
+        if (!endpoint->monitor.allowRequest()) {
+            continue;
+        }
+        if (endpoint == avoid) {
+            fallback = endpoint;
+            continue;
+        }
+        const double endpoint_score = score(*endpoint);
+        if (!best || endpoint_score < best_score) {
+            best = endpoint;
+            best_score = endpoint_score;
+        }
+    }
+    if (!best) {
+        best = fallback;
+    }
+    if (best) {
+        ++best->outstanding;
+        next_index = (next_index + 1) % count;
+    }
+    return best;
+}
+
+void PreciseServerPool::release(const PreciseEndpointPtr& endpoint, Outcome outcome, double latency_ms,
+                                const std::string& reason) {
+    if (!endpoint) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (endpoint->outstanding > 0) {
+            --endpoint->outstanding;
+        }
+        if (outcome == Outcome::Success && latency_ms >= 0.0) {
+            double& average = endpoint->upload_latency_ms;
+            average = average < 0.0 ? latency_ms : average + UPLOAD_LATENCY_EWMA_ALPHA * (latency_ms - average);
+        }
+    }
+
+    // 上传耗时包含识别时间，不计入探测延迟
+    if (outcome == Outcome::Success) {
+        endpoint->monitor.recordSuccess();
+    } else if (outcome == Outcome::Failure) {
+        endpoint->monitor.recordFailure(endpoint->url + ": " + reason);
+    }
+}
+
+bool PreciseServerPool::hasAlternative(const PreciseEndpointPtr& endpoint) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::any_of(endpoints.begin(), endpoints.end(), [&endpoint](const PreciseEndpointPtr& other) {
+        return other != endpoint && other->monitor.allowRequest();
+    });
+}
+
+std::string PreciseServerPool::describe() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream oss;
+    oss << getRoutingName(routing) << " [";
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        const PreciseEndpoint& endpoint = *endpoints[i];
+        if (i > 0) {
+            oss << "; ";
+        }
+        oss << endpoint.url << " " << ServerHealthMonitor::getStateName(endpoint.monitor.getState())
+            << "，未完成 " << endpoint.outstanding;
+        int load = 0;
+        int capacity = 0;
+        if (endpoint.monitor.getServerLoad(load, capacity)) {
+            oss << "，负载 " << load << "/" << capacity;
+        }
+        if (endpoint.upload_latency_ms >= 0.0) {
+            oss << "，上传 " << static_cast<int>(endpoint.upload_latency_ms) << "ms";
+        }
+    }
+    oss << "]";
+    return oss.str();
+}
+
+bool PreciseServerPool::parseRouting(const std::string& name, PreciseRouting& routing) {
+    if (name == "least_outstanding") {
+        routing = PreciseRouting::LeastOutstanding;
+        return true;
+    }
+    if (name == "ewma") {
+        routing = PreciseRouting::EwmaLatency;
+        return true;
+    }
+    return false;
+}
+
+const char* PreciseServerPool::getRoutingName(PreciseRouting routing) {
+    switch (routing) {
+        case PreciseRouting::LeastOutstanding: return "least_outstanding";
+        case PreciseRouting::EwmaLatency: return "ewma";
+    }
+    return "unknown";
+}
@@ -6,15 +6,6 @@
 #include <filesystem>
 #include <chrono>
 
-// Helper function: calculate total samples in AudioBuffer vector
-size_t getAudioBuffersTotalSamples(const std::vector<AudioBuffer>& buffers) {
-    size_t total = 0;
-    for (const auto& buffer : buffers) {
-        total += buffer.data.size();
-    }
-    return total;
-}
-
 RealtimeSegmentHandler::RealtimeSegmentHandler(
     size_t segment_size_ms,
     size_t overlap_ms,
@@ -139,20 +130,17 @@ void RealtimeSegmentHandler::stop() {
                 " 个缓冲区，总样本数: " + std::to_string(total_samples));
         
         // 创建最后一个音频段
-        std::string segment_path;
+        AudioSegment segment;
         try {
-            segment_path = createSegment(current_buffers);
+            segment = createSegment(current_buffers);
         } catch (const std::exception& e) {
             LOG_ERROR("创建最后段失败: " + std::string(e.what()));
         }
         
-        if (!segment_path.empty() && segment_ready_callback) {
-            AudioSegment segment;
-            segment.filepath = segment_path;
-            segment.timestamp = std::chrono::system_clock::now();
+        if (segment.hasAudio() && segment_ready_callback) {
             segment.is_last = true;  // 标记为最后一段
             
-            LOG_INFO("创建最后音频段: " + segment_path + "（停止时的剩余数据）");
+            LOG_INFO("创建最后音频段: " + segment.filepath + "（停止时的剩余数据）");
             
             // 调用回调处理最后一段
             try {
@@ -211,45 +199,63 @@ void RealtimeSegmentHandler::addBuffer(const AudioBuffer& buffer) {
         return;
     }
     
+    // 调用方仍持有该缓冲区：复制到池中的帧（复用帧已分配的存储）
+    AudioFrameRef pcm = AudioFramePool::getInstance().acquire();
+    pcm->samples.assign(buffer.data.begin(), buffer.data.end());
+    
     // 单线程模式：直接处理缓冲区，不使用队列
-    processBufferDirectly(buffer);
+    processBufferDirectly(buffer, std::move(pcm));
+}
+
+void RealtimeSegmentHandler::addBuffer(AudioBuffer&& buffer) {
+    if (!running) {
+        return;
+    }
+    
+    // 与池中的帧交换存储，不复制样本
+    AudioFrameRef pcm = AudioFramePool::getInstance().acquire();
+    pcm->samples.swap(buffer.data);
+    
+    processBufferDirectly(buffer, std::move(pcm));
 }
 
 // 新增方法：直接处理缓冲区
-void RealtimeSegmentHandler::processBufferDirectly(const AudioBuffer& buffer) {
+void RealtimeSegmentHandler::processBufferDirectly(const AudioBuffer& buffer, AudioFrameRef pcm) {
     // 添加互斥锁保护，确保线程安全，避免乱序和重复生成
     static std::mutex process_mutex;
     std::lock_guard<std::mutex> lock(process_mutex);
     
-    // 创建处理后的缓冲区副本
-    AudioBuffer processed_buffer = buffer;
+    // 预处理和VAD直接作用于帧中的样本，此时帧只有这一个引用
+    std::vector<float>& samples = pcm->samples;
+    bool is_silence = buffer.is_silence;
+    bool voice_end = buffer.voice_end;
+    const bool is_last = buffer.is_last;
     
     // 应用音频预处理（如果有预处理器）
     static int preprocessing_counter = 0;
-    if (audio_preprocessor && !buffer.data.empty()) {
-        processed_buffer.data = buffer.data; // 复制原始数据
-        audio_preprocessor->process(processed_buffer.data, buffer.sample_rate);
+    if (audio_preprocessor && !samples.empty()) {
+        audio_preprocessor->process(samples, buffer.sample_rate);
         
         // 减少预处理日志频率：每50次记录一次
         preprocessing_counter++;
         if (preprocessing_counter == 1 || preprocessing_counter % 50 == 0) {
             LOG_INFO("音频预处理 #" + std::to_string(preprocessing_counter) + 
-                    " (样本数: " + std::to_string(processed_buffer.data.size()) + ")");
+                    " (样本数: " + std::to_string(samples.size()) + ")");
         }
     }
     
     // 应用VAD检测（如果有VAD检测器且不是最后缓冲区）
     static bool last_vad_state = false;
     static int vad_counter = 0;
-    if (voice_detector && !buffer.is_last && !buffer.data.empty()) {
-        bool has_voice = voice_detector->detect(processed_buffer.data, buffer.sample_rate);
+    if (voice_detector && !is_last && !samples.empty()) {
+        bool has_voice = voice_detector->detect(samples, buffer.sample_rate);
         
         // 更新缓冲区的静音状态
-        processed_buffer.is_silence = !has_voice;
+        is_silence = !has_voice;
         
         // 检查语音结束检测
         if (voice_detector->hasVoiceEndedDetected()) {
-            processed_buffer.voice_end = true;
+            voice_end = true;
             LOG_INFO("🎯 VAD检测到语音结束，标记语音段结束");
         }
         
@@ -257,19 +263,24 @@ void RealtimeSegmentHandler::processBufferDirectly(const AudioBuffer& buffer) {
         vad_counter++;
         bool vad_state_changed = (has_voice != last_vad_state);
         
-        if (vad_state_changed || vad_counter % 100 == 0 || processed_buffer.voice_end) {
+        if (vad_state_changed || vad_counter % 100 == 0 || voice_end) {
             LOG_INFO("VAD #" + std::to_string(vad_counter) + ": " + 
                     std::string(has_voice ? "有语音" : "静音") + 
                     (vad_state_changed ? " (状态变化)" : "") +
-                    (processed_buffer.voice_end ? " | 语音结束" : ""));
+                    (voice_end ? " | 语音结束" : ""));
             last_vad_state = has_voice;
         }
     }
     
+    SegmentFrame frame;
+    frame.length = samples.size();
+    frame.is_last = is_last;
+    frame.pcm = std::move(pcm);
+    
     // 检查是否需要生成段
     bool should_create_segment = false;
     
-    if (processed_buffer.is_last) {
+    if (is_last) {
         // 最后一个缓冲区，强制生成段
         should_create_segment = true;
         LOG_INFO("收到最后缓冲区，生成最终段");
@@ -277,9 +288,9 @@ void RealtimeSegmentHandler::processBufferDirectly(const AudioBuffer& buffer) {
         // 处理最后缓冲区前的累积静音
         if (!silence_buffers.empty()) {
             // 保留所有累积的短静音
-            for (const auto& silence_buf : silence_buffers) {
-                current_buffers.push_back(silence_buf);
-                total_samples += silence_buf.data.size();
+            for (auto& silence_buf : silence_buffers) {
+                total_samples += silence_buf.length;
+                current_buffers.push_back(std::move(silence_buf));
             }
             LOG_INFO("最后段保留了所有累积静音: " + std::to_string(silence_buffers.size()) + " 个缓冲区");
             silence_buffers.clear();
@@ -287,20 +298,20 @@ void RealtimeSegmentHandler::processBufferDirectly(const AudioBuffer& buffer) {
         
         // 即使当前缓冲区是空的，也要添加到current_buffers以确保处理
         // 但只有在数据不为空时才添加样本数
-        if (!processed_buffer.data.empty()) {
-            current_buffers.push_back(processed_buffer);
-            total_samples += processed_buffer.data.size();
+        if (frame.length > 0) {
+            total_samples += frame.length;
+            current_buffers.push_back(std::move(frame));
         } else {
             LOG_INFO("最后缓冲区为空，但仍会强制处理之前积累的音频数据");
         }
-    } else if (processed_buffer.is_silence) {
+    } else if (is_silence) {
         // 静音缓冲区：应用短静音保留策略
-        silence_buffers.push_back(processed_buffer);
+        silence_buffers.push_back(std::move(frame));
         
         // 计算累积的静音时长
         size_t total_silence_samples = 0;
         for (const auto& silence_buf : silence_buffers) {
-            total_silence_samples += silence_buf.data.size();
+            total_silence_samples += silence_buf.length;
         }
         
         // 静音时长阈值：300ms以下的静音保留，超过300ms的静音触发分段
@@ -315,11 +326,12 @@ void RealtimeSegmentHandler::processBufferDirectly(const AudioBuffer& buffer) {
                 
                 for (const auto& silence_buf : silence_buffers) {
                     if (added_silence < keep_silence_samples) {
-                        AudioBuffer partial_silence = silence_buf;
-                        size_t samples_to_add = std::min(silence_buf.data.size(), 
+                        // 只引用帧的前一部分，不复制样本
+                        SegmentFrame partial_silence = silence_buf;
+                        size_t samples_to_add = std::min(silence_buf.length, 
                                                        keep_silence_samples - added_silence);
-                        partial_silence.data.resize(samples_to_add);
-                        current_buffers.push_back(partial_silence);
+                        partial_silence.length = samples_to_add;
+                        current_buffers.push_back(std::move(partial_silence));
                         total_samples += samples_to_add;
                         added_silence += samples_to_add;
                     } else {
@@ -340,10 +352,10 @@ void RealtimeSegmentHandler::processBufferDirectly(const AudioBuffer& buffer) {
         // 如果之前有累积的短静音，全部添加到当前分段（保持自然节奏）
         if (!silence_buffers.empty()) {
             size_t total_silence_samples = 0;
-            for (const auto& silence_buf : silence_buffers) {
-                current_buffers.push_back(silence_buf);
-                total_samples += silence_buf.data.size();
-                total_silence_samples += silence_buf.data.size();
+            for (auto& silence_buf : silence_buffers) {
+                total_samples += silence_buf.length;
+                total_silence_samples += silence_buf.length;
+                current_buffers.push_back(std::move(silence_buf));
             }
             
             LOG_INFO("保留了" + std::to_string(total_silence_samples * 1000.0 / SAMPLE_RATE) 
@@ -353,10 +365,10 @@ void RealtimeSegmentHandler::processBufferDirectly(const AudioBuffer& buffer) {
         }
         
         // 非最后缓冲区，正常添加到当前缓冲区
-        current_buffers.push_back(processed_buffer);
-        total_samples += processed_buffer.data.size();
+        total_samples += frame.length;
+        current_buffers.push_back(std::move(frame));
         
-        if (processed_buffer.voice_end) {
+        if (voice_end) {
             // 检测到语音结束，生成段
             should_create_segment = true;
             LOG_INFO("🎯 VAD智能分段：检测到语音结束，触发分段！总样本数: " + std::to_string(total_samples));
@@ -378,40 +390,44 @@ void RealtimeSegmentHandler::processBufferDirectly(const AudioBuffer& buffer) {
         }
     }
     
+    // 流式模式：语音段每增长一个步长就交给增量识别器重新解码，不必等到语音结束
+    if (!should_create_segment && !is_silence &&
+        total_samples >= last_partial_samples + partial_step_samples) {
+        emitPartialAudio();
+    }
+    
     if (should_create_segment && !current_buffers.empty()) {
         // 对于最后一个段，即使没有新的音频数据，也要处理之前积累的数据
         LOG_INFO("准备生成音频段，当前缓冲区数量: " + std::to_string(current_buffers.size()) + 
                 ", 总样本数: " + std::to_string(total_samples));
         
         // 添加音频段末尾缓冲：为了避免截断最后几个字，添加短暂的静音
-        if (processed_buffer.voice_end || processed_buffer.is_last) {
+        if (voice_end || is_last) {
             // 在语音段结束时添加200ms的缓冲时间
             size_t buffer_samples = 16000 * 0.2; // 200ms @ 16kHz
-            AudioBuffer padding_buffer;
-            padding_buffer.data.resize(buffer_samples, 0.0f); // 静音填充
-            padding_buffer.sample_rate = 16000;
-            padding_buffer.channels = 1;
-            padding_buffer.timestamp = std::chrono::system_clock::now();
-            padding_buffer.is_silence = true;
-            padding_buffer.voice_end = false;
-            padding_buffer.is_last = processed_buffer.is_last;
+            if (!padding_frame) {
+                // 静音填充帧只创建一次，之后各段共享引用
+                padding_frame = AudioFramePool::getInstance().acquire();
+                padding_frame->samples.assign(buffer_samples, 0.0f);
+            }
+            SegmentFrame padding_buffer;
+            padding_buffer.pcm = padding_frame;
+            padding_buffer.length = buffer_samples;
+            padding_buffer.is_last = is_last;
             
-            current_buffers.push_back(padding_buffer);
+            current_buffers.push_back(std::move(padding_buffer));
             total_samples += buffer_samples;
             
             LOG_INFO("添加了200ms缓冲以避免音频截断，新增样本数: " + std::to_string(buffer_samples));
         }
         
         // 生成音频段
-        std::string segment_path = createSegment(current_buffers);
+        AudioSegment segment = createSegment(current_buffers);
         
-        if (!segment_path.empty() && segment_ready_callback) {
-            AudioSegment segment;
-            segment.filepath = segment_path;
-            segment.timestamp = std::chrono::system_clock::now();
-            segment.is_last = processed_buffer.is_last;
+        if (segment.hasAudio() && segment_ready_callback) {
+            segment.is_last = is_last;
             
-            LOG_INFO("音频段已创建: " + segment_path + 
+            LOG_INFO("音频段已创建: #" + std::to_string(segment.sequence_number) + " " + segment.filepath + 
                     ", 是否为最后段: " + (segment.is_last ? "是" : "否"));
             
             // 直接调用回调
@@ -421,6 +437,7 @@ void RealtimeSegmentHandler::processBufferDirectly(const AudioBuffer& buffer) {
         }
         
         // 清理当前缓冲区
+        endPartialSegment();
         current_buffers.clear();
         silence_buffers.clear();  // 也清理静音缓冲区
         total_samples = 0;
@@ -428,7 +445,7 @@ void RealtimeSegmentHandler::processBufferDirectly(const AudioBuffer& buffer) {
         
         // 更新最后分段时间
         last_segment_time = std::chrono::steady_clock::now();
-    } else if (processed_buffer.is_last && current_buffers.empty()) {
+    } else if (is_last && current_buffers.empty()) {
         // 特殊情况：最后缓冲区但没有积累的数据
         LOG_INFO("收到最后缓冲区但没有积累的音频数据，仍会触发最后段处理回调");
         
@@ -462,21 +479,18 @@ void RealtimeSegmentHandler::flushCurrentSegment() {
                 " 个缓冲区，总样本数: " + std::to_string(total_samples) + "，强制生成音频段");
         
         // 创建音频段
-        std::string segment_path;
+        AudioSegment segment;
         try {
-            segment_path = createSegment(current_buffers);
+            segment = createSegment(current_buffers);
         } catch (const std::exception& e) {
             LOG_ERROR("强制创建音频段失败: " + std::string(e.what()));
             return;
         }
         
-        if (!segment_path.empty() && segment_ready_callback) {
-            AudioSegment segment;
-            segment.filepath = segment_path;
-            segment.timestamp = std::chrono::system_clock::now();
+        if (segment.hasAudio() && segment_ready_callback) {
             segment.is_last = true;  // 标记为最后一段
             
-            LOG_INFO("强制创建的音频段: " + segment_path + "（手动触发的最后段）");
+            LOG_INFO("强制创建的音频段: " + segment.filepath + "（手动触发的最后段）");
             
             // 调用回调处理段
             try {
@@ -489,6 +503,7 @@ void RealtimeSegmentHandler::flushCurrentSegment() {
         }
         
         // 清理当前缓冲区
+        endPartialSegment();
         current_buffers.clear();
         silence_buffers.clear();  // 也清理静音缓冲区
         total_samples = 0;
@@ -893,20 +908,11 @@ void RealtimeSegmentHandler::processingThread() {
 
 // 添加辅助方法来处理缓冲区
 void RealtimeSegmentHandler::processBuffer(std::vector<AudioBuffer>* buffer, size_t segment_num) {
-    // 创建临时WAV文件并返回段对象
-    std::string output_path = createSegment(*buffer);
-    
-    // 创建段对象
-    AudioSegment segment;
-    segment.filepath = output_path;
+    // 创建段对象（内存PCM块或临时WAV文件）
+    AudioSegment segment = createSegment(*buffer);
     segment.sequence_number = segment_num;
-    segment.timestamp = std::chrono::system_clock::now();
     segment.is_last = !buffer->empty() && buffer->back().is_last;
     
-    // 获取段的时长
-    size_t total_samples = getAudioBuffersTotalSamples(*buffer);
-    segment.duration_ms = (total_samples * 1000.0) / SAMPLE_RATE;
-    
     // 调用回调
     if (segment_ready_callback) {
         LOG_INFO("段处理完成: #" + std::to_string(segment.sequence_number) + 
@@ -927,12 +933,46 @@ void RealtimeSegmentHandler::processBuffer(std::vector<AudioBuffer>* buffer, siz
     last_segment_time = current_time;
 }
 
-std::string RealtimeSegmentHandler::createSegment(const std::vector<AudioBuffer>& buffers) {
+AudioSegment RealtimeSegmentHandler::createSegment(const std::vector<AudioBuffer>& buffers) {
+    if (buffers.empty()) {
+        LOG_WARNING("Attempted to create segment from empty buffer");
+        return AudioSegment();
+    }
+    return createSegment(WavFileUtils::concatBuffers(buffers), buffers.back().is_last);
+}
+
+AudioSegment RealtimeSegmentHandler::createSegment(const std::vector<SegmentFrame>& frames) {
+    if (frames.empty()) {
+        LOG_WARNING("Attempted to create segment from empty buffer");
+        return AudioSegment();
+    }
+    return createSegment(concatFrames(frames), frames.back().is_last);
+}
+
+std::vector<float> RealtimeSegmentHandler::concatFrames(const std::vector<SegmentFrame>& frames) {
+    size_t total = 0;
+    for (const auto& frame : frames) {
+        total += frame.length;
+    }
+    
+    std::vector<float> combined;
+    combined.reserve(total);
+    for (const auto& frame : frames) {
+        if (frame.pcm && frame.length > 0) {
+            const float* begin = frame.pcm->samples.data();
+            combined.insert(combined.end(), begin, begin + frame.length);
+        }
+    }
+    return combined;
+}
+
+AudioSegment RealtimeSegmentHandler::createSegment(std::vector<float> samples, bool is_last) {
     auto segment_start_time = std::chrono::steady_clock::now();
     
-    if (buffers.empty()) {
+    AudioSegment segment;
+    if (samples.empty()) {
         LOG_WARNING("Attempted to create segment from empty buffer");
-        return "";
+        return segment;
     }
     
     // 性能追踪：只在OpenAI模式下输出
@@ -941,7 +981,7 @@ std::string RealtimeSegmentHandler::createSegment(const std::vector<AudioBuffer>
     auto total_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(current_time - processing_start_time).count();
     
     // Calculate total samples
-    size_t total_samples = getAudioBuffersTotalSamples(buffers);
+    size_t total_samples = samples.size();
     
     // Check if sample count is sufficient
     double segment_duration_ms = total_samples * 1000.0 / SAMPLE_RATE;
@@ -980,22 +1020,47 @@ std::string RealtimeSegmentHandler::createSegment(const std::vector<AudioBuffer>
     last_segment_time = current_time;
     
     // If segment is too short, issue warning (but still create segment)
-    if (segment_duration_ms < 1000 && !buffers.back().is_last) {
+    if (segment_duration_ms < 1000 && !is_last) {
         LOG_WARNING("Created audio segment is unusually short (" + std::to_string(segment_duration_ms) + 
                    "ms), may result in decreased recognition quality");
     }
     
+    segment.sequence_number = static_cast<int>(current_segment_number);
+    segment.timestamp = std::chrono::system_clock::now();
+    segment.duration_ms = segment_duration_ms;
+    
+    // 内存模式：直接交付引用计数的PCM块，WAV仅在上传时按需生成
+    if (in_memory_segments) {
+        try {
+            segment.pcm = PcmBlock::create(std::move(samples), SAMPLE_RATE);
+        } catch (const std::bad_alloc&) {
+            LOG_ERROR("PCM block allocation failed: " + std::to_string(total_samples) + " samples");
+            return segment;
+        }
+        
+        auto block_create_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - segment_start_time).count();
+        LOG_INFO("Created in-memory segment #" + std::to_string(current_segment_number) +
+                 ", duration: " + std::to_string(segment_duration_ms) +
+                 "ms, creation took: " + std::to_string(block_create_ms) + "ms");
+        return segment;
+    }
+    
     // Create filename with sequence number and duration info
     std::string segment_prefix = "segment_" + std::to_string(current_segment_number) + 
                                 "_" + std::to_string(static_cast<int>(segment_duration_ms)) + "ms";
     
     // Create WAV file with sequence number prefix 
-    std::string wav_path = WavFileUtils::createWavFromBuffers(buffers, temp_directory, segment_prefix);
+    std::string wav_path = WavFileUtils::generateUniqueFilename(temp_directory, segment_prefix);
+    if (!WavFileUtils::saveWavFile(wav_path, samples)) {
+        wav_path.clear();
+    }
     
     if (wav_path.empty()) {
         LOG_ERROR("Failed to create WAV file");
-        return "";
+        return segment;
     }
+    segment.filepath = wav_path;
     
     // 计算文件创建时间
     auto file_create_time = std::chrono::steady_clock::now();
@@ -1013,7 +1078,7 @@ std::string RealtimeSegmentHandler::createSegment(const std::vector<AudioBuffer>
                   << CONSOLE_COLOR_RESET << std::endl;
     }
     
-    return wav_path;
+    return segment;
 }
 
 // Save current overlap to overlap_buffer - 简化为空操作，禁用重叠
@@ -1080,3 +1145,39 @@ void RealtimeSegmentHandler::setVoiceActivityDetector(VoiceActivityDetector* det
     LOG_INFO("VAD检测器已设置: " + std::string(detector ? "启用" : "禁用"));
 }
 
+// 设置内存分段模式
+void RealtimeSegmentHandler::setInMemorySegments(bool enable) {
+    in_memory_segments = enable;
+    LOG_INFO("内存分段模式: " + std::string(enable ? "启用（不写临时WAV）" : "禁用"));
+}
+
+bool RealtimeSegmentHandler::isInMemorySegmentsEnabled() const {
+    return in_memory_segments;
+}
+
+void RealtimeSegmentHandler::setStreamingPartials(bool enable, size_t step_ms) {
+    partial_step_samples = std::max<size_t>(step_ms, 100) * SAMPLE_RATE / 1000;
+    streaming_partials = enable;
+    LOG_INFO("流式部分结果: " + std::string(enable ? "启用" : "禁用") + 
+            "，步长: " + std::to_string(partial_step_samples * 1000 / SAMPLE_RATE) + "ms");
+}
+
+void RealtimeSegmentHandler::setPartialAudioCallback(PartialAudioCallback callback) {
+    partial_audio_callback = callback;
+}
+
+void RealtimeSegmentHandler::emitPartialAudio() {
+    if (!streaming_partials || !partial_audio_callback || current_buffers.empty()) {
+        return;
+    }
+    last_partial_samples = total_samples;
+    partial_audio_callback(segment_count, concatFrames(current_buffers), false);
+}
+
+void RealtimeSegmentHandler::endPartialSegment() {
+    last_partial_samples = 0;
+    if (streaming_partials && partial_audio_callback) {
+        partial_audio_callback(segment_count, std::vector<float>(), true);
+    }
+}
+
@@ -104,6 +104,20 @@ FastRecognizer::FastRecognizer(const std::string& model_path, ResultQueue* input
 }
 
 FastRecognizer::~FastRecognizer() {
+    {
+        std::lock_guard<std::mutex> lock(partial_mutex);
+        if (partial_state) {
+            whisper_free_state(partial_state);
+            partial_state = nullptr;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        for (whisper_state* state : pool_states) {
+            whisper_free_state(state);
+        }
+        pool_states.clear();
+    }
     if (ctx) {
         whisper_free(ctx);
     }
@@ -117,6 +131,69 @@ void FastRecognizer::stop() {
     running = false;
 }
 
+bool FastRecognizer::decodePartial(const std::vector<float>& audio, std::string& text) {
+    std::lock_guard<std::mutex> lock(partial_mutex);
+    
+    if (!ctx || audio.empty()) {
+        return false;
+    }
+    
+    // 与最终识别共享模型权重，只额外分配一份解码状态
+    if (!partial_state) {
+        partial_state = whisper_init_state(ctx);
+        if (!partial_state) {
+            std::cerr << "Failed to create whisper state for partial decoding" << std::endl;
+            return false;
+        }
+    }
+    
+    whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    if (language == "en" || language == "English") {
+        wparams.language = "en";
+    } else if (language == "zh" || language == "Chinese") {
+        wparams.language = "zh";
+    } else if (language == "ja") {
+        wparams.language = "ja";
+    } else {
+        wparams.language = nullptr;  // 自动检测语言
+    }
+    
+    // 与whisper.cpp stream示例一致：单段、无上下文、不输出时间戳
+    wparams.n_threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+    wparams.translate = false;
+    wparams.print_progress = false;
+    wparams.print_special = false;
+    wparams.print_realtime = false;
+    wparams.print_timestamps = false;
+    wparams.no_context = true;
+    wparams.no_timestamps = true;
+    wparams.single_segment = true;
+    wparams.max_tokens = 0;
+    wparams.suppress_blank = true;
+    
+    // whisper对不足1秒的音频效果较差，补齐静音
+    const size_t min_samples = 16000;
+    const std::vector<float>* input = &audio;
+    std::vector<float> padded;
+    if (audio.size() < min_samples) {
+        padded = audio;
+        padded.resize(min_samples, 0.0f);
+        input = &padded;
+    }
+    
+    if (whisper_full_with_state(ctx, partial_state, wparams, input->data(), static_cast<int>(input->size())) != 0) {
+        std::cerr << "Partial decoding failed" << std::endl;
+        return false;
+    }
+    
+    text.clear();
+    const int n_segments = whisper_full_n_segments_from_state(partial_state);
+    for (int i = 0; i < n_segments; ++i) {
+        text += whisper_full_get_segment_text_from_state(partial_state, i);
+    }
+    return true;
+}
+
 void FastRecognizer::process_audio_batch(const std::vector<AudioBuffer>& batch) {
     if (batch.empty()) {
         std::cerr << "Empty batch, skipping" << std::endl;
@@ -134,10 +211,46 @@ void FastRecognizer::process_audio_batch(const std::vector<AudioBuffer>& batch)
         combined_data.insert(combined_data.end(), buffer.data.begin(), buffer.data.end());
     }
     
+    process_audio(combined_data.data(), combined_data.size(), batch.front().timestamp);
+}
+
+void FastRecognizer::process_audio(const float* samples, size_t count,
+                                   std::chrono::system_clock::time_point timestamp, qint64 duration_ms) {
+    if (count == 0) {
+        std::cerr << "Empty audio, skipping" << std::endl;
+        return;
+    }
+    
+    if (!ctx) {
+        std::cerr << "Model not loaded, skipping" << std::endl;
+        return;
+    }
+    
+    RecognitionResult result;
+    result.timestamp = timestamp;
+    result.duration = duration_ms;
+    if (!recognize(nullptr, samples, count, static_cast<int>(std::thread::hardware_concurrency()), result.text)) {
+        return;
+    }
+    
+    // 修改：检查是否有output_queue，如果有则推送到output_queue，否则推送到input_queue
+    if (output_queue) {
+        output_queue->push(result);
+        std::cout << "结果已推送到输出队列" << std::endl;
+    } else if (input_queue) {
+        input_queue->push(result);
+        std::cout << "结果已推送到输入队列" << std::endl;
+    }
+}
+
+bool FastRecognizer::recognize(whisper_state* state, const float* samples, size_t count, int n_threads,
+                               std::string& output) {
     // 检查音频长度是否足够
-    float audio_length_ms = combined_data.size() * 1000.0f / 16000;
+    float audio_length_ms = count * 1000.0f / 16000;
     const float min_audio_length_ms = 1000.0f; // 最小音频长度为1秒
     
+    // 只有过短的音频需要拷贝出来补静音，其余直接使用调用方的样本
+    std::vector<float> padded_data;
     if (audio_length_ms < min_audio_length_ms) {
         std::cout << "音频过短，添加静音填充：" << audio_length_ms << "ms < " << min_audio_length_ms << "ms" << std::endl;
         
@@ -145,11 +258,14 @@ void FastRecognizer::process_audio_batch(const std::vector<AudioBuffer>& batch)
         size_t padding_samples = (min_audio_length_ms - audio_length_ms) * 16000 / 1000;
         
         // 添加静音填充到音频末尾
-        combined_data.insert(combined_data.end(), padding_samples, 0.0f);
+        padded_data.assign(samples, samples + count);
+        padded_data.insert(padded_data.end(), padding_samples, 0.0f);
+        samples = padded_data.data();
+        count = padded_data.size();
         
         // 更新音频长度
-        audio_length_ms = combined_data.size() * 1000.0f / 16000;
-        std::cout << "填充后音频长度：" << audio_length_ms << "ms，样本数：" << combined_data.size() << std::endl;
+        audio_length_ms = count * 1000.0f / 16000;
+        std::cout << "填充后音频长度：" << audio_length_ms << "ms，样本数：" << count << std::endl;
     }
     
     // 设置whisper_full参数
@@ -170,7 +286,7 @@ void FastRecognizer::process_audio_batch(const std::vector<AudioBuffer>& batch)
     }
     
     // 其他参数设置
-    wparams.n_threads = std::thread::hardware_concurrency();
+    wparams.n_threads = std::max(1, n_threads);
     wparams.translate = false;
     wparams.print_progress = false;
     wparams.print_special = false;
@@ -186,27 +302,29 @@ void FastRecognizer::process_audio_batch(const std::vector<AudioBuffer>& batch)
     
     auto recstart = std::chrono::high_resolution_clock::now();
     // 执行识别时使用显式类型转换
-    if (whisper_full(ctx, wparams, combined_data.data(), static_cast<int>(combined_data.size())) != 0) {
+    // 独立的状态可与其他状态并发解码，ctx自带的状态只能串行使用
+    const int status = state
+        ? whisper_full_with_state(ctx, state, wparams, samples, static_cast<int>(count))
+        : whisper_full(ctx, wparams, samples, static_cast<int>(count));
+    if (status != 0) {
         std::cerr << "Fast recognition failed" << std::endl;
-        return;
+        return false;
     }
      
     auto recend = std::chrono::high_resolution_clock::now();
     auto rectime = std::chrono::duration_cast<std::chrono::milliseconds>(recend - recstart).count();
     
-    const int n_segments = whisper_full_n_segments(ctx);
+    const int n_segments = state ? whisper_full_n_segments_from_state(state) : whisper_full_n_segments(ctx);
     
     if (n_segments == 0) {
         std::cout << "No speech detected" << std::endl;
-        return;
+        return false;
     }
     
-    RecognitionResult result;
-    result.timestamp = batch.front().timestamp;
-    
     std::string text = "";
     for (int i = 0; i < n_segments; ++i) {
-        const char* segment_text = whisper_full_get_segment_text(ctx, i);
+        const char* segment_text = state ? whisper_full_get_segment_text_from_state(state, i)
+                                         : whisper_full_get_segment_text(ctx, i);
         text += segment_text;
     }
     
@@ -227,7 +345,7 @@ void FastRecognizer::process_audio_batch(const std::vector<AudioBuffer>& batch)
         }
     }
     
-    result.text = filtered_text;
+    output = filtered_text;
     
     // 添加编码转换
     // 检测文本是否有编码问题，例如："浠栧彲鏄湪濂芥鍟"这种情况
@@ -311,35 +429,93 @@ void FastRecognizer::process_audio_batch(const std::vector<AudioBuffer>& batch)
             
             // 使用转换后的文本
             if (!utf8_text.empty()) {
-                result.text = utf8_text;
+                output = utf8_text;
                 std::cout << "快速识别编码转换成功: " << utf8_text << std::endl;
             } else {
                 // 如果转换后为空，使用原始文本
-                result.text = filtered_text;
+                output = filtered_text;
             }
         } catch (const std::exception& e) {
             std::cerr << "快速识别编码转换失败: " << e.what() << std::endl;
             // 保留原始文本
-            result.text = filtered_text;
+            output = filtered_text;
         }
     } else {
         // 不需要转换
-        result.text = filtered_text;
+        output = filtered_text;
     }
     
-    // 修改：检查是否有output_queue，如果有则推送到output_queue，否则推送到input_queue
-    if (output_queue) {
-        output_queue->push(result);
-        std::cout << "结果已推送到输出队列" << std::endl;
-    } else if (input_queue) {
-        input_queue->push(result);
-        std::cout << "结果已推送到输入队列" << std::endl;
+    std::cout << "Fast recognition completed in " << rectime << "ms for " 
+              << audio_length_ms << "ms audio. Text: " << output << std::endl;
+    return true;
+}
+
+void FastRecognizer::process_blocks_parallel(const std::vector<PcmBlockPtr>& blocks, int states,
+                                             const std::function<void(size_t, const std::string&)>& on_result,
+                                             const std::atomic<bool>* cancel) {
+    if (!ctx || blocks.empty()) {
+        return;
     }
     
-    std::cout << "Fast recognition completed in " << rectime << "ms for " 
-              << audio_length_ms << "ms audio. Text: " << result.text << std::endl;
+    const int hardware_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    states = std::max(1, std::min({states, hardware_threads, static_cast<int>(blocks.size())}));
+    
+    // 每个状态各自分配KV缓存和计算缓冲区，模型权重只有ctx中的一份
+    std::vector<whisper_state*> worker_states;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        while (static_cast<int>(pool_states.size()) < states) {
+            whisper_state* state = whisper_init_state(ctx);
+            if (!state) {
+                std::cerr << "Failed to create whisper state #" << pool_states.size()
+                          << " for parallel recognition" << std::endl;
+                break;
+            }
+            pool_states.push_back(state);
+        }
+        if (pool_states.empty()) {
+            return;
+        }
+        worker_states.assign(pool_states.begin(),
+                             pool_states.begin() + std::min(states, static_cast<int>(pool_states.size())));
+    }
+    
+    const int threads_per_state = std::max(1, hardware_threads / static_cast<int>(worker_states.size()));
+    std::cout << "并行识别 " << blocks.size() << " 段: " << worker_states.size() << " 个状态，每个 "
+              << threads_per_state << " 线程" << std::endl;
+    
+    // 各工作线程从共享计数器领取下一段，长短不一的段自然均衡到各线程
+    std::atomic<size_t> next_block{0};
+    std::mutex callback_mutex;
+    auto worker = [&](whisper_state* state) {
+        while (!(cancel && cancel->load())) {
+            const size_t index = next_block.fetch_add(1);
+            if (index >= blocks.size()) {
+                break;
+            }
+            
+            std::string text;
+            const PcmBlockPtr& block = blocks[index];
+            if (block && !block->empty() && !recognize(state, block->data(), block->size(), threads_per_state, text)) {
+                text.clear();
+            }
+            
+            std::lock_guard<std::mutex> lock(callback_mutex);
+            on_result(index, text);
+        }
+    };
+    
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < worker_states.size(); ++i) {
+        workers.emplace_back(worker, worker_states[i]);
+    }
+    worker(worker_states[0]);
+    for (auto& thread : workers) {
+        thread.join();
+    }
 }
 
+
 // PreciseRecognizer实现
 PreciseRecognizer::PreciseRecognizer(const std::string& model_path, ResultQueue* input_queue,
                                    const std::string& language, bool use_gpu, float vad_threshold,
@@ -0,0 +1,270 @@
+#include "server_health_monitor.h"
+#include "health_status.h"
+#include "log_utils.h"
+#include <QTimer>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QUrl>
+#include <algorithm>
+
+namespace {
+
+constexpr double LATENCY_EWMA_ALPHA = 0.2;  // 新样本在延迟滑动平均中的权重
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+ServerHealthMonitor::ServerHealthMonitor(const HealthCheckOptions& options)
+    : options(options)
+    , current_open_ms(std::max(1, options.open_ms)) {
+    probe_timer = new QTimer(&context);
+    probe_timer->setSingleShot(true);
+    QObject::connect(probe_timer, &QTimer::timeout, &context, [this]() { probe(); });
+
+    network_manager = new QNetworkAccessManager(&context);
+}
+
+ServerHealthMonitor::~ServerHealthMonitor() {
+    stop();
+}
+
+void ServerHealthMonitor::setServerUrl(const std::string& url) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (url == server_url) {
+            return;
+        }
+        server_url = url;
+        state = State::Closed;
+        consecutive_failures = 0;
+        latency_ms = -1.0;
+        server_load = -1;
+        server_capacity = 0;
+        upload_formats.clear();
+        current_open_ms = std::max(1, options.open_ms);
+        last_success = std::chrono::steady_clock::time_point();
+    }
+
+    LOG_INFO("[HealthMonitor] 监测服务器: " + url);
+    if (running) {
+        cancelProbe();
+        scheduleProbe(0);
+    }
+}
+
+void ServerHealthMonitor::start() {
+    if (running.exchange(true)) {
+        return;
+    }
+    LOG_INFO("[HealthMonitor] 启动健康监测，探测间隔 " + std::to_string(options.interval_ms) +
+             "ms，连续失败 " + std::to_string(options.failure_threshold) + " 次后熔断");
+    scheduleProbe(0);
+}
+
+void ServerHealthMonitor::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    probe_timer->stop();
+    cancelProbe();
+}
+
+void ServerHealthMonitor::cancelProbe() {
+    if (probe_reply) {
+        // 超时同样以中止结束，用标志区分主动取消
+        probe_cancelled = true;
+        probe_reply->abort();
+    }
+}
+
+bool ServerHealthMonitor::allowRequest() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return state == State::Closed;
+}
+
+void ServerHealthMonitor::recordSuccess(double sample_ms) {
+    bool recovered = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (sample_ms >= 0.0) {
+            latency_ms = latency_ms < 0.0 ? sample_ms : latency_ms + LATENCY_EWMA_ALPHA * (sample_ms - latency_ms);
+        }
+        consecutive_failures = 0;
+        last_success = std::chrono::steady_clock::now();
+        if (state != State::Closed) {
+            state = State::Closed;
+            current_open_ms = std::max(1, options.open_ms);
+            recovered = true;
+        }
+    }
+
+    if (recovered) {
+        LOG_INFO("[HealthMonitor] 服务器已恢复，平均延迟 " + std::to_string(static_cast<int>(getLatencyMs())) + "ms");
+    }
+}
+
+void ServerHealthMonitor::recordFailure(const std::string& reason) {
+    int failures = 0;
+    int open_ms = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        failures = ++consecutive_failures;
+        if (state == State::HalfOpen) {
+            // 恢复探测失败，等待时间加倍
+            current_open_ms = std::min(current_open_ms * 2, std::max(options.max_open_ms, options.open_ms));
+            state = State::Open;
+            open_ms = current_open_ms;
+        } else if (state == State::Closed && consecutive_failures >= std::max(1, options.failure_threshold)) {
+            current_open_ms = std::max(1, options.open_ms);
+            state = State::Open;
+            open_ms = current_open_ms;
+        }
+    }
+
+    LOG_WARNING("[HealthMonitor] " + reason + "（连续失败 " + std::to_string(failures) + " 次）");
+    if (open_ms > 0) {
+        LOG_ERROR("[HealthMonitor] 服务器不可用，熔断 " + std::to_string(open_ms) + "ms 后重新探测");
+        scheduleProbe(open_ms);
+    }
+}
+
+ServerHealthMonitor::State ServerHealthMonitor::getState() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return state;
+}
+
+double ServerHealthMonitor::getLatencyMs() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return latency_ms;
+}
+
+int ServerHealthMonitor::getConsecutiveFailures() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return consecutive_failures;
+}
+
+bool ServerHealthMonitor::getServerLoad(int& load, int& capacity) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    // 跳过探测期间排队深度不再更新，超过两个探测间隔视为过期
+    if (server_load < 0 ||
+        std::chrono::steady_clock::now() - load_time > std::chrono::milliseconds(2 * options.interval_ms)) {
+        return false;
+    }
+    load = server_load;
+    capacity = server_capacity;
+    return true;
+}
+
+bool ServerHealthMonitor::supportsUploadFormat(const std::string& format) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::find(upload_formats.begin(), upload_formats.end(), format) != upload_formats.end();
+}
+
+void ServerHealthMonitor::parseHealthStatus(const QByteArray& body) {
+    ServerHealthStatus status;
+    if (!parseServerHealthStatus(body.toStdString(), status)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    upload_formats.swap(status.upload_formats);
+    if (!status.has_load) {
+        return;
+    }
+    server_capacity = status.capacity;
+    server_load = status.load;
+    load_time = std::chrono::steady_clock::now();
+}
+
+const char* ServerHealthMonitor::getStateName(State state) {
+    switch (state) {
+        case State::Closed: return "closed";
+        case State::Open: return "open";
+        case State::HalfOpen: return "half-open";
+    }
+    return "unknown";
+}
+
+void ServerHealthMonitor::scheduleProbe(int delay_ms) {
+    // 上传结果可能在其他线程反馈，定时器只能在所属线程上启动
+    QMetaObject::invokeMethod(&context, [this, delay_ms]() {
+        if (running) {
+            probe_timer->start(std::max(0, delay_ms));
+        }
+    });
+}
+
+void ServerHealthMonitor::probe() {
+    if (!running || probe_reply) {
+        return;
+    }
+
+    std::string url;
+    bool recently_succeeded = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        url = server_url;
+        recently_succeeded = !options.track_load && state == State::Closed &&
+            last_success != std::chrono::steady_clock::time_point() &&
+            std::chrono::steady_clock::now() - last_success < std::chrono::milliseconds(options.interval_ms);
+        if (!url.empty() && state == State::Open) {
+            state = State::HalfOpen;
+        }
+    }
+    if (url.empty()) {
+        return;
+    }
+
+    // 最近的上传已经证明服务器可用，不再额外探测
+    if (recently_succeeded) {
+        scheduleProbe(options.interval_ms);
+        return;
+    }
+
+    QString health_url = QString::fromStdString(url);
+    health_url += health_url.endsWith("/") ? "health" : "/health";
+
+    QNetworkRequest request{QUrl(health_url)};
+    request.setTransferTimeout(std::max(1, options.timeout_ms));
+
+    const auto sent_at = std::chrono::steady_clock::now();
+    QNetworkReply* reply = network_manager->get(request);
+    probe_reply = reply;
+    QObject::connect(reply, &QNetworkReply::finished, &context, [this, reply, sent_at]() {
+        onProbeFinished(reply, sent_at);
+    });
+}
+
+void ServerHealthMonitor::onProbeFinished(QNetworkReply* reply, std::chrono::steady_clock::time_point sent_at) {
+    reply->deleteLater();
+    if (probe_reply == reply) {
+        probe_reply = nullptr;
+    }
+    const bool cancelled = probe_cancelled;
+    probe_cancelled = false;
+
+    // 停止或切换服务器时中止的探测不计入结果
+    if (!running || cancelled) {
+        return;
+    }
+
+    if (reply->error() == QNetworkReply::NoError) {
+        parseHealthStatus(reply->readAll());
+        recordSuccess(elapsedMs(sent_at));
+    } else {
+        recordFailure("健康检查失败: " + reply->errorString().toStdString());
+    }
+
+    int delay_ms = options.interval_ms;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (state == State::Open) {
+            delay_ms = current_open_ms;
+        }
+    }
+    scheduleProbe(delay_ms);
+}
@@ -0,0 +1,441 @@
+#include "silero_vad_engine.h"
+#include <onnxruntime_cxx_api.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    std::mutex g_registry_mutex;
+    std::unordered_map<std::string, std::weak_ptr<SileroVADEngine>> g_engines;
+    SileroEngineOptions g_default_options;
+
+    void logEngineError(const std::string& message) {
+        std::cerr << "[SileroVAD ERROR] " << message << std::endl;
+    }
+
+    void logEngineInfo(const std::string& message) {
+        std::cout << "[SileroVAD INFO] " << message << std::endl;
+    }
+}
+
+// ONNX Runtime对象与按批大小预绑定的缓冲区，只由工作线程访问
+struct SileroVADEngine::Runtime {
+    // 循环状态张量，形状为[layers, N, hidden]
+    struct Recurrent {
+        std::string input_name;
+        std::string output_name;
+        int64_t layers = 2;
+        int64_t hidden = 64;
+        size_t offset = 0;              // 在每个流状态向量中的偏移
+        std::vector<float> input_buffer;
+        std::vector<float> output_buffer;
+    };
+
+    // 某个批大小对应的绑定，张量指向上面的缓冲区，创建后重复使用
+    struct Binding {
+        std::vector<Ort::Value> values;
+        std::unique_ptr<Ort::IoBinding> io_binding;
+    };
+
+    Ort::Env env{ORT_LOGGING_LEVEL_WARNING, "SileroVADEngine"};
+    Ort::SessionOptions session_options;
+    std::unique_ptr<Ort::Session> session;
+    Ort::MemoryInfo memory_info{Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)};
+    Ort::RunOptions run_options{nullptr};
+
+    std::string audio_input;
+    std::string sr_input;               // 旧模型没有采样率输入时为空
+    size_t sr_rank = 0;
+    std::string prob_output;
+    size_t prob_rank = 2;
+    std::vector<Recurrent> recurrent;
+    size_t state_size = 0;              // 每个流的状态浮点数
+
+    std::vector<float> audio_buffer;
+    std::vector<float> prob_buffer;
+    int64_t sample_rate = SAMPLE_RATE;
+
+    std::unordered_map<size_t, Binding> bindings;
+
+    Ort::IoBinding& bindingFor(size_t batch_size);
+};
+
+Ort::IoBinding& SileroVADEngine::Runtime::bindingFor(size_t batch_size) {
+    auto it = bindings.find(batch_size);
+    if (it != bindings.end()) {
+        return *it->second.io_binding;
+    }
+
+    const int64_t n = static_cast<int64_t>(batch_size);
+    Binding binding;
+    binding.io_binding = std::make_unique<Ort::IoBinding>(*session);
+
+    // 音频输入 [N, WINDOW_SIZE]
+    const int64_t audio_shape[2] = {n, static_cast<int64_t>(WINDOW_SIZE)};
+    binding.values.push_back(Ort::Value::CreateTensor<float>(
+        memory_info, audio_buffer.data(), batch_size * WINDOW_SIZE, audio_shape, 2));
+    binding.io_binding->BindInput(audio_input.c_str(), binding.values.back());
+
+    // 采样率输入：标量或[1]
+    if (!sr_input.empty()) {
+        const int64_t sr_shape[1] = {1};
+        binding.values.push_back(Ort::Value::CreateTensor<int64_t>(
+            memory_info, &sample_rate, 1, sr_shape, sr_rank));
+        binding.io_binding->BindInput(sr_input.c_str(), binding.values.back());
+    }
+
+    for (Recurrent& r : recurrent) {
+        const int64_t state_shape[3] = {r.layers, n, r.hidden};
+        const size_t count = static_cast<size_t>(r.layers * n * r.hidden);
+        binding.values.push_back(Ort::Value::CreateTensor<float>(
+            memory_info, r.input_buffer.data(), count, state_shape, 3));
+        binding.io_binding->BindInput(r.input_name.c_str(), binding.values.back());
+        binding.values.push_back(Ort::Value::CreateTensor<float>(
+            memory_info, r.output_buffer.data(), count, state_shape, 3));
+        binding.io_binding->BindOutput(r.output_name.c_str(), binding.values.back());
+    }
+
+    // 概率输出 [N, 1]（部分导出为[N]）
+    const int64_t prob_shape[2] = {n, 1};
+    binding.values.push_back(Ort::Value::CreateTensor<float>(
+        memory_info, prob_buffer.data(), batch_size, prob_shape, prob_rank));
+    binding.io_binding->BindOutput(prob_output.c_str(), binding.values.back());
+
+    Ort::IoBinding& result = *binding.io_binding;
+    bindings.emplace(batch_size, std::move(binding));
+    return result;
+}
+
+std::shared_ptr<SileroVADEngine> SileroVADEngine::acquire(const std::string& model_path) {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+
+    auto it = g_engines.find(model_path);
+    if (it != g_engines.end()) {
+        if (auto engine = it->second.lock()) {
+            return engine;
+        }
+    }
+
+    std::shared_ptr<SileroVADEngine> engine(new SileroVADEngine(model_path, g_default_options));
+    if (!engine->initialize()) {
+        return nullptr;
+    }
+    g_engines[model_path] = engine;
+    return engine;
+}
+
+void SileroVADEngine::setDefaultOptions(const SileroEngineOptions& options) {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    g_default_options = options;
+    g_default_options.intra_op_threads = std::max(0, options.intra_op_threads);
+    g_default_options.max_batch = std::max<size_t>(1, options.max_batch);
+    g_default_options.batch_wait_us = std::max(0, options.batch_wait_us);
+}
+
+SileroEngineOptions SileroVADEngine::getDefaultOptions() {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    return g_default_options;
+}
+
+SileroVADEngine::SileroVADEngine(const std::string& model_path, const SileroEngineOptions& options)
+    : model_path_(model_path)
+    , options_(options) {
+}
+
+SileroVADEngine::~SileroVADEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool SileroVADEngine::initialize() {
+    try {
+        logEngineInfo("正在加载Silero VAD共享引擎: " + model_path_);
+
+        runtime_ = std::make_unique<Runtime>();
+        Runtime& rt = *runtime_;
+
+        // 批推理本身已经合并了各流的工作，算子内线程数由配置决定，算子间不再并行
+        rt.session_options.SetIntraOpNumThreads(options_.intra_op_threads);
+        rt.session_options.SetInterOpNumThreads(1);
+        rt.session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+
+#ifdef _WIN32
+        std::wstring wide_model_path(model_path_.begin(), model_path_.end());
+        rt.session = std::make_unique<Ort::Session>(rt.env, wide_model_path.c_str(), rt.session_options);
+#else
+        rt.session = std::make_unique<Ort::Session>(rt.env, model_path_.c_str(), rt.session_options);
+#endif
+
+        Ort::AllocatorWithDefaultOptions allocator;
+
+        // 按名称识别输入：input为音频，sr为采样率，其余（h/c或state）为循环状态
+        const size_t input_count = rt.session->GetInputCount();
+        for (size_t i = 0; i < input_count; i++) {
+            std::string name = rt.session->GetInputNameAllocated(i, allocator).get();
+            std::vector<int64_t> shape = rt.session->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape();
+
+            if (name == "sr") {
+                rt.sr_input = name;
+                rt.sr_rank = shape.size();
+            } else if (rt.audio_input.empty() && (name == "input" || i == 0)) {
+                rt.audio_input = name;
+            } else {
+                Runtime::Recurrent r;
+                r.input_name = name;
+                if (shape.size() == 3) {
+                    if (shape[0] > 0) r.layers = shape[0];
+                    if (shape[2] > 0) r.hidden = shape[2];
+                    else r.hidden = (name == "state") ? 128 : 64;
+                } else {
+                    logEngineError("不支持的状态输入形状: " + name);
+                    return false;
+                }
+                rt.recurrent.push_back(std::move(r));
+            }
+        }
+
+        // 输出：output为概率，循环状态输出按名称（hn/cn/stateN）与输入配对，否则按顺序配对
+        std::vector<std::string> state_outputs;
+        const size_t output_count = rt.session->GetOutputCount();
+        for (size_t i = 0; i < output_count; i++) {
+            std::string name = rt.session->GetOutputNameAllocated(i, allocator).get();
+            if (rt.prob_output.empty() && (name == "output" || i == 0)) {
+                rt.prob_output = name;
+                rt.prob_rank = std::clamp<size_t>(
+                    rt.session->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape().size(), 1, 2);
+            } else {
+                state_outputs.push_back(name);
+            }
+        }
+
+        if (state_outputs.size() != rt.recurrent.size()) {
+            logEngineError("模型状态输入输出数量不一致");
+            return false;
+        }
+
+        for (size_t i = 0; i < rt.recurrent.size(); i++) {
+            Runtime::Recurrent& r = rt.recurrent[i];
+            auto match = std::find_if(state_outputs.begin(), state_outputs.end(), [&r](const std::string& name) {
+                return name == r.input_name + "n" || name == r.input_name + "N";
+            });
+            r.output_name = (match != state_outputs.end()) ? *match : state_outputs[i];
+
+            r.offset = rt.state_size;
+            const size_t per_stream = static_cast<size_t>(r.layers * r.hidden);
+            rt.state_size += per_stream;
+            r.input_buffer.assign(per_stream * options_.max_batch, 0.0f);
+            r.output_buffer.assign(per_stream * options_.max_batch, 0.0f);
+        }
+
+        rt.audio_buffer.assign(WINDOW_SIZE * options_.max_batch, 0.0f);
+        rt.prob_buffer.assign(options_.max_batch, 0.0f);
+
+        logEngineInfo("Silero VAD共享引擎加载成功，状态张量数: " + std::to_string(rt.recurrent.size()) +
+                      "，最大批大小: " + std::to_string(options_.max_batch) +
+                      "，算子内线程数: " + std::to_string(options_.intra_op_threads));
+
+    } catch (const std::exception& e) {
+        logEngineError("共享引擎初始化失败: " + std::string(e.what()));
+        runtime_.reset();
+        return false;
+    }
+
+    worker_ = std::thread(&SileroVADEngine::workerLoop, this);
+    return true;
+}
+
+uint64_t SileroVADEngine::openStream() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t id = next_stream_id_++;
+    states_[id].values.assign(runtime_->state_size, 0.0f);
+    return id;
+}
+
+void SileroVADEngine::closeStream(uint64_t stream_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    states_.erase(stream_id);
+}
+
+void SileroVADEngine::resetStream(uint64_t stream_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = states_.find(stream_id);
+    if (it != states_.end()) {
+        std::fill(it->second.values.begin(), it->second.values.end(), 0.0f);
+        it->second.generation++;
+    }
+}
+
+float SileroVADEngine::infer(uint64_t stream_id, const float* window) {
+    Request request;
+    request.stream_id = stream_id;
+    request.window = window;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (states_.find(stream_id) == states_.end() || stopping_) {
+        return 0.0f;
+    }
+
+    pending_.push_back(&request);
+    work_cv_.notify_one();
+    result_cv_.wait(lock, [&request] { return request.done; });
+    return request.result;
+}
+
+void SileroVADEngine::workerLoop() {
+    std::vector<Request*> batch;
+    batch.reserve(options_.max_batch);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            break;
+        }
+
+        // 等待其他流凑批：所有打开的流都已提交或达到最大批大小时立即推理
+        if (!stopping_ && options_.batch_wait_us > 0) {
+            const size_t target = std::min(options_.max_batch, states_.size());
+            const auto deadline = std::chrono::steady_clock::now() +
+                                  std::chrono::microseconds(options_.batch_wait_us);
+            work_cv_.wait_until(lock, deadline, [this, target] {
+                return stopping_ || pending_.size() >= target;
+            });
+        }
+
+        // 取出批次，同一个流只取最早的一个窗口，保证状态按顺序更新
+        batch.clear();
+        for (auto it = pending_.begin(); it != pending_.end() && batch.size() < options_.max_batch;) {
+            const uint64_t id = (*it)->stream_id;
+            bool duplicate = std::any_of(batch.begin(), batch.end(),
+                                         [id](const Request* r) { return r->stream_id == id; });
+            if (duplicate) {
+                ++it;
+                continue;
+            }
+            batch.push_back(*it);
+            it = pending_.erase(it);
+        }
+
+        // 状态的读取和写回都在锁内完成，推理期间其他线程可以安全地重置或关闭流
+        collectBatch(batch);
+        lock.unlock();
+        const bool success = runBatch(batch.size());
+        lock.lock();
+        storeBatch(batch, success);
+
+        stats_.runs++;
+        stats_.windows += batch.size();
+        stats_.largest_batch = std::max(stats_.largest_batch, batch.size());
+        for (Request* request : batch) {
+            request->done = true;
+        }
+        result_cv_.notify_all();
+    }
+}
+
+void SileroVADEngine::collectBatch(const std::vector<Request*>& batch) {
+    Runtime& rt = *runtime_;
+    const size_t n = batch.size();
+
+    // 收集各流的窗口与状态（流在提交后被关闭时按零状态推理，结果不写回）
+    std::vector<const float*> states(n, nullptr);
+    for (size_t i = 0; i < n; i++) {
+        std::memcpy(rt.audio_buffer.data() + i * WINDOW_SIZE, batch[i]->window, WINDOW_SIZE * sizeof(float));
+        auto it = states_.find(batch[i]->stream_id);
+        if (it != states_.end()) {
+            states[i] = it->second.values.data();
+            batch[i]->generation = it->second.generation;
+        }
+    }
+    for (Runtime::Recurrent& r : rt.recurrent) {
+        const size_t hidden = static_cast<size_t>(r.hidden);
+        const size_t layers = static_cast<size_t>(r.layers);
+        for (size_t layer = 0; layer < layers; layer++) {
+            for (size_t i = 0; i < n; i++) {
+                float* dst = r.input_buffer.data() + (layer * n + i) * hidden;
+                if (states[i]) {
+                    std::memcpy(dst, states[i] + r.offset + layer * hidden, hidden * sizeof(float));
+                } else {
+                    std::fill(dst, dst + hidden, 0.0f);
+                }
+            }
+        }
+    }
+}
+
+bool SileroVADEngine::runBatch(size_t batch_size) {
+    Runtime& rt = *runtime_;
+    try {
+        rt.session->Run(rt.run_options, rt.bindingFor(batch_size));
+        return true;
+    } catch (const std::exception& e) {
+        logEngineError("批推理失败: " + std::string(e.what()));
+        return false;
+    }
+}
+
+void SileroVADEngine::storeBatch(const std::vector<Request*>& batch, bool success) {
+    Runtime& rt = *runtime_;
+    const size_t n = batch.size();
+
+    if (!success) {
+        for (Request* request : batch) {
+            request->result = 0.0f;
+        }
+        return;
+    }
+
+    // 写回概率与新状态
+    std::vector<float*> states(n, nullptr);
+    for (size_t i = 0; i < n; i++) {
+        batch[i]->result = std::clamp(rt.prob_buffer[i], 0.0f, 1.0f);
+        auto it = states_.find(batch[i]->stream_id);
+        if (it != states_.end() && it->second.generation == batch[i]->generation) {
+            states[i] = it->second.values.data();
+        }
+    }
+    for (Runtime::Recurrent& r : rt.recurrent) {
+        const size_t hidden = static_cast<size_t>(r.hidden);
+        const size_t layers = static_cast<size_t>(r.layers);
+        for (size_t layer = 0; layer < layers; layer++) {
+            for (size_t i = 0; i < n; i++) {
+                if (states[i]) {
+                    std::memcpy(states[i] + r.offset + layer * hidden,
+                                r.output_buffer.data() + (layer * n + i) * hidden, hidden * sizeof(float));
+                }
+            }
+        }
+    }
+}
+
+SileroEngineStats SileroVADEngine::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SileroEngineStats stats = stats_;
+    stats.streams = states_.size();
+    return stats;
+}
+
+std::string SileroVADEngine::getModelInfo() const {
+    if (!runtime_) {
+        return "模型未初始化";
+    }
+
+    SileroEngineStats stats = getStats();
+    std::string info;
+    info += "- 输入节点数: " + std::to_string(runtime_->session->GetInputCount()) + "\n";
+    info += "- 输出节点数: " + std::to_string(runtime_->session->GetOutputCount()) + "\n";
+    info += "- 状态张量数: " + std::to_string(runtime_->recurrent.size()) + "\n";
+    info += "- 共享流数: " + std::to_string(stats.streams) + "\n";
+    info += "- 最大批大小: " + std::to_string(options_.max_batch) + "\n";
+    if (stats.runs > 0) {
+        info += "- 平均批大小: " + std::to_string(static_cast<double>(stats.windows) / stats.runs) + "\n";
+    }
+    return info;
+}
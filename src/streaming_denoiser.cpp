@@ -0,0 +1,161 @@
+#include "streaming_denoiser.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#ifdef RNNOISE_AVAILABLE
+extern "C" {
+    #include "rnnoise.h"
+}
+#endif
+
+namespace {
+
+constexpr float PCM_SCALE = 32767.0f;  // RNNoise按int16幅度处理浮点样本
+constexpr int FRAMES_PER_SECOND = 100; // RNNoise帧长固定为10ms
+
+} // namespace
+
+StreamingDenoiser::StreamingDenoiser(int sample_rate)
+    : sample_rate(sample_rate) {
+}
+
+StreamingDenoiser::~StreamingDenoiser() {
+#ifdef RNNOISE_AVAILABLE
+    if (state) {
+        rnnoise_destroy(state);
+        state = nullptr;
+    }
+#endif
+}
+
+bool StreamingDenoiser::initialize() {
+#ifdef RNNOISE_AVAILABLE
+    if (state) {
+        return true;
+    }
+
+    state = rnnoise_create(nullptr);
+    if (!state) {
+        std::cerr << "[StreamingDenoiser] RNNoise初始化失败" << std::endl;
+        return false;
+    }
+
+    frame_size = static_cast<size_t>(rnnoise_get_frame_size());
+    const int library_rate = static_cast<int>(frame_size) * FRAMES_PER_SECOND;
+
+    // RNNoise的重叠相加使输出滞后一帧
+    if (library_rate == sample_rate) {
+        // 帧末样本到达时整帧输出，最多等待帧长-1个样本
+        buffer_delay = frame_size - 1;
+        latency = buffer_delay + frame_size;
+    } else {
+        upsampler = std::make_unique<AudioResampler>(sample_rate, library_rate);
+        downsampler = std::make_unique<AudioResampler>(library_rate, sample_rate);
+        // 一帧对应的输入样本数（向上取整），比直接处理多留一个样本以吸收重采样的取整误差
+        buffer_delay = (frame_size * sample_rate + library_rate - 1) / library_rate;
+        // 上采样器和RNNoise的延迟按库采样率计，下采样器的延迟已按输入采样率计
+        const double library_delay = static_cast<double>(upsampler->getLatency() + frame_size);
+        latency = buffer_delay
+                + static_cast<size_t>(std::lround(library_delay * sample_rate / library_rate))
+                + downsampler->getLatency();
+    }
+
+    frame.assign(frame_size, 0.0f);
+    reset();
+
+    std::cout << "[StreamingDenoiser] RNNoise初始化成功，帧长: " << frame_size
+              << (isNativeRate() ? "（按输入采样率直接处理）" : "（经流式重采样）")
+              << "，延迟: " << latency << " 样本 (" << getLatencyMs() << "ms)" << std::endl;
+    return true;
+#else
+    std::cout << "[StreamingDenoiser] RNNoise库未编译，噪声抑制功能不可用" << std::endl;
+    return false;
+#endif
+}
+
+void StreamingDenoiser::reset() {
+#ifdef RNNOISE_AVAILABLE
+    if (state) {
+        rnnoise_init(state, nullptr);
+    }
+#endif
+    if (upsampler) {
+        upsampler->reset();
+        downsampler->reset();
+    }
+    frame_fill = 0;
+
+    // 预填充缓冲延迟，保证每次调用都能输出与输入等量的样本
+    ready.assign(buffer_delay, 0.0f);
+    dry_delay.assign(latency, 0.0f);
+}
+
+void StreamingDenoiser::process(const float* input, size_t count, float* output, float* dry) {
+    if (count == 0) {
+        return;
+    }
+    if (!state) {
+        if (output != input) {
+            std::copy(input, input + count, output);
+        }
+        if (dry) {
+            std::copy(input, input + count, dry);
+        }
+        return;
+    }
+
+    // 先消耗全部输入，再写输出，允许原地处理
+    dry_delay.insert(dry_delay.end(), input, input + count);
+    if (upsampler) {
+        upsampled.clear();
+        upsampler->process(input, count, upsampled);
+        feedFrames(upsampled.data(), upsampled.size());
+    } else {
+        feedFrames(input, count);
+    }
+
+    if (dry) {
+        std::copy(dry_delay.begin(), dry_delay.begin() + count, dry);
+    }
+    dry_delay.erase(dry_delay.begin(), dry_delay.begin() + count);
+
+    // 预填充保证ready不少于count，这里只是防御
+    const size_t available = std::min(count, ready.size());
+    std::copy(ready.begin(), ready.begin() + available, output);
+    std::fill(output + available, output + count, 0.0f);
+    ready.erase(ready.begin(), ready.begin() + available);
+}
+
+void StreamingDenoiser::feedFrames(const float* samples, size_t count) {
+#ifdef RNNOISE_AVAILABLE
+    while (count > 0) {
+        const size_t n = std::min(count, frame_size - frame_fill);
+        for (size_t i = 0; i < n; ++i) {
+            frame[frame_fill + i] = samples[i] * PCM_SCALE;
+        }
+        frame_fill += n;
+        samples += n;
+        count -= n;
+
+        if (frame_fill < frame_size) {
+            break;
+        }
+
+        rnnoise_process_frame(state, frame.data(), frame.data());
+        for (float& sample : frame) {
+            const float value = sample / PCM_SCALE;
+            sample = std::isfinite(value) ? std::max(-1.0f, std::min(1.0f, value)) : 0.0f;
+        }
+        if (downsampler) {
+            downsampler->process(frame.data(), frame_size, ready);
+        } else {
+            ready.insert(ready.end(), frame.begin(), frame.end());
+        }
+        frame_fill = 0;
+    }
+#else
+    (void)samples;
+    (void)count;
+#endif
+}
@@ -0,0 +1,187 @@
+#include "streaming_recognizer.h"
+#include "log_utils.h"
+#include <algorithm>
+
+StreamingRecognizer::StreamingRecognizer(PartialDecodeFunction decode,
+                                         PartialResultCallback callback,
+                                         size_t window_ms,
+                                         int sample_rate)
+    : decode_function(std::move(decode))
+    , result_callback(std::move(callback))
+    , window_samples(window_ms * sample_rate / 1000) {
+    // whisper单次最多处理30秒音频
+    window_samples = std::min(window_samples, static_cast<size_t>(30 * sample_rate));
+}
+
+StreamingRecognizer::~StreamingRecognizer() {
+    stop();
+}
+
+void StreamingRecognizer::start() {
+    if (running) {
+        return;
+    }
+    running = true;
+    decode_thread = std::thread(&StreamingRecognizer::decodeLoop, this);
+    LOG_INFO("流式增量识别已启动，窗口: " + std::to_string(window_samples) + " 样本");
+}
+
+void StreamingRecognizer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+        has_pending = false;
+    }
+    pending_cv.notify_all();
+    if (decode_thread.joinable()) {
+        decode_thread.join();
+    }
+    LOG_INFO("流式增量识别已停止");
+}
+
+void StreamingRecognizer::submit(size_t segment_id, std::vector<float> audio) {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        if (!running || audio.empty()) {
+            return;
+        }
+        // 只保留最新的窗口，解码跟不上时直接覆盖过期的窗口
+        pending.segment_id = segment_id;
+        pending.audio = std::move(audio);
+        has_pending = true;
+    }
+    pending_cv.notify_one();
+}
+
+void StreamingRecognizer::endSegment(size_t segment_id) {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    ended_segment_id = segment_id;
+    any_segment_ended = true;
+    if (has_pending && pending.segment_id <= segment_id) {
+        has_pending = false;
+        pending.audio.clear();
+    }
+}
+
+size_t StreamingRecognizer::stablePrefixLength(const std::string& a, const std::string& b) {
+    const size_t limit = std::min(a.size(), b.size());
+    size_t n = 0;
+    while (n < limit && a[n] == b[n]) {
+        ++n;
+    }
+
+    // 不在UTF-8多字节字符中间截断
+    while (n > 0 && n < a.size() && (static_cast<unsigned char>(a[n]) & 0xC0) == 0x80) {
+        --n;
+    }
+
+    // 以空格分词的文本不截断单词：退回到最后一个空格
+    const bool at_word_end = (n == a.size() || a[n] == ' ') && (n == b.size() || b[n] == ' ');
+    if (!at_word_end) {
+        size_t space = a.rfind(' ', n > 0 ? n - 1 : 0);
+        if (space != std::string::npos && space < n) {
+            n = space;
+        }
+    }
+    return n;
+}
+
+void StreamingRecognizer::decodeLoop() {
+    size_t window_start = 0;      // 当前窗口在语音段中的起点（样本）
+    size_t last_decoded_end = 0;  // 上一次解码覆盖到的位置
+
+    while (true) {
+        PendingWindow window;
+        {
+            std::unique_lock<std::mutex> lock(pending_mutex);
+            pending_cv.wait(lock, [this] { return has_pending || !running; });
+            if (!running) {
+                break;
+            }
+            window = std::move(pending);
+            pending.audio.clear();
+            has_pending = false;
+
+            if (any_segment_ended && window.segment_id <= ended_segment_id) {
+                continue;
+            }
+        }
+
+        if (!has_segment || window.segment_id != current_segment_id) {
+            resetHypothesis(window.segment_id);
+            window_start = 0;
+            last_decoded_end = 0;
+        }
+
+        // 语音段超过窗口长度时，把上一次的完整假设作为已提交文本，从上一次解码的终点开始新窗口
+        bool window_shifted = false;
+        if (window.audio.size() > window_start + window_samples && last_decoded_end > window_start) {
+            window_start = last_decoded_end;
+            window_shifted = true;
+        }
+        if (window.audio.size() > window_start + window_samples) {
+            window_start = window.audio.size() - window_samples;
+        }
+
+        std::vector<float> audio(window.audio.begin() + window_start, window.audio.end());
+        std::string text;
+        if (!decode_function || !decode_function(audio, text)) {
+            continue;
+        }
+        last_decoded_end = window.audio.size();
+
+        {
+            // 解码期间该段可能已经结束，最终结果会替代部分结果
+            std::lock_guard<std::mutex> lock(pending_mutex);
+            if (any_segment_ended && window.segment_id <= ended_segment_id) {
+                continue;
+            }
+        }
+        updateHypothesis(window.segment_id, window_shifted, text);
+    }
+}
+
+void StreamingRecognizer::updateHypothesis(size_t segment_id, bool window_shifted, const std::string& text) {
+    if (!has_segment || segment_id != current_segment_id) {
+        resetHypothesis(segment_id);
+    }
+
+    if (window_shifted) {
+        frozen_text += previous_text;
+        committed_text.clear();
+        previous_text.clear();
+    }
+
+    // 连续两次解码一致的前缀视为稳定，已提交的文本只增不减
+    size_t stable = stablePrefixLength(previous_text, text);
+    if (stable > committed_text.size() && text.compare(0, committed_text.size(), committed_text) == 0) {
+        committed_text = text.substr(0, stable);
+    }
+    previous_text = text;
+
+    size_t tentative_start = stablePrefixLength(committed_text, text);
+    if (tentative_start < committed_text.size()) {
+        // 新结果修正了已提交部分，已提交的文本保持不变，只输出其长度之后的内容
+        tentative_start = std::min(committed_text.size(), text.size());
+        while (tentative_start < text.size() &&
+               (static_cast<unsigned char>(text[tentative_start]) & 0xC0) == 0x80) {
+            ++tentative_start;
+        }
+    }
+    std::string tentative = text.substr(tentative_start);
+
+    if (result_callback) {
+        result_callback(frozen_text + committed_text, tentative);
+    }
+}
+
+void StreamingRecognizer::resetHypothesis(size_t segment_id) {
+    current_segment_id = segment_id;
+    has_segment = true;
+    frozen_text.clear();
+    committed_text.clear();
+    previous_text.clear();
+}
@@ -1,4 +1,5 @@
 ﻿#include "voice_activity_detector.h"
+#include "audio_kernels.h"
 #include <algorithm>
 #include <numeric>
 #include <cmath>
@@ -143,6 +144,11 @@ VoiceActivityDetector::VoiceActivityDetector(float threshold, QObject* parent,
             std::cerr << "[VAD] VAD实例存在，将尝试继续使用" << std::endl;
         }
     }
+    
+    // 构造时指定了使用Silero的类型，直接加载模型
+    if (vad_type_ != VADType::WebRTC && !silero_model_path_.empty()) {
+        initSileroDetector();
+    }
 }
 
 // 析构函数
@@ -204,54 +210,25 @@ bool VoiceActivityDetector::detect(const std::vector<float>& audio_buffer, int s
         
         // 移除采样率检查，直接使用16kHz
         
-        // 使用实例成员变量代替静态缓冲区，避免线程安全问题
-        int16_buffer.resize(audio_buffer.size());
-        
-        // 将float音频转换为WebRTC VAD需要的int16_t格式
-        for (size_t i = 0; i < audio_buffer.size(); i++) {
-            // 限制在[-1.0, 1.0]范围内，然后缩放到int16范围[-32768, 32767]
-            float sample = std::clamp(audio_buffer[i], -1.0f, 1.0f);
-            int16_buffer[i] = static_cast<int16_t>(sample * 32767.0f);
+        // 按10ms帧运行WebRTC VAD，不足一帧的尾部留到下次调用
+        if (!runWebRtcFrames(audio_buffer.data(), audio_buffer.size())) {
+            return last_voice_state;
         }
         
-        // 固定使用160个样本(10ms@16kHz)作为WebRTC VAD的处理单位，提供更精细的检测
-        const int samples_per_frame = 160; // 10ms@16kHz
-        
-        // 如果缓冲区太小，保持上一状态
-        if (int16_buffer.size() < samples_per_frame) {
+        // 本次没有凑满一帧，保持上一状态
+        if (frame_decisions.empty()) {
             return last_voice_state;
         }
         
         // 改进的多帧投票机制：统计所有子帧的语音检测结果
-        std::vector<bool> frame_results;
-        int total_frames = 0;
-        int voice_frames = 0;
-        
-        for (size_t offset = 0; offset + samples_per_frame <= int16_buffer.size(); offset += samples_per_frame) {
-            // 安全检查VAD实例
-            if (!vad_instance) {
-                std::cerr << "[VAD] VAD实例在处理过程中变为无效" << std::endl;
-                return last_voice_state;
-            }
-            
-            int vad_result = fvad_process(vad_instance, int16_buffer.data() + offset, samples_per_frame);
-            if (vad_result < 0) {
-                std::cerr << "[VAD] fvad_process返回错误: " << vad_result << std::endl;
-                return last_voice_state;
-            }
-            
-            bool is_voice_frame = (vad_result > 0);
-            frame_results.push_back(is_voice_frame);
-            total_frames++;
-            if (is_voice_frame) {
-                voice_frames++;
-            }
-        }
+        int total_frames = static_cast<int>(frame_decisions.size());
+        int voice_frames = static_cast<int>(frame_decisions.countVoice());
         
         // 智能投票决策：60%静音帧才认为整段为静音
         bool has_voice = false;
+        float voice_ratio = 0.0f;
         if (total_frames > 0) {
-            float voice_ratio = static_cast<float>(voice_frames) / total_frames;
+            voice_ratio = static_cast<float>(voice_frames) / total_frames;
             float silence_ratio = 1.0f - voice_ratio;
             
             // 如果静音帧比例 >= 60%，则认为整段为静音；否则认为有语音
@@ -282,8 +259,23 @@ bool VoiceActivityDetector::detect(const std::vector<float>& audio_buffer, int s
             }
         }
         
-        // 使用多层验证进行更精确的语音检测
-        bool basic_detection = isRealVoice(audio_buffer, has_voice, current_energy);
+        // 按VAD类型得到本段的判决，Silero不可用时退回WebRTC + 多层验证
+        bool basic_detection = false;
+        if (vad_type_ == VADType::Cascade) {
+            basic_detection = decideCascade(audio_buffer, voice_ratio, current_energy);
+        } else if ((vad_type_ == VADType::Silero || vad_type_ == VADType::Hybrid) && silero_vad_) {
+            float silero_probability = std::max(0.0f, sileroStreamProbability(audio_buffer));
+            if (vad_type_ == VADType::Silero) {
+                basic_detection = silero_probability > silero_vad_->getThreshold();
+            } else {
+                // 混合模式：WebRTC语音帧比例与Silero概率加权融合
+                float fused = webrtc_weight_ * voice_ratio + silero_weight_ * silero_probability;
+                basic_detection = isRealVoice(audio_buffer, fused >= 0.5f, current_energy);
+            }
+        } else {
+            // 使用多层验证进行更精确的语音检测
+            basic_detection = isRealVoice(audio_buffer, has_voice, current_energy);
+        }
         
         // 记录状态变化前的状态
         bool previous_state = last_voice_state;
@@ -424,6 +416,13 @@ void VoiceActivityDetector::reset() {
         
         // 清理缓冲区
         int16_buffer.clear();
+        pending_count = 0;
+        frame_decisions.clear();
+        
+        cascade_last_result_ = false;
+        
+        // 清空Silero的循环状态
+        resetSileroStream();
         
         // 仅重置VAD模式和采样率，不销毁重建实例
         if (vad_instance) {
@@ -492,44 +491,16 @@ bool VoiceActivityDetector::process(AudioBuffer& audio_buffer, float threshold)
         return false;
     }
     
-    // 用于记录静音帧的数量
-    int silence_frames = 0;
-    int total_frames = 0;
-    
-    // 将float音频转换为WebRTC VAD需要的int16_t格式
-    std::vector<int16_t> pcm_data;
-    pcm_data.reserve(audio_buffer.data.size());
-    
-    for (float sample : audio_buffer.data) {
-        // 归一化到[-32768, 32767]范围
-        int16_t pcm_sample = static_cast<int16_t>(std::max(std::min(sample * 32768.0f, 32767.0f), -32768.0f));
-        pcm_data.push_back(pcm_sample);
+    // 按10ms帧检测，帧网格与上次调用连续
+    if (!runWebRtcFrames(audio_buffer.data.data(), audio_buffer.data.size())) {
+        // 检测失败
+        std::cerr << "VAD detection failed" << std::endl;
+        return false;
     }
     
-    // 固定使用160个样本(10ms@16kHz)作为WebRTC VAD的处理单位，提供更精细的检测
-    const int frame_size = 160;  // 10ms @ 16kHz
-    int num_frames = static_cast<int>(pcm_data.size() / frame_size);
-    
-    // 将整个缓冲区划分为多个帧，分别处理
-    for (int i = 0; i < num_frames; i++) {
-        int16_t* frame_start = pcm_data.data() + i * frame_size;
-        
-        // 检测当前帧是否有语音活动
-        int result = fvad_process(vad_instance, frame_start, frame_size);
-        
-        if (result < 0) {
-            // 检测失败
-            std::cerr << "VAD detection failed" << std::endl;
-            return false;
-        }
-        
-        // 统计静音帧
-        if (result == 0) {
-            silence_frames++;
-        }
-        
-        total_frames++;
-    }
+    // 用于记录静音帧的数量
+    int total_frames = static_cast<int>(frame_decisions.size());
+    int silence_frames = total_frames - static_cast<int>(frame_decisions.countVoice());
     
     // 计算静音占比
     float silence_ratio = 0.0f;
@@ -547,6 +518,36 @@ bool VoiceActivityDetector::process(AudioBuffer& audio_buffer, float threshold)
     return !is_silent;
 }
 
+// 流式分帧：上次剩余样本 + 本次样本，整帧送入WebRTC VAD，尾部保存
+bool VoiceActivityDetector::runWebRtcFrames(const float* samples, size_t count) {
+    frame_decisions.clear();
+    
+    // 使用实例成员变量代替静态缓冲区，避免线程安全问题
+    const size_t total = pending_count + count;
+    if (int16_buffer.size() < total) {
+        int16_buffer.resize(total);
+    }
+    std::copy(pending_samples, pending_samples + pending_count, int16_buffer.begin());
+    
+    // 将float音频转换为WebRTC VAD需要的int16_t格式（向量化）
+    AudioKernels::floatToInt16(samples, count, int16_buffer.data() + pending_count);
+    
+    size_t offset = 0;
+    for (; offset + FRAME_SAMPLES <= total; offset += FRAME_SAMPLES) {
+        int vad_result = fvad_process(vad_instance, int16_buffer.data() + offset, FRAME_SAMPLES);
+        if (vad_result < 0) {
+            std::cerr << "[VAD] fvad_process返回错误: " << vad_result << std::endl;
+            pending_count = 0;
+            return false;
+        }
+        frame_decisions.push(vad_result > 0);
+    }
+    
+    pending_count = total - offset;
+    std::copy(int16_buffer.begin() + offset, int16_buffer.begin() + total, pending_samples);
+    return true;
+}
+
 // 设置语音结束检测的静音时长(毫秒)
 void VoiceActivityDetector::setSilenceDuration(size_t silence_ms) {
     // 计算对应的帧数 (使用20ms作为基准帧长度，因为检测逻辑以20ms为单位)
@@ -573,6 +574,32 @@ void VoiceActivityDetector::resetVoiceEndDetection() {
     silence_history.clear();
 }
 
+void VoiceActivityDetector::copySettingsFrom(const VoiceActivityDetector& other) {
+    if (&other == this) {
+        return;
+    }
+    
+    threshold = other.threshold;
+    setVADMode(other.vad_mode);
+    required_silence_frames = other.required_silence_frames;
+    min_voice_frames = other.min_voice_frames;
+    voice_hold_frames = other.voice_hold_frames;
+    energy_threshold = other.energy_threshold;
+    adaptive_mode = other.adaptive_mode;
+    webrtc_weight_ = other.webrtc_weight_;
+    silero_weight_ = other.silero_weight_;
+    cascade_low_ = other.cascade_low_;
+    cascade_high_ = other.cascade_high_;
+    
+    // Silero模型只在类型或模型路径变化时重新加载
+    if (silero_model_path_ != other.silero_model_path_) {
+        setSileroModelPath(other.silero_model_path_);
+    }
+    if (vad_type_ != other.vad_type_) {
+        setVADType(other.vad_type_);
+    }
+}
+
 // 更新语音活动状态，返回是否为静音
 bool VoiceActivityDetector::updateVoiceState(bool is_silence) {
     // 更新静音历史
@@ -830,6 +857,10 @@ bool VoiceActivityDetector::isRealVoice(const std::vector<float>& audio_frame, b
 
 // VAD类型相关方法实现
 void VoiceActivityDetector::setVADType(VADType type) {
+    // 级联的独立窗口会清空循环状态，切换模式后连续推理从头开始
+    if (type != vad_type_) {
+        resetSileroStream();
+    }
     vad_type_ = type;
     
     // 根据VAD类型进行相应的初始化
@@ -837,24 +868,22 @@ void VoiceActivityDetector::setVADType(VADType type) {
         case VADType::Silero:
             // 如果设置了Silero模型路径，初始化Silero VAD
             if (!silero_model_path_.empty() && !silero_vad_) {
-                try {
-                    silero_vad_ = new SileroVADDetector(silero_model_path_);
-                    if (silero_vad_ && silero_vad_->initialize()) {
-                        std::cout << "[VAD] Silero VAD初始化成功" << std::endl;
-                    } else {
-                        std::cerr << "[VAD] Silero VAD初始化失败" << std::endl;
-                        delete silero_vad_;
-                        silero_vad_ = nullptr;
-                    }
-                } catch (const std::exception& e) {
-                    std::cerr << "[VAD] Silero VAD创建异常: " << e.what() << std::endl;
-                    silero_vad_ = nullptr;
-                }
+                initSileroDetector();
             }
             break;
         case VADType::Hybrid:
+            if (!silero_model_path_.empty() && !silero_vad_) {
+                initSileroDetector();
+            }
             std::cout << "[VAD] 混合VAD模式已设置" << std::endl;
             break;
+        case VADType::Cascade:
+            if (!silero_model_path_.empty() && !silero_vad_) {
+                initSileroDetector();
+            }
+            std::cout << "[VAD] 级联VAD模式已设置 (静音/语音边界: " << cascade_low_
+                      << "/" << cascade_high_ << ")" << std::endl;
+            break;
         case VADType::WebRTC:
         default:
             std::cout << "[VAD] WebRTC VAD模式已设置" << std::endl;
@@ -866,7 +895,7 @@ bool VoiceActivityDetector::setSileroModelPath(const std::string& model_path) {
     silero_model_path_ = model_path;
     
     // 如果当前使用Silero VAD，重新初始化
-    if (vad_type_ == VADType::Silero || vad_type_ == VADType::Hybrid) {
+    if (vad_type_ != VADType::WebRTC) {
         // 清理旧的实例
         if (silero_vad_) {
             delete silero_vad_;
@@ -874,29 +903,37 @@ bool VoiceActivityDetector::setSileroModelPath(const std::string& model_path) {
         }
         
         // 创建新的Silero VAD实例
-        try {
-            silero_vad_ = new SileroVADDetector(model_path);
-            if (silero_vad_ && silero_vad_->initialize()) {
-                std::cout << "[VAD] Silero模型路径已设置并初始化成功: " << model_path << std::endl;
-                return true;
-            } else {
-                std::cerr << "[VAD] Silero VAD初始化失败" << std::endl;
-                delete silero_vad_;
-                silero_vad_ = nullptr;
-                return false;
-            }
-        } catch (const std::exception& e) {
-            std::cerr << "[VAD] Silero VAD创建异常: " << e.what() << std::endl;
-            silero_vad_ = nullptr;
-            return false;
+        if (initSileroDetector()) {
+            std::cout << "[VAD] Silero模型路径已设置: " << model_path << std::endl;
+            return true;
         }
+        return false;
     }
     
     return true;
 }
 
+bool VoiceActivityDetector::initSileroDetector() {
+    try {
+        silero_vad_ = new SileroVADDetector(silero_model_path_);
+        if (silero_vad_->initialize()) {
+            std::cout << "[VAD] Silero VAD初始化成功" << std::endl;
+            return true;
+        }
+        std::cerr << "[VAD] Silero VAD初始化失败" << std::endl;
+        delete silero_vad_;
+        silero_vad_ = nullptr;
+        return false;
+    } catch (const std::exception& e) {
+        std::cerr << "[VAD] Silero VAD创建异常: " << e.what() << std::endl;
+        delete silero_vad_;
+        silero_vad_ = nullptr;
+        return false;
+    }
+}
+
 float VoiceActivityDetector::getSileroVADProbability(const std::vector<float>& audio_buffer) {
-    if (vad_type_ != VADType::Silero && vad_type_ != VADType::Hybrid) {
+    if (vad_type_ == VADType::WebRTC) {
         return 0.0f; // 不是Silero模式，返回0
     }
     
@@ -910,4 +947,105 @@ float VoiceActivityDetector::getSileroVADProbability(const std::vector<float>& a
         std::cerr << "[VAD] Silero VAD检测异常: " << e.what() << std::endl;
         return 0.0f;
     }
-}
\ No newline at end of file
+}
+
+void VoiceActivityDetector::setCascadeBounds(float low, float high) {
+    cascade_low_ = std::clamp(low, 0.0f, 1.0f);
+    cascade_high_ = std::clamp(high, cascade_low_, 1.0f);
+    std::cout << "[VAD] 级联边界: 静音<=" << cascade_low_ << ", 语音>=" << cascade_high_ << std::endl;
+}
+
+// 取缓冲区末尾的一个窗口做Silero推理，窗口与状态机当前判决对应的最新音频对齐
+float VoiceActivityDetector::sileroTailProbability(const std::vector<float>& audio_buffer) {
+    if (!silero_vad_) {
+        return -1.0f;
+    }
+    
+    const size_t start = audio_buffer.size() > SILERO_WINDOW_SAMPLES ? audio_buffer.size() - SILERO_WINDOW_SAMPLES : 0;
+    silero_window_.assign(audio_buffer.begin() + start, audio_buffer.end());
+    
+    // 级联只在边界附近才调用Silero，相邻两次探测之间隔着未送入模型的音频，
+    // 每个窗口都从空状态开始推理，不沿用上一个不相邻窗口留下的循环状态
+    try {
+        return silero_vad_->detectIsolatedWindow(silero_window_);
+    } catch (const std::exception& e) {
+        std::cerr << "[VAD] Silero VAD检测异常: " << e.what() << std::endl;
+        return -1.0f;
+    }
+}
+
+// Silero和混合模式下每个缓冲区都送入Silero，音频是连续的，按窗口依次推理并沿用本流的循环状态
+float VoiceActivityDetector::sileroStreamProbability(const std::vector<float>& audio_buffer) {
+    if (!silero_vad_) {
+        return -1.0f;
+    }
+    
+    silero_pending_.insert(silero_pending_.end(), audio_buffer.begin(), audio_buffer.end());
+    size_t offset = 0;
+    try {
+        while (silero_pending_.size() - offset >= SILERO_WINDOW_SAMPLES) {
+            silero_window_.assign(silero_pending_.begin() + offset,
+                                  silero_pending_.begin() + offset + SILERO_WINDOW_SAMPLES);
+            silero_last_probability_ = silero_vad_->detectVoiceActivity(silero_window_);
+            offset += SILERO_WINDOW_SAMPLES;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[VAD] Silero VAD检测异常: " << e.what() << std::endl;
+        resetSileroStream();
+        return -1.0f;
+    }
+    silero_pending_.erase(silero_pending_.begin(), silero_pending_.begin() + offset);
+    return silero_last_probability_;
+}
+
+void VoiceActivityDetector::resetSileroStream() {
+    silero_pending_.clear();
+    silero_last_probability_ = 0.0f;
+    if (silero_vad_) {
+        silero_vad_->reset();
+    }
+}
+
+// 级联判决：大部分缓冲区由能量门和WebRTC决定，只有不确定的才调用Silero
+bool VoiceActivityDetector::decideCascade(const std::vector<float>& audio_buffer, float voice_ratio, float current_energy) {
+    bool result = false;
+    
+    if (current_energy < energy_threshold) {
+        // 第一级：能量低于阈值，明确的静音
+        cascade_stats_.energy_decided++;
+        result = false;
+    } else {
+        // 第二级：WebRTC帧投票明确，且与当前状态一致（不在语音起止点）
+        // 上一次判决与当前状态不一致说明状态机正在计数切换，同样视为起止点
+        bool clear_silence = voice_ratio <= cascade_low_;
+        bool clear_speech = voice_ratio >= cascade_high_;
+        bool at_transition = (clear_speech != last_voice_state) || (cascade_last_result_ != last_voice_state);
+        
+        float silero_probability = -1.0f;
+        if ((clear_silence || clear_speech) && !at_transition) {
+            cascade_stats_.webrtc_decided++;
+            result = clear_speech && isRealVoice(audio_buffer, true, current_energy);
+        } else if ((silero_probability = sileroTailProbability(audio_buffer)) >= 0.0f) {
+            // 第三级：边界附近或起止点，由Silero决定
+            cascade_stats_.silero_decided++;
+            result = silero_probability > silero_vad_->getThreshold();
+        } else {
+            // Silero不可用，按WebRTC投票处理
+            cascade_stats_.webrtc_decided++;
+            result = isRealVoice(audio_buffer, voice_ratio > 0.4f, current_energy);
+        }
+    }
+    
+    cascade_last_result_ = result;
+    
+    // 定期输出各级命中率
+    const uint64_t total = cascade_stats_.total();
+    if (total % 1000 == 0) {
+        std::cout << "[VAD] 级联命中率 (" << total << "次): 能量门 "
+                  << std::fixed << std::setprecision(1) << (100.0 * cascade_stats_.energy_decided / total)
+                  << "%, WebRTC " << (100.0 * cascade_stats_.webrtc_decided / total)
+                  << "%, Silero " << (100.0 * cascade_stats_.silero_decided / total) << "%" << std::endl;
+    }
+    
+    return result;
+}
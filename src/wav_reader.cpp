@@ -0,0 +1,498 @@
+#include "wav_reader.h"
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+constexpr uint32_t RF64_SIZE_IN_DS64 = 0xFFFFFFFF;  // RF64中实际大小记录在ds64块
+
+constexpr float INT32_TO_FLOAT = 1.0f / 2147483648.0f;
+
+// Loudest模式参数
+constexpr float ENERGY_SMOOTHING = 0.3f;   // 每个块的新能量所占权重
+constexpr float SWITCH_RATIO = 2.0f;       // 其他声道能量超过当前声道2倍（约3dB）才切换，避免来回跳
+constexpr size_t CROSSFADE_SAMPLES = 256;  // 切换声道时的交叉淡化长度
+
+// WAV文件为小端序
+uint16_t readU16(const uint8_t* data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+uint32_t readU32(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+uint64_t readU64(const uint8_t* data) {
+    return static_cast<uint64_t>(readU32(data)) | (static_cast<uint64_t>(readU32(data + 4)) << 32);
+}
+
+bool isChunk(const uint8_t* header, const char* id) {
+    return std::memcmp(header, id, 4) == 0;
+}
+
+} // namespace
+
+// ============ WavReader ============
+
+bool WavReader::open(const std::string& path, bool memory_mapped) {
+    close();
+
+    uint64_t file_size = 0;
+    if (memory_mapped) {
+        if (!mapFile(path)) {
+            return false;
+        }
+        file_size = mapped_size;
+    } else {
+        file.open(path, std::ios::binary);
+        if (!file.is_open()) {
+            return fail("无法打开文件: " + path);
+        }
+        file.seekg(0, std::ios::end);
+        file_size = static_cast<uint64_t>(file.tellg());
+        file.seekg(0, std::ios::beg);
+    }
+
+    if (!parseChunks(file_size)) {
+        const std::string message = error;
+        close();
+        error = message;
+        return false;
+    }
+
+    if (file.is_open()) {
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(data_offset));
+    }
+    return true;
+}
+
+void WavReader::close() {
+    if (file.is_open()) {
+        file.close();
+    }
+    file.clear();
+    unmapFile();
+    format = WavFormat();
+    data_offset = 0;
+    total_frames = 0;
+    position = 0;
+    error.clear();
+}
+
+bool WavReader::fail(const std::string& message) {
+    error = message;
+    return false;
+}
+
+bool WavReader::mapFile(const std::string& path) {
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return fail("无法打开文件: " + path);
+    }
+    LARGE_INTEGER size = {};
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart < 12) {
+        CloseHandle(handle);
+        return fail("文件过短，不是WAV文件");
+    }
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(handle);
+    if (!mapping) {
+        return fail("无法映射文件，错误码: " + std::to_string(GetLastError()));
+    }
+    // 视图保持映射对象存活，两个句柄都可以立即关闭
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) {
+        return fail("无法映射文件视图，错误码: " + std::to_string(GetLastError()));
+    }
+    mapped_size = static_cast<uint64_t>(size.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return fail("无法打开文件: " + path);
+    }
+    struct stat info = {};
+    if (fstat(fd, &info) != 0 || info.st_size < 12) {
+        ::close(fd);
+        return fail("文件过短，不是WAV文件");
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return fail("无法映射文件: " + path);
+    }
+    madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+    mapped_size = static_cast<uint64_t>(info.st_size);
+#endif
+    mapped = static_cast<const uint8_t*>(view);
+    return true;
+}
+
+void WavReader::unmapFile() {
+    if (!mapped) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(mapped);
+#else
+    munmap(const_cast<uint8_t*>(mapped), static_cast<size_t>(mapped_size));
+#endif
+    mapped = nullptr;
+    mapped_size = 0;
+}
+
+bool WavReader::readAt(uint64_t offset, void* buffer, size_t size) {
+    if (mapped) {
+        if (offset > mapped_size || size > mapped_size - offset) {
+            return false;
+        }
+        std::memcpy(buffer, mapped + offset, size);
+        return true;
+    }
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(offset));
+    return static_cast<bool>(file.read(static_cast<char*>(buffer), static_cast<std::streamsize>(size)));
+}
+
+bool WavReader::parseChunks(uint64_t file_size) {
+    uint8_t header[12] = {};
+    if (!readAt(0, header, sizeof(header))) {
+        return fail("文件过短，不是WAV文件");
+    }
+    const bool is_rf64 = isChunk(header, "RF64");
+    if ((!isChunk(header, "RIFF") && !is_rf64) || !isChunk(header + 8, "WAVE")) {
+        return fail("不是RIFF/WAVE文件");
+    }
+
+    bool has_format = false;
+    bool has_data = false;
+    uint64_t ds64_data_size = 0;
+    uint64_t data_size = 0;
+
+    // 逐块遍历：块头为4字节ID + 4字节长度，奇数长度的块后有一个填充字节
+    uint64_t chunk_pos = sizeof(header);
+    while (chunk_pos + 8 <= file_size && !(has_format && has_data)) {
+        uint8_t chunk_header[8] = {};
+        if (!readAt(chunk_pos, chunk_header, sizeof(chunk_header))) {
+            break;
+        }
+        uint64_t chunk_size = readU32(chunk_header + 4);
+        const uint64_t body_pos = chunk_pos + 8;
+
+        if (isChunk(chunk_header, "ds64")) {
+            uint8_t ds64[16] = {};
+            if (chunk_size >= sizeof(ds64) && readAt(body_pos, ds64, sizeof(ds64))) {
+                ds64_data_size = readU64(ds64 + 8);  // 依次为RIFF大小、data大小
+            }
+        } else if (isChunk(chunk_header, "fmt ")) {
+            if (chunk_size < 16 || chunk_size > 1024) {
+                return fail("fmt块长度异常: " + std::to_string(chunk_size));
+            }
+            std::vector<uint8_t> chunk(static_cast<size_t>(chunk_size));
+            if (!readAt(body_pos, chunk.data(), chunk.size())) {
+                return fail("fmt块不完整");
+            }
+            if (!parseFormatChunk(chunk)) {
+                return false;
+            }
+            has_format = true;
+        } else if (isChunk(chunk_header, "data")) {
+            if (is_rf64 && chunk_size == RF64_SIZE_IN_DS64) {
+                chunk_size = ds64_data_size;
+            }
+            // 录制中断或流式写入的文件长度字段可能为0或未回填，按实际文件长度截断
+            const uint64_t available = file_size - body_pos;
+            if (chunk_size == 0 || chunk_size > available) {
+                chunk_size = available;
+            }
+            data_offset = body_pos;
+            data_size = chunk_size;
+            has_data = true;
+        }
+
+        chunk_pos = body_pos + chunk_size + (chunk_size & 1);
+    }
+
+    if (!has_format) {
+        return fail("缺少fmt块");
+    }
+    if (!has_data) {
+        return fail("缺少data块");
+    }
+
+    total_frames = data_size / format.block_align;
+    position = 0;
+    return true;
+}
+
+bool WavReader::parseFormatChunk(const std::vector<uint8_t>& chunk) {
+    uint16_t format_tag = readU16(chunk.data());
+    format.channels = readU16(chunk.data() + 2);
+    format.sample_rate = static_cast<int>(readU32(chunk.data() + 4));
+    format.block_align = readU16(chunk.data() + 12);
+    format.bits_per_sample = readU16(chunk.data() + 14);
+
+    // EXTENSIBLE格式的实际编码为子格式GUID的前两个字节
+    if (format_tag == WAVE_FORMAT_EXTENSIBLE && chunk.size() >= 40) {
+        format_tag = readU16(chunk.data() + 24);
+    }
+
+    if (format_tag == WAVE_FORMAT_PCM) {
+        format.is_float = false;
+        if (format.bits_per_sample != 8 && format.bits_per_sample != 16 &&
+            format.bits_per_sample != 24 && format.bits_per_sample != 32) {
+            return fail("不支持的PCM位深度: " + std::to_string(format.bits_per_sample));
+        }
+    } else if (format_tag == WAVE_FORMAT_IEEE_FLOAT) {
+        format.is_float = true;
+        if (format.bits_per_sample != 32 && format.bits_per_sample != 64) {
+            return fail("不支持的浮点位深度: " + std::to_string(format.bits_per_sample));
+        }
+    } else {
+        return fail("不支持的编码格式: " + std::to_string(format_tag));
+    }
+
+    if (format.channels <= 0 || format.sample_rate <= 0) {
+        return fail("声道数或采样率无效");
+    }
+    if (format.block_align != static_cast<size_t>(format.channels) * (format.bits_per_sample / 8)) {
+        return fail("块对齐与声道数、位深度不符: " + std::to_string(format.block_align));
+    }
+    return true;
+}
+
+bool WavReader::seekToFrame(uint64_t frame) {
+    if (!isOpen() || frame > total_frames) {
+        return false;
+    }
+    if (file.is_open()) {
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(data_offset + frame * format.block_align));
+    }
+    position = frame;
+    return true;
+}
+
+size_t WavReader::readFrames(size_t max_frames, std::vector<std::vector<float>>& planes) {
+    if (!isOpen() || position >= total_frames || max_frames == 0) {
+        return 0;
+    }
+
+    const size_t wanted = static_cast<size_t>(std::min<uint64_t>(max_frames, total_frames - position));
+    if (mapped) {
+        decodeFrames(mapped + data_offset + position * format.block_align, wanted, planes);
+        position += wanted;
+        return wanted;
+    }
+
+    const size_t bytes = wanted * format.block_align;
+    if (raw.size() < bytes) {
+        raw.resize(bytes);
+    }
+    file.read(raw.data(), static_cast<std::streamsize>(bytes));
+    const size_t frames = static_cast<size_t>(file.gcount()) / format.block_align;
+    if (frames == 0) {
+        fail("读取音频数据失败，位置: " + std::to_string(position));
+        return 0;
+    }
+
+    decodeFrames(reinterpret_cast<const uint8_t*>(raw.data()), frames, planes);
+    position += frames;
+    return frames;
+}
+
+void WavReader::decodeFrames(const uint8_t* data, size_t frames, std::vector<std::vector<float>>& planes) {
+    const int channels = format.channels;
+    const size_t samples = frames * channels;
+    if (planes.size() != static_cast<size_t>(channels)) {
+        planes.resize(channels);
+    }
+    for (auto& plane : planes) {
+        if (plane.size() < frames) {
+            plane.resize(frames);
+        }
+    }
+
+    // 单声道直接解码到平面，多声道先解码为交错浮点再拆分
+    float* decoded = planes[0].data();
+    if (channels > 1) {
+        if (interleaved.size() < samples) {
+            interleaved.resize(samples);
+        }
+        decoded = interleaved.data();
+    }
+
+    if (format.is_float && format.bits_per_sample == 32) {
+        std::memcpy(decoded, data, samples * sizeof(float));
+    } else if (format.is_float) {
+        for (size_t i = 0; i < samples; ++i) {
+            double value;
+            std::memcpy(&value, data + i * sizeof(double), sizeof(double));
+            decoded[i] = static_cast<float>(value);
+        }
+    } else if (format.bits_per_sample == 16) {
+        AudioKernels::int16ToFloat(reinterpret_cast<const int16_t*>(data), samples, decoded);
+    } else if (format.bits_per_sample == 24) {
+        for (size_t i = 0; i < samples; ++i) {
+            const uint8_t* sample = data + i * 3;
+            // 放到32位整数的高24位，按32位的比例缩放
+            const uint32_t bits = (static_cast<uint32_t>(sample[0]) << 8) |
+                                  (static_cast<uint32_t>(sample[1]) << 16) |
+                                  (static_cast<uint32_t>(sample[2]) << 24);
+            decoded[i] = static_cast<float>(static_cast<int32_t>(bits)) * INT32_TO_FLOAT;
+        }
+    } else if (format.bits_per_sample == 32) {
+        for (size_t i = 0; i < samples; ++i) {
+            int32_t value;
+            std::memcpy(&value, data + i * sizeof(int32_t), sizeof(int32_t));
+            decoded[i] = static_cast<float>(value) * INT32_TO_FLOAT;
+        }
+    } else {
+        for (size_t i = 0; i < samples; ++i) {
+            decoded[i] = (static_cast<int>(data[i]) - 128) / 128.0f;
+        }
+    }
+
+    if (channels > 1) {
+        plane_pointers.resize(channels);
+        for (int c = 0; c < channels; ++c) {
+            plane_pointers[c] = planes[c].data();
+        }
+        AudioKernels::deinterleave(interleaved.data(), frames, channels, plane_pointers.data());
+    }
+}
+
+// ============ ChannelDownmixer ============
+
+void ChannelDownmixer::setMode(DownmixMode mode, int channel) {
+    this->mode = mode;
+    selected_channel = std::max(0, channel);
+    reset();
+}
+
+void ChannelDownmixer::reset() {
+    smoothed_energy.clear();
+    active_channel = 0;
+}
+
+void ChannelDownmixer::process(const std::vector<std::vector<float>>& planes, size_t frames,
+                               std::vector<float>& output) {
+    output.resize(frames);
+    if (planes.empty() || frames == 0) {
+        std::fill(output.begin(), output.end(), 0.0f);
+        return;
+    }
+
+    const int channels = static_cast<int>(planes.size());
+    if (channels == 1) {
+        std::copy(planes[0].begin(), planes[0].begin() + frames, output.begin());
+        return;
+    }
+
+    switch (mode) {
+    case DownmixMode::SelectChannel: {
+        const auto& plane = planes[std::min(selected_channel, channels - 1)];
+        std::copy(plane.begin(), plane.begin() + frames, output.begin());
+        break;
+    }
+    case DownmixMode::Loudest:
+        processLoudest(planes, frames, output);
+        break;
+    case DownmixMode::Average:
+    default:
+        plane_pointers.resize(channels);
+        for (int c = 0; c < channels; ++c) {
+            plane_pointers[c] = planes[c].data();
+        }
+        AudioKernels::averageChannels(plane_pointers.data(), channels, frames, output.data());
+        break;
+    }
+}
+
+void ChannelDownmixer::processLoudest(const std::vector<std::vector<float>>& planes, size_t frames,
+                                      std::vector<float>& output) {
+    const int channels = static_cast<int>(planes.size());
+    const bool first_block = smoothed_energy.size() != static_cast<size_t>(channels);
+    if (first_block) {
+        smoothed_energy.assign(channels, 0.0f);
+    }
+
+    int loudest = 0;
+    for (int c = 0; c < channels; ++c) {
+        const float energy = AudioKernels::analyze(planes[c].data(), frames).sum_squares / frames;
+        smoothed_energy[c] = first_block ? energy
+                                         : smoothed_energy[c] + ENERGY_SMOOTHING * (energy - smoothed_energy[c]);
+        if (smoothed_energy[c] > smoothed_energy[loudest]) {
+            loudest = c;
+        }
+    }
+
+    if (first_block) {
+        active_channel = loudest;
+    }
+
+    const float* current = planes[active_channel].data();
+    size_t start = 0;
+    if (!first_block && loudest != active_channel &&
+        smoothed_energy[loudest] > SWITCH_RATIO * smoothed_energy[active_channel]) {
+        // 切换声道：前CROSSFADE_SAMPLES个样本从原声道线性过渡到新声道
+        const float* previous = current;
+        active_channel = loudest;
+        current = planes[active_channel].data();
+        start = std::min(frames, CROSSFADE_SAMPLES);
+        for (size_t i = 0; i < start; ++i) {
+            const float weight = static_cast<float>(i + 1) / static_cast<float>(start + 1);
+            output[i] = previous[i] + weight * (current[i] - previous[i]);
+        }
+    }
+    std::copy(current + start, current + frames, output.begin() + start);
+}
+
+bool ChannelDownmixer::parseMode(const std::string& name, DownmixMode& mode) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "average") {
+        mode = DownmixMode::Average;
+    } else if (lower == "channel") {
+        mode = DownmixMode::SelectChannel;
+    } else if (lower == "loudest") {
+        mode = DownmixMode::Loudest;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* ChannelDownmixer::getModeName(DownmixMode mode) {
+    switch (mode) {
+    case DownmixMode::SelectChannel:
+        return "channel";
+    case DownmixMode::Loudest:
+        return "loudest";
+    case DownmixMode::Average:
+    default:
+        return "average";
+    }
+}
@@ -611,6 +611,7 @@ void WhisperGUI::setupConnections() {
     
     // 连接识别结果信号
     connect(audioProcessor, &AudioProcessor::recognitionResultReady, this, &WhisperGUI::appendFinalOutput);
+    connect(audioProcessor, &AudioProcessor::partialResultReady, this, &WhisperGUI::updatePartialOutput);
     //connect(audioProcessor, &AudioProcessor::translationResultReady, this, &WhisperGUI::appendFinalOutput);
     connect(audioProcessor, &AudioProcessor::openAIResultReady, this, &WhisperGUI::appendFinalOutput);
     connect(audioProcessor, &AudioProcessor::preciseServerResultReady, this, &WhisperGUI::appendFinalOutput);
@@ -991,12 +992,45 @@ void WhisperGUI::onMediaPlayerError(QMediaPlayer::Error error, const QString& er
 }
 
 void WhisperGUI::appendFinalOutput(const QString& text) {
+    // 最终结果替换正在显示的部分结果
+    removePartialLine();
+    
     // 将文本封装在span标签中以应用样式
     finalOutput->append("<span>" + text + "</span>");
     finalOutput->verticalScrollBar()->setValue(
         finalOutput->verticalScrollBar()->maximum());
 }
 
+void WhisperGUI::updatePartialOutput(const QString& committed, const QString& tentative) {
+    if (!finalOutput) {
+        return;
+    }
+    
+    removePartialLine();
+    if (committed.isEmpty() && tentative.isEmpty()) {
+        return;
+    }
+    
+    // 已稳定的部分正常显示，可能被修正的部分显示为灰色
+    finalOutput->append("<span>" + committed.toHtmlEscaped() + "</span>" +
+                        "<span style=\"color: gray;\">" + tentative.toHtmlEscaped() + "</span>");
+    hasPartialLine = true;
+    finalOutput->verticalScrollBar()->setValue(
+        finalOutput->verticalScrollBar()->maximum());
+}
+
+void WhisperGUI::removePartialLine() {
+    if (!hasPartialLine || !finalOutput) {
+        return;
+    }
+    
+    QTextCursor cursor(finalOutput->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.select(QTextCursor::BlockUnderCursor);
+    cursor.removeSelectedText();
+    hasPartialLine = false;
+}
+
 void WhisperGUI::appendLogMessage(const QString& message) {
     // 总是记录到控制台
     qDebug() << "LOG:" << message;
@@ -0,0 +1,10 @@
+#pragma once
+
+// 测试构建使用的日志头：与include/log_utils.h的日志宏一致，但不依赖Qt和GUI
+#include <iostream>
+#include <string>
+
+#define LOG_INFO(msg) std::cout << "[INFO] " << msg << std::endl
+#define LOG_ERROR(msg) std::cerr << "[ERROR] " << msg << std::endl
+#define LOG_WARNING(msg) std::cout << "[WARNING] " << msg << std::endl
+#define LOG_DEBUG(msg) std::cout << "[DEBUG] " << msg << std::endl
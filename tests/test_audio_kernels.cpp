@@ -0,0 +1,299 @@
+// AudioKernels单元测试：当前分派的实现（AVX2/SSE2/NEON/标量）与预处理原来的逐样本标量写法对比
+// 长度都不是8的倍数，覆盖向量块之后的尾部；数据起点偏移一个样本，覆盖未对齐的读写
+//
+// 容差：
+// - 逐样本输出（预加重、缩放限幅、高通、逐点处理链、int16转换、声道拆分与平均）：绝对误差 <= 1e-6
+// - 平方和：与double精度的顺序累加相比，相对误差 <= 1e-5（内核按8路交错累加，合并顺序与顺序累加不同）
+// - 峰值、float转int16：完全一致
+#include "audio_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr float SAMPLE_TOLERANCE = 1e-6f;
+constexpr double SUM_RELATIVE_TOLERANCE = 1e-5;
+const size_t TEST_LENGTHS[] = {1, 3, 7, 9, 15, 17, 31, 33, 1037, 4099};
+
+int failures = 0;
+
+void fail(const std::string& kernel, size_t count, const std::string& detail) {
+    std::cerr << kernel << " (长度 " << count << "): " << detail << std::endl;
+    ++failures;
+}
+
+// 合成数据，幅度超出[-1, 1]以覆盖限幅
+std::vector<float> makeSignal(size_t count, uint32_t seed) {
+    std::vector<float> signal(count);
+    for (float& sample : signal) {
+        seed = seed * 1664525u + 1013904223u;
+        sample = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 3.0f;
+    }
+    return signal;
+}
+
+float clampUnit(float value) {
+    return std::min(std::max(value, -1.0f), 1.0f);
+}
+
+// ============ 原来的标量写法 ============
+
+double referenceSumSquares(const std::vector<float>& data) {
+    double sum = 0.0;
+    for (float sample : data) {
+        sum += static_cast<double>(sample) * sample;
+    }
+    return sum;
+}
+
+float referencePeak(const std::vector<float>& data) {
+    float peak = 0.0f;
+    for (float sample : data) {
+        peak = std::max(peak, std::abs(sample));
+    }
+    return peak;
+}
+
+void referencePreEmphasis(std::vector<float>& data, float coef) {
+    float prev = data[0];
+    for (size_t i = 1; i < data.size(); i++) {
+        float current = data[i];
+        data[i] = current - coef * prev;
+        prev = current;
+    }
+}
+
+void referenceScaleClamp(std::vector<float>& data, float scale) {
+    for (float& sample : data) {
+        sample *= scale;
+        sample = clampUnit(sample);
+    }
+}
+
+void referenceHighPass(std::vector<float>& data, float alpha, float* state) {
+    for (float& sample : data) {
+        state[0] = alpha * (state[0] + sample - state[1]);
+        state[1] = sample;
+        sample = state[0];
+    }
+}
+
+void referencePointwise(std::vector<float>& data, const PointwiseChainParams& params) {
+    if (params.apply_gain) {
+        for (float& sample : data) {
+            sample *= params.gain;
+            sample = clampUnit(sample);
+        }
+    }
+    if (params.apply_compression) {
+        for (float& sample : data) {
+            float abs_sample = std::abs(sample);
+            if (abs_sample > params.compression_threshold) {
+                float gain_reduction = 1.0f + (params.compression_threshold - abs_sample) *
+                                       (1.0f - 1.0f / params.compression_ratio) / params.compression_threshold;
+                sample *= gain_reduction;
+            }
+            sample = clampUnit(sample);
+        }
+    }
+    if (params.apply_final_gain) {
+        for (float& sample : data) {
+            sample *= params.final_gain;
+            sample = clampUnit(sample);
+        }
+    }
+}
+
+// ============ 比较 ============
+
+void checkSamples(const std::string& kernel, const std::vector<float>& expected, const float* actual) {
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (!(std::abs(expected[i] - actual[i]) <= SAMPLE_TOLERANCE)) {
+            fail(kernel, expected.size(), "第 " + std::to_string(i) + " 个样本 " + std::to_string(actual[i]) +
+                 "，期望 " + std::to_string(expected[i]));
+            return;
+        }
+    }
+}
+
+void checkSum(const std::string& kernel, size_t count, double expected, float actual) {
+    const double tolerance = SUM_RELATIVE_TOLERANCE * std::max(expected, 1.0);
+    if (!(std::abs(expected - actual) <= tolerance)) {
+        fail(kernel, count, "平方和 " + std::to_string(actual) + "，期望 " + std::to_string(expected));
+    }
+}
+
+void checkPeak(const std::string& kernel, size_t count, float expected, float actual) {
+    if (expected != actual) {
+        fail(kernel, count, "峰值 " + std::to_string(actual) + "，期望 " + std::to_string(expected));
+    }
+}
+
+// 输入拷贝到偏移一个样本的缓冲区，使向量读写不按16/32字节对齐
+struct OffsetBuffer {
+    std::vector<float> storage;
+    float* data;
+
+    explicit OffsetBuffer(const std::vector<float>& input) : storage(input.size() + 1) {
+        data = storage.data() + 1;
+        std::copy(input.begin(), input.end(), data);
+    }
+};
+
+void testAnalyze(const std::vector<float>& input) {
+    OffsetBuffer buffer(input);
+    AudioBufferStats stats = AudioKernels::analyze(buffer.data, input.size());
+    checkSum("analyze", input.size(), referenceSumSquares(input), stats.sum_squares);
+    checkPeak("analyze", input.size(), referencePeak(input), stats.peak);
+}
+
+void testPreEmphasis(const std::vector<float>& input) {
+    std::vector<float> expected = input;
+    referencePreEmphasis(expected, 0.97f);
+
+    OffsetBuffer buffer(input);
+    float sum_squares = AudioKernels::preEmphasis(buffer.data, input.size(), 0.97f);
+    checkSamples("preEmphasis", expected, buffer.data);
+    checkSum("preEmphasis", input.size(), referenceSumSquares(expected), sum_squares);
+}
+
+void testScaleAndHighPass(const std::vector<float>& input) {
+    // 只缩放限幅（向量实现）
+    {
+        std::vector<float> expected = input;
+        referenceScaleClamp(expected, 1.9f);
+
+        OffsetBuffer buffer(input);
+        float state[2] = {0.0f, 0.0f};
+        float sum_squares = AudioKernels::scaleAndHighPass(buffer.data, input.size(), true, 1.9f, false, 0.0f, state);
+        checkSamples("scaleAndHighPass(缩放)", expected, buffer.data);
+        checkSum("scaleAndHighPass(缩放)", input.size(), referenceSumSquares(expected), sum_squares);
+    }
+
+    // 缩放 + 高通，分两次调用检查状态跨调用保存
+    {
+        const float alpha = 0.98f;
+        std::vector<float> expected = input;
+        referenceScaleClamp(expected, 1.9f);
+        float expected_state[2] = {0.0f, 0.0f};
+        referenceHighPass(expected, alpha, expected_state);
+
+        OffsetBuffer buffer(input);
+        float state[2] = {0.0f, 0.0f};
+        const size_t split = input.size() / 2;
+        float first = AudioKernels::scaleAndHighPass(buffer.data, split, true, 1.9f, true, alpha, state);
+        float second = AudioKernels::scaleAndHighPass(buffer.data + split, input.size() - split,
+                                                      true, 1.9f, true, alpha, state);
+        checkSamples("scaleAndHighPass(高通)", expected, buffer.data);
+        checkSum("scaleAndHighPass(高通)", input.size(), referenceSumSquares(expected),
+                 first + second);
+    }
+}
+
+void testPointwise(const std::vector<float>& input) {
+    PointwiseChainParams params;
+    params.apply_gain = true;
+    params.gain = 1.7f;
+    params.apply_compression = true;
+    params.compression_threshold = 0.5f;
+    params.compression_ratio = 2.0f;
+    params.apply_final_gain = true;
+    params.final_gain = 1.3f;
+
+    std::vector<float> expected = input;
+    referencePointwise(expected, params);
+
+    OffsetBuffer buffer(input);
+    AudioBufferStats stats = AudioKernels::applyPointwise(buffer.data, input.size(), params);
+    checkSamples("applyPointwise", expected, buffer.data);
+    checkSum("applyPointwise", input.size(), referenceSumSquares(expected), stats.sum_squares);
+    checkPeak("applyPointwise", input.size(), referencePeak(expected), stats.peak);
+}
+
+void testInt16Conversion(const std::vector<float>& input) {
+    OffsetBuffer buffer(input);
+    std::vector<int16_t> pcm(input.size() + 1);
+    AudioKernels::floatToInt16(buffer.data, input.size(), pcm.data() + 1);
+    for (size_t i = 0; i < input.size(); ++i) {
+        const int16_t expected = static_cast<int16_t>(clampUnit(input[i]) * 32767.0f);
+        if (pcm[i + 1] != expected) {
+            fail("floatToInt16", input.size(), "第 " + std::to_string(i) + " 个样本 " +
+                 std::to_string(pcm[i + 1]) + "，期望 " + std::to_string(expected));
+            break;
+        }
+    }
+
+    std::vector<float> expected(input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+        expected[i] = static_cast<float>(pcm[i + 1]) / 32768.0f;
+    }
+    std::vector<float> output(input.size() + 1);
+    AudioKernels::int16ToFloat(pcm.data() + 1, input.size(), output.data() + 1);
+    checkSamples("int16ToFloat", expected, output.data() + 1);
+}
+
+void testChannels(const std::vector<float>& input) {
+    for (int channels : {1, 2, 3, 6}) {
+        const size_t frames = input.size() / channels;
+        if (frames == 0) {
+            continue;
+        }
+        const std::string suffix = "(" + std::to_string(channels) + "声道)";
+
+        std::vector<float> planes(frames * channels);
+        std::vector<float*> plane_ptrs(channels);
+        for (int c = 0; c < channels; ++c) {
+            plane_ptrs[c] = planes.data() + c * frames;
+        }
+        AudioKernels::deinterleave(input.data(), frames, channels, plane_ptrs.data());
+        for (int c = 0; c < channels; ++c) {
+            std::vector<float> expected(frames);
+            for (size_t i = 0; i < frames; ++i) {
+                expected[i] = input[i * channels + c];
+            }
+            checkSamples("deinterleave" + suffix, expected, plane_ptrs[c]);
+        }
+
+        std::vector<float> expected(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            double sum = 0.0;
+            for (int c = 0; c < channels; ++c) {
+                sum += input[i * channels + c];
+            }
+            expected[i] = static_cast<float>(sum / channels);
+        }
+        const std::vector<const float*> const_planes(plane_ptrs.begin(), plane_ptrs.end());
+        std::vector<float> mono(frames);
+        AudioKernels::averageChannels(const_planes.data(), channels, frames, mono.data());
+        checkSamples("averageChannels" + suffix, expected, mono.data());
+    }
+}
+
+} // namespace
+
+int main() {
+    const std::string implementation = AudioKernels::getActiveImplementation();
+    std::cout << "测试实现: " << implementation << std::endl;
+
+    uint32_t seed = 12345;
+    for (size_t count : TEST_LENGTHS) {
+        const std::vector<float> input = makeSignal(count, seed++);
+        testAnalyze(input);
+        testPreEmphasis(input);
+        testScaleAndHighPass(input);
+        testPointwise(input);
+        testInt16Conversion(input);
+        testChannels(input);
+    }
+
+    if (failures != 0) {
+        std::cerr << failures << " 项检查失败" << std::endl;
+        return 1;
+    }
+    std::cout << "audio_kernels: 全部通过" << std::endl;
+    return 0;
+}
@@ -0,0 +1,114 @@
+// 健康检查响应解析测试：负载按忙碌通道加排队任务计算，空闲服务器的负载为0
+// 样例响应与recognizer_server的/health格式一致（multi_channel_status内嵌在顶层）
+#include "health_status.h"
+#include <iostream>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "失败: " << what << std::endl;
+        ++failures;
+    }
+}
+
+// 4个通道都正常工作（active_channels=4），没有任务
+const char* IDLE_HEALTH = R"({
+    "status": "healthy",
+    "upload_formats": ["wav", "flac"],
+    "multi_channel_status": {
+        "total_channels": 4,
+        "active_channels": 4,
+        "busy_channels": 0,
+        "pending_tasks": 0,
+        "batch_pending_tasks": 0,
+        "channels": [
+            {"channel_id": "channel_0", "status": 0},
+            {"channel_id": "channel_1", "status": 0},
+            {"channel_id": "channel_2", "status": 0},
+            {"channel_id": "channel_3", "status": 0}
+        ]
+    }
+})";
+
+// 3个通道在识别（其中一个已从队列取走任务），另有2个排队任务和1个批处理任务
+const char* BUSY_HEALTH = R"({
+    "status": "healthy",
+    "upload_formats": ["wav", "flac"],
+    "multi_channel_status": {
+        "total_channels": 4,
+        "active_channels": 4,
+        "busy_channels": 3,
+        "pending_tasks": 2,
+        "batch_pending_tasks": 1,
+        "channels": [
+            {"channel_id": "channel_0", "status": 1},
+            {"channel_id": "channel_1", "status": 1},
+            {"channel_id": "channel_2", "status": 0},
+            {"channel_id": "channel_3", "status": 1}
+        ]
+    }
+})";
+
+// 旧版服务器：没有busy_channels和upload_formats，按channels中的BUSY计数
+const char* LEGACY_BUSY_HEALTH = R"({
+    "status": "healthy",
+    "multi_channel_status": {
+        "total_channels": 2,
+        "active_channels": 2,
+        "pending_tasks": 1,
+        "channels": [
+            {"channel_id": "channel_0", "status": 1},
+            {"channel_id": "channel_1", "status": 2}
+        ]
+    }
+})";
+
+void testIdle() {
+    ServerHealthStatus status;
+    expect(parseServerHealthStatus(IDLE_HEALTH, status), "空闲响应解析成功");
+    expect(status.has_load, "空闲响应带有负载");
+    expect(status.capacity == 4, "空闲响应通道数为4");
+    expect(status.load == 0, "空闲服务器负载为0，实际为" + std::to_string(status.load));
+    expect(status.upload_formats.size() == 2 && status.upload_formats[1] == "flac", "上传格式");
+}
+
+void testBusy() {
+    ServerHealthStatus status;
+    expect(parseServerHealthStatus(BUSY_HEALTH, status), "忙碌响应解析成功");
+    expect(status.capacity == 4, "忙碌响应通道数为4");
+    expect(status.load == 6, "忙碌服务器负载为3个通道加3个排队任务，实际为" + std::to_string(status.load));
+}
+
+void testLegacy() {
+    ServerHealthStatus status;
+    expect(parseServerHealthStatus(LEGACY_BUSY_HEALTH, status), "旧版响应解析成功");
+    expect(status.load == 2, "旧版响应按BUSY通道计数，实际为" + std::to_string(status.load));
+    expect(status.upload_formats.empty(), "旧版服务器不声明上传格式");
+}
+
+void testInvalid() {
+    ServerHealthStatus status;
+    expect(!parseServerHealthStatus("not json", status), "非JSON响应返回false");
+    expect(parseServerHealthStatus(R"({"status": "healthy"})", status) && !status.has_load,
+           "没有多路识别状态时不报告负载");
+}
+
+} // namespace
+
+int main() {
+    testIdle();
+    testBusy();
+    testLegacy();
+    testInvalid();
+
+    if (failures != 0) {
+        std::cerr << failures << " 项检查失败" << std::endl;
+        return 1;
+    }
+    std::cout << "health_status: 全部通过" << std::endl;
+    return 0;
+}
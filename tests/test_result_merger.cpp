@@ -0,0 +1,112 @@
+// ResultMerger单元测试：ParallelOpenAIProcessor的结果乱序到达时按序号输出，重叠段去掉与上一段结尾重复的文本
+// 关闭定时合并，只检查到达即输出的路径，不依赖超时
+#include "result_merger.h"
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <iostream>
+#include <string>
+
+// result_merger.cpp记录耗时用，由parallel_openai_processor.cpp提供
+void log_performance(const std::string&, const std::string&, std::chrono::steady_clock::time_point) {}
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "失败: " << what << std::endl;
+        ++failures;
+    }
+}
+
+// 与ParallelOpenAIProcessor::handleReply发出的格式相同
+QString makeResult(int sequence, const QString& text, int overlap_ms = 0) {
+    QJsonObject obj;
+    obj["text"] = text;
+    obj["sequence"] = sequence;
+    obj["is_last"] = false;
+    obj["has_overlap"] = overlap_ms > 0;
+    obj["overlap_ms"] = overlap_ms;
+    return QString::fromUtf8(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+}
+
+struct Collector {
+    ResultMerger merger;
+    QStringList emitted;
+
+    Collector() {
+        merger.setTimerMerge(false);
+        QObject::connect(&merger, &ResultMerger::resultReady, [this](const QString& text) {
+            emitted.append(text);
+        });
+    }
+};
+
+void testOutOfOrder() {
+    Collector c;
+    c.merger.addResult(makeResult(2, "第三段"));
+    c.merger.addResult(makeResult(1, "第二段"));
+    expect(c.emitted.isEmpty(), "序号0未到时不应输出");
+
+    c.merger.addResult(makeResult(0, "第一段"));
+    expect(c.emitted.size() == 1, "序号0到达后一次输出前三段");
+    expect(c.emitted.value(0) == "第一段\n第二段\n第三段",
+           "输出顺序: " + c.emitted.value(0).toStdString());
+
+    c.merger.addResult(makeResult(3, "第四段"));
+    expect(c.emitted.size() == 2 && c.emitted.value(1) == "第四段", "后续按序到达的段立即输出");
+}
+
+void testOverlap() {
+    Collector c;
+    // 重叠段先于上一段到达，去重叠必须按输出顺序进行
+    c.merger.addResult(makeResult(1, "公园散步吧然后去吃饭", 1000));
+    c.merger.addResult(makeResult(0, "今天天气很好我们去公园散步吧"));
+    expect(c.emitted.size() == 1, "两段一次输出");
+    expect(c.emitted.value(0) == "今天天气很好我们去公园散步吧\n然后去吃饭",
+           "去除重叠: " + c.emitted.value(0).toStdString());
+
+    // 没有标记重叠的段保持原文
+    c.merger.addResult(makeResult(2, "然后去吃饭"));
+    expect(c.emitted.value(1) == "然后去吃饭", "无重叠段不裁剪: " + c.emitted.value(1).toStdString());
+}
+
+void testFailedSegment() {
+    Collector c;
+    // 失败段的空结果推进序号，后面的段不用等待超时
+    c.merger.addResult(makeResult(1, "第二段"));
+    c.merger.addResult(makeResult(0, ""));
+    expect(c.emitted.size() == 1 && c.emitted.value(0) == "第二段",
+           "空结果之后的段立即输出: " + c.emitted.value(0).toStdString());
+}
+
+void testClear() {
+    Collector c;
+    c.merger.addResult(makeResult(0, "上一次"));
+    c.merger.addResult(makeResult(5, "残留"));
+    c.merger.clear();
+
+    c.merger.addResult(makeResult(0, "重新开始"));
+    expect(c.emitted.size() == 2 && c.emitted.value(1) == "重新开始", "清空后从序号0重新开始");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    testOutOfOrder();
+    testOverlap();
+    testFailedSegment();
+    testClear();
+
+    if (failures != 0) {
+        std::cerr << failures << " 项检查失败" << std::endl;
+        return 1;
+    }
+    std::cout << "result_merger: 全部通过" << std::endl;
+    return 0;
+}